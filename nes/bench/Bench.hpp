@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace bench {
+    /// @brief number of ticks simulated in each iteration of a benchmark
+    /// @note large enough that the cost of the benchmark loop is lost in the noise
+    const uint64_t kTicksPerIteration = 10000;
+
+    /// @class NullBus
+    /// @brief bus model for cores that are not connected to memory (e.g. VGAExample)
+    struct NullBus {
+        template <class CORE>
+        void simulateCombinatorial(CORE& core) {}
+    };
+
+    /// @brief report the number of simulated ticks as a rate (i.e. ticks/sec)
+    inline void reportTicks(benchmark::State& state, uint64_t numTicks) {
+        state.counters["ticks/sec"] = benchmark::Counter(double(numTicks), benchmark::Counter::kIsRate);
+    }
+}
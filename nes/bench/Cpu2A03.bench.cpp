@@ -0,0 +1,42 @@
+#include "nes/bench/Bench.hpp"
+#include "nes/bench/Workloads.hpp"
+
+#include "nes/Cpu2A03TestBench.h"
+#include "nes/memory/SRAM.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/CpuBus.hpp"
+
+using namespace cpu2a03testbench;
+using namespace memory;
+using namespace simulation;
+
+namespace {
+    void BM_Cpu2A03_LoadStoreLoop(benchmark::State& state) {
+        Cpu2A03TestBench testBench;
+        SRAM sram(0x10000);
+        CpuBus<VCpu2A03> bus(sram);
+        Simulation<Cpu2A03TestBench, CpuBus<VCpu2A03>> simulation(testBench, bus);
+
+        bench::assembleLoadStoreLoop(sram);
+
+        testBench.setClockPolarity(0);
+        auto& core = testBench.core();
+        core.i_clk_en = 1;
+        core.i_irq_n = 1;
+        core.i_nmi_n = 1;
+
+        simulation.setTraceMode(TraceMode::kNone);
+        simulation.reset();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            simulation.tick(bench::kTicksPerIteration);
+            numTicks += bench::kTicksPerIteration;
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_Cpu2A03_LoadStoreLoop);
@@ -0,0 +1,42 @@
+#include "nes/bench/Bench.hpp"
+#include "nes/bench/Workloads.hpp"
+
+#include "nes/Cpu6502TestBench.h"
+#include "nes/memory/SRAM.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/CpuBus.hpp"
+
+using namespace cpu6502testbench;
+using namespace memory;
+using namespace simulation;
+
+namespace {
+    void BM_Cpu6502_LoadStoreLoop(benchmark::State& state) {
+        Cpu6502TestBench testBench;
+        SRAM sram(0x10000);
+        CpuBus<VCpu6502> bus(sram);
+        Simulation<Cpu6502TestBench, CpuBus<VCpu6502>> simulation(testBench, bus);
+
+        bench::assembleLoadStoreLoop(sram);
+
+        testBench.setClockPolarity(0);
+        auto& core = testBench.core();
+        core.i_clk_en = 1;
+        core.i_irq_n = 1;
+        core.i_nmi_n = 1;
+
+        simulation.setTraceMode(TraceMode::kNone);
+        simulation.reset();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            simulation.tick(bench::kTicksPerIteration);
+            numTicks += bench::kTicksPerIteration;
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_Cpu6502_LoadStoreLoop);
@@ -0,0 +1,31 @@
+#include "nes/bench/Bench.hpp"
+#include "nes/bench/Workloads.hpp"
+
+#include "nes/memory/SRAM.hpp"
+#include "nes/cpu6502/model/Cpu6502Model.hpp"
+
+using namespace memory;
+using namespace cpu6502::model;
+
+namespace {
+    void BM_Cpu6502Model_LoadStoreLoop(benchmark::State& state) {
+        SRAM sram(0x10000);
+        SRAMBus bus(sram);
+        Cpu6502Model<SRAMBus> model(bus);
+
+        bench::assembleLoadStoreLoop(sram);
+
+        model.reset();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            // note: each tick of the model is a CPU clock cycle
+            numTicks += model.run(bench::kTicksPerIteration);
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_Cpu6502Model_LoadStoreLoop);
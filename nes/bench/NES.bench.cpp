@@ -0,0 +1,51 @@
+#include "nes/bench/Bench.hpp"
+#include "nes/bench/NESBench.hpp"
+
+#include "nes/NESTestBench.h"
+#include "nes/NESFastTestBench.h"
+
+#include <memory>
+
+using namespace nestestbench;
+using namespace nesfasttestbench;
+
+namespace {
+    typedef bench::NESBench<NESTestBench, VNES> NESBench;
+    typedef bench::NESBench<NESFastTestBench, VNESFast> NESFastBench;
+
+    /// @brief boot from reset, up to the first rendered frame
+    void BM_NES_Boot(benchmark::State& state) {
+        // note: the Verilated model is too large for the stack
+        auto nes = std::make_unique<NESBench>();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            nes->reset();
+            numTicks += nes->simulateFrames(bench::kNumBootFrames);
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+
+    /// @brief steady state, after boot: rendering with NMI enabled
+    template <class NES_BENCH>
+    void BM_NES_Render(benchmark::State& state) {
+        auto nes = std::make_unique<NES_BENCH>();
+        nes->reset();
+        nes->simulateFrames(bench::kNumBootFrames);
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            nes->tick(bench::kTicksPerIteration);
+            numTicks += bench::kTicksPerIteration;
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_NES_Boot)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_NES_Render, NESBench);
+BENCHMARK_TEMPLATE(BM_NES_Render, NESFastBench);
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+
+#include "nes/bench/Workloads.hpp"
+#include "nes/memory/SRAM.hpp"
+#include "nes/memory/PageTable.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/NESBus.hpp"
+
+namespace bench {
+    // frames simulated by the boot: 2 frames to warm up the PPU, then the first rendered frame
+    const uint64_t kNumBootFrames = 3;
+
+    /// @class NESBench
+    /// @brief NES core, with an assembled NROM style program, CHR RAM and 4 screen nametables
+    /// @param TESTBENCH gtestverilog TestBench for a Verilated NES (e.g. NESTestBench, NES_mt2TestBench)
+    /// @param CORE Verilated NES core
+    template <class TESTBENCH, class CORE>
+    class NESBench {
+    public:
+        NESBench() : prg(0x10000), sram(0x0800), chr(0x2000), vram(0x1000), bus(cpuMemory, ppuMemory), simulation(testBench, bus) {
+            assembleNESBoot(prg);
+            fillPatternTables(chr.data(), chr.size());
+
+            cpuMemory.map(0x0000, sram.size(), sram.data());
+            cpuMemory.map(0x8000, 0x8000, static_cast<const uint8_t*>(prg.data() + 0x8000));
+
+            ppuMemory.map(0x0000, chr.size(), chr.data());
+            ppuMemory.map(0x2000, vram.size(), vram.data());
+
+            testBench.setClockPolarity(0);
+            testBench.core().i_ce = 1;
+
+            simulation.setTraceMode(simulation::TraceMode::kNone);
+        }
+
+        void reset() {
+            sram.clear(0);
+            vram.clear(0);
+
+            simulation.reset();
+
+            numFrames = 0;
+            wasFirstPixel = false;
+        }
+
+        /// @brief simulate until the frame counter reaches endFrame
+        /// @return number of ticks simulated
+        uint64_t simulateFrames(uint64_t endFrame) {
+            uint64_t numTicks = 0;
+
+            while (numFrames < endFrame) {
+                simulateTick();
+                numTicks += 1;
+            }
+
+            return numTicks;
+        }
+
+        /// @brief simulate ticks, without checking for the end of each frame
+        void tick(uint64_t numTicks) {
+            simulation.tick(numTicks);
+        }
+
+        uint64_t frames() const {
+            return numFrames;
+        }
+
+    private:
+        TESTBENCH testBench;
+
+        memory::SRAM prg;
+        memory::SRAM sram;
+        memory::SRAM chr;
+        memory::SRAM vram;
+
+        memory::PageTable cpuMemory;
+        memory::PageTable ppuMemory;
+
+        simulation::NESBus<CORE> bus;
+        simulation::Simulation<TESTBENCH, simulation::NESBus<CORE>> simulation;
+
+        uint64_t numFrames = 0;
+        bool wasFirstPixel = false;
+
+        void simulateTick() {
+            auto& core = testBench.core();
+
+            simulation.tick();
+
+            bool isFirstPixel = (core.o_video_x == 0) && (core.o_video_y == 0);
+            if (isFirstPixel && !wasFirstPixel) {
+                numFrames += 1;
+            }
+            wasFirstPixel = isFirstPixel;
+        }
+    };
+}
@@ -0,0 +1,194 @@
+#include "nes/bench/Bench.hpp"
+#include "nes/bench/NESBench.hpp"
+
+#include "nes/NESDebuggerTopTestBench.h"
+
+#include <memory>
+#include <vector>
+
+using namespace nesdebuggertoptestbench;
+
+namespace {
+    // VGA clock (25MHz) ticks for each NES clock (5MHz) tick
+    const int kVGATicksPerNESTick = 5;
+
+    // NES clock ticks for each half period of the SPI clock
+    // note: SPIPeripheral needs the NES clock to be at least 4x the SPI clock
+    const int kNESTicksPerSPIHalfBit = 2;
+
+    const uint64_t kNumTicksPerFrame = 341 * 262;
+
+    // debugger commands + values (see NESDebugger.v, NESDebuggerValues.v)
+    const uint8_t kCmdMemWrite = 2;
+    const uint8_t kCmdValueWrite = 4;
+
+    const uint16_t kValueNESResetN = 1;
+    const uint16_t kValueMemoryPool = 2;
+
+    const uint16_t kMemoryPoolPrg = 0;
+    const uint16_t kMemoryPoolPatternTable = 2;
+
+    /// @class DebuggerTopBench
+    /// @brief NESDebuggerTop, with the same boot program + pattern tables as NESBench, loaded over SPI
+    /// @note NESDebuggerTop has two clocks, so is driven directly rather than via Simulation
+    class DebuggerTopBench {
+    public:
+        DebuggerTopBench() {
+            auto& core = testBench.core();
+
+            core.i_spi_cs_n = 1;
+            core.i_spi_clk = 0;
+            core.i_spi_copi = 0;
+
+            core.i_reset_n = 0;
+            tick();
+            core.i_reset_n = 1;
+
+            memory::SRAM prg(0x10000);
+            bench::assembleNESBoot(prg);
+
+            std::vector<uint8_t> patternTables(0x2000);
+            bench::fillPatternTables(patternTables.data(), patternTables.size());
+
+            // hold the NES in reset while its memories are written
+            writeValue(kValueNESResetN, 0);
+
+            writeValue(kValueMemoryPool, kMemoryPoolPrg);
+            writeMemory(0x8000, prg.data() + 0x8000, 0x8000);
+
+            writeValue(kValueMemoryPool, kMemoryPoolPatternTable);
+            writeMemory(0x0000, patternTables.data(), patternTables.size());
+        }
+
+        /// @brief reset the NES via the debugger, and boot up to the first rendered frame
+        /// @return number of ticks simulated
+        uint64_t boot() {
+            writeValue(kValueNESResetN, 0);
+            writeValue(kValueNESResetN, 1);
+
+            // note: NESDebuggerTop doesn't output the video position, so boot for a fixed number of frames
+            uint64_t numTicks = bench::kNumBootFrames * kNumTicksPerFrame;
+            for (uint64_t i = 0; i < numTicks; i++) {
+                tick();
+            }
+
+            return numTicks;
+        }
+
+        /// @brief simulate one tick of the NES clock, and the VGA clock ticks within it
+        void tick() {
+            auto& core = testBench.core();
+
+            for (int phase = 0; phase < 2; phase++) {
+                core.i_clk_5mhz = !core.i_clk_5mhz;
+
+                for (int i = 0; i < kVGATicksPerNESTick; i++) {
+                    core.i_clk_25mhz = !core.i_clk_25mhz;
+                    core.eval();
+                }
+            }
+        }
+
+    private:
+        NESDebuggerTopTestBench testBench;
+
+        void writeValue(uint16_t id, uint16_t value) {
+            const uint8_t command[] = { kCmdValueWrite, hi(id), lo(id), hi(value), lo(value) };
+
+            select();
+            for (uint8_t byte : command) {
+                sendByte(byte);
+            }
+            deselect();
+        }
+
+        void writeMemory(uint16_t address, const uint8_t* data, size_t size) {
+            const uint8_t command[] = { kCmdMemWrite, hi(address), lo(address), hi(uint16_t(size)), lo(uint16_t(size)) };
+
+            select();
+            for (uint8_t byte : command) {
+                sendByte(byte);
+            }
+            for (size_t i = 0; i < size; i++) {
+                sendByte(data[i]);
+            }
+            deselect();
+        }
+
+        void select() {
+            testBench.core().i_spi_cs_n = 0;
+            tick(kNESTicksPerSPIHalfBit);
+        }
+
+        /// @note the debugger is held in reset while chip select is inactive
+        void deselect() {
+            // let the last byte cross into the NES clock domain
+            tick(kNESTicksPerSPIHalfBit * 8);
+
+            testBench.core().i_spi_cs_n = 1;
+            tick(kNESTicksPerSPIHalfBit);
+        }
+
+        /// @brief send a byte, MSB first, that the peripheral samples on the falling edge of SPI clock
+        void sendByte(uint8_t byte) {
+            auto& core = testBench.core();
+
+            for (int bit = 7; bit >= 0; bit--) {
+                core.i_spi_copi = (byte >> bit) & 1;
+                core.i_spi_clk = 1;
+                tick(kNESTicksPerSPIHalfBit);
+
+                core.i_spi_clk = 0;
+                tick(kNESTicksPerSPIHalfBit);
+            }
+        }
+
+        void tick(int numTicks) {
+            for (int i = 0; i < numTicks; i++) {
+                tick();
+            }
+        }
+
+        static uint8_t hi(uint16_t value) {
+            return (value >> 8) & 0xff;
+        }
+
+        static uint8_t lo(uint16_t value) {
+            return value & 0xff;
+        }
+    };
+
+    /// @brief boot from reset, up to the first rendered frame, with VGA output running
+    void BM_NESDebuggerTop_Boot(benchmark::State& state) {
+        // note: the Verilated model is too large for the stack
+        auto nes = std::make_unique<DebuggerTopBench>();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            numTicks += nes->boot();
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+
+    /// @brief steady state, after boot: rendering with NMI enabled, and VGA output running
+    void BM_NESDebuggerTop_Render(benchmark::State& state) {
+        auto nes = std::make_unique<DebuggerTopBench>();
+        nes->boot();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            for (uint64_t i = 0; i < bench::kTicksPerIteration; i++) {
+                nes->tick();
+            }
+            numTicks += bench::kTicksPerIteration;
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_NESDebuggerTop_Boot)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_NESDebuggerTop_Render);
@@ -0,0 +1,101 @@
+#include "nes/bench/Bench.hpp"
+#include "nes/bench/Workloads.hpp"
+
+#include "nes/PPUTestBench.h"
+#include "nes/memory/SRAM.hpp"
+#include "nes/simulation/Simulation.hpp"
+
+using namespace pputestbench;
+using namespace memory;
+using namespace simulation;
+
+namespace {
+    const int RS_PPUMASK = 1;
+    const int RS_PPUADDR = 6;
+    const int RS_PPUDATA = 7;
+
+    const int RW_READ = 1;
+    const int RW_WRITE = 0;
+
+    /// @class PPUBus
+    /// @brief Connect the VRAM bus of a PPU core to 16KB of SRAM
+    class PPUBus {
+    public:
+        PPUBus(SRAM& vram) : m_vram(vram) {
+        }
+
+        inline void simulateCombinatorial(VPPU& core) {
+            if (core.i_clk == 1) {
+                if (core.o_vram_we_n == 0) {
+                    m_vram.write(core.o_vram_address, core.o_vram_data);
+                } else if (core.o_vram_rd_n == 0) {
+                    core.i_vram_data = m_vram.read(core.o_vram_address);
+                }
+            } else {
+                core.i_vram_data = 0xFF;
+            }
+        }
+
+    private:
+        SRAM& m_vram;
+    };
+
+    void writeRegister(Simulation<PPUTestBench, PPUBus>& simulation, VPPU& core, int rs, uint8_t data) {
+        core.i_rs = rs;
+        core.i_rw = RW_WRITE;
+        core.i_data = data;
+        simulation.tick();
+
+        core.i_rw = RW_READ;
+    }
+
+    void BM_PPU_RenderNametable(benchmark::State& state) {
+        PPUTestBench testBench;
+        SRAM vram(0x4000);
+        PPUBus bus(vram);
+        Simulation<PPUTestBench, PPUBus> simulation(testBench, bus);
+
+        // pattern tables + a nametable that uses every tile, with a non-zero attribute table
+        vram.clear(0);
+        bench::fillPatternTables(vram.data(), 0x2000);
+        for (int i = 0; i < 0x3c0; i++) {
+            vram.write(0x2000 + i, i & 0xff);
+        }
+        for (int i = 0x3c0; i < 0x400; i++) {
+            vram.write(0x2000 + i, 0xe4);
+        }
+
+        testBench.setClockPolarity(1);
+        auto& core = testBench.core();
+        core.i_cs_n = 0;
+        core.i_ce = 1;
+        core.i_rw = RW_READ;
+
+        simulation.setTraceMode(TraceMode::kNone);
+        simulation.reset();
+
+        // palette
+        writeRegister(simulation, core, RS_PPUADDR, 0x3f);
+        writeRegister(simulation, core, RS_PPUADDR, 0x00);
+        for (int i = 0; i < 32; i++) {
+            writeRegister(simulation, core, RS_PPUDATA, uint8_t(i * 3) & 0x3f);
+        }
+
+        // render background + sprites
+        writeRegister(simulation, core, RS_PPUMASK, 0x1e);
+
+        // deselect, so that the CPU interface is idle while rendering
+        core.i_cs_n = 1;
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            simulation.tick(bench::kTicksPerIteration);
+            numTicks += bench::kTicksPerIteration;
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_PPU_RenderNametable);
@@ -0,0 +1,36 @@
+#include "nes/bench/Bench.hpp"
+
+#include "nes/VGAExampleTestBench.h"
+#include "nes/simulation/Simulation.hpp"
+
+using namespace vgaexampletestbench;
+using namespace simulation;
+
+namespace {
+    void BM_VGAExample_Frame(benchmark::State& state) {
+        VGAExampleTestBench testBench;
+        bench::NullBus bus;
+        Simulation<VGAExampleTestBench, bench::NullBus> simulation(testBench, bus);
+
+        // same rectangle as EmulatorVGA
+        auto& core = testBench.core();
+        core.i_rect_x = 10;
+        core.i_rect_y = 15;
+        core.i_rect_width = 80;
+        core.i_rect_height = 66;
+
+        simulation.setTraceMode(TraceMode::kNone);
+        simulation.reset();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            simulation.tick(bench::kTicksPerIteration);
+            numTicks += bench::kTicksPerIteration;
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_VGAExample_Frame);
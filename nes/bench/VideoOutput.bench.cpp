@@ -0,0 +1,62 @@
+#include "nes/bench/Bench.hpp"
+
+#include "nes/VideoOutputTestBench.h"
+#include "nes/simulation/Simulation.hpp"
+
+using namespace videooutputtestbench;
+using namespace simulation;
+
+namespace {
+    const int kNESVisibleWidth = 255;
+    const int kVGAWidth = 800;
+
+    /// @class VideoFeed
+    /// @brief feed a scanline of NES pixels at the NES pixel rate, while the VGA
+    ///        position sweeps each line (VGA clock is twice the NES pixel clock)
+    class VideoFeed {
+    public:
+        inline void simulateCombinatorial(VVideoOutput& core) {
+            if (core.i_clk == 1) {
+                return;
+            }
+
+            core.i_vga_x = m_vgaX;
+            m_vgaX = (m_vgaX + 1) % kVGAWidth;
+
+            m_isPixelTick = !m_isPixelTick;
+            core.i_pixel_valid = m_isPixelTick ? 1 : 0;
+            if (m_isPixelTick) {
+                core.i_pixel_x = m_pixelX;
+                core.i_pixel_rgb = (m_pixelX << 16) | (m_pixelX << 8) | m_pixelX;
+                m_pixelX = (m_pixelX + 1) % kNESVisibleWidth;
+            }
+        }
+
+    private:
+        uint32_t m_vgaX = 0;
+        uint32_t m_pixelX = 0;
+        bool m_isPixelTick = false;
+    };
+
+    void BM_VideoOutput_Scanlines(benchmark::State& state) {
+        VideoOutputTestBench testBench;
+        VideoFeed feed;
+        Simulation<VideoOutputTestBench, VideoFeed> simulation(testBench, feed);
+
+        testBench.setClockPolarity(0);
+
+        simulation.setTraceMode(TraceMode::kNone);
+        simulation.reset();
+
+        uint64_t numTicks = 0;
+
+        for (auto _ : state) {
+            simulation.tick(bench::kTicksPerIteration);
+            numTicks += bench::kTicksPerIteration;
+        }
+
+        bench::reportTicks(state, numTicks);
+    }
+}
+
+BENCHMARK(BM_VideoOutput_Scanlines);
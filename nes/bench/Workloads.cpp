@@ -0,0 +1,132 @@
+#include "Workloads.hpp"
+
+#include "nes/cpu6502/assembler/Assembler.hpp"
+
+using namespace cpu6502::assembler;
+
+namespace {
+    const uint16_t PPUCTRL = 0x2000;
+    const uint16_t PPUMASK = 0x2001;
+    const uint16_t PPUSTATUS = 0x2002;
+    const uint16_t PPUADDR = 0x2006;
+    const uint16_t PPUDATA = 0x2007;
+
+    const uint16_t RAM = 0x0000;
+
+    const uint8_t kPalette[32] = {
+        0x0f, 0x01, 0x11, 0x21, 0x0f, 0x06, 0x16, 0x26, 0x0f, 0x09, 0x19, 0x29, 0x0f, 0x04, 0x14, 0x24,
+        0x0f, 0x02, 0x12, 0x22, 0x0f, 0x07, 0x17, 0x27, 0x0f, 0x0a, 0x1a, 0x2a, 0x0f, 0x05, 0x15, 0x25
+    };
+}
+
+namespace bench {
+    void assembleLoadStoreLoop(memory::SRAM& sram) {
+        // note: Assembler only positions code by .org after the first opcode
+        Assembler()
+                .NOP()
+            .org(0x0200)
+            .label("start")
+                .LDX().immediate(0)
+            .label("loop")
+                .LDA().absolute(0x1000).x()
+                .STA().absolute(0x2000).x()
+                .INX()
+                .JMP().absolute("loop")
+            .org(0xfffc)
+            .word("start")
+            .compileTo(sram);
+    }
+
+    void assembleNESBoot(memory::SRAM& sram) {
+        Assembler assembler;
+
+        assembler
+                .NOP()
+            .org(0x8000)
+            .label("reset")
+                .SEI()
+                .CLD()
+                .LDX().immediate(0xff)
+                .TXS()
+                .LDA().immediate(0)
+                .STA().absolute(PPUCTRL)
+                .STA().absolute(PPUMASK)
+            .label("vblank1")
+                .BIT().absolute(PPUSTATUS)
+                .BPL().relative("vblank1")
+                .LDX().immediate(0)
+            .label("clear_ram")
+                .STA().absolute(RAM).x()
+                .STA().absolute(RAM + 0x0100).x()
+                .STA().absolute(RAM + 0x0200).x()
+                .STA().absolute(RAM + 0x0300).x()
+                .STA().absolute(RAM + 0x0400).x()
+                .STA().absolute(RAM + 0x0500).x()
+                .STA().absolute(RAM + 0x0600).x()
+                .STA().absolute(RAM + 0x0700).x()
+                .INX()
+                .BNE().relative("clear_ram")
+            .label("vblank2")
+                .BIT().absolute(PPUSTATUS)
+                .BPL().relative("vblank2")
+
+                // nametable 0 + attribute table (0x2000:0x23FF)
+                .LDA().immediate(0x20)
+                .STA().absolute(PPUADDR)
+                .LDA().immediate(0x00)
+                .STA().absolute(PPUADDR)
+                .LDY().immediate(4)
+            .label("fill_nametable_page")
+                .LDX().immediate(0)
+            .label("fill_nametable")
+                .STX().absolute(PPUDATA)
+                .INX()
+                .BNE().relative("fill_nametable")
+                .DEY()
+                .BNE().relative("fill_nametable_page")
+
+                // palette (0x3F00:0x3F1F)
+                .LDA().immediate(0x3f)
+                .STA().absolute(PPUADDR)
+                .LDA().immediate(0x00)
+                .STA().absolute(PPUADDR)
+                .LDX().immediate(0)
+            .label("fill_palette")
+                .LDA().absolute("palette").x()
+                .STA().absolute(PPUDATA)
+                .INX()
+                .CPX().immediate(sizeof(kPalette))
+                .BNE().relative("fill_palette")
+
+                // enable NMI on vblank, and rendering of background + sprites
+                .LDA().immediate(0x80)
+                .STA().absolute(PPUCTRL)
+                .LDA().immediate(0x1e)
+                .STA().absolute(PPUMASK)
+            .label("main")
+                .INC().absolute(0x0010)
+                .JMP().absolute("main")
+            .label("nmi")
+                .INC().absolute(0x0011)
+                .RTI()
+            .label("palette");
+
+        for (uint8_t colour : kPalette) {
+            assembler.byte(colour);
+        }
+
+        assembler
+            .org(0xfffa)
+            .word("nmi")
+            .word("reset")
+            .word("nmi")
+            .compileTo(sram);
+    }
+
+    void fillPatternTables(uint8_t* patternTables, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            // vary both bit planes by tile (16 bytes) and row
+            patternTables[i] = uint8_t((i >> 4) ^ (i * 0x35));
+        }
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "nes/memory/SRAM.hpp"
+
+namespace bench {
+    /// @brief assemble a tight loop of LDA/STA (absolute,X) into a 64KB address space
+    void assembleLoadStoreLoop(memory::SRAM& sram);
+
+    /// @brief assemble a typical NES boot into a 64KB address space, with PRG at 0x8000:0xFFFF
+    /// @note waits for the PPU to warm up, clears RAM, fills the first nametable + palette,
+    ///       then enables NMI + rendering and spins in a main loop
+    void assembleNESBoot(memory::SRAM& sram);
+
+    /// @brief fill pattern tables with a repeating (non-empty) set of tiles
+    void fillPatternTables(uint8_t* patternTables, size_t size);
+}
@@ -0,0 +1,45 @@
+#include "nes/bench/Bench.hpp"
+#include "nes/bench/NESBench.hpp"
+
+// note: each variant of the NES is Verilated with the same top module (VNES),
+//       so is built into a binary of its own, selected by NES_THREADS (see BUILD)
+#if NES_THREADS == 1
+#include "nes/NESTestBench.h"
+typedef nestestbench::NESTestBench NESThreadsTestBench;
+#elif NES_THREADS == 2
+#include "nes/NES_mt2TestBench.h"
+typedef nes_mt2testbench::NES_mt2TestBench NESThreadsTestBench;
+#elif NES_THREADS == 4
+#include "nes/NES_mt4TestBench.h"
+typedef nes_mt4testbench::NES_mt4TestBench NESThreadsTestBench;
+#else
+#error "NES_THREADS should be 1, 2 or 4"
+#endif
+
+#include <memory>
+
+namespace {
+    typedef bench::NESBench<NESThreadsTestBench, VNES> NESBench;
+
+    /// @brief render one full frame per iteration, in steady state after boot
+    void BM_NES_RenderFrame(benchmark::State& state) {
+        // note: the Verilated model is too large for the stack
+        auto nes = std::make_unique<NESBench>();
+        nes->reset();
+        nes->simulateFrames(bench::kNumBootFrames);
+
+        uint64_t numTicks = 0;
+        uint64_t numFrames = 0;
+
+        for (auto _ : state) {
+            numTicks += nes->simulateFrames(nes->frames() + 1);
+            numFrames += 1;
+        }
+
+        bench::reportTicks(state, numTicks);
+        state.counters["frames/sec"] = benchmark::Counter(double(numFrames), benchmark::Counter::kIsRate);
+        state.counters["threads"] = NES_THREADS;
+    }
+}
+
+BENCHMARK(BM_NES_RenderFrame)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,35 @@
+#include "CNROM.hpp"
+
+namespace cartridge {
+    CNROM::CNROM(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam) : Mapper(rom, cpuMemory, ppuMemory, nametableRam, true), m_chrBank(0) {
+
+    }
+
+    void CNROM::reset() {
+        mapPrg16(0x8000, 0);
+        mapPrg16(0xC000, numPrgBanks16() - 1);
+
+        m_chrBank = 0;
+
+        mapChr8(m_chrBank);
+
+        setMirroring(m_rom.header().mirroring);
+    }
+
+    void CNROM::write(uint16_t address, uint8_t value) {
+        // bank select (0x8000:0xFFFF)
+        m_chrBank = value;
+
+        mapChr8(m_chrBank);
+    }
+
+    std::vector<uint8_t> CNROM::registers() const {
+        return { m_chrBank };
+    }
+
+    void CNROM::restoreRegisters(std::span<const uint8_t> registers) {
+        reset();
+
+        write(0x8000, registers[0]);
+    }
+}
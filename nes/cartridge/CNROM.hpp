@@ -0,0 +1,23 @@
+#pragma once
+
+#include "nes/cartridge/Mapper.hpp"
+
+namespace cartridge {
+    /// @class CNROM
+    /// @brief Mapper 3 - 16KB or 32KB PRG ROM, switchable 8KB CHR ROM bank
+    /// @note https://www.nesdev.org/wiki/INES_Mapper_003
+    class CNROM : public Mapper {
+    public:
+        CNROM(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam);
+
+        void reset() override;
+        void write(uint16_t address, uint8_t value) override;
+
+    protected:
+        std::vector<uint8_t> registers() const override;
+        void restoreRegisters(std::span<const uint8_t> registers) override;
+
+    private:
+        uint8_t m_chrBank;
+    };
+}
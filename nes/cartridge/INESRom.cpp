@@ -0,0 +1,253 @@
+#include "INESRom.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    bool hasBit(uint8_t value, int index) {
+        return (value & (1 << index)) != 0;
+    }
+
+    // note: the exponent-multiplier notation can describe sizes up to 2^63 * 7, far larger than
+    //       any file that could be mapped. Larger exponents are rejected, so that sizes can't overflow.
+    const size_t kMaxRomSizeExponent = 30;
+
+    /// @brief decode a NES 2.0 ROM size, from the LSB in byte 4/5 and MSB nibble in byte 9
+    /// @return false if the size is too large to be a ROM image
+    bool decodeNES20RomSize(uint8_t lsb, uint8_t msb, size_t bankSize, size_t& size) {
+        if (msb == 0x0F) {
+            // exponent-multiplier notation: 2^E * (MM*2 + 1)
+            size_t exponent = lsb >> 2;
+            size_t multiplier = (lsb & 0x03) * 2 + 1;
+
+            if (exponent > kMaxRomSizeExponent) {
+                return false;
+            }
+
+            size = (size_t(1) << exponent) * multiplier;
+            return true;
+        }
+
+        size = ((size_t(msb) << 8) | lsb) * bankSize;
+        return true;
+    }
+
+    /// @brief add sizes, unless the sum overflows
+    bool addSize(size_t a, size_t b, size_t& sum) {
+        if (b > (SIZE_MAX - a)) {
+            return false;
+        }
+
+        sum = a + b;
+        return true;
+    }
+
+    /// @brief decode a NES 2.0 RAM size shift count (64 << shift bytes)
+    size_t decodeNES20RamSize(uint8_t shift) {
+        return (shift == 0) ? 0 : (size_t(64) << shift);
+    }
+}
+
+namespace cartridge {
+    bool INESHeader::parse(const uint8_t* data, INESHeader& header, std::string& error) {
+        const uint8_t MSDOS_EOF = 0x1A;
+        if ((data[0] != 'N') || (data[1] != 'E') || (data[2] != 'S') || (data[3] != MSDOS_EOF)) {
+            error = "missing iNES header";
+            return false;
+        }
+
+        uint8_t flags6 = data[6];
+        uint8_t flags7 = data[7];
+
+        header.isNES20 = (flags7 & 0x0C) == 0x08;
+
+        header.hasBattery = hasBit(flags6, 1);
+        header.hasTrainer = hasBit(flags6, 2);
+
+        if (hasBit(flags6, 3)) {
+            header.mirroring = Mirroring::kFourScreen;
+        } else {
+            header.mirroring = hasBit(flags6, 0) ? Mirroring::kVertical : Mirroring::kHorizontal;
+        }
+
+        if (header.isNES20) {
+            header.mapper = (flags6 >> 4) | (flags7 & 0xF0) | (uint16_t(data[8] & 0x0F) << 8);
+            header.submapper = data[8] >> 4;
+
+            if (!decodeNES20RomSize(data[4], data[9] & 0x0F, kPrgBankSize, header.prgRomSize)) {
+                error = "PRG ROM size is too large";
+                return false;
+            }
+
+            if (!decodeNES20RomSize(data[5], data[9] >> 4, kChrBankSize, header.chrRomSize)) {
+                error = "CHR ROM size is too large";
+                return false;
+            }
+
+            // volatile + battery backed RAM
+            header.prgRamSize = decodeNES20RamSize(data[10] & 0x0F) + decodeNES20RamSize(data[10] >> 4);
+            header.chrRamSize = decodeNES20RamSize(data[11] & 0x0F) + decodeNES20RamSize(data[11] >> 4);
+        } else {
+            // note: bytes 12-15 should be zero, a non-zero value is usually a 'ripper'
+            //       signature (e.g. "DiskDude!") over byte 7, so the upper mapper nibble is unreliable
+            bool isDirty = (data[12] | data[13] | data[14] | data[15]) != 0;
+
+            header.mapper = (flags6 >> 4) | (isDirty ? 0 : (flags7 & 0xF0));
+            header.submapper = 0;
+
+            header.prgRomSize = data[4] * kPrgBankSize;
+            header.chrRomSize = data[5] * kChrBankSize;
+
+            // note: 0 means 8KB, for compatibility
+            header.prgRamSize = ((data[8] == 0) ? 1 : data[8]) * 0x2000;
+            header.chrRamSize = (header.chrRomSize == 0) ? kChrBankSize : 0;
+        }
+
+        if (header.prgRomSize == 0) {
+            error = "no PRG ROM";
+            return false;
+        }
+
+        return true;
+    }
+
+    INESRom::INESRom() : m_data(nullptr), m_size(0), m_header() {
+
+    }
+
+    INESRom::~INESRom() {
+        close();
+    }
+
+    bool INESRom::open(const std::string& path) {
+        close();
+        m_error.clear();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return fail("unable to open '" + path + "': " + strerror(errno));
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0) {
+            ::close(fd);
+            return fail("unable to stat '" + path + "': " + strerror(errno));
+        }
+
+        size_t size = size_t(fileStat.st_size);
+        if (size < INESHeader::kSize) {
+            ::close(fd);
+            return fail("'" + path + "' is too small to be a ROM image");
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // note: the mapping keeps its own reference to the file
+        ::close(fd);
+
+        if (mapping == MAP_FAILED) {
+            return fail("unable to map '" + path + "': " + strerror(errno));
+        }
+
+        m_data = static_cast<const uint8_t*>(mapping);
+        m_size = size;
+
+        if (!INESHeader::parse(m_data, m_header, m_error)) {
+            return fail("'" + path + "': " + m_error);
+        }
+
+        size_t offset = INESHeader::kSize;
+        size_t trainerSize = m_header.hasTrainer ? INESHeader::kTrainerSize : 0;
+        size_t expectedSize = offset + trainerSize;
+
+        if (!addSize(expectedSize, m_header.prgRomSize, expectedSize) || !addSize(expectedSize, m_header.chrRomSize, expectedSize)) {
+            return fail("'" + path + "': PRG / CHR ROM sizes are too large");
+        }
+
+        // note: trailing data (e.g. PlayChoice-10 INST-ROM) is permitted, and ignored
+        if (m_size < expectedSize) {
+            return fail("'" + path + "' is truncated, expected " + std::to_string(expectedSize) + " bytes but found " + std::to_string(m_size));
+        }
+
+        m_trainer = std::span<const uint8_t>(m_data + offset, trainerSize);
+        offset += trainerSize;
+
+        m_prgRom = std::span<const uint8_t>(m_data + offset, m_header.prgRomSize);
+        offset += m_header.prgRomSize;
+
+        m_chrRom = std::span<const uint8_t>(m_data + offset, m_header.chrRomSize);
+
+        return true;
+    }
+
+    void INESRom::close() {
+        if (m_data != nullptr) {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_header = INESHeader();
+        m_trainer = {};
+        m_prgRom = {};
+        m_chrRom = {};
+    }
+
+    bool INESRom::isOpen() const {
+        return m_data != nullptr;
+    }
+
+    const std::string& INESRom::error() const {
+        return m_error;
+    }
+
+    const INESHeader& INESRom::header() const {
+        return m_header;
+    }
+
+    std::span<const uint8_t> INESRom::trainer() const {
+        return m_trainer;
+    }
+
+    std::span<const uint8_t> INESRom::prgRom() const {
+        return m_prgRom;
+    }
+
+    std::span<const uint8_t> INESRom::chrRom() const {
+        return m_chrRom;
+    }
+
+    size_t INESRom::numPrgBanks() const {
+        return m_prgRom.size() / INESHeader::kPrgBankSize;
+    }
+
+    size_t INESRom::numChrBanks() const {
+        return m_chrRom.size() / INESHeader::kChrBankSize;
+    }
+
+    std::span<const uint8_t> INESRom::prgBank(size_t index) const {
+        assert(index < numPrgBanks());
+
+        return m_prgRom.subspan(index * INESHeader::kPrgBankSize, INESHeader::kPrgBankSize);
+    }
+
+    std::span<const uint8_t> INESRom::chrBank(size_t index) const {
+        assert(index < numChrBanks());
+
+        return m_chrRom.subspan(index * INESHeader::kChrBankSize, INESHeader::kChrBankSize);
+    }
+
+    bool INESRom::fail(const std::string& reason) {
+        close();
+        m_error = reason;
+
+        return false;
+    }
+}
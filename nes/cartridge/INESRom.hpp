@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace cartridge {
+    /// @brief nametable mirroring, wired by the cartridge
+    enum class Mirroring {
+        kHorizontal,
+        kVertical,
+        kFourScreen,
+        kSingleScreenLower,     // mapper controlled (e.g. MMC1)
+        kSingleScreenUpper
+    };
+
+    /// @class INESHeader
+    /// @brief Decoded 16 byte header of an iNES (or NES 2.0) ROM image
+    struct INESHeader {
+        static constexpr size_t kSize = 16;
+        static constexpr size_t kTrainerSize = 512;
+        static constexpr size_t kPrgBankSize = 0x4000;
+        static constexpr size_t kChrBankSize = 0x2000;
+
+        bool isNES20;
+
+        uint16_t mapper;
+        uint8_t submapper;
+        Mirroring mirroring;
+        bool hasBattery;
+        bool hasTrainer;
+
+        // sizes in bytes
+        size_t prgRomSize;
+        size_t chrRomSize;
+        size_t prgRamSize;
+        size_t chrRamSize;
+
+        /// @brief decode and validate a header
+        /// @param data first kSize bytes of the ROM image
+        /// @param header decoded header
+        /// @param error reason that the header is invalid
+        /// @return false if the header is not a valid iNES or NES 2.0 header
+        static bool parse(const uint8_t* data, INESHeader& header, std::string& error);
+    };
+
+    /// @class INESRom
+    /// @brief iNES (.nes) ROM image, memory mapped from file
+    /// @note PRG / CHR banks are views directly onto the mapped file, so they can be
+    ///       mapped into a memory::PageTable without copying. Views remain valid 
+    ///       until the INESRom is closed or destroyed.
+    class INESRom {
+    public:
+        INESRom();
+        ~INESRom();
+
+        INESRom(const INESRom&) = delete;
+        INESRom& operator=(const INESRom&) = delete;
+
+        /// @brief memory map and validate a ROM image
+        /// @param path filepath of .nes ROM image
+        /// @return false if the file could not be mapped, or is not a valid ROM image (see error())
+        bool open(const std::string& path);
+
+        /// @brief unmap the ROM image
+        void close();
+
+        bool isOpen() const;
+
+        /// @brief reason that the last call to open() failed
+        const std::string& error() const;
+
+        const INESHeader& header() const;
+
+        /// @brief 512 byte trainer (empty if the ROM has no trainer)
+        std::span<const uint8_t> trainer() const;
+
+        /// @brief all of PRG ROM
+        std::span<const uint8_t> prgRom() const;
+
+        /// @brief all of CHR ROM (empty if the cartridge uses CHR RAM)
+        std::span<const uint8_t> chrRom() const;
+
+        /// @brief number of 16KB PRG ROM banks
+        size_t numPrgBanks() const;
+
+        /// @brief number of 8KB CHR ROM banks
+        size_t numChrBanks() const;
+
+        /// @brief view of a 16KB PRG ROM bank
+        std::span<const uint8_t> prgBank(size_t index) const;
+
+        /// @brief view of an 8KB CHR ROM bank
+        std::span<const uint8_t> chrBank(size_t index) const;
+
+    private:
+        bool fail(const std::string& reason);
+
+        const uint8_t* m_data;
+        size_t m_size;
+        INESHeader m_header;
+        std::span<const uint8_t> m_trainer;
+        std::span<const uint8_t> m_prgRom;
+        std::span<const uint8_t> m_chrRom;
+        std::string m_error;
+    };
+}
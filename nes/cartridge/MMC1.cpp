@@ -0,0 +1,119 @@
+#include "MMC1.hpp"
+
+namespace {
+    const uint8_t kShiftReset = 0x10;
+}
+
+namespace cartridge {
+    MMC1::MMC1(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam) : Mapper(rom, cpuMemory, ppuMemory, nametableRam, true), m_shift(kShiftReset), m_control(0x0C), m_chrBank0(0), m_chrBank1(0), m_prgBank(0) {
+
+    }
+
+    void MMC1::reset() {
+        m_shift = kShiftReset;
+
+        // PRG mode 3 - last bank fixed at 0xC000
+        m_control = 0x0C;
+        m_chrBank0 = 0;
+        m_chrBank1 = 0;
+        m_prgBank = 0;
+
+        updateBanks();
+    }
+
+    void MMC1::write(uint16_t address, uint8_t value) {
+        if (value & 0x80) {
+            m_shift = kShiftReset;
+            m_control |= 0x0C;
+
+            updateBanks();
+
+            return;
+        }
+
+        bool isFull = (m_shift & 1) == 1;
+        m_shift = (m_shift >> 1) | ((value & 1) << 4);
+
+        if (!isFull) {
+            return;
+        }
+
+        // register is selected by address bits 13 + 14
+        switch ((address >> 13) & 3) {
+            case 0:
+                m_control = m_shift;
+                break;
+            case 1:
+                m_chrBank0 = m_shift;
+                break;
+            case 2:
+                m_chrBank1 = m_shift;
+                break;
+            case 3:
+                m_prgBank = m_shift & 0x0F;
+                break;
+        }
+
+        m_shift = kShiftReset;
+
+        updateBanks();
+    }
+
+    std::vector<uint8_t> MMC1::registers() const {
+        return { m_shift, m_control, m_chrBank0, m_chrBank1, m_prgBank };
+    }
+
+    void MMC1::restoreRegisters(std::span<const uint8_t> registers) {
+        m_shift = registers[0];
+        m_control = registers[1];
+        m_chrBank0 = registers[2];
+        m_chrBank1 = registers[3];
+        m_prgBank = registers[4];
+
+        updateBanks();
+    }
+
+    void MMC1::updateBanks() {
+        switch (m_control & 3) {
+            case 0:
+                setMirroring(Mirroring::kSingleScreenLower);
+                break;
+            case 1:
+                setMirroring(Mirroring::kSingleScreenUpper);
+                break;
+            case 2:
+                setMirroring(Mirroring::kVertical);
+                break;
+            case 3:
+                setMirroring(Mirroring::kHorizontal);
+                break;
+        }
+
+        switch ((m_control >> 2) & 3) {
+            case 0:
+            case 1:
+                // 32KB, ignoring low bit of bank number
+                mapPrg32(m_prgBank >> 1);
+                break;
+            case 2:
+                // first bank fixed at 0x8000, switch 0xC000
+                mapPrg16(0x8000, 0);
+                mapPrg16(0xC000, m_prgBank);
+                break;
+            case 3:
+                // switch 0x8000, last bank fixed at 0xC000
+                mapPrg16(0x8000, m_prgBank);
+                mapPrg16(0xC000, numPrgBanks16() - 1);
+                break;
+        }
+
+        if (m_control & 0x10) {
+            // two 4KB banks
+            mapChr4(0x0000, m_chrBank0);
+            mapChr4(0x1000, m_chrBank1);
+        } else {
+            // 8KB, ignoring low bit of bank number
+            mapChr8(m_chrBank0 >> 1);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "nes/cartridge/Mapper.hpp"
+
+namespace cartridge {
+    /// @class MMC1
+    /// @brief Mapper 1 - serially loaded registers, switchable 16KB/32KB PRG and 4KB/8KB CHR banks,
+    ///        mapper controlled mirroring
+    /// @note https://www.nesdev.org/wiki/MMC1
+    /// @note PRG RAM (0x6000:0x7FFF) is not routed to the cartridge by CPUMemoryMap, and the
+    ///       second of two writes on consecutive cycles (e.g. by read-modify-write opcodes) is
+    ///       not ignored
+    class MMC1 : public Mapper {
+    public:
+        MMC1(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam);
+
+        void reset() override;
+        void write(uint16_t address, uint8_t value) override;
+
+    protected:
+        std::vector<uint8_t> registers() const override;
+        void restoreRegisters(std::span<const uint8_t> registers) override;
+
+    private:
+        /// @brief map banks, as selected by the current register values
+        void updateBanks();
+
+        // 5 bit shift register, with a marker bit that reaches bit 0 when 4 bits have been loaded
+        uint8_t m_shift;
+
+        uint8_t m_control;
+        uint8_t m_chrBank0;
+        uint8_t m_chrBank1;
+        uint8_t m_prgBank;
+    };
+}
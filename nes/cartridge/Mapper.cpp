@@ -0,0 +1,159 @@
+#include "Mapper.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "nes/cartridge/NROM.hpp"
+#include "nes/cartridge/MMC1.hpp"
+#include "nes/cartridge/UxROM.hpp"
+#include "nes/cartridge/CNROM.hpp"
+
+namespace cartridge {
+    Mapper::Mapper(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam, bool hasRegisters) : m_rom(rom), m_cpuMemory(cpuMemory), m_ppuMemory(ppuMemory), m_nametableRam(nametableRam), m_hasRegisters(hasRegisters), m_mirroring(rom.header().mirroring) {
+        if (rom.numChrBanks() == 0) {
+            m_chrRam.resize(INESHeader::kChrBankSize);
+        }
+    }
+
+    Mapper::~Mapper() {
+
+    }
+
+    std::unique_ptr<Mapper> Mapper::create(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam, std::string& error) {
+        const INESHeader& header = rom.header();
+
+        if ((header.prgRomSize % INESHeader::kPrgBankSize) != 0) {
+            error = "PRG ROM is not a multiple of 16KB";
+            return nullptr;
+        }
+
+        if ((header.chrRomSize % INESHeader::kChrBankSize) != 0) {
+            error = "CHR ROM is not a multiple of 8KB";
+            return nullptr;
+        }
+
+        switch (header.mapper) {
+            case 0:
+                return std::make_unique<NROM>(rom, cpuMemory, ppuMemory, nametableRam);
+            case 1:
+                return std::make_unique<MMC1>(rom, cpuMemory, ppuMemory, nametableRam);
+            case 2:
+                return std::make_unique<UxROM>(rom, cpuMemory, ppuMemory, nametableRam);
+            case 3:
+                return std::make_unique<CNROM>(rom, cpuMemory, ppuMemory, nametableRam);
+            default:
+                error = "mapper " + std::to_string(header.mapper) + " is not supported";
+                return nullptr;
+        }
+    }
+
+    uint8_t Mapper::read(uint16_t address) {
+        // note: PRG pages are backed by ROM, so reads never reach the mapper
+        return 0xFF;
+    }
+
+    Mirroring Mapper::mirroring() const {
+        return m_mirroring;
+    }
+
+    std::vector<uint8_t> Mapper::saveState() const {
+        std::vector<uint8_t> state = registers();
+        state.insert(state.end(), m_chrRam.begin(), m_chrRam.end());
+
+        return state;
+    }
+
+    bool Mapper::restoreState(std::span<const uint8_t> state) {
+        size_t numRegisters = registers().size();
+
+        if (state.size() != (numRegisters + m_chrRam.size())) {
+            return false;
+        }
+
+        std::copy(state.begin() + numRegisters, state.end(), m_chrRam.begin());
+        restoreRegisters(state.first(numRegisters));
+
+        return true;
+    }
+
+    std::vector<uint8_t> Mapper::registers() const {
+        return {};
+    }
+
+    void Mapper::restoreRegisters(std::span<const uint8_t> registers) {
+        // no registers
+    }
+
+    size_t Mapper::numPrgBanks16() const {
+        return m_rom.numPrgBanks();
+    }
+
+    size_t Mapper::numChrBanks4() const {
+        return m_chrRam.empty() ? (m_rom.numChrBanks() * 2) : 2;
+    }
+
+    void Mapper::mapPrg16(uint16_t address, size_t bank) {
+        assert((address == 0x8000) || (address == 0xC000));
+
+        const uint8_t* memory = m_rom.prgBank(bank % numPrgBanks16()).data();
+
+        if (m_hasRegisters) {
+            m_cpuMemory.map(address, INESHeader::kPrgBankSize, memory, this);
+        } else {
+            m_cpuMemory.map(address, INESHeader::kPrgBankSize, memory);
+        }
+    }
+
+    void Mapper::mapPrg32(size_t bank) {
+        mapPrg16(0x8000, (bank * 2));
+        mapPrg16(0xC000, (bank * 2) + 1);
+    }
+
+    void Mapper::mapChr4(uint16_t address, size_t bank) {
+        assert((address == 0x0000) || (address == 0x1000));
+
+        const size_t kBankSize = 0x1000;
+        bank = bank % numChrBanks4();
+
+        if (m_chrRam.empty()) {
+            const uint8_t* memory = m_rom.chrRom().data() + (bank * kBankSize);
+            m_ppuMemory.map(address, kBankSize, memory);
+        } else {
+            m_ppuMemory.map(address, kBankSize, m_chrRam.data() + (bank * kBankSize));
+        }
+    }
+
+    void Mapper::mapChr8(size_t bank) {
+        mapChr4(0x0000, (bank * 2));
+        mapChr4(0x1000, (bank * 2) + 1);
+    }
+
+    void Mapper::setMirroring(Mirroring mirroring) {
+        m_mirroring = mirroring;
+
+        // nametable RAM (1KB unit) for each of the 4 nametables
+        size_t layout[4];
+
+        switch (mirroring) {
+            case Mirroring::kHorizontal:
+                layout[0] = 0; layout[1] = 0; layout[2] = 1; layout[3] = 1;
+                break;
+            case Mirroring::kVertical:
+                layout[0] = 0; layout[1] = 1; layout[2] = 0; layout[3] = 1;
+                break;
+            case Mirroring::kFourScreen:
+                layout[0] = 0; layout[1] = 1; layout[2] = 2; layout[3] = 3;
+                break;
+            case Mirroring::kSingleScreenLower:
+                layout[0] = 0; layout[1] = 0; layout[2] = 0; layout[3] = 0;
+                break;
+            case Mirroring::kSingleScreenUpper:
+                layout[0] = 1; layout[1] = 1; layout[2] = 1; layout[3] = 1;
+                break;
+        }
+
+        for (size_t i = 0; i < 4; i++) {
+            m_ppuMemory.map(0x2000 + (i * kNametableSize), kNametableSize, m_nametableRam + (layout[i] * kNametableSize));
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "nes/cartridge/INESRom.hpp"
+#include "nes/memory/PageTable.hpp"
+
+namespace cartridge {
+    /// @class Mapper
+    /// @brief Cartridge hardware, that maps PRG / CHR banks + nametable RAM into the 
+    ///        CPU and PPU address spaces
+    /// @note Banks are switched by re-pointing pages of the PageTables, so reads never
+    ///       dispatch through the mapper. Only CPU writes to 0x8000:0xFFFF (i.e. mapper
+    ///       registers) are sent to write(), and only for mappers that have registers.
+    class Mapper : public memory::PageHandler {
+    public:
+        /// @param rom ROM image, must outlive the mapper
+        /// @param cpuMemory CPU address space (PRG mapped into 0x8000:0xFFFF)
+        /// @param ppuMemory PPU address space (CHR mapped into 0x0000:0x1FFF, nametables into 0x2000:0x2FFF)
+        /// @param nametableRam nametable RAM (4KB), must outlive the mapper
+        /// @param hasRegisters should CPU writes to PRG be sent to write()
+        Mapper(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam, bool hasRegisters);
+        virtual ~Mapper();
+
+        Mapper(const Mapper&) = delete;
+        Mapper& operator=(const Mapper&) = delete;
+
+        /// @brief create the mapper for a ROM image
+        /// @return nullptr if the mapper is not supported (see error)
+        static std::unique_ptr<Mapper> create(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam, std::string& error);
+
+        /// @brief restore power-on state, and map the initial banks
+        virtual void reset() = 0;
+
+        /// @brief mapper registers are write only
+        uint8_t read(uint16_t address) override;
+
+        Mirroring mirroring() const;
+
+        /// @brief capture mapper registers + CHR RAM (e.g. for a snapshot)
+        std::vector<uint8_t> saveState() const;
+
+        /// @brief restore state captured by saveState(), and re-map banks
+        /// @return false if the state was not captured from this mapper + ROM
+        bool restoreState(std::span<const uint8_t> state);
+
+    protected:
+        /// @brief values of the mapper registers
+        virtual std::vector<uint8_t> registers() const;
+
+        /// @brief restore the mapper registers, and re-map banks
+        /// @param registers values, the same size as returned by registers()
+        virtual void restoreRegisters(std::span<const uint8_t> registers);
+
+        static const size_t kNametableSize = 0x400;
+
+        size_t numPrgBanks16() const;
+        size_t numChrBanks4() const;
+
+        /// @brief map a 16KB PRG bank into 0x8000 or 0xC000
+        void mapPrg16(uint16_t address, size_t bank);
+
+        /// @brief map a 32KB PRG bank into 0x8000
+        void mapPrg32(size_t bank);
+
+        /// @brief map a 4KB CHR bank into 0x0000 or 0x1000
+        void mapChr4(uint16_t address, size_t bank);
+
+        /// @brief map an 8KB CHR bank into 0x0000
+        void mapChr8(size_t bank);
+
+        /// @brief arrange nametable RAM in 0x2000:0x2FFF
+        void setMirroring(Mirroring mirroring);
+
+        const INESRom& m_rom;
+        memory::PageTable& m_cpuMemory;
+        memory::PageTable& m_ppuMemory;
+        uint8_t* m_nametableRam;
+
+    private:
+        // CHR RAM, for cartridges without CHR ROM
+        std::vector<uint8_t> m_chrRam;
+
+        bool m_hasRegisters;
+
+        Mirroring m_mirroring;
+    };
+}
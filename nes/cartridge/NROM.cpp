@@ -0,0 +1,21 @@
+#include "NROM.hpp"
+
+namespace cartridge {
+    NROM::NROM(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam) : Mapper(rom, cpuMemory, ppuMemory, nametableRam, false) {
+
+    }
+
+    void NROM::reset() {
+        // a single 16KB bank is mirrored at 0x8000 and 0xC000
+        mapPrg16(0x8000, 0);
+        mapPrg16(0xC000, numPrgBanks16() - 1);
+
+        mapChr8(0);
+
+        setMirroring(m_rom.header().mirroring);
+    }
+
+    void NROM::write(uint16_t address, uint8_t value) {
+        // no registers
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "nes/cartridge/Mapper.hpp"
+
+namespace cartridge {
+    /// @class NROM
+    /// @brief Mapper 0 - 16KB or 32KB PRG ROM, 8KB CHR ROM, no bank switching
+    /// @note PRG is mapped without a write handler, so writes to ROM never dispatch to the mapper
+    class NROM : public Mapper {
+    public:
+        NROM(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam);
+
+        void reset() override;
+        void write(uint16_t address, uint8_t value) override;
+    };
+}
@@ -0,0 +1,35 @@
+#include "UxROM.hpp"
+
+namespace cartridge {
+    UxROM::UxROM(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam) : Mapper(rom, cpuMemory, ppuMemory, nametableRam, true), m_prgBank(0) {
+
+    }
+
+    void UxROM::reset() {
+        m_prgBank = 0;
+
+        mapPrg16(0x8000, m_prgBank);
+        mapPrg16(0xC000, numPrgBanks16() - 1);
+
+        mapChr8(0);
+
+        setMirroring(m_rom.header().mirroring);
+    }
+
+    void UxROM::write(uint16_t address, uint8_t value) {
+        // bank select (0x8000:0xFFFF)
+        m_prgBank = value;
+
+        mapPrg16(0x8000, m_prgBank);
+    }
+
+    std::vector<uint8_t> UxROM::registers() const {
+        return { m_prgBank };
+    }
+
+    void UxROM::restoreRegisters(std::span<const uint8_t> registers) {
+        reset();
+
+        write(0x8000, registers[0]);
+    }
+}
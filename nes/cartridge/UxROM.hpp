@@ -0,0 +1,23 @@
+#pragma once
+
+#include "nes/cartridge/Mapper.hpp"
+
+namespace cartridge {
+    /// @class UxROM
+    /// @brief Mapper 2 - switchable 16KB PRG bank at 0x8000, last PRG bank fixed at 0xC000, 8KB CHR RAM
+    /// @note https://www.nesdev.org/wiki/UxROM
+    class UxROM : public Mapper {
+    public:
+        UxROM(const INESRom& rom, memory::PageTable& cpuMemory, memory::PageTable& ppuMemory, uint8_t* nametableRam);
+
+        void reset() override;
+        void write(uint16_t address, uint8_t value) override;
+
+    protected:
+        std::vector<uint8_t> registers() const override;
+        void restoreRegisters(std::span<const uint8_t> registers) override;
+
+    private:
+        uint8_t m_prgBank;
+    };
+}
@@ -0,0 +1,380 @@
+#include "nes/cpu6502/assembler/CodeMap.hpp"
+
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    using cpu6502::assembler::CodeMap;
+
+    const struct {
+        uint8_t flag;
+        char letter;
+    } kLabelLetters[] = {
+        { CodeMap::kLabelReset, 'R' },
+        { CodeMap::kLabelNMI, 'N' },
+        { CodeMap::kLabelIRQ, 'I' },
+        { CodeMap::kLabelSubroutine, 'S' },
+        { CodeMap::kLabelJump, 'J' },
+        { CodeMap::kLabelBranch, 'B' }
+    };
+
+    bool parseNumber(const std::string& text, int base, size_t maxValue, size_t& value) {
+        if (text.empty()) {
+            return false;
+        }
+
+        char* end = nullptr;
+        unsigned long long parsed = strtoull(text.c_str(), &end, base);
+        if ((*end != '\0') || (parsed > maxValue)) {
+            return false;
+        }
+
+        value = size_t(parsed);
+
+        return true;
+    }
+}
+
+namespace cpu6502 { namespace assembler {
+    CodeMap::CodeMap(size_t bank, uint16_t baseAddress, size_t size) :
+        m_bank(bank),
+        m_baseAddress(baseAddress),
+        m_size(size),
+        m_code((size + 63) / 64, 0),
+        m_opcodes((size + 63) / 64, 0),
+        m_labelFlags(size, 0) {
+    }
+
+    size_t CodeMap::bank() const {
+        return m_bank;
+    }
+
+    uint16_t CodeMap::baseAddress() const {
+        return m_baseAddress;
+    }
+
+    size_t CodeMap::size() const {
+        return m_size;
+    }
+
+    bool CodeMap::contains(uint16_t address) const {
+        return (address >= m_baseAddress) && ((size_t(address) - m_baseAddress) < m_size);
+    }
+
+    bool CodeMap::isCode(uint16_t address) const {
+        return contains(address) && testBit(m_code, address - m_baseAddress);
+    }
+
+    bool CodeMap::isOpcode(uint16_t address) const {
+        return contains(address) && testBit(m_opcodes, address - m_baseAddress);
+    }
+
+    void CodeMap::markOpcode(uint16_t address, uint16_t byteSize) {
+        if (!contains(address)) {
+            return;
+        }
+
+        const size_t offset = address - m_baseAddress;
+        setBit(m_opcodes, offset);
+
+        for (size_t i = offset; (i < (offset + byteSize)) && (i < m_size); i++) {
+            setBit(m_code, i);
+        }
+    }
+
+    void CodeMap::clearOpcode(uint16_t address, uint16_t byteSize) {
+        if (!contains(address)) {
+            return;
+        }
+
+        const size_t offset = address - m_baseAddress;
+        clearBit(m_opcodes, offset);
+
+        for (size_t i = offset; (i < (offset + byteSize)) && (i < m_size); i++) {
+            clearBit(m_code, i);
+        }
+    }
+
+    uint8_t CodeMap::labelFlags(uint16_t address) const {
+        return contains(address) ? m_labelFlags[address - m_baseAddress] : 0;
+    }
+
+    void CodeMap::addLabel(uint16_t address, uint8_t flags) {
+        if (contains(address)) {
+            m_labelFlags[address - m_baseAddress] |= flags;
+        }
+    }
+
+    void CodeMap::setLabelFlags(uint16_t address, uint8_t flags) {
+        if (contains(address)) {
+            m_labelFlags[address - m_baseAddress] = flags;
+        }
+    }
+
+    bool CodeMap::formatLabel(uint16_t address, char* buffer, size_t size) const {
+        const uint8_t flags = labelFlags(address);
+
+        if (flags & kLabelReset) {
+            snprintf(buffer, size, "reset");
+        } else if (flags & kLabelNMI) {
+            snprintf(buffer, size, "nmi");
+        } else if (flags & kLabelIRQ) {
+            snprintf(buffer, size, "irq");
+        } else if (flags & kLabelSubroutine) {
+            snprintf(buffer, size, "sub_%04X", address);
+        } else if (flags != 0) {
+            snprintf(buffer, size, "L_%04X", address);
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    size_t CodeMap::numCodeBytes() const {
+        size_t count = 0;
+
+        for (uint64_t bits: m_code) {
+            count += size_t(std::popcount(bits));
+        }
+
+        return count;
+    }
+
+    size_t CodeMap::numOpcodes() const {
+        size_t count = 0;
+
+        for (uint64_t bits: m_opcodes) {
+            count += size_t(std::popcount(bits));
+        }
+
+        return count;
+    }
+
+    size_t CodeMap::numLabels() const {
+        size_t count = 0;
+
+        for (uint8_t flags: m_labelFlags) {
+            count += (flags != 0) ? 1 : 0;
+        }
+
+        return count;
+    }
+
+    uint64_t CodeMap::checksum(std::span<const uint8_t> prgRom) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+
+        for (uint8_t value: prgRom) {
+            hash = (hash ^ value) * 0x100000001b3ULL;
+        }
+
+        return hash;
+    }
+
+    bool CodeMap::save(const std::string& path, const std::vector<CodeMap>& codeMaps, std::span<const uint8_t> prgRom, std::string& error) {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            error = "unable to open '" + path + "'";
+            return false;
+        }
+
+        char text[64];
+
+        file << "# cpu6502 code map\n";
+
+        snprintf(text, sizeof(text), "prg %zX %016llX\n", prgRom.size(), (unsigned long long)checksum(prgRom));
+        file << text;
+
+        for (const CodeMap& codeMap: codeMaps) {
+            snprintf(text, sizeof(text), "bank %zu %04X %zX\n", codeMap.m_bank, codeMap.m_baseAddress, codeMap.m_size);
+            file << text;
+
+            // runs of consecutive opcodes, each with the byte size of its opcodes
+            for (size_t offset = 0; offset < codeMap.m_size; ) {
+                if (!testBit(codeMap.m_opcodes, offset)) {
+                    offset++;
+                    continue;
+                }
+
+                snprintf(text, sizeof(text), "code %04X ", unsigned(codeMap.m_baseAddress + offset));
+                file << text;
+
+                while ((offset < codeMap.m_size) && testBit(codeMap.m_opcodes, offset)) {
+                    size_t byteSize = 1;
+                    while (((offset + byteSize) < codeMap.m_size) && testBit(codeMap.m_code, offset + byteSize) && !testBit(codeMap.m_opcodes, offset + byteSize)) {
+                        byteSize++;
+                    }
+
+                    file << char('0' + byteSize);
+                    offset += byteSize;
+                }
+
+                file << "\n";
+            }
+
+            for (size_t offset = 0; offset < codeMap.m_size; offset++) {
+                const uint8_t flags = codeMap.m_labelFlags[offset];
+                if (flags == 0) {
+                    continue;
+                }
+
+                snprintf(text, sizeof(text), "label %04X ", unsigned(codeMap.m_baseAddress + offset));
+                file << text;
+
+                for (auto& label: kLabelLetters) {
+                    if (flags & label.flag) {
+                        file << label.letter;
+                    }
+                }
+
+                file << "\n";
+            }
+        }
+
+        if (!file.good()) {
+            error = "unable to write '" + path + "'";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool CodeMap::load(const std::string& path, std::span<const uint8_t> prgRom, std::vector<CodeMap>& outCodeMaps, std::string& error) {
+        outCodeMaps.clear();
+
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            error = "unable to open '" + path + "'";
+            return false;
+        }
+
+        std::string line;
+        int lineNumber = 0;
+        bool hasPrg = false;
+
+        auto fail = [&](const std::string& reason) {
+            error = "'" + path + "' line " + std::to_string(lineNumber) + ": " + reason;
+            outCodeMaps.clear();
+
+            return false;
+        };
+
+        while (std::getline(file, line)) {
+            lineNumber += 1;
+
+            line = line.substr(0, line.find('#'));
+
+            std::stringstream lineStream(line);
+            std::string type;
+
+            if (!(lineStream >> type)) {
+                // blank, or comment
+                continue;
+            }
+
+            std::string first;
+            std::string second;
+            std::string third;
+
+            if (type == "prg") {
+                size_t size;
+                size_t prgChecksum;
+
+                if (hasPrg || !(lineStream >> first >> second) || !parseNumber(first, 16, SIZE_MAX, size) || !parseNumber(second, 16, UINT64_MAX, prgChecksum)) {
+                    return fail("expected a single 'prg <size> <checksum>'");
+                }
+
+                if ((size != prgRom.size()) || (uint64_t(prgChecksum) != checksum(prgRom))) {
+                    return fail("built from a different PRG ROM");
+                }
+
+                hasPrg = true;
+                continue;
+            }
+
+            if (!hasPrg) {
+                return fail("expected 'prg' before '" + type + "'");
+            }
+
+            if (type == "bank") {
+                size_t bank;
+                size_t baseAddress;
+                size_t size;
+
+                if (!(lineStream >> first >> second >> third) || !parseNumber(first, 10, SIZE_MAX, bank) ||
+                    !parseNumber(second, 16, 0xFFFF, baseAddress) || !parseNumber(third, 16, 0x10000 - baseAddress, size) || (size == 0)) {
+                    return fail("expected 'bank <index> <base address> <size>'");
+                }
+
+                outCodeMaps.emplace_back(bank, uint16_t(baseAddress), size);
+                continue;
+            }
+
+            if (outCodeMaps.empty()) {
+                return fail("expected 'bank' before '" + type + "'");
+            }
+
+            CodeMap& codeMap = outCodeMaps.back();
+            size_t address;
+
+            if (!(lineStream >> first >> second) || !parseNumber(first, 16, 0xFFFF, address) || !codeMap.contains(uint16_t(address))) {
+                return fail("expected '" + type + " <address in bank> ...'");
+            }
+
+            if (type == "code") {
+                for (char byteSize: second) {
+                    if ((byteSize < '1') || (byteSize > '3') || !codeMap.contains(uint16_t(address))) {
+                        return fail("invalid opcode sizes '" + second + "'");
+                    }
+
+                    codeMap.markOpcode(uint16_t(address), uint16_t(byteSize - '0'));
+                    address += size_t(byteSize - '0');
+                }
+            } else if (type == "label") {
+                uint8_t flags = 0;
+
+                for (char letter: second) {
+                    bool isValid = false;
+
+                    for (auto& label: kLabelLetters) {
+                        if (letter == label.letter) {
+                            flags |= label.flag;
+                            isValid = true;
+                        }
+                    }
+
+                    if (!isValid) {
+                        return fail("invalid label flags '" + second + "'");
+                    }
+                }
+
+                codeMap.addLabel(uint16_t(address), flags);
+            } else {
+                return fail("unknown type '" + type + "'");
+            }
+        }
+
+        if (!hasPrg) {
+            // e.g. empty, or only comments
+            return fail("expected 'prg <size> <checksum>'");
+        }
+
+        return true;
+    }
+
+    bool CodeMap::testBit(const std::vector<uint64_t>& bits, size_t index) {
+        return (bits[index / 64] >> (index % 64)) & 1;
+    }
+
+    void CodeMap::setBit(std::vector<uint64_t>& bits, size_t index) {
+        bits[index / 64] |= uint64_t(1) << (index % 64);
+    }
+
+    void CodeMap::clearBit(std::vector<uint64_t>& bits, size_t index) {
+        bits[index / 64] &= ~(uint64_t(1) << (index % 64));
+    }
+} // assembler
+} // cpu6502
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cpu6502 {
+    namespace assembler {
+
+        /// @class CodeMap
+        /// @brief Which bytes of a bank of PRG ROM are code, and the jump targets that are labelled
+        /// @note Built by a StaticDisassembler, and saved as text (one file for all banks of a ROM), e.g.
+        ///         # prg <size> <checksum>
+        ///         prg 8000 1F2E3D4C5B6A7988
+        ///         # bank <index> <base address> <size>
+        ///         bank 1 C000 4000
+        ///         # code <address> <byte size of each consecutive opcode>
+        ///         code C000 3232211
+        ///         # label <address> <R(eset) N(MI) I(RQ) S(ubroutine) J(ump) B(ranch)>
+        ///         label C000 RJ
+        ///       so that it can be loaded without disassembling anything. The checksum of PRG ROM is only
+        ///       used to check that a code map is loaded for the ROM it was built from.
+        class CodeMap {
+        public:
+            enum LabelFlags : uint8_t {
+                kLabelBranch = 1 << 0,              // target of a conditional branch
+                kLabelJump = 1 << 1,                // target of JMP
+                kLabelSubroutine = 1 << 2,          // target of JSR
+                kLabelReset = 1 << 3,               // vectors
+                kLabelNMI = 1 << 4,
+                kLabelIRQ = 1 << 5
+            };
+
+            /// @param bank index of the bank in PRG ROM
+            /// @param baseAddress CPU address that the bank is mapped to
+            /// @param size size of the bank in bytes
+            CodeMap(size_t bank, uint16_t baseAddress, size_t size);
+
+            size_t bank() const;
+            uint16_t baseAddress() const;
+            size_t size() const;
+
+            bool contains(uint16_t address) const;
+
+            /// @brief is the byte part of an opcode (or its operands)
+            /// @note false outside of the bank
+            bool isCode(uint16_t address) const;
+
+            /// @brief is the byte the first byte of an opcode
+            bool isOpcode(uint16_t address) const;
+
+            /// @brief mark the bytes of an opcode as code
+            void markOpcode(uint16_t address, uint16_t byteSize);
+
+            /// @brief mark the bytes of an opcode as no longer code (e.g. to roll back a speculative walk)
+            void clearOpcode(uint16_t address, uint16_t byteSize);
+
+            /// @return combination of LabelFlags, 0 if the address is not labelled
+            uint8_t labelFlags(uint16_t address) const;
+
+            void addLabel(uint16_t address, uint8_t flags);
+
+            /// @brief replace the flags of a label (0 removes the label)
+            void setLabelFlags(uint16_t address, uint8_t flags);
+
+            /// @brief name of the label at an address, e.g. "reset", "sub_C5F5" or "L_C5F5"
+            /// @return false if the address is not labelled
+            bool formatLabel(uint16_t address, char* buffer, size_t size) const;
+
+            size_t numCodeBytes() const;
+            size_t numOpcodes() const;
+            size_t numLabels() const;
+
+            /// @brief identify PRG ROM (FNV-1a of its bytes)
+            static uint64_t checksum(std::span<const uint8_t> prgRom);
+
+            /// @brief write the code maps of a ROM
+            /// @param prgRom the PRG ROM that the code maps were built from
+            /// @return false if the file could not be written
+            static bool save(const std::string& path, const std::vector<CodeMap>& codeMaps, std::span<const uint8_t> prgRom, std::string& error);
+
+            /// @brief read the code maps of a ROM, as written by save()
+            /// @param prgRom the PRG ROM that the code maps are for
+            /// @return false if the file could not be read or parsed, or was built from different PRG ROM
+            static bool load(const std::string& path, std::span<const uint8_t> prgRom, std::vector<CodeMap>& outCodeMaps, std::string& error);
+
+        private:
+            size_t m_bank;
+            uint16_t m_baseAddress;
+            size_t m_size;
+
+            // bit per byte of the bank
+            std::vector<uint64_t> m_code;
+            std::vector<uint64_t> m_opcodes;
+
+            // flags per byte of the bank
+            std::vector<uint8_t> m_labelFlags;
+
+            static bool testBit(const std::vector<uint64_t>& bits, size_t index);
+            static void setBit(std::vector<uint64_t>& bits, size_t index);
+            static void clearBit(std::vector<uint64_t>& bits, size_t index);
+        };
+
+    }
+}
@@ -1,304 +1,152 @@
 #include "nes/cpu6502/assembler/Disassembler.hpp"
-#include "nes/cpu6502/assembler/Opcodes.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
 
 namespace cpu6502 { namespace assembler {
-    namespace {
-        const std::map<uint32_t, uint16_t> kAddressingModeByteSizeLookup {
-            { kAbsolute, 3 },
-            { kAbsolute | kIndexedWithX, 3 },
-            { kAbsolute | kIndexedWithY, 3 },
-            { kAbsolute | kIndirect, 3 },
-            { kAccumulator, 1 },
-            { kImmediate, 2 },
-            { kImplied, 1 },
-            { kRelative, 2 },
-            { kZeroPage, 2 },
-            { kZeroPage | kIndexedWithX | kIndirect, 2 },
-            { kZeroPage | kIndexedWithX, 2 },
-            { kZeroPage | kIndexedWithY, 2 },
-            { kZeroPage | kIndirect | kIndexedWithY, 2 },
-            { kIndirect, 3 }
-        };
-    }
+    size_t Disassembler::DisassembledOpcode::format(char* buffer, size_t size) const {
+        int length = (labelOperands[0] == 0) ? snprintf(buffer, size, "%s", labelOpcode)
+                                             : snprintf(buffer, size, "%s %s", labelOpcode, labelOperands);
 
-    Disassembler::Disassembler() {
-        registerOpcodes();
+        return (length < 0) ? 0 : std::min(size_t(length), size - 1);
     }
 
-    Disassembler::DisassembledOpcodes Disassembler::disassemble(const memory::SRAM& sram, uint16_t inPc, int numOpcodes) {
-        DisassembledOpcodes disassembledOpcodes;
-
-        uint16_t pc = inPc;     
-
-        for (int i=0; (i < numOpcodes) && (pc < sram.size()); i++) {
-            DisassembledOpcode disassembledOpcode;
-            disassembledOpcode.pc = pc;
-            disassembledOpcode.opcode = sram.read(pc);
-
-            bool success = true;
-            
-            if (opcodes.find(disassembledOpcode.opcode) == opcodes.end()) {
-                char buffer[16];
-                sprintf(buffer, "0x%02X", disassembledOpcode.opcode);
-                disassembledOpcode.labelOpcode = std::string(buffer) + " ????";
-                disassembledOpcode.byteSize = 1;
-                disassembledOpcode.addressingMode = kUnknown;
-                disassembledOpcode.data.push_back(disassembledOpcode.opcode);
-
-                disassembledOpcodes.push_back(disassembledOpcode);
-                success = false;
-
-                break;
-            }
-
-            ParseOpcodeInfo parseOpcodeInfo {
-                .pc = pc,
-                .sram = sram
-            };
+    bool Disassembler::disassembleOpcode(std::span<const uint8_t> memory, uint16_t baseAddress, uint16_t pc, DisassembledOpcode& outOpcode) {
+        const size_t offset = size_t(uint16_t(pc - baseAddress));
 
-            auto& opcodeInfo = opcodes.at(disassembledOpcode.opcode);
-            disassembledOpcode.labelOpcode = opcodeInfo.label;
-            disassembledOpcode.addressingMode = opcodeInfo.addressingMode;
-            uint16_t byteSize = kAddressingModeByteSizeLookup.at(opcodeInfo.addressingMode);
-            disassembledOpcode.byteSize = byteSize;
-            
-            if ( (pc + byteSize) <= sram.size() ) {
-                for (uint16_t i = 0; i<byteSize; i++) {
-                    disassembledOpcode.data.push_back(sram.read(pc + i));
-                }
+        outOpcode.pc = pc;
+        outOpcode.opcode = (offset < memory.size()) ? memory[offset] : 0;
+        outOpcode.labelOperands[0] = 0;
 
-                switch (opcodeInfo.addressingMode) {
-                    case kAbsolute:
-                        success &= parseOpcodeAbsolute(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kAbsolute | kIndirect | kIndexedWithX:
-                        success &= parseOpcodeAbsoluteIndexedIndirect(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kAbsolute | kIndexedWithX:
-                        success &= parseOpcodeAbsoluteIndexedWithX(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kAbsolute | kIndexedWithY:
-                        success &= parseOpcodeAbsoluteIndexedWithY(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kAbsolute | kIndirect:
-                        success &= parseOpcodeAbsoluteIndirect(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kAccumulator:
-                        success &= parseOpcodeAccumulator(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kImmediate:
-                        success &= parseOpcodeImmediate(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kImplied:
-                        // also for kStack
-                        success &= parseOpcodeImplied(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kRelative:
-                        success &= parseOpcodeProgramCounterRelative(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kZeroPage:
-                        success &= parseOpcodeZeroPage(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kZeroPage | kIndexedWithX | kIndirect:
-                        success &= parseOpcodeZeroPageIndexedIndirect(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kZeroPage | kIndexedWithX:
-                        success &= parseOpcodeZeroPageIndexedWithX(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kZeroPage | kIndexedWithY:
-                        success &= parseOpcodeZeroPageIndexedWithY(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kZeroPage | kIndirect | kIndexedWithY:
-                        success &= parseOpcodeZeroPageIndirectIndexedWithY(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    case kIndirect:
-                        success &= parseOpcodeIndirect(parseOpcodeInfo, disassembledOpcode);
-                        break;
-                    default:
-                        printf("unsupported addressing mode [%u]\n", unsigned(opcodeInfo.addressingMode));
-                        assert(false);
-                }
-            }
+        const OpcodeTableEntry& entry = kOpcodeTable[outOpcode.opcode];
 
-            if (!success) {
-                break;
-            }
+        if (entry.label == nullptr) {
+            snprintf(outOpcode.labelOpcode, sizeof(outOpcode.labelOpcode), "0x%02X ????", outOpcode.opcode);
+            outOpcode.addressingMode = kUnknown;
+            outOpcode.byteSize = 1;
+            outOpcode.data[0] = outOpcode.opcode;
 
-            disassembledOpcodes.push_back(disassembledOpcode);
-            pc += byteSize;
+            return false;
         }
-        
-        return disassembledOpcodes;
-    }
-
-    void Disassembler::registerOpcodes() {
-        #define OPCODE(_x) { _x op; registerOpcode(#_x, &op); }
-        # include "OpcodeList.inl"
-        #undef OPCODE
-    }
-
-    void Disassembler::registerOpcode(const std::string& label, const Opcode* opcode) {
-        const Opcode::AddressingModes& addressingModes = opcode->addressingModes();
-
-        for (auto it = addressingModes.begin(); it != addressingModes.end(); it ++ ) {
-            uint32_t addressingMode = it->first;
-            uint8_t opcode = it->second;
 
-            OpcodeInfo opcodeInfo {
-                .label = label,
-                .addressingMode = addressingMode
-            };
+        snprintf(outOpcode.labelOpcode, sizeof(outOpcode.labelOpcode), "%s", entry.label);
+        outOpcode.addressingMode = entry.addressingMode;
+        outOpcode.byteSize = entry.byteSize;
 
-            opcodes[opcode] = opcodeInfo;
+        for (size_t i = 0; i < DisassembledOpcode::kMaxBytes; i++) {
+            outOpcode.data[i] = ((i < entry.byteSize) && ((offset + i) < memory.size())) ? memory[offset + i] : 0;
         }
-    }
-
-    bool Disassembler::parseOpcodeAbsolute(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint16_t address = (info.sram.read(info.pc + 2) << 8) | info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "$0x%04X", address);
-        outOpcode.labelOperands = buffer;
-
-        return true;
-    }
-
-    bool Disassembler::parseOpcodeAbsoluteIndexedIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint16_t address = (info.sram.read(info.pc + 2) << 8) | info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "($0x%04X,x)", address);
-        outOpcode.labelOperands = buffer;
-
-        return true;
-    }
-
-    bool Disassembler::parseOpcodeAbsoluteIndexedWithX(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint16_t address = (info.sram.read(info.pc + 2) << 8) | info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "$0x%04X,x", address);
-        outOpcode.labelOperands = buffer;
-
-        return true;
-    }
-
-    bool Disassembler::parseOpcodeAbsoluteIndexedWithY(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint16_t address = (info.sram.read(info.pc + 2) << 8) | info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "$0x%4X,y", address);
-        outOpcode.labelOperands = buffer;
-
-        return true;
-    }
-
-    bool Disassembler::parseOpcodeAbsoluteIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint16_t address = (info.sram.read(info.pc + 2) << 8) | info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "($0x%04X)", address);
-        outOpcode.labelOperands = buffer;
-
-        return true;
-    }
 
-    bool Disassembler::parseOpcodeAccumulator(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        outOpcode.labelOperands = "A";
+        if ((offset + entry.byteSize) > memory.size()) {
+            // operands are past the end of memory
+            return true;
+        }
 
-        return true;
-    }
+        const uint8_t data = outOpcode.data[1];
+        const uint16_t address = (outOpcode.data[2] << 8) | outOpcode.data[1];
 
-    bool Disassembler::parseOpcodeImmediate(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t data = info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "#$0x%02X", data);
-        outOpcode.labelOperands = buffer;
+        char* operands = outOpcode.labelOperands;
+        const size_t size = sizeof(outOpcode.labelOperands);
 
-        return true;
-    }
+        switch (entry.addressingMode) {
+            case kAbsolute:
+                snprintf(operands, size, "$0x%04X", address);
+                break;
+            case kAbsolute | kIndirect | kIndexedWithX:
+                snprintf(operands, size, "($0x%04X,x)", address);
+                break;
+            case kAbsolute | kIndexedWithX:
+                snprintf(operands, size, "$0x%04X,x", address);
+                break;
+            case kAbsolute | kIndexedWithY:
+                snprintf(operands, size, "$0x%04X,y", address);
+                break;
+            case kAbsolute | kIndirect:
+            case kIndirect:
+                snprintf(operands, size, "($0x%04X)", address);
+                break;
+            case kAccumulator:
+                snprintf(operands, size, "A");
+                break;
+            case kImmediate:
+                snprintf(operands, size, "#$0x%02X", data);
+                break;
+            case kImplied:
+                // also for kStack
+                break;
+            case kRelative:
+                // combine relative-offset with pc to create an address
+                snprintf(operands, size, "$0x%04X", uint16_t(pc + 2 + int8_t(data)));
+                break;
+            case kZeroPage:
+                snprintf(operands, size, "$0x%02X", data);
+                break;
+            case kZeroPage | kIndexedWithX | kIndirect:
+                snprintf(operands, size, "($0x%02X,x)", data);
+                break;
+            case kZeroPage | kIndexedWithX:
+                snprintf(operands, size, "$0x%02X,x", data);
+                break;
+            case kZeroPage | kIndexedWithY:
+                snprintf(operands, size, "$0x%02X,y", data);
+                break;
+            case kZeroPage | kIndirect | kIndexedWithY:
+                snprintf(operands, size, "($0x%02X),y", data);
+                break;
+            default:
+                printf("unsupported addressing mode [%u]\n", unsigned(entry.addressingMode));
+                assert(false);
+        }
 
-    bool Disassembler::parseOpcodeImplied(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
         return true;
     }
 
-    bool Disassembler::parseOpcodeProgramCounterRelative(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t data = info.sram.read(info.pc + 1);
+    void Disassembler::disassembleData(std::span<const uint8_t> memory, uint16_t baseAddress, uint16_t pc, DisassembledOpcode& outOpcode) {
+        const size_t offset = size_t(uint16_t(pc - baseAddress));
 
-        // combine relative-offset with pc to create an address
-        uint16_t address = info.pc + 2 + *(reinterpret_cast<int8_t*>(&data));
-        
-        char buffer[16];
-        sprintf(buffer, "$0x%04X", address);
-        outOpcode.labelOperands = buffer;
+        outOpcode.pc = pc;
+        outOpcode.opcode = (offset < memory.size()) ? memory[offset] : 0;
+        outOpcode.addressingMode = kUnknown;
+        outOpcode.byteSize = 1;
+        outOpcode.data[0] = outOpcode.opcode;
 
-        return true;
+        snprintf(outOpcode.labelOpcode, sizeof(outOpcode.labelOpcode), ".byte");
+        snprintf(outOpcode.labelOperands, sizeof(outOpcode.labelOperands), "$0x%02X", outOpcode.opcode);
     }
 
-    bool Disassembler::parseOpcodeStack(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        return true;
-    }
+    size_t Disassembler::disassemble(const memory::SRAM& sram, uint16_t inPc, std::span<DisassembledOpcode> outOpcodes) {
+        const std::span<const uint8_t> memory = sram.span();
 
-    bool Disassembler::parseOpcodeZeroPage(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t address = info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "$0x%02X", address);
-        outOpcode.labelOperands = buffer;
-
-        return true;
-    }
+        uint16_t pc = inPc;
+        size_t numOpcodes = 0;
 
-    bool Disassembler::parseOpcodeZeroPageIndexedIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t address = info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "($0x%02X,x)", address);
-        outOpcode.labelOperands = buffer;
+        while ((numOpcodes < outOpcodes.size()) && (pc < memory.size())) {
+            DisassembledOpcode& disassembledOpcode = outOpcodes[numOpcodes++];
 
-        return true;
-    }
+            if (!disassembleOpcode(memory, 0, pc, disassembledOpcode)) {
+                break;
+            }
 
-    bool Disassembler::parseOpcodeZeroPageIndexedWithX(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t address = info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "$0x%02X,x", address);
-        outOpcode.labelOperands = buffer;
+            pc += disassembledOpcode.byteSize;
+        }
 
-        return true;
+        return numOpcodes;
     }
 
-    bool Disassembler::parseOpcodeZeroPageIndexedWithY(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t address = info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "$0x%02X,y", address);
-        outOpcode.labelOperands = buffer;
+    size_t Disassembler::disassembleBank(std::span<const uint8_t> bank, uint16_t baseAddress, std::span<DisassembledOpcode> outOpcodes) {
+        size_t offset = 0;
+        size_t numOpcodes = 0;
 
-        return true;
-    }
+        while ((numOpcodes < outOpcodes.size()) && (offset < bank.size())) {
+            DisassembledOpcode& disassembledOpcode = outOpcodes[numOpcodes++];
 
-    bool Disassembler::parseOpcodeZeroPageIndirectIndexedWithY(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t address = info.sram.read(info.pc + 1);
-        
-        char buffer[16];
-        sprintf(buffer, "($0x%02X),y", address);
-        outOpcode.labelOperands = buffer;
+            disassembleOpcode(bank, baseAddress, uint16_t(baseAddress + offset), disassembledOpcode);
 
-        return true;
-    }
-
-    bool Disassembler::parseOpcodeIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode) {
-        uint8_t addressLow = info.sram.read(info.pc + 1);
-        uint8_t addressHigh = info.sram.read(info.pc + 2);
-        
-        char buffer[16];
-        sprintf(buffer, "($0x%02X%02X)", addressHigh, addressLow);
-        outOpcode.labelOperands = buffer;
+            offset += disassembledOpcode.byteSize;
+        }
 
-        return true;
+        return numOpcodes;
     }
 } // assembler
 } // cpu6502
@@ -1,61 +1,52 @@
-#pragma once 
+#pragma once
+
+#include <span>
 
 #include "nes/memory/SRAM.hpp"
-#include "nes/cpu6502/assembler/Opcode.hpp"
+#include "nes/cpu6502/assembler/OpcodeTable.hpp"
 
 namespace cpu6502 {
     namespace assembler {
 
+        /// @class Disassembler
+        /// @brief Disassemble 6502 opcodes through the compile time opcode table (see OpcodeTable.hpp),
+        ///        into fixed size structures provided by the caller, so that nothing is allocated
         class Disassembler {
         public:
-            Disassembler();
-
             struct DisassembledOpcode {
+                static constexpr size_t kMaxBytes = 3;
+                static constexpr size_t kMaxLabelSize = 16;
+
                 uint8_t opcode;
                 uint32_t addressingMode;
-                std::string labelOpcode;
-                std::string labelOperands;
+                char labelOpcode[kMaxLabelSize];        // e.g. "LDA", or "0x02 ????" if not supported
+                char labelOperands[kMaxLabelSize];      // e.g. "$0x1234,x"
                 uint16_t pc;
                 uint16_t byteSize;
-                std::vector<uint8_t> data;
-            };
+                uint8_t data[kMaxBytes];                // note: bytes past the end of memory are 0
 
-            typedef std::vector<DisassembledOpcode> DisassembledOpcodes;
-
-            DisassembledOpcodes disassemble(const memory::SRAM& sram, uint16_t pc, int numOpcodes);
-
-        private:
-            struct OpcodeInfo {
-                std::string label;
-                uint32_t    addressingMode;
+                /// @brief format as "<opcode> <operands>"
+                /// @return length of the text, truncated to size - 1
+                size_t format(char* buffer, size_t size) const;
             };
 
-            std::map<uint8_t, OpcodeInfo> opcodes;
+            /// @brief disassemble the opcode at pc
+            /// @param memory memory starting at baseAddress, e.g. SRAM::span() or a PRG bank
+            /// @return false if the opcode is not supported, in which case it is disassembled as a single byte
+            static bool disassembleOpcode(std::span<const uint8_t> memory, uint16_t baseAddress, uint16_t pc, DisassembledOpcode& outOpcode);
 
-            void registerOpcodes();
-            void registerOpcode(const std::string& label, const Opcode* opcode);
+            /// @brief disassemble the byte at pc as data (".byte $0xNN"), e.g. where a CodeMap has no code
+            static void disassembleData(std::span<const uint8_t> memory, uint16_t baseAddress, uint16_t pc, DisassembledOpcode& outOpcode);
 
-            struct ParseOpcodeInfo {
-                uint16_t pc;
-                const memory::SRAM& sram;
-            };
+            /// @brief disassemble consecutive opcodes from pc, up to (and including) an unsupported opcode
+            /// @return number of opcodes written to outOpcodes
+            static size_t disassemble(const memory::SRAM& sram, uint16_t pc, std::span<DisassembledOpcode> outOpcodes);
 
-            bool parseOpcodeAbsolute(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeAbsoluteIndexedIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeAbsoluteIndexedWithX(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeAbsoluteIndexedWithY(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeAbsoluteIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeAccumulator(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeImmediate(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeImplied(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeProgramCounterRelative(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeStack(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeZeroPage(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeZeroPageIndexedIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeZeroPageIndexedWithX(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeZeroPageIndexedWithY(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeZeroPageIndirectIndexedWithY(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
-            bool parseOpcodeIndirect(const ParseOpcodeInfo& info, DisassembledOpcode& outOpcode);
+            /// @brief disassemble a whole bank (e.g. a 16KB PRG bank) linearly into a flat array, continuing
+            ///        past unsupported opcodes as single bytes
+            /// @param outOpcodes needs at most bank.size() entries
+            /// @return number of opcodes written to outOpcodes
+            static size_t disassembleBank(std::span<const uint8_t> bank, uint16_t baseAddress, std::span<DisassembledOpcode> outOpcodes);
         };
 
     }
@@ -0,0 +1,151 @@
+#include "nes/cpu6502/assembler/DisassemblyCache.hpp"
+
+#include <algorithm>
+
+namespace cpu6502 { namespace assembler {
+    namespace {
+        const size_t kAddressSpaceSize = 0x10000;
+        const size_t kPageSize = memory::SRAM::kPageSize;
+    }
+
+    DisassemblyCache::DisassemblyCache(const memory::SRAM& sram) :
+        m_sram(sram),
+        m_entries(kAddressSpaceSize),
+        m_numCachedInPage(kAddressSpaceSize / kPageSize, 0),
+        m_numDisassembled(0),
+        m_codeMapOfPage(kAddressSpaceSize / kPageSize, nullptr) {
+    }
+
+    const DisassemblyCache::DisassembledOpcode& DisassemblyCache::at(uint16_t pc) {
+        Entry& entry = m_entries[pc];
+
+        if (!entry.isCached) {
+            const CodeMap* codeMap = m_codeMapOfPage[pc / kPageSize];
+
+            if ((codeMap != nullptr) && !codeMap->isOpcode(pc)) {
+                Disassembler::disassembleData(m_sram.span(), 0, pc, entry.opcode);
+            } else {
+                Disassembler::disassembleOpcode(m_sram.span(), 0, pc, entry.opcode);
+            }
+
+            entry.isCached = true;
+
+            m_numCachedInPage[pc / kPageSize]++;
+            m_numDisassembled++;
+        }
+
+        return entry.opcode;
+    }
+
+    size_t DisassemblyCache::disassemble(uint16_t inPc, std::span<DisassembledOpcode> outOpcodes) {
+        uint16_t pc = inPc;
+        size_t numOpcodes = 0;
+
+        while ((numOpcodes < outOpcodes.size()) && (pc < m_sram.size())) {
+            const DisassembledOpcode& opcode = at(pc);
+            outOpcodes[numOpcodes++] = opcode;
+
+            if ((opcode.addressingMode == kUnknown) && (m_codeMapOfPage[pc / kPageSize] == nullptr)) {
+                break;
+            }
+
+            pc += opcode.byteSize;
+        }
+
+        return numOpcodes;
+    }
+
+    void DisassemblyCache::invalidatePages(const Pages& writtenPages) {
+        if (writtenPages.none()) {
+            return;
+        }
+
+        for (size_t page = 0; page < writtenPages.size(); page++) {
+            if (writtenPages[page]) {
+                invalidatePage(page);
+            }
+        }
+    }
+
+    void DisassemblyCache::invalidate() {
+        for (Entry& entry: m_entries) {
+            entry.isCached = false;
+        }
+
+        std::fill(m_numCachedInPage.begin(), m_numCachedInPage.end(), 0);
+    }
+
+    void DisassemblyCache::setCodeMaps(std::vector<CodeMap> codeMaps) {
+        m_codeMaps = std::move(codeMaps);
+
+        std::fill(m_codeMapOfPage.begin(), m_codeMapOfPage.end(), nullptr);
+
+        for (const CodeMap& codeMap: m_codeMaps) {
+            for (size_t offset = 0; offset < codeMap.size(); offset += kPageSize) {
+                const size_t page = (codeMap.baseAddress() + offset) / kPageSize;
+
+                if ((page < m_codeMapOfPage.size()) && (m_codeMapOfPage[page] == nullptr)) {
+                    m_codeMapOfPage[page] = &codeMap;
+                }
+            }
+        }
+
+        invalidate();
+    }
+
+    bool DisassemblyCache::formatLabel(uint16_t address, char* buffer, size_t size) const {
+        const CodeMap* codeMap = m_codeMapOfPage[address / kPageSize];
+
+        return (codeMap != nullptr) && codeMap->formatLabel(address, buffer, size);
+    }
+
+    uint64_t DisassemblyCache::numDisassembled() const {
+        return m_numDisassembled;
+    }
+
+    void DisassemblyCache::invalidatePage(size_t page) {
+        const size_t pageStart = page * kPageSize;
+
+        // opcodes that start at the end of the previous page may have operands in this page
+        const size_t kMaxOperandBytes = Disassembler::DisassembledOpcode::kMaxBytes - 1;
+        const size_t start = (page == 0) ? 0 : (pageStart - kMaxOperandBytes);
+        const size_t end = pageStart + kPageSize;
+
+        for (size_t pc = start; pc < end; pc++) {
+            const size_t pcPage = pc / kPageSize;
+
+            if (m_numCachedInPage[pcPage] == 0) {
+                // nothing cached in the rest of this page
+                pc = ((pcPage + 1) * kPageSize) - 1;
+                continue;
+            }
+
+            Entry& entry = m_entries[pc];
+
+            if (!entry.isCached || ((pc + entry.opcode.byteSize) <= pageStart)) {
+                continue;
+            }
+
+            if (hasChanged(entry.opcode)) {
+                entry.isCached = false;
+                m_numCachedInPage[pcPage]--;
+            }
+        }
+    }
+
+    bool DisassemblyCache::hasChanged(const DisassembledOpcode& opcode) const {
+        const size_t numBytes = std::min<size_t>(opcode.byteSize, Disassembler::DisassembledOpcode::kMaxBytes);
+
+        for (size_t i = 0; i < numBytes; i++) {
+            const size_t address = size_t(opcode.pc) + i;
+            const uint8_t value = (address < m_sram.size()) ? m_sram.read(address) : 0;
+
+            if (value != opcode.data[i]) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+} // assembler
+} // cpu6502
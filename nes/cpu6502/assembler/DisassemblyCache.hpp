@@ -0,0 +1,85 @@
+#pragma once
+
+#include <bitset>
+#include <span>
+#include <vector>
+
+#include "nes/memory/SRAM.hpp"
+#include "nes/cpu6502/assembler/CodeMap.hpp"
+#include "nes/cpu6502/assembler/Disassembler.hpp"
+
+namespace cpu6502 {
+    namespace assembler {
+
+        /// @class DisassemblyCache
+        /// @brief Opcodes of a 16bit address space, disassembled on first use and cached by PC
+        /// @note Code rarely changes, so an opcode is only disassembled again once a write has changed
+        ///       one of its bytes (e.g. self-modifying code, or a routine copied into RAM). Writes are
+        ///       reported a page at a time, see invalidatePages()
+        /// @note With a code map (see StaticDisassembler), bytes that are not code are disassembled as data,
+        ///       so disassembling from an arbitrary PC doesn't misalign on data
+        class DisassemblyCache {
+        public:
+            typedef Disassembler::DisassembledOpcode DisassembledOpcode;
+
+            /// @brief set of the pages (of memory::SRAM::kPageSize bytes) in the 16bit address space
+            typedef std::bitset<0x10000 / memory::SRAM::kPageSize> Pages;
+
+            /// @param sram memory to disassemble, which must outlive the cache
+            DisassemblyCache(const memory::SRAM& sram);
+
+            /// @brief retrieve the opcode at pc, disassembling it if it is not cached
+            /// @note the reference is valid until the opcode is invalidated
+            const DisassembledOpcode& at(uint16_t pc);
+
+            /// @brief retrieve consecutive opcodes from pc, up to (and including) an unsupported opcode
+            /// @note within a code map, data is retrieved a byte at a time (as ".byte"), rather than stopping
+            /// @return number of opcodes written to outOpcodes
+            /// @see Disassembler::disassemble()
+            size_t disassemble(uint16_t pc, std::span<DisassembledOpcode> outOpcodes);
+
+            /// @brief use code maps for the banks that are mapped into memory
+            /// @note where code maps overlap (e.g. switchable banks), the first is used
+            void setCodeMaps(std::vector<CodeMap> codeMaps);
+
+            /// @brief name of the label at an address, from the code maps
+            /// @return false if the address is not labelled
+            bool formatLabel(uint16_t address, char* buffer, size_t size) const;
+
+            /// @brief invalidate the cached opcodes overlapping the written pages whose bytes have changed
+            /// @param writtenPages e.g. from CpuBus::takeWrittenPages()
+            void invalidatePages(const Pages& writtenPages);
+
+            /// @brief invalidate all cached opcodes (e.g. after loading a program)
+            void invalidate();
+
+            /// @brief number of opcodes that have been disassembled, rather than found in the cache
+            uint64_t numDisassembled() const;
+
+        private:
+            struct Entry {
+                DisassembledOpcode opcode;
+                bool isCached = false;
+            };
+
+            const memory::SRAM& m_sram;
+
+            // indexed by PC
+            std::vector<Entry> m_entries;
+
+            // number of cached opcodes that start in each page
+            std::vector<uint16_t> m_numCachedInPage;
+
+            uint64_t m_numDisassembled;
+
+            std::vector<CodeMap> m_codeMaps;
+
+            // code map of each page, or nullptr
+            std::vector<const CodeMap*> m_codeMapOfPage;
+
+            void invalidatePage(size_t page);
+            bool hasChanged(const DisassembledOpcode& opcode) const;
+        };
+
+    }
+}
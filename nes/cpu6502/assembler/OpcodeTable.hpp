@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "AddressingMode.hpp"
+
+namespace cpu6502 {
+    namespace assembler {
+        /// @brief mnemonic and addressing mode of an opcode
+        struct OpcodeTableEntry {
+            const char* label = nullptr;            // nullptr = not supported
+            uint32_t addressingMode = kUnknown;
+            uint8_t byteSize = 1;
+        };
+
+        /// @brief size of an opcode and its operands
+        constexpr uint8_t addressingModeByteSize(uint32_t addressingMode) {
+            switch (addressingMode) {
+                case kAbsolute:
+                case kAbsolute | kIndexedWithX:
+                case kAbsolute | kIndexedWithY:
+                case kAbsolute | kIndirect:
+                case kAbsolute | kIndirect | kIndexedWithX:
+                case kIndirect:
+                    return 3;
+                case kImmediate:
+                case kRelative:
+                case kZeroPage:
+                case kZeroPage | kIndexedWithX | kIndirect:
+                case kZeroPage | kIndexedWithX:
+                case kZeroPage | kIndexedWithY:
+                case kZeroPage | kIndirect | kIndexedWithY:
+                    return 2;
+                default:
+                    return 1;
+            }
+        }
+
+        typedef std::array<OpcodeTableEntry, 256> OpcodeTable;
+
+        /// @brief the documented opcodes, as registered by the Opcode classes (see OpcodeList.inl)
+        /// @note Disassembler.test.cpp checks that both agree
+        constexpr OpcodeTable makeOpcodeTable() {
+            OpcodeTable table {};
+
+            table[0x00] = { "BRK", kImplied };
+            table[0x01] = { "ORA", kZeroPage|kIndexedWithX|kIndirect };
+            table[0x05] = { "ORA", kZeroPage };
+            table[0x06] = { "ASL", kZeroPage };
+            table[0x08] = { "PHP", kImplied };
+            table[0x09] = { "ORA", kImmediate };
+            table[0x0A] = { "ASL", kAccumulator };
+            table[0x0D] = { "ORA", kAbsolute };
+            table[0x0E] = { "ASL", kAbsolute };
+            table[0x10] = { "BPL", kRelative };
+            table[0x11] = { "ORA", kZeroPage|kIndirect|kIndexedWithY };
+            table[0x15] = { "ORA", kZeroPage|kIndexedWithX };
+            table[0x16] = { "ASL", kZeroPage|kIndexedWithX };
+            table[0x18] = { "CLC", kImplied };
+            table[0x19] = { "ORA", kAbsolute|kIndexedWithY };
+            table[0x1D] = { "ORA", kAbsolute|kIndexedWithX };
+            table[0x1E] = { "ASL", kAbsolute|kIndexedWithX };
+            table[0x20] = { "JSR", kAbsolute };
+            table[0x21] = { "AND", kZeroPage|kIndexedWithX|kIndirect };
+            table[0x24] = { "BIT", kZeroPage };
+            table[0x25] = { "AND", kZeroPage };
+            table[0x26] = { "ROL", kZeroPage };
+            table[0x28] = { "PLP", kImplied };
+            table[0x29] = { "AND", kImmediate };
+            table[0x2A] = { "ROL", kAccumulator };
+            table[0x2C] = { "BIT", kAbsolute };
+            table[0x2D] = { "AND", kAbsolute };
+            table[0x2E] = { "ROL", kAbsolute };
+            table[0x30] = { "BMI", kRelative };
+            table[0x31] = { "AND", kZeroPage|kIndirect|kIndexedWithY };
+            table[0x35] = { "AND", kZeroPage|kIndexedWithX };
+            table[0x36] = { "ROL", kZeroPage|kIndexedWithX };
+            table[0x38] = { "SEC", kImplied };
+            table[0x39] = { "AND", kAbsolute|kIndexedWithY };
+            table[0x3D] = { "AND", kAbsolute|kIndexedWithX };
+            table[0x3E] = { "ROL", kAbsolute|kIndexedWithX };
+            table[0x40] = { "RTI", kImplied };
+            table[0x41] = { "EOR", kZeroPage|kIndexedWithX|kIndirect };
+            table[0x45] = { "EOR", kZeroPage };
+            table[0x46] = { "LSR", kZeroPage };
+            table[0x48] = { "PHA", kImplied };
+            table[0x49] = { "EOR", kImmediate };
+            table[0x4A] = { "LSR", kAccumulator };
+            table[0x4C] = { "JMP", kAbsolute };
+            table[0x4D] = { "EOR", kAbsolute };
+            table[0x4E] = { "LSR", kAbsolute };
+            table[0x50] = { "BVC", kRelative };
+            table[0x51] = { "EOR", kZeroPage|kIndirect|kIndexedWithY };
+            table[0x55] = { "EOR", kZeroPage|kIndexedWithX };
+            table[0x56] = { "LSR", kZeroPage|kIndexedWithX };
+            table[0x58] = { "CLI", kImplied };
+            table[0x59] = { "EOR", kAbsolute|kIndexedWithY };
+            table[0x5D] = { "EOR", kAbsolute|kIndexedWithX };
+            table[0x5E] = { "LSR", kAbsolute|kIndexedWithX };
+            table[0x60] = { "RTS", kImplied };
+            table[0x61] = { "ADC", kZeroPage|kIndexedWithX|kIndirect };
+            table[0x65] = { "ADC", kZeroPage };
+            table[0x66] = { "ROR", kZeroPage };
+            table[0x68] = { "PLA", kImplied };
+            table[0x69] = { "ADC", kImmediate };
+            table[0x6A] = { "ROR", kAccumulator };
+            table[0x6C] = { "JMP", kIndirect };
+            table[0x6D] = { "ADC", kAbsolute };
+            table[0x6E] = { "ROR", kAbsolute };
+            table[0x70] = { "BVS", kRelative };
+            table[0x71] = { "ADC", kZeroPage|kIndirect|kIndexedWithY };
+            table[0x75] = { "ADC", kZeroPage|kIndexedWithX };
+            table[0x76] = { "ROR", kZeroPage|kIndexedWithX };
+            table[0x78] = { "SEI", kImplied };
+            table[0x79] = { "ADC", kAbsolute|kIndexedWithY };
+            table[0x7D] = { "ADC", kAbsolute|kIndexedWithX };
+            table[0x7E] = { "ROR", kAbsolute|kIndexedWithX };
+            table[0x81] = { "STA", kZeroPage|kIndexedWithX|kIndirect };
+            table[0x84] = { "STY", kZeroPage };
+            table[0x85] = { "STA", kZeroPage };
+            table[0x86] = { "STX", kZeroPage };
+            table[0x88] = { "DEY", kImplied };
+            table[0x8A] = { "TXA", kImplied };
+            table[0x8C] = { "STY", kAbsolute };
+            table[0x8D] = { "STA", kAbsolute };
+            table[0x8E] = { "STX", kAbsolute };
+            table[0x90] = { "BCC", kRelative };
+            table[0x91] = { "STA", kZeroPage|kIndirect|kIndexedWithY };
+            table[0x94] = { "STY", kZeroPage|kIndexedWithX };
+            table[0x95] = { "STA", kZeroPage|kIndexedWithX };
+            table[0x96] = { "STX", kZeroPage|kIndexedWithY };
+            table[0x98] = { "TYA", kImplied };
+            table[0x99] = { "STA", kAbsolute|kIndexedWithY };
+            table[0x9A] = { "TXS", kImplied };
+            table[0x9D] = { "STA", kAbsolute|kIndexedWithX };
+            table[0xA0] = { "LDY", kImmediate };
+            table[0xA1] = { "LDA", kZeroPage|kIndexedWithX|kIndirect };
+            table[0xA2] = { "LDX", kImmediate };
+            table[0xA4] = { "LDY", kZeroPage };
+            table[0xA5] = { "LDA", kZeroPage };
+            table[0xA6] = { "LDX", kZeroPage };
+            table[0xA8] = { "TAY", kImplied };
+            table[0xA9] = { "LDA", kImmediate };
+            table[0xAA] = { "TAX", kImplied };
+            table[0xAC] = { "LDY", kAbsolute };
+            table[0xAD] = { "LDA", kAbsolute };
+            table[0xAE] = { "LDX", kAbsolute };
+            table[0xB0] = { "BCS", kRelative };
+            table[0xB1] = { "LDA", kZeroPage|kIndirect|kIndexedWithY };
+            table[0xB4] = { "LDY", kZeroPage|kIndexedWithX };
+            table[0xB5] = { "LDA", kZeroPage|kIndexedWithX };
+            table[0xB6] = { "LDX", kZeroPage|kIndexedWithY };
+            table[0xB8] = { "CLV", kImplied };
+            table[0xB9] = { "LDA", kAbsolute|kIndexedWithY };
+            table[0xBA] = { "TSX", kImplied };
+            table[0xBC] = { "LDY", kAbsolute|kIndexedWithX };
+            table[0xBD] = { "LDA", kAbsolute|kIndexedWithX };
+            table[0xBE] = { "LDX", kAbsolute|kIndexedWithY };
+            table[0xC0] = { "CPY", kImmediate };
+            table[0xC1] = { "CMP", kZeroPage|kIndexedWithX|kIndirect };
+            table[0xC4] = { "CPY", kZeroPage };
+            table[0xC5] = { "CMP", kZeroPage };
+            table[0xC6] = { "DEC", kZeroPage };
+            table[0xC8] = { "INY", kImplied };
+            table[0xC9] = { "CMP", kImmediate };
+            table[0xCA] = { "DEX", kImplied };
+            table[0xCC] = { "CPY", kAbsolute };
+            table[0xCD] = { "CMP", kAbsolute };
+            table[0xCE] = { "DEC", kAbsolute };
+            table[0xD0] = { "BNE", kRelative };
+            table[0xD1] = { "CMP", kZeroPage|kIndirect|kIndexedWithY };
+            table[0xD5] = { "CMP", kZeroPage|kIndexedWithX };
+            table[0xD6] = { "DEC", kZeroPage|kIndexedWithX };
+            table[0xD8] = { "CLD", kImplied };
+            table[0xD9] = { "CMP", kAbsolute|kIndexedWithY };
+            table[0xDD] = { "CMP", kAbsolute|kIndexedWithX };
+            table[0xDE] = { "DEC", kAbsolute|kIndexedWithX };
+            table[0xE0] = { "CPX", kImmediate };
+            table[0xE1] = { "SBC", kZeroPage|kIndexedWithX|kIndirect };
+            table[0xE4] = { "CPX", kZeroPage };
+            table[0xE5] = { "SBC", kZeroPage };
+            table[0xE6] = { "INC", kZeroPage };
+            table[0xE8] = { "INX", kImplied };
+            table[0xE9] = { "SBC", kImmediate };
+            table[0xEA] = { "NOP", kImplied };
+            table[0xEC] = { "CPX", kAbsolute };
+            table[0xED] = { "SBC", kAbsolute };
+            table[0xEE] = { "INC", kAbsolute };
+            table[0xF0] = { "BEQ", kRelative };
+            table[0xF1] = { "SBC", kZeroPage|kIndirect|kIndexedWithY };
+            table[0xF5] = { "SBC", kZeroPage|kIndexedWithX };
+            table[0xF6] = { "INC", kZeroPage|kIndexedWithX };
+            table[0xF8] = { "SED", kImplied };
+            table[0xF9] = { "SBC", kAbsolute|kIndexedWithY };
+            table[0xFD] = { "SBC", kAbsolute|kIndexedWithX };
+            table[0xFE] = { "INC", kAbsolute|kIndexedWithX };
+
+            for (auto& entry: table) {
+                entry.byteSize = addressingModeByteSize(entry.addressingMode);
+            }
+
+            return table;
+        }
+
+        /// @brief opcode table, indexed by opcode
+        inline constexpr OpcodeTable kOpcodeTable = makeOpcodeTable();
+    }
+}
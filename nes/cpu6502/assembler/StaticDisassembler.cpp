@@ -0,0 +1,346 @@
+#include "nes/cpu6502/assembler/StaticDisassembler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace cpu6502 { namespace assembler {
+    namespace {
+        const size_t kBankSize = 0x4000;
+        const size_t kNumVectors = 3;
+
+        const struct {
+            uint16_t address;
+            uint8_t labelFlags;
+        } kVectors[kNumVectors] = {
+            { 0xFFFA, CodeMap::kLabelNMI },
+            { 0xFFFC, CodeMap::kLabelReset },
+            { 0xFFFE, CodeMap::kLabelIRQ }
+        };
+
+        // opcodes that change the flow of the program (other than branches)
+        const uint8_t kOpcodeBRK = 0x00;
+        const uint8_t kOpcodeJSR = 0x20;
+        const uint8_t kOpcodeRTI = 0x40;
+        const uint8_t kOpcodeJMPAbsolute = 0x4C;
+        const uint8_t kOpcodeRTS = 0x60;
+        const uint8_t kOpcodeJMPIndirect = 0x6C;
+    }
+
+    std::vector<StaticDisassembler::Bank> StaticDisassembler::banksOf(std::span<const uint8_t> prgRom) {
+        std::vector<Bank> banks;
+
+        if (prgRom.empty()) {
+            return banks;
+        }
+
+        if (prgRom.size() <= 0x8000) {
+            banks.push_back({ prgRom, uint16_t(0x10000 - prgRom.size()), true });
+            return banks;
+        }
+
+        for (size_t offset = 0; offset < prgRom.size(); offset += kBankSize) {
+            const size_t size = std::min(kBankSize, prgRom.size() - offset);
+            const bool isLast = (offset + size) == prgRom.size();
+
+            banks.push_back({ prgRom.subspan(offset, size), uint16_t(isLast ? (0x10000 - size) : 0x8000), isLast });
+        }
+
+        return banks;
+    }
+
+    StaticDisassembler::StaticDisassembler(size_t numThreads) : m_numThreads(numThreads) {
+        if (m_numThreads == 0) {
+            m_numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    std::vector<CodeMap> StaticDisassembler::disassemble(const std::vector<Bank>& banks) {
+        m_stats = Stats();
+
+        std::vector<CodeMap> codeMaps;
+        std::vector<BankState> states(banks.size());
+
+        for (size_t i = 0; i < banks.size(); i++) {
+            codeMaps.emplace_back(i, banks[i].baseAddress, banks[i].data.size());
+
+            states[i].bank = &banks[i];
+            states[i].isOnlyBank = (banks.size() == 1);
+            states[i].isQueued.assign(banks[i].data.size(), 0);
+        }
+
+        // vectors, from the fixed bank at the top of the address space
+        for (size_t i = 0; i < banks.size(); i++) {
+            const Bank& bank = banks[i];
+
+            if (!bank.isFixed || ((size_t(bank.baseAddress) + bank.data.size()) != 0x10000) || (bank.data.size() < 6)) {
+                continue;
+            }
+
+            for (auto& vector: kVectors) {
+                const size_t offset = vector.address - bank.baseAddress;
+                const uint16_t address = bank.data[offset] | (bank.data[offset + 1] << 8);
+
+                for (size_t j = 0; j < banks.size(); j++) {
+                    uint16_t resolved;
+                    if (banks[j].isFixed && resolve(states[j], address, resolved)) {
+                        queue(states[j], codeMaps[j], { resolved, vector.labelFlags, false });
+                    }
+                }
+            }
+        }
+
+        std::vector<size_t> pendingBanks;
+
+        while (true) {
+            pendingBanks.clear();
+
+            for (size_t i = 0; i < states.size(); i++) {
+                if (!states[i].pending.empty()) {
+                    pendingBanks.push_back(i);
+                }
+            }
+
+            if (pendingBanks.empty()) {
+                break;
+            }
+
+            m_stats.numRounds++;
+
+            // each bank only touches its own state and code map, so banks are walked in parallel
+            const size_t numThreads = std::min(m_numThreads, pendingBanks.size());
+            std::atomic<size_t> nextBank(0);
+
+            auto walkBanks = [&]() {
+                for (size_t index = nextBank++; index < pendingBanks.size(); index = nextBank++) {
+                    walkBank(states[pendingBanks[index]], codeMaps[pendingBanks[index]]);
+                }
+            };
+
+            if (numThreads <= 1) {
+                walkBanks();
+            } else {
+                std::vector<std::thread> threads;
+
+                for (size_t i = 0; i < numThreads; i++) {
+                    threads.emplace_back(walkBanks);
+                }
+
+                for (auto& thread: threads) {
+                    thread.join();
+                }
+            }
+
+            // queue targets in other banks, for the next round
+            for (size_t from = 0; from < states.size(); from++) {
+                for (const Target& target: states[from].external) {
+                    for (size_t to = 0; to < banks.size(); to++) {
+                        uint16_t resolved;
+
+                        if ((to == from) || !resolve(states[to], target.address, resolved)) {
+                            continue;
+                        }
+
+                        if (!banks[from].isFixed && !banks[to].isFixed) {
+                            // can't tell which bank a switchable bank has switched in
+                            continue;
+                        }
+
+                        queue(states[to], codeMaps[to], { resolved, target.labelFlags, target.isSpeculative || !banks[to].isFixed });
+                    }
+                }
+
+                states[from].external.clear();
+            }
+        }
+
+        for (const BankState& state: states) {
+            m_stats.numUnsupported += state.stats.numUnsupported;
+            m_stats.numConflicts += state.stats.numConflicts;
+            m_stats.numIndirectJumps += state.stats.numIndirectJumps;
+            m_stats.numSpeculative += state.stats.numSpeculative;
+            m_stats.numRejected += state.stats.numRejected;
+        }
+
+        return codeMaps;
+    }
+
+    const StaticDisassembler::Stats& StaticDisassembler::stats() const {
+        return m_stats;
+    }
+
+    void StaticDisassembler::walkBank(BankState& state, CodeMap& codeMap) {
+        std::vector<Target> pending;
+        pending.swap(state.pending);
+
+        for (const Target& target: pending) {
+            walk(state, target, codeMap);
+        }
+    }
+
+    bool StaticDisassembler::walk(BankState& state, const Target& target, CodeMap& codeMap) {
+        // speculative targets record their changes, which are rolled back unless all of it is code
+        if (target.isSpeculative) {
+            state.stats.numSpeculative++;
+            state.changes.clear();
+        }
+
+        const Bank& bank = *state.bank;
+
+        std::vector<Target> external;
+        std::vector<Target> stack { target };
+
+        auto record = [&](uint16_t address, uint16_t byteSize) {
+            if (target.isSpeculative) {
+                state.changes.push_back({ address, byteSize, codeMap.labelFlags(address) });
+            }
+        };
+
+        auto reject = [&]() {
+            // newest first, so each label ends up with its flags from before the walk
+            for (auto change = state.changes.rbegin(); change != state.changes.rend(); ++change) {
+                if (change->byteSize != 0) {
+                    codeMap.clearOpcode(change->address, change->byteSize);
+                }
+
+                codeMap.setLabelFlags(change->address, change->labelFlags);
+            }
+
+            state.stats.numRejected++;
+            return false;
+        };
+
+        while (!stack.empty()) {
+            Target next = stack.back();
+            stack.pop_back();
+
+            uint16_t pc;
+            if (!resolve(state, next.address, pc)) {
+                external.push_back({ next.address, next.labelFlags, target.isSpeculative });
+                continue;
+            }
+
+            if (codeMap.isOpcode(pc)) {
+                record(pc, 0);
+                codeMap.addLabel(pc, next.labelFlags);
+                continue;
+            }
+
+            if (codeMap.isCode(pc)) {
+                // in the middle of a known opcode
+                if (target.isSpeculative) {
+                    return reject();
+                }
+
+                state.stats.numConflicts++;
+                continue;
+            }
+
+            Disassembler::DisassembledOpcode opcode;
+            const bool isSupported = Disassembler::disassembleOpcode(bank.data, bank.baseAddress, pc, opcode);
+            const size_t offset = pc - bank.baseAddress;
+
+            if (!isSupported || ((offset + opcode.byteSize) > bank.data.size())) {
+                if (target.isSpeculative) {
+                    return reject();
+                }
+
+                state.stats.numUnsupported++;
+                continue;
+            }
+
+            bool isOverlapping = false;
+            for (uint16_t i = 1; i < opcode.byteSize; i++) {
+                isOverlapping |= codeMap.isCode(pc + i);
+            }
+
+            if (isOverlapping) {
+                // operands overlap a known opcode
+                if (target.isSpeculative) {
+                    return reject();
+                }
+
+                state.stats.numConflicts++;
+                continue;
+            }
+
+            record(pc, opcode.byteSize);
+            codeMap.markOpcode(pc, opcode.byteSize);
+            codeMap.addLabel(pc, next.labelFlags);
+
+            const uint16_t address = (opcode.data[2] << 8) | opcode.data[1];
+            const uint16_t nextPc = pc + opcode.byteSize;
+
+            switch (opcode.opcode) {
+                case kOpcodeJSR:
+                    stack.push_back({ nextPc, 0, false });
+                    stack.push_back({ address, CodeMap::kLabelSubroutine, false });
+                    break;
+                case kOpcodeJMPAbsolute:
+                    stack.push_back({ address, CodeMap::kLabelJump, false });
+                    break;
+                case kOpcodeJMPIndirect:
+                    state.stats.numIndirectJumps++;
+                    break;
+                case kOpcodeBRK:
+                case kOpcodeRTI:
+                case kOpcodeRTS:
+                    break;
+                default:
+                    if (opcode.addressingMode == kRelative) {
+                        stack.push_back({ nextPc, 0, false });
+                        stack.push_back({ uint16_t(nextPc + int8_t(opcode.data[1])), CodeMap::kLabelBranch, false });
+                    } else {
+                        stack.push_back({ nextPc, 0, false });
+                    }
+                    break;
+            }
+        }
+
+        state.external.insert(state.external.end(), external.begin(), external.end());
+
+        return true;
+    }
+
+    void StaticDisassembler::queue(BankState& state, CodeMap& codeMap, const Target& target) {
+        const size_t offset = target.address - state.bank->baseAddress;
+
+        if (!state.isQueued[offset]) {
+            state.isQueued[offset] = 1;
+            state.pending.push_back(target);
+            return;
+        }
+
+        // already walked (or about to be), but may be the target of another kind of jump
+        if (codeMap.isOpcode(target.address)) {
+            codeMap.addLabel(target.address, target.labelFlags);
+            return;
+        }
+
+        for (Target& pending: state.pending) {
+            if (pending.address == target.address) {
+                pending.labelFlags |= target.labelFlags;
+                pending.isSpeculative &= target.isSpeculative;
+            }
+        }
+    }
+
+    bool StaticDisassembler::resolve(const BankState& state, uint16_t address, uint16_t& outAddress) {
+        const Bank& bank = *state.bank;
+        const size_t size = bank.data.size();
+
+        if ((address >= bank.baseAddress) && ((size_t(address) - bank.baseAddress) < size)) {
+            outAddress = address;
+            return true;
+        }
+
+        if (state.isOnlyBank && (address >= 0x8000) && (bank.baseAddress > 0x8000)) {
+            // a single bank that is smaller than 0x8000:0xFFFF is mirrored
+            outAddress = uint16_t(bank.baseAddress + ((address - 0x8000) % size));
+            return true;
+        }
+
+        return false;
+    }
+} // assembler
+} // cpu6502
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "nes/cpu6502/assembler/CodeMap.hpp"
+#include "nes/cpu6502/assembler/Disassembler.hpp"
+
+namespace cpu6502 {
+    namespace assembler {
+
+        /// @class StaticDisassembler
+        /// @brief Find the code in PRG ROM by recursive descent, from the reset / NMI / IRQ vectors, following
+        ///        branches, JSR and JMP, rather than disassembling linearly (which misaligns on data)
+        /// @note Banks are walked in parallel, in rounds. Targets in another bank are walked in the next round.
+        ///       Targets in a switchable bank are speculative (which bank is switched in is unknown), so each
+        ///       is only kept if it doesn't reach an unsupported opcode, or the middle of a known opcode.
+        ///       A rejected target's changes to the code map are rolled back.
+        /// @note JMP (indirect) targets (e.g. jump tables) are not followed
+        class StaticDisassembler {
+        public:
+            /// @brief a bank of PRG ROM, as mapped into the CPU address space
+            struct Bank {
+                std::span<const uint8_t> data;
+                uint16_t baseAddress;
+                bool isFixed;                       // always mapped at baseAddress
+            };
+
+            struct Stats {
+                size_t numRounds = 0;
+                size_t numUnsupported = 0;          // unsupported opcodes reached from a vector or fixed code
+                size_t numConflicts = 0;            // targets in the middle of a known opcode
+                size_t numIndirectJumps = 0;
+                size_t numSpeculative = 0;          // targets in a switchable bank
+                size_t numRejected = 0;             // speculative targets that weren't code
+            };
+
+            /// @brief split PRG ROM into banks as mapped at power on
+            /// @note 16KB and 32KB images are a single fixed bank (NROM, with 16KB mirrored into 0x8000:0xBFFF).
+            ///       Larger images are 16KB banks, with the last fixed at 0xC000 and the others switched into
+            ///       0x8000 (UxROM, and MMC1 in its power on mode)
+            static std::vector<Bank> banksOf(std::span<const uint8_t> prgRom);
+
+            /// @param numThreads maximum number of banks walked at once (0 = number of cores)
+            explicit StaticDisassembler(size_t numThreads = 0);
+
+            /// @brief find the code in each bank, from the vectors of the fixed bank at 0xFFFA:0xFFFF
+            /// @return code map for each bank, in the order of banks
+            std::vector<CodeMap> disassemble(const std::vector<Bank>& banks);
+
+            const Stats& stats() const;
+
+        private:
+            struct Target {
+                uint16_t address;
+                uint8_t labelFlags;
+                bool isSpeculative;
+            };
+
+            /// @brief a change made to a code map by a speculative walk, so that it can be rolled back
+            struct Change {
+                uint16_t address;
+                uint16_t byteSize;                  // of the opcode marked, 0 if only labelled
+                uint8_t labelFlags;                 // before the change
+            };
+
+            struct BankState {
+                const Bank* bank;
+                bool isOnlyBank;
+                std::vector<Target> pending;
+                std::vector<Target> external;       // targets outside of the bank, found by the last walk
+                std::vector<uint8_t> isQueued;      // flag per byte, so that each target is only walked once
+                std::vector<Change> changes;        // by the current speculative walk
+                Stats stats;
+            };
+
+            size_t m_numThreads;
+            Stats m_stats;
+
+            void walkBank(BankState& state, CodeMap& codeMap);
+            bool walk(BankState& state, const Target& target, CodeMap& codeMap);
+            void queue(BankState& state, CodeMap& codeMap, const Target& target);
+
+            /// @brief address of a target in a bank, taking the mirroring of a single 16KB bank into account
+            /// @return false if the address is outside of the bank
+            static bool resolve(const BankState& state, uint16_t address, uint16_t& outAddress);
+        };
+
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+
+#include "nes/memory/SRAM.hpp"
+
+namespace cpu6502 {
+    namespace model {
+        /// @brief programmer visible registers of a 6502
+        struct Registers {
+            uint16_t pc = 0;
+            uint8_t a = 0;
+            uint8_t x = 0;
+            uint8_t y = 0;
+            uint8_t s = 0;
+            uint8_t p = 0;
+
+            bool operator==(const Registers& other) const {
+                return (pc == other.pc) && (a == other.a) && (x == other.x) && (y == other.y) && (s == other.s) && (p == other.p);
+            }
+
+            bool operator!=(const Registers& other) const {
+                return !(*this == other);
+            }
+        };
+
+        /// @class SRAMBus
+        /// @brief Connect the model to SRAM (i.e. the same memory map as CpuBus)
+        class SRAMBus {
+        public:
+            SRAMBus(memory::SRAM& sram) : m_sram(sram) {
+            }
+
+            inline uint8_t read(uint16_t address) {
+                return m_sram.read(address);
+            }
+
+            inline void write(uint16_t address, uint8_t data) {
+                m_sram.write(address, data);
+            }
+
+        private:
+            memory::SRAM& m_sram;
+        };
+
+        /// @class Cpu6502Model
+        /// @brief Behavioural model of the 6502, that executes an instruction per call to step()
+        /// @param BUS bus model with 'uint8_t read(uint16_t)' and 'void write(uint16_t, uint8_t)'
+        /// @note Every clock cycle of the 6502 is a bus cycle, so the model makes the same sequence of
+        ///       reads and writes as the hardware (including the dummy reads and writes), and counts
+        ///       cycles by counting bus accesses
+        /// @note Matches the RTL rather than a 2A03 or a NMOS 6502 where they differ: decimal mode is not
+        ///       implemented (see ALU i_daa), and undocumented opcodes are reported by hasErrored()
+        ///       (see o_debug_error)
+        /// @note Interrupts are taken at the instruction boundary, so the one instruction delay of
+        ///       CLI/SEI/PLP and interrupt hijacking are not modelled
+        template <class BUS>
+        class Cpu6502Model {
+        public:
+            static const uint16_t kVectorNMI = 0xFFFA;
+            static const uint16_t kVectorReset = 0xFFFC;
+            static const uint16_t kVectorIRQ = 0xFFFE;
+
+            // processor status flags (cf ProcessorStatusFlags.hpp)
+            static const uint8_t kFlagC = 1 << 0;
+            static const uint8_t kFlagZ = 1 << 1;
+            static const uint8_t kFlagI = 1 << 2;
+            static const uint8_t kFlagD = 1 << 3;
+            static const uint8_t kFlagB = 1 << 4;
+            static const uint8_t kFlagU = 1 << 5;
+            static const uint8_t kFlagV = 1 << 6;
+            static const uint8_t kFlagN = 1 << 7;
+
+            explicit Cpu6502Model(BUS& bus);
+
+            /// @brief run the reset sequence, as the RTL does after i_reset_n
+            /// @return number of cycles taken (7)
+            uint32_t reset();
+
+            /// @brief execute one instruction, or enter a pending interrupt
+            /// @return number of cycles taken
+            uint32_t step();
+
+            /// @brief execute whole instructions until at least numCycles have been taken
+            /// @return number of cycles taken
+            uint64_t run(uint64_t numCycles);
+
+            /// @brief level of the NMI line, edge triggered (cf i_nmi_n)
+            void setNMI(bool isActive);
+
+            /// @brief level of the IRQ line (cf i_irq_n)
+            void setIRQ(bool isActive);
+
+            const Registers& registers() const {
+                return m_registers;
+            }
+
+            Registers& registers() {
+                return m_registers;
+            }
+
+            /// @brief number of cycles taken since construction
+            uint64_t cycles() const {
+                return m_cycles;
+            }
+
+            /// @brief has an undocumented opcode been executed
+            bool hasErrored() const {
+                return m_hasErrored;
+            }
+
+            /// @brief opcode that caused hasErrored()
+            uint8_t errorOpcode() const {
+                return m_errorOpcode;
+            }
+
+        private:
+            enum class Access {
+                kRead,
+                kWrite,
+                kModify
+            };
+
+            BUS& m_bus;
+            Registers m_registers;
+            uint64_t m_cycles = 0;
+
+            bool m_hasErrored = false;
+            uint8_t m_errorOpcode = 0;
+
+            bool m_isNMIActive = false;
+            bool m_isNMIPending = false;
+            bool m_isIRQActive = false;
+
+            inline uint8_t read(uint16_t address);
+            inline void write(uint16_t address, uint8_t data);
+
+            inline uint8_t fetch();
+            inline void implied();
+            inline void push(uint8_t data);
+            inline uint8_t pull();
+
+            // addressing modes, that return the effective address after taking the
+            //  cycles (and dummy accesses) of the hardware
+            inline uint16_t zeroPage();
+            inline uint16_t zeroPageIndexed(uint8_t index);
+            inline uint16_t absolute();
+            inline uint16_t absoluteIndexed(uint8_t index, Access access);
+            inline uint16_t indexedIndirect();
+            inline uint16_t indirectIndexed(Access access);
+
+            inline void setNZ(uint8_t value);
+            inline void setFlag(uint8_t flag, bool isSet);
+
+            inline void adc(uint8_t value);
+            inline void compare(uint8_t reg, uint8_t value);
+            inline void bit(uint8_t value);
+            inline uint8_t asl(uint8_t value);
+            inline uint8_t lsr(uint8_t value);
+            inline uint8_t rol(uint8_t value);
+            inline uint8_t ror(uint8_t value);
+
+            /// @brief read-modify-write, with the dummy write of the unmodified value
+            template <class OPERATION>
+            inline void modify(uint16_t address, OPERATION operation);
+
+            inline void branch(bool isTaken);
+
+            /// @brief push PC and P, then load PC from the vector
+            /// @param isBRK true for BRK (which sets B in the pushed P)
+            inline void interrupt(uint16_t vector, bool isBRK);
+        };
+    }
+}
+
+// inlined template implementations
+#include "Cpu6502Model.inl"
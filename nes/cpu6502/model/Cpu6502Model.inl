@@ -0,0 +1,546 @@
+// note: included inline from Cpu6502Model.hpp
+
+namespace cpu6502 {
+    namespace model {
+        template <class BUS>
+        Cpu6502Model<BUS>::Cpu6502Model(BUS& bus) : m_bus(bus) {
+            m_registers.p = kFlagU;
+        }
+
+        template <class BUS>
+        uint32_t Cpu6502Model<BUS>::reset() {
+            const uint64_t start = m_cycles;
+
+            // same bus cycles as BRK, with the writes to the stack suppressed
+            read(m_registers.pc);
+            read(m_registers.pc);
+
+            for (int i = 0; i < 3; ++i) {
+                read(0x0100 | m_registers.s);
+                m_registers.s--;
+            }
+
+            uint8_t pcl = read(kVectorReset);
+            uint8_t pch = read(kVectorReset + 1);
+
+            m_registers.pc = (pch << 8) | pcl;
+            m_registers.p |= kFlagI;
+
+            m_isNMIPending = false;
+
+            return uint32_t(m_cycles - start);
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::setNMI(bool isActive) {
+            if (isActive && !m_isNMIActive) {
+                m_isNMIPending = true;
+            }
+
+            m_isNMIActive = isActive;
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::setIRQ(bool isActive) {
+            m_isIRQActive = isActive;
+        }
+
+        template <class BUS>
+        uint64_t Cpu6502Model<BUS>::run(uint64_t numCycles) {
+            const uint64_t start = m_cycles;
+
+            while ((m_cycles - start) < numCycles) {
+                step();
+            }
+
+            return m_cycles - start;
+        }
+
+        template <class BUS>
+        uint32_t Cpu6502Model<BUS>::step() {
+            const uint64_t start = m_cycles;
+            Registers& r = m_registers;
+
+            if (m_isNMIPending || (m_isIRQActive && ((r.p & kFlagI) == 0))) {
+                const uint16_t vector = m_isNMIPending ? kVectorNMI : kVectorIRQ;
+                m_isNMIPending = false;
+
+                // opcode fetch and operand fetch are made, but PC is not incremented
+                read(r.pc);
+                read(r.pc);
+                interrupt(vector, false);
+
+                return uint32_t(m_cycles - start);
+            }
+
+            const uint8_t opcode = fetch();
+
+            switch (opcode) {
+                // load
+                case 0xA9: r.a = fetch(); setNZ(r.a); break;
+                case 0xA5: r.a = read(zeroPage()); setNZ(r.a); break;
+                case 0xB5: r.a = read(zeroPageIndexed(r.x)); setNZ(r.a); break;
+                case 0xAD: r.a = read(absolute()); setNZ(r.a); break;
+                case 0xBD: r.a = read(absoluteIndexed(r.x, Access::kRead)); setNZ(r.a); break;
+                case 0xB9: r.a = read(absoluteIndexed(r.y, Access::kRead)); setNZ(r.a); break;
+                case 0xA1: r.a = read(indexedIndirect()); setNZ(r.a); break;
+                case 0xB1: r.a = read(indirectIndexed(Access::kRead)); setNZ(r.a); break;
+
+                case 0xA2: r.x = fetch(); setNZ(r.x); break;
+                case 0xA6: r.x = read(zeroPage()); setNZ(r.x); break;
+                case 0xB6: r.x = read(zeroPageIndexed(r.y)); setNZ(r.x); break;
+                case 0xAE: r.x = read(absolute()); setNZ(r.x); break;
+                case 0xBE: r.x = read(absoluteIndexed(r.y, Access::kRead)); setNZ(r.x); break;
+
+                case 0xA0: r.y = fetch(); setNZ(r.y); break;
+                case 0xA4: r.y = read(zeroPage()); setNZ(r.y); break;
+                case 0xB4: r.y = read(zeroPageIndexed(r.x)); setNZ(r.y); break;
+                case 0xAC: r.y = read(absolute()); setNZ(r.y); break;
+                case 0xBC: r.y = read(absoluteIndexed(r.x, Access::kRead)); setNZ(r.y); break;
+
+                // store
+                case 0x85: write(zeroPage(), r.a); break;
+                case 0x95: write(zeroPageIndexed(r.x), r.a); break;
+                case 0x8D: write(absolute(), r.a); break;
+                case 0x9D: write(absoluteIndexed(r.x, Access::kWrite), r.a); break;
+                case 0x99: write(absoluteIndexed(r.y, Access::kWrite), r.a); break;
+                case 0x81: write(indexedIndirect(), r.a); break;
+                case 0x91: write(indirectIndexed(Access::kWrite), r.a); break;
+
+                case 0x86: write(zeroPage(), r.x); break;
+                case 0x96: write(zeroPageIndexed(r.y), r.x); break;
+                case 0x8E: write(absolute(), r.x); break;
+
+                case 0x84: write(zeroPage(), r.y); break;
+                case 0x94: write(zeroPageIndexed(r.x), r.y); break;
+                case 0x8C: write(absolute(), r.y); break;
+
+                // transfer
+                case 0xAA: implied(); r.x = r.a; setNZ(r.x); break;
+                case 0xA8: implied(); r.y = r.a; setNZ(r.y); break;
+                case 0xBA: implied(); r.x = r.s; setNZ(r.x); break;
+                case 0x8A: implied(); r.a = r.x; setNZ(r.a); break;
+                case 0x9A: implied(); r.s = r.x; break;
+                case 0x98: implied(); r.a = r.y; setNZ(r.a); break;
+
+                // logic
+                case 0x29: r.a &= fetch(); setNZ(r.a); break;
+                case 0x25: r.a &= read(zeroPage()); setNZ(r.a); break;
+                case 0x35: r.a &= read(zeroPageIndexed(r.x)); setNZ(r.a); break;
+                case 0x2D: r.a &= read(absolute()); setNZ(r.a); break;
+                case 0x3D: r.a &= read(absoluteIndexed(r.x, Access::kRead)); setNZ(r.a); break;
+                case 0x39: r.a &= read(absoluteIndexed(r.y, Access::kRead)); setNZ(r.a); break;
+                case 0x21: r.a &= read(indexedIndirect()); setNZ(r.a); break;
+                case 0x31: r.a &= read(indirectIndexed(Access::kRead)); setNZ(r.a); break;
+
+                case 0x09: r.a |= fetch(); setNZ(r.a); break;
+                case 0x05: r.a |= read(zeroPage()); setNZ(r.a); break;
+                case 0x15: r.a |= read(zeroPageIndexed(r.x)); setNZ(r.a); break;
+                case 0x0D: r.a |= read(absolute()); setNZ(r.a); break;
+                case 0x1D: r.a |= read(absoluteIndexed(r.x, Access::kRead)); setNZ(r.a); break;
+                case 0x19: r.a |= read(absoluteIndexed(r.y, Access::kRead)); setNZ(r.a); break;
+                case 0x01: r.a |= read(indexedIndirect()); setNZ(r.a); break;
+                case 0x11: r.a |= read(indirectIndexed(Access::kRead)); setNZ(r.a); break;
+
+                case 0x49: r.a ^= fetch(); setNZ(r.a); break;
+                case 0x45: r.a ^= read(zeroPage()); setNZ(r.a); break;
+                case 0x55: r.a ^= read(zeroPageIndexed(r.x)); setNZ(r.a); break;
+                case 0x4D: r.a ^= read(absolute()); setNZ(r.a); break;
+                case 0x5D: r.a ^= read(absoluteIndexed(r.x, Access::kRead)); setNZ(r.a); break;
+                case 0x59: r.a ^= read(absoluteIndexed(r.y, Access::kRead)); setNZ(r.a); break;
+                case 0x41: r.a ^= read(indexedIndirect()); setNZ(r.a); break;
+                case 0x51: r.a ^= read(indirectIndexed(Access::kRead)); setNZ(r.a); break;
+
+                case 0x24: bit(read(zeroPage())); break;
+                case 0x2C: bit(read(absolute())); break;
+
+                // arithmetic
+                case 0x69: adc(fetch()); break;
+                case 0x65: adc(read(zeroPage())); break;
+                case 0x75: adc(read(zeroPageIndexed(r.x))); break;
+                case 0x6D: adc(read(absolute())); break;
+                case 0x7D: adc(read(absoluteIndexed(r.x, Access::kRead))); break;
+                case 0x79: adc(read(absoluteIndexed(r.y, Access::kRead))); break;
+                case 0x61: adc(read(indexedIndirect())); break;
+                case 0x71: adc(read(indirectIndexed(Access::kRead))); break;
+
+                // note: SBC is ADC of the ones complement
+                case 0xE9: adc(~fetch()); break;
+                case 0xE5: adc(~read(zeroPage())); break;
+                case 0xF5: adc(~read(zeroPageIndexed(r.x))); break;
+                case 0xED: adc(~read(absolute())); break;
+                case 0xFD: adc(~read(absoluteIndexed(r.x, Access::kRead))); break;
+                case 0xF9: adc(~read(absoluteIndexed(r.y, Access::kRead))); break;
+                case 0xE1: adc(~read(indexedIndirect())); break;
+                case 0xF1: adc(~read(indirectIndexed(Access::kRead))); break;
+
+                // compare
+                case 0xC9: compare(r.a, fetch()); break;
+                case 0xC5: compare(r.a, read(zeroPage())); break;
+                case 0xD5: compare(r.a, read(zeroPageIndexed(r.x))); break;
+                case 0xCD: compare(r.a, read(absolute())); break;
+                case 0xDD: compare(r.a, read(absoluteIndexed(r.x, Access::kRead))); break;
+                case 0xD9: compare(r.a, read(absoluteIndexed(r.y, Access::kRead))); break;
+                case 0xC1: compare(r.a, read(indexedIndirect())); break;
+                case 0xD1: compare(r.a, read(indirectIndexed(Access::kRead))); break;
+
+                case 0xE0: compare(r.x, fetch()); break;
+                case 0xE4: compare(r.x, read(zeroPage())); break;
+                case 0xEC: compare(r.x, read(absolute())); break;
+
+                case 0xC0: compare(r.y, fetch()); break;
+                case 0xC4: compare(r.y, read(zeroPage())); break;
+                case 0xCC: compare(r.y, read(absolute())); break;
+
+                // inc / dec
+                case 0xE6: modify(zeroPage(), [this](uint8_t value) { value++; setNZ(value); return value; }); break;
+                case 0xF6: modify(zeroPageIndexed(r.x), [this](uint8_t value) { value++; setNZ(value); return value; }); break;
+                case 0xEE: modify(absolute(), [this](uint8_t value) { value++; setNZ(value); return value; }); break;
+                case 0xFE: modify(absoluteIndexed(r.x, Access::kModify), [this](uint8_t value) { value++; setNZ(value); return value; }); break;
+
+                case 0xC6: modify(zeroPage(), [this](uint8_t value) { value--; setNZ(value); return value; }); break;
+                case 0xD6: modify(zeroPageIndexed(r.x), [this](uint8_t value) { value--; setNZ(value); return value; }); break;
+                case 0xCE: modify(absolute(), [this](uint8_t value) { value--; setNZ(value); return value; }); break;
+                case 0xDE: modify(absoluteIndexed(r.x, Access::kModify), [this](uint8_t value) { value--; setNZ(value); return value; }); break;
+
+                case 0xE8: implied(); r.x++; setNZ(r.x); break;
+                case 0xC8: implied(); r.y++; setNZ(r.y); break;
+                case 0xCA: implied(); r.x--; setNZ(r.x); break;
+                case 0x88: implied(); r.y--; setNZ(r.y); break;
+
+                // shift
+                case 0x0A: implied(); r.a = asl(r.a); break;
+                case 0x06: modify(zeroPage(), [this](uint8_t value) { return asl(value); }); break;
+                case 0x16: modify(zeroPageIndexed(r.x), [this](uint8_t value) { return asl(value); }); break;
+                case 0x0E: modify(absolute(), [this](uint8_t value) { return asl(value); }); break;
+                case 0x1E: modify(absoluteIndexed(r.x, Access::kModify), [this](uint8_t value) { return asl(value); }); break;
+
+                case 0x4A: implied(); r.a = lsr(r.a); break;
+                case 0x46: modify(zeroPage(), [this](uint8_t value) { return lsr(value); }); break;
+                case 0x56: modify(zeroPageIndexed(r.x), [this](uint8_t value) { return lsr(value); }); break;
+                case 0x4E: modify(absolute(), [this](uint8_t value) { return lsr(value); }); break;
+                case 0x5E: modify(absoluteIndexed(r.x, Access::kModify), [this](uint8_t value) { return lsr(value); }); break;
+
+                case 0x2A: implied(); r.a = rol(r.a); break;
+                case 0x26: modify(zeroPage(), [this](uint8_t value) { return rol(value); }); break;
+                case 0x36: modify(zeroPageIndexed(r.x), [this](uint8_t value) { return rol(value); }); break;
+                case 0x2E: modify(absolute(), [this](uint8_t value) { return rol(value); }); break;
+                case 0x3E: modify(absoluteIndexed(r.x, Access::kModify), [this](uint8_t value) { return rol(value); }); break;
+
+                case 0x6A: implied(); r.a = ror(r.a); break;
+                case 0x66: modify(zeroPage(), [this](uint8_t value) { return ror(value); }); break;
+                case 0x76: modify(zeroPageIndexed(r.x), [this](uint8_t value) { return ror(value); }); break;
+                case 0x6E: modify(absolute(), [this](uint8_t value) { return ror(value); }); break;
+                case 0x7E: modify(absoluteIndexed(r.x, Access::kModify), [this](uint8_t value) { return ror(value); }); break;
+
+                // branch
+                case 0x10: branch((r.p & kFlagN) == 0); break;
+                case 0x30: branch((r.p & kFlagN) != 0); break;
+                case 0x50: branch((r.p & kFlagV) == 0); break;
+                case 0x70: branch((r.p & kFlagV) != 0); break;
+                case 0x90: branch((r.p & kFlagC) == 0); break;
+                case 0xB0: branch((r.p & kFlagC) != 0); break;
+                case 0xD0: branch((r.p & kFlagZ) == 0); break;
+                case 0xF0: branch((r.p & kFlagZ) != 0); break;
+
+                // jump / subroutine
+                case 0x4C: r.pc = absolute(); break;
+
+                case 0x6C: {
+                    uint16_t pointer = absolute();
+
+                    // note: the high byte is read from the same page as the low byte
+                    uint8_t pcl = read(pointer);
+                    uint8_t pch = read((pointer & 0xFF00) | ((pointer + 1) & 0x00FF));
+                    r.pc = (pch << 8) | pcl;
+                    break;
+                }
+
+                case 0x20: {
+                    uint8_t pcl = fetch();
+                    read(0x0100 | r.s);
+                    push(r.pc >> 8);
+                    push(r.pc & 0xFF);
+                    uint8_t pch = read(r.pc);
+                    r.pc = (pch << 8) | pcl;
+                    break;
+                }
+
+                case 0x60: {
+                    implied();
+                    read(0x0100 | r.s);
+                    uint8_t pcl = pull();
+                    uint8_t pch = pull();
+                    r.pc = (pch << 8) | pcl;
+                    fetch();
+                    break;
+                }
+
+                // interrupt
+                case 0x00:
+                    fetch();
+                    interrupt(kVectorIRQ, true);
+                    break;
+
+                case 0x40: {
+                    implied();
+                    read(0x0100 | r.s);
+                    r.p = (pull() & ~kFlagB) | kFlagU;
+                    uint8_t pcl = pull();
+                    uint8_t pch = pull();
+                    r.pc = (pch << 8) | pcl;
+                    break;
+                }
+
+                // stack
+                case 0x48: implied(); push(r.a); break;
+                case 0x08: implied(); push(r.p | kFlagB | kFlagU); break;
+                case 0x68: implied(); read(0x0100 | r.s); r.a = pull(); setNZ(r.a); break;
+                case 0x28: implied(); read(0x0100 | r.s); r.p = (pull() & ~kFlagB) | kFlagU; break;
+
+                // status
+                case 0x18: implied(); r.p &= ~kFlagC; break;
+                case 0x38: implied(); r.p |= kFlagC; break;
+                case 0x58: implied(); r.p &= ~kFlagI; break;
+                case 0x78: implied(); r.p |= kFlagI; break;
+                case 0xB8: implied(); r.p &= ~kFlagV; break;
+                case 0xD8: implied(); r.p &= ~kFlagD; break;
+                case 0xF8: implied(); r.p |= kFlagD; break;
+
+                case 0xEA: implied(); break;
+
+                default:
+                    // undocumented opcode
+                    if (!m_hasErrored) {
+                        m_hasErrored = true;
+                        m_errorOpcode = opcode;
+                    }
+
+                    implied();
+                    break;
+            }
+
+            return uint32_t(m_cycles - start);
+        }
+
+        template <class BUS>
+        uint8_t Cpu6502Model<BUS>::read(uint16_t address) {
+            m_cycles++;
+            return m_bus.read(address);
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::write(uint16_t address, uint8_t data) {
+            m_cycles++;
+            m_bus.write(address, data);
+        }
+
+        template <class BUS>
+        uint8_t Cpu6502Model<BUS>::fetch() {
+            return read(m_registers.pc++);
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::implied() {
+            // the byte after the opcode is read, and discarded
+            read(m_registers.pc);
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::push(uint8_t data) {
+            write(0x0100 | m_registers.s, data);
+            m_registers.s--;
+        }
+
+        template <class BUS>
+        uint8_t Cpu6502Model<BUS>::pull() {
+            m_registers.s++;
+            return read(0x0100 | m_registers.s);
+        }
+
+        template <class BUS>
+        uint16_t Cpu6502Model<BUS>::zeroPage() {
+            return fetch();
+        }
+
+        template <class BUS>
+        uint16_t Cpu6502Model<BUS>::zeroPageIndexed(uint8_t index) {
+            uint8_t base = fetch();
+            read(base);
+
+            return uint8_t(base + index);
+        }
+
+        template <class BUS>
+        uint16_t Cpu6502Model<BUS>::absolute() {
+            uint8_t low = fetch();
+            uint8_t high = fetch();
+
+            return (high << 8) | low;
+        }
+
+        template <class BUS>
+        uint16_t Cpu6502Model<BUS>::absoluteIndexed(uint8_t index, Access access) {
+            uint16_t base = absolute();
+            uint16_t address = base + index;
+
+            // the address is read before the carry into the high byte is added,
+            //  which reads skip unless a page is crossed
+            if ((access != Access::kRead) || ((base ^ address) & 0xFF00)) {
+                read((base & 0xFF00) | (address & 0x00FF));
+            }
+
+            return address;
+        }
+
+        template <class BUS>
+        uint16_t Cpu6502Model<BUS>::indexedIndirect() {
+            uint8_t pointer = fetch();
+            read(pointer);
+            pointer += m_registers.x;
+
+            uint8_t low = read(pointer);
+            uint8_t high = read(uint8_t(pointer + 1));
+
+            return (high << 8) | low;
+        }
+
+        template <class BUS>
+        uint16_t Cpu6502Model<BUS>::indirectIndexed(Access access) {
+            uint8_t pointer = fetch();
+
+            uint8_t low = read(pointer);
+            uint8_t high = read(uint8_t(pointer + 1));
+
+            uint16_t base = (high << 8) | low;
+            uint16_t address = base + m_registers.y;
+
+            if ((access != Access::kRead) || ((base ^ address) & 0xFF00)) {
+                read((base & 0xFF00) | (address & 0x00FF));
+            }
+
+            return address;
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::setNZ(uint8_t value) {
+            m_registers.p = (m_registers.p & ~(kFlagN | kFlagZ)) | (value & kFlagN) | ((value == 0) ? kFlagZ : 0);
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::setFlag(uint8_t flag, bool isSet) {
+            if (isSet) {
+                m_registers.p |= flag;
+            } else {
+                m_registers.p &= ~flag;
+            }
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::adc(uint8_t value) {
+            uint8_t a = m_registers.a;
+            uint16_t sum = a + value + (m_registers.p & kFlagC);
+            uint8_t result = uint8_t(sum);
+
+            setFlag(kFlagC, sum > 0xFF);
+            setFlag(kFlagV, (~(a ^ value) & (a ^ result) & 0x80) != 0);
+
+            m_registers.a = result;
+            setNZ(result);
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::compare(uint8_t reg, uint8_t value) {
+            setFlag(kFlagC, reg >= value);
+            setNZ(uint8_t(reg - value));
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::bit(uint8_t value) {
+            m_registers.p = (m_registers.p & ~(kFlagN | kFlagV | kFlagZ)) | (value & (kFlagN | kFlagV)) | (((m_registers.a & value) == 0) ? kFlagZ : 0);
+        }
+
+        template <class BUS>
+        uint8_t Cpu6502Model<BUS>::asl(uint8_t value) {
+            setFlag(kFlagC, (value & 0x80) != 0);
+            value <<= 1;
+            setNZ(value);
+
+            return value;
+        }
+
+        template <class BUS>
+        uint8_t Cpu6502Model<BUS>::lsr(uint8_t value) {
+            setFlag(kFlagC, (value & 0x01) != 0);
+            value >>= 1;
+            setNZ(value);
+
+            return value;
+        }
+
+        template <class BUS>
+        uint8_t Cpu6502Model<BUS>::rol(uint8_t value) {
+            uint8_t carry = m_registers.p & kFlagC;
+
+            setFlag(kFlagC, (value & 0x80) != 0);
+            value = (value << 1) | carry;
+            setNZ(value);
+
+            return value;
+        }
+
+        template <class BUS>
+        uint8_t Cpu6502Model<BUS>::ror(uint8_t value) {
+            uint8_t carry = (m_registers.p & kFlagC) << 7;
+
+            setFlag(kFlagC, (value & 0x01) != 0);
+            value = (value >> 1) | carry;
+            setNZ(value);
+
+            return value;
+        }
+
+        template <class BUS>
+        template <class OPERATION>
+        void Cpu6502Model<BUS>::modify(uint16_t address, OPERATION operation) {
+            uint8_t value = read(address);
+            write(address, value);
+            write(address, operation(value));
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::branch(bool isTaken) {
+            int8_t offset = int8_t(fetch());
+
+            if (!isTaken) {
+                return;
+            }
+
+            uint16_t pc = m_registers.pc;
+            uint16_t target = pc + offset;
+
+            read(pc);
+
+            if ((pc ^ target) & 0xFF00) {
+                // PCH is fixed up in an extra cycle
+                read((pc & 0xFF00) | (target & 0x00FF));
+            }
+
+            m_registers.pc = target;
+        }
+
+        template <class BUS>
+        void Cpu6502Model<BUS>::interrupt(uint16_t vector, bool isBRK) {
+            push(m_registers.pc >> 8);
+            push(m_registers.pc & 0xFF);
+            push((m_registers.p & ~kFlagB) | kFlagU | (isBRK ? kFlagB : 0));
+
+            m_registers.p |= kFlagI;
+
+            uint8_t pcl = read(vector);
+            uint8_t pch = read(vector + 1);
+
+            m_registers.pc = (pch << 8) | pcl;
+        }
+    }
+}
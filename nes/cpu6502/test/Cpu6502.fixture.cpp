@@ -4,7 +4,7 @@
 //   simulation in TTY
 //#define CPU6502_VERBOSE
 
-Cpu6502::Cpu6502() : sram(64 * 1024) {
+Cpu6502::Cpu6502() : sram(64 * 1024), bus(sram) {
 }
 
 void Cpu6502::SetUp() {
@@ -18,28 +18,16 @@ void Cpu6502::SetUp() {
     // simulation at the end of a clock phase, before
     //   transition to other clock phase
     testBench.setCallbackSimulateCombinatorial([this, &core]{
-        if (core.i_clk == 1) {
-            // clock: end of phi2
-            // R/W data is valid on the bus
-            if (core.o_rw == 0) {
-                // write
-                sram.write(core.o_address, core.o_data);
-            } else {
-                // read
-                core.i_data = sram.read(core.o_address);
-            }
+        bus.simulateCombinatorial(core);
 
 #ifdef CPU6502_VERBOSE
+        if (core.i_clk == 1) {
             printf("Cpu6502: %s addr [0x%04x] data [0x%02x]\n", 
                     (core.o_rw == 1) ? "R" : "W",
                     core.o_address,
                     sram.read(core.o_address));
-#endif
-        } else {
-            // clock: end of phi 1
-            // undefined data on the bus
-            core.i_data = 0xFF;
         }
+#endif
     });
 
     testBench.reset();
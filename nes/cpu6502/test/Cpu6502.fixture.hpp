@@ -12,6 +12,9 @@ using namespace cpu6502testbench;
 #include "nes/memory/SRAM.hpp"
 using namespace memory;
 
+#include "nes/simulation/CpuBus.hpp"
+using namespace simulation;
+
 #include "nes/cpu6502/assembler/Assembler.hpp"
 using namespace cpu6502::assembler;
 
@@ -28,6 +31,7 @@ public:
 
     Cpu6502TestBench testBench;
     SRAM sram;
+    CpuBus<VCpu6502> bus;
 
     template <class OPCODE>
     struct TestAbsolute {
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+using namespace testing;
+
+#include "nes/Cpu6502TestBench.h"
+using namespace cpu6502testbench;
+
+#include "nes/memory/SRAM.hpp"
+using namespace memory;
+
+#include "nes/simulation/CpuLockstep.hpp"
+using namespace simulation;
+
+#include "nes/cpu6502/assembler/Assembler.hpp"
+using namespace cpu6502::assembler;
+
+namespace {
+    /// @brief assemble a loop over most addressing modes, page crossings, the stack, BRK / RTI
+    ///        and subroutines, so that every cycle of them is compared against the model
+    void assembleInstructionMix(SRAM& sram) {
+        sram.clear(0);
+
+        Assembler()
+                .NOP()
+            .org(0x8000)
+            .label("start")
+                .LDX().immediate(0xFF)
+                .TXS()
+                // pointer at 0x0010 = 0x0280
+                .LDA().immediate(0x80)
+                .STA().zp(0x10)
+                .LDA().immediate(0x02)
+                .STA().zp(0x11)
+            .label("main")
+                // (zp),y with a page crossing
+                .LDY().immediate(0x90)
+                .LDA().immediate(0x5A)
+                .STA().zpIndirect(0x10).y()
+                .LDA().immediate(0x00)
+                .ORA().zpIndirect(0x10).y()
+                // (zp,x)
+                .LDX().immediate(0x04)
+                .EOR().zpIndirect(0x0C).x()
+                .STA().zpIndirect(0x0C).x()
+                // absolute indexed, with and without a page crossing
+                .LDX().immediate(0x20)
+                .LDA().absolute(0x02F0).x()
+                .AND().absolute(0x0300).y()
+                .STA().absolute(0x02F8).x()
+                .INC().absolute(0x02F0).x()
+                .ROL().absolute(0x02F0).x()
+                .LSR().absolute(0x0310)
+                // zero page, and zero page indexed with wrap around
+                .LDX().immediate(0xF8)
+                .STA().zp(0x20).x()
+                .LDY().zp(0x18)
+                .DEC().zp(0x18)
+                .ROR().zp(0x20).x()
+                .ASL().zp(0x18)
+                .LDX().zp(0x18).y()
+                .STX().zp(0x30)
+                .STY().zp(0x31)
+                // arithmetic and compare
+                .CLC()
+                .LDA().immediate(0x70)
+                .ADC().immediate(0x20)
+                .SEC()
+                .SBC().zp(0x30)
+                .CMP().immediate(0x40)
+                .CPX().zp(0x31)
+                .CPY().absolute(0x0310)
+                .BIT().zp(0x30)
+                .ASL().A()
+                .ROR().A()
+                // stack
+                .PHA()
+                .PHP()
+                .LDA().immediate(0xFF)
+                .PLP()
+                .PLA()
+                .TSX()
+                .TXA()
+                .TAY()
+                .DEY()
+                .TYA()
+                .INX()
+                .CLV()
+                .SEI()
+                .CLI()
+                // subroutine with branches taken across pages in both directions
+                .LDX().immediate(3)
+                .JSR().absolute("cross")
+                // interrupt
+                .BRK()
+                .NOP()
+                // JMP (indirect) with the high byte read from the same page
+                .LDA().immediate(0x00)
+                .STA().absolute(0x02FF)
+                .LDA().immediate(0x83)
+                .STA().absolute(0x0200)
+                .JMP().indirect(0x02FF)
+            .org(0x81FB)
+            .label("cross")
+                .DEX()
+                .BNE().relative("cross_back")
+                .RTS()
+                .NOP()
+                .NOP()
+                .NOP()
+            .label("cross_back")
+                .BNE().relative("cross")
+            .org(0x8300)
+                .INC().zp(0x40)
+                .BPL().relative("main_again")
+                .CLC()
+            .label("main_again")
+                .JMP().absolute("main")
+            .org(0x8400)
+            .label("irq")
+                .INY()
+                .RTI()
+            .org(0xfffc)
+            .word("start")
+            .word("irq")
+            .compileTo(sram);
+    }
+
+    class Cpu6502Lockstep : public ::testing::Test {
+    public:
+        Cpu6502Lockstep() : sram(64 * 1024) {
+        }
+
+        void SetUp() override {
+            testBench.setClockPolarity(1);
+        }
+
+        Cpu6502TestBench testBench;
+        SRAM sram;
+    };
+}
+
+TEST_F(Cpu6502Lockstep, ShouldMatchModelOverInstructionMix) {
+    assembleInstructionMix(sram);
+
+    CpuLockstep<Cpu6502TestBench, VCpu6502> lockstep(testBench, sram);
+    lockstep.reset();
+
+    const uint64_t kNumInstructions = 2000;
+
+    EXPECT_EQ(kNumInstructions, lockstep.run(kNumInstructions)) << lockstep.diagnostic();
+    EXPECT_FALSE(lockstep.hasDiverged()) << lockstep.diagnostic();
+}
+
+TEST_F(Cpu6502Lockstep, ShouldStopAtFirstDivergence) {
+    sram.clear(0);
+
+    Assembler()
+            .NOP()
+        .org(0x8000)
+        .label("start")
+            .LDX().immediate(0x01)
+            .LDA().absolute(0x0300)
+            .TAY()
+        .label("end")
+            .JMP().absolute("end")
+        .org(0xfffc)
+        .word("start")
+        .compileTo(sram);
+
+    CpuLockstep<Cpu6502TestBench, VCpu6502> lockstep(testBench, sram);
+    lockstep.reset();
+
+    // change memory behind the model's back, so that LDA diverges
+    sram.write(0x0300, 0x42);
+
+    // reset, LDX, LDA
+    EXPECT_EQ(3u, lockstep.run(100));
+    EXPECT_TRUE(lockstep.hasDiverged());
+
+    EXPECT_THAT(lockstep.diagnostic(), HasSubstr("registers differ"));
+    EXPECT_THAT(lockstep.diagnostic(), HasSubstr("A:42"));
+    EXPECT_EQ(0x00, lockstep.modelRegisters().a);
+}
+
+namespace {
+    /// @brief a loop that counts into 0x10, with NMI / IRQ handlers that count into 0x20 / 0x21
+    void assembleInterruptLoop(SRAM& sram) {
+        sram.clear(0);
+
+        Assembler()
+                .NOP()
+            .org(0x8000)
+            .label("start")
+                .LDX().immediate(0xFF)
+                .TXS()
+                .CLI()
+            .label("loop")
+                .LDA().zp(0x10)
+                .CLC()
+                .ADC().immediate(0x01)
+                .STA().zp(0x10)
+                .INX()
+                .JMP().absolute("loop")
+            .org(0x8100)
+            .label("nmi")
+                .PHA()
+                .INC().zp(0x20)
+                .PLA()
+                .RTI()
+            .label("irq")
+                .INC().zp(0x21)
+                .RTI()
+            .org(0xfffa)
+            .word("nmi")
+            .word("start")
+            .word("irq")
+            .compileTo(sram);
+    }
+}
+
+TEST_F(Cpu6502Lockstep, ShouldMatchModelTakingNMI) {
+    assembleInterruptLoop(sram);
+
+    CpuLockstep<Cpu6502TestBench, VCpu6502> lockstep(testBench, sram);
+    lockstep.reset();
+
+    ASSERT_EQ(20u, lockstep.run(20)) << lockstep.diagnostic();
+
+    // mid-loop, then again once the handler has returned
+    for (uint8_t numNMIs = 1; numNMIs <= 2; numNMIs++) {
+        lockstep.setNMI(true);
+        ASSERT_EQ(20u, lockstep.run(20)) << lockstep.diagnostic();
+
+        lockstep.setNMI(false);
+        ASSERT_EQ(5u, lockstep.run(5)) << lockstep.diagnostic();
+
+        EXPECT_EQ(numNMIs, sram.read(0x20));
+    }
+
+    // the loop carried on
+    EXPECT_GT(sram.read(0x10), 5);
+}
+
+TEST_F(Cpu6502Lockstep, ShouldMatchModelTakingIRQ) {
+    assembleInterruptLoop(sram);
+
+    CpuLockstep<Cpu6502TestBench, VCpu6502> lockstep(testBench, sram);
+    lockstep.reset();
+
+    ASSERT_EQ(20u, lockstep.run(20)) << lockstep.diagnostic();
+
+    // level triggered, so taken again on each return from the handler, until released
+    lockstep.setIRQ(true);
+    ASSERT_EQ(10u, lockstep.run(10)) << lockstep.diagnostic();
+
+    lockstep.setIRQ(false);
+    ASSERT_EQ(20u, lockstep.run(20)) << lockstep.diagnostic();
+
+    EXPECT_GE(sram.read(0x21), 1);
+    EXPECT_EQ(0, sram.read(0x20));
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/memory/SRAM.hpp"
+using namespace memory;
+
+#include "nes/cpu6502/assembler/Assembler.hpp"
+#include "nes/cpu6502/assembler/Disassembler.hpp"
+#include "nes/cpu6502/assembler/Opcodes.hpp"
+using namespace cpu6502::assembler;
+
+namespace {
+    std::string text(const Disassembler::DisassembledOpcode& opcode) {
+        char buffer[32];
+        opcode.format(buffer, sizeof(buffer));
+
+        return buffer;
+    }
+}
+
+TEST(Disassembler, OpcodeTableShouldMatchOpcodes) {
+    OpcodeTable registered {};
+
+    auto registerOpcode = [&registered](const char* label, const Opcode& opcode) {
+        for (auto& it: opcode.addressingModes()) {
+            registered[it.second] = { label, it.first, addressingModeByteSize(it.first) };
+        }
+    };
+
+    #define OPCODE(_x) { _x op; registerOpcode(#_x, op); }
+    # include "nes/cpu6502/assembler/OpcodeList.inl"
+    #undef OPCODE
+
+    for (size_t i = 0; i < registered.size(); i++) {
+        const OpcodeTableEntry& expected = registered[i];
+        const OpcodeTableEntry& actual = kOpcodeTable[i];
+
+        if (expected.label == nullptr) {
+            EXPECT_EQ(nullptr, actual.label) << "opcode " << i;
+            continue;
+        }
+
+        ASSERT_NE(nullptr, actual.label) << "opcode " << i;
+        EXPECT_STREQ(expected.label, actual.label) << "opcode " << i;
+        EXPECT_EQ(expected.addressingMode, actual.addressingMode) << "opcode " << i;
+        EXPECT_EQ(expected.byteSize, actual.byteSize) << "opcode " << i;
+    }
+}
+
+TEST(Disassembler, ShouldDisassembleAddressingModes) {
+    SRAM sram(64 * 1024);
+    sram.clear(0);
+
+    Assembler()
+            .NOP()
+        .org(0x8000)
+        .label("start")
+            .LDA().immediate(0x42)
+            .STA().absolute(0x0234).y()
+            .LDX().zp(0x10).y()
+            .ORA().zpIndirect(0x20).y()
+            .ASL().A()
+            .BNE().relative("start")
+            .JMP().indirect(0x1234)
+            .RTS()
+        .compileTo(sram);
+
+    Disassembler::DisassembledOpcode opcodes[10];
+    size_t numOpcodes = Disassembler::disassemble(sram, 0x8000, opcodes);
+
+    ASSERT_EQ(10u, numOpcodes);
+
+    EXPECT_EQ("LDA #$0x42", text(opcodes[0]));
+    EXPECT_EQ("STA $0x0234,y", text(opcodes[1]));
+    EXPECT_EQ("LDX $0x10,y", text(opcodes[2]));
+    EXPECT_EQ("ORA ($0x20),y", text(opcodes[3]));
+    EXPECT_EQ("ASL A", text(opcodes[4]));
+    EXPECT_EQ("BNE $0x8000", text(opcodes[5]));
+    EXPECT_EQ("JMP ($0x1234)", text(opcodes[6]));
+    EXPECT_EQ("RTS", text(opcodes[7]));
+
+    EXPECT_EQ(0x8005, opcodes[2].pc);
+    EXPECT_EQ(3, opcodes[1].byteSize);
+    EXPECT_EQ(0x99, opcodes[1].data[0]);
+    EXPECT_EQ(0x34, opcodes[1].data[1]);
+    EXPECT_EQ(0x02, opcodes[1].data[2]);
+}
+
+TEST(Disassembler, ShouldStopAfterUnsupportedOpcode) {
+    SRAM sram(64 * 1024);
+    sram.clear(0);
+
+    const uint8_t program[] = { 0xEA, 0x02, 0xEA };
+    sram.write(0x8000, std::span<const uint8_t>(program));
+
+    Disassembler::DisassembledOpcode opcodes[10];
+    size_t numOpcodes = Disassembler::disassemble(sram, 0x8000, opcodes);
+
+    ASSERT_EQ(2u, numOpcodes);
+    EXPECT_EQ("NOP", text(opcodes[0]));
+    EXPECT_EQ("0x02 ????", text(opcodes[1]));
+    EXPECT_EQ(kUnknown, opcodes[1].addressingMode);
+    EXPECT_EQ(1, opcodes[1].byteSize);
+}
+
+TEST(Disassembler, ShouldDisassembleWholeBank) {
+    // LDA #$01, <unsupported>, JMP $C000, then a truncated LDA $xxxx
+    const uint8_t bank[] = { 0xA9, 0x01, 0x02, 0x4C, 0x00, 0xC0, 0xAD, 0x34 };
+
+    Disassembler::DisassembledOpcode opcodes[sizeof(bank)];
+    size_t numOpcodes = Disassembler::disassembleBank(bank, 0xC000, opcodes);
+
+    ASSERT_EQ(4u, numOpcodes);
+
+    EXPECT_EQ(0xC000, opcodes[0].pc);
+    EXPECT_EQ("LDA #$0x01", text(opcodes[0]));
+
+    EXPECT_EQ(0xC002, opcodes[1].pc);
+    EXPECT_EQ("0x02 ????", text(opcodes[1]));
+
+    EXPECT_EQ(0xC003, opcodes[2].pc);
+    EXPECT_EQ("JMP $0xC000", text(opcodes[2]));
+
+    EXPECT_EQ(0xC006, opcodes[3].pc);
+    EXPECT_EQ("LDA", text(opcodes[3]));
+    EXPECT_EQ(0x34, opcodes[3].data[1]);
+    EXPECT_EQ(0x00, opcodes[3].data[2]);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/memory/SRAM.hpp"
+using namespace memory;
+
+#include "nes/cpu6502/assembler/DisassemblyCache.hpp"
+using namespace cpu6502::assembler;
+
+namespace {
+    class DisassemblyCacheTest : public ::testing::Test {
+    public:
+        DisassemblyCacheTest() : sram(64 * 1024), cache(sram) {
+        }
+
+        void SetUp() override {
+            sram.clear(0xEA);           // NOP
+        }
+
+        /// @brief write as the core would, reporting the written page
+        void write(uint16_t address, uint8_t value) {
+            sram.write(address, value);
+            writtenPages[address / SRAM::kPageSize] = true;
+        }
+
+        void invalidateWrittenPages() {
+            cache.invalidatePages(writtenPages);
+            writtenPages.reset();
+        }
+
+        SRAM sram;
+        DisassemblyCache cache;
+        DisassemblyCache::Pages writtenPages;
+    };
+}
+
+TEST_F(DisassemblyCacheTest, ShouldDisassembleOnlyOnFirstUse) {
+    const uint8_t program[] = { 0xA9, 0x42, 0x8D, 0x00, 0x02 };    // LDA #$42, STA $0200
+    sram.write(0x8000, std::span<const uint8_t>(program));
+
+    Disassembler::DisassembledOpcode opcodes[3];
+
+    EXPECT_EQ(3u, cache.disassemble(0x8000, opcodes));
+    EXPECT_EQ(3u, cache.numDisassembled());
+
+    EXPECT_EQ(3u, cache.disassemble(0x8000, opcodes));
+    EXPECT_EQ(3u, cache.numDisassembled());
+
+    EXPECT_STREQ("LDA", opcodes[0].labelOpcode);
+    EXPECT_STREQ("#$0x42", opcodes[0].labelOperands);
+    EXPECT_STREQ("STA", opcodes[1].labelOpcode);
+    EXPECT_EQ(0x8005, opcodes[2].pc);
+}
+
+TEST_F(DisassemblyCacheTest, ShouldKeepOpcodesWhenWritesMissTheirBytes) {
+    const uint8_t program[] = { 0xA9, 0x42 };                       // LDA #$42
+    sram.write(0x0300, std::span<const uint8_t>(program));
+
+    cache.at(0x0300);
+    cache.at(0x0302);
+
+    // same page, but not the opcode's bytes
+    write(0x0310, 0x00);
+    // same byte value
+    write(0x0301, 0x42);
+    // other page
+    write(0x0200, 0x00);
+    invalidateWrittenPages();
+
+    cache.at(0x0300);
+    cache.at(0x0302);
+    EXPECT_EQ(2u, cache.numDisassembled());
+}
+
+TEST_F(DisassemblyCacheTest, ShouldDisassembleAgainWhenOperandIsModified) {
+    const uint8_t program[] = { 0xA9, 0x42 };                       // LDA #$42
+    sram.write(0x0300, std::span<const uint8_t>(program));
+
+    EXPECT_STREQ("#$0x42", cache.at(0x0300).labelOperands);
+
+    write(0x0301, 0x24);
+    invalidateWrittenPages();
+
+    EXPECT_STREQ("#$0x24", cache.at(0x0300).labelOperands);
+    EXPECT_EQ(2u, cache.numDisassembled());
+}
+
+TEST_F(DisassemblyCacheTest, ShouldInvalidateOpcodesCrossingIntoWrittenPage) {
+    const uint8_t program[] = { 0x4C, 0x00, 0x80 };                 // JMP $8000
+    sram.write(0x02FE, std::span<const uint8_t>(program));
+
+    EXPECT_STREQ("$0x8000", cache.at(0x02FE).labelOperands);
+
+    write(0x0300, 0x90);
+    invalidateWrittenPages();
+
+    EXPECT_STREQ("$0x9000", cache.at(0x02FE).labelOperands);
+}
+
+TEST_F(DisassemblyCacheTest, ShouldInvalidateEverything) {
+    cache.at(0x8000);
+
+    // e.g. a program loaded without going through the core
+    sram.write(0x8000, 0xE8);
+    cache.invalidate();
+
+    EXPECT_STREQ("INX", cache.at(0x8000).labelOpcode);
+    EXPECT_EQ(2u, cache.numDisassembled());
+}
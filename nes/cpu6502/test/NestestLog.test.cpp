@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+using namespace testing;
+
+#include <sstream>
+
+#include "nes/simulation/NestestLog.hpp"
+using namespace simulation;
+
+namespace {
+    const char* kLines[] = {
+        "C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7",
+        "C5F5  A2 00     LDX #$00                        A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 30 CYC:10",
+        "C5F7  86 00     STX $00 = 00                    A:00 X:00 Y:00 P:26 SP:FD PPU:  0, 36 CYC:12"
+    };
+
+    std::string expectedLog() {
+        std::string log;
+
+        for (auto line: kLines) {
+            log += line;
+            log += "\r\n";
+        }
+
+        return log;
+    }
+}
+
+TEST(NestestLog, ShouldParseLine) {
+    NestestLogLine line;
+
+    ASSERT_TRUE(NestestLogLine::parse(kLines[0], line));
+
+    EXPECT_EQ(0xC000, line.pc);
+    EXPECT_EQ(3, line.numBytes);
+    EXPECT_EQ(0x4C, line.bytes[0]);
+    EXPECT_EQ(0xF5, line.bytes[1]);
+    EXPECT_EQ(0xC5, line.bytes[2]);
+    EXPECT_EQ(0x00, line.a);
+    EXPECT_EQ(0x24, line.p);
+    EXPECT_EQ(0xFD, line.sp);
+    EXPECT_TRUE(line.hasCycles);
+    EXPECT_EQ(7u, line.cycles);
+
+    EXPECT_FALSE(NestestLogLine::parse("not a log line", line));
+}
+
+TEST(NestestLog, ShouldFormatInNestestColumns) {
+    NestestLogLine line;
+    ASSERT_TRUE(NestestLogLine::parse(kLines[1], line));
+
+    char text[128];
+    line.format(text, sizeof(text), "LDX #$00");
+
+    EXPECT_STREQ("C5F5  A2 00     LDX #$00                        A:00 X:00 Y:00 P:24 SP:FD CYC:10", text);
+}
+
+TEST(NestestLog, ShouldMatchIdenticalLog) {
+    std::stringstream expected(expectedLog());
+    NestestLogComparator comparator(expected);
+
+    for (auto text: kLines) {
+        NestestLogLine line;
+        ASSERT_TRUE(NestestLogLine::parse(text, line));
+        EXPECT_TRUE(comparator.compare(line, text));
+    }
+
+    EXPECT_TRUE(comparator.finish());
+    EXPECT_EQ(3u, comparator.numLines());
+}
+
+TEST(NestestLog, ShouldStopAtFirstMismatch) {
+    std::stringstream expected(expectedLog());
+    NestestLogComparator comparator(expected);
+
+    NestestLogLine line;
+    ASSERT_TRUE(NestestLogLine::parse(kLines[0], line));
+    EXPECT_TRUE(comparator.compare(line, kLines[0]));
+
+    ASSERT_TRUE(NestestLogLine::parse(kLines[1], line));
+    line.x = 0x01;
+    EXPECT_FALSE(comparator.compare(line, "actual"));
+
+    EXPECT_TRUE(comparator.hasMismatched());
+    EXPECT_EQ(1u, comparator.numLines());
+    EXPECT_THAT(comparator.diagnostic(), HasSubstr("difference at line 2"));
+    EXPECT_THAT(comparator.diagnostic(), HasSubstr("[X] expected [00] actual [01]"));
+
+    // stays stopped
+    ASSERT_TRUE(NestestLogLine::parse(kLines[2], line));
+    EXPECT_FALSE(comparator.compare(line, kLines[2]));
+}
+
+TEST(NestestLog, ShouldCompareCyclesUnlessIgnored) {
+    NestestLogLine line;
+    ASSERT_TRUE(NestestLogLine::parse(kLines[0], line));
+    line.cycles = 8;
+
+    std::stringstream expected(expectedLog());
+    NestestLogComparator comparator(expected);
+    EXPECT_FALSE(comparator.compare(line, "actual"));
+    EXPECT_THAT(comparator.diagnostic(), HasSubstr("[CYC] expected [7] actual [8]"));
+
+    std::stringstream expectedIgnored(expectedLog());
+    NestestLogComparator comparatorIgnored(expectedIgnored);
+    comparatorIgnored.setCompareCycles(false);
+    EXPECT_TRUE(comparatorIgnored.compare(line, "actual"));
+}
+
+TEST(NestestLog, ShouldReportDifferentNumberOfLines) {
+    std::stringstream expected(expectedLog());
+    NestestLogComparator comparator(expected);
+
+    NestestLogLine line;
+    ASSERT_TRUE(NestestLogLine::parse(kLines[0], line));
+    EXPECT_TRUE(comparator.compare(line, kLines[0]));
+
+    EXPECT_FALSE(comparator.finish());
+    EXPECT_THAT(comparator.diagnostic(), HasSubstr("actual log ended after 1 lines"));
+}
@@ -0,0 +1,310 @@
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "nes/memory/SRAM.hpp"
+using namespace memory;
+
+#include "nes/cpu6502/assembler/Assembler.hpp"
+#include "nes/cpu6502/assembler/CodeMap.hpp"
+#include "nes/cpu6502/assembler/DisassemblyCache.hpp"
+#include "nes/cpu6502/assembler/StaticDisassembler.hpp"
+using namespace cpu6502::assembler;
+
+namespace {
+    /// @brief 32KB PRG ROM (NROM) with data after its code, and a jump table that can't be followed
+    void assembleRom(SRAM& sram) {
+        sram.clear(0xFF);
+
+        // note: Assembler only positions code by .org after the first opcode
+        Assembler()
+                .NOP()
+            .org(0x8000)
+            .label("reset")
+                .SEI()
+                .LDX().immediate(0xFF)
+                .TXS()
+                .JSR().absolute("init")
+            .label("loop")
+                .LDA().zp(0x10)
+                .BEQ().relative("loop")
+                .JMP().absolute("loop")
+            .label("table")
+                .byte(0x02)
+                .byte(0x12)
+                .byte(0x22)
+            .label("init")
+                .LDA().immediate(0x00)
+                .STA().zp(0x10)
+                .JMP().indirect(0x0300)
+            .org(0x9000)
+            .label("nmi")
+                .INC().zp(0x10)
+                .RTI()
+            .label("unreachable")
+                .LDA().immediate(0x01)
+                .RTS()
+            .org(0xfffa)
+            .word("nmi")
+            .word("reset")
+            .word("nmi")
+            .compileTo(sram);
+    }
+
+    std::span<const uint8_t> prgRomOf(const SRAM& sram) {
+        return sram.span().subspan(0x8000, 0x8000);
+    }
+}
+
+TEST(StaticDisassembler, ShouldSplitPrgRomIntoBanks) {
+    std::vector<uint8_t> prgRom(0x4000 * 4);
+
+    auto nrom = StaticDisassembler::banksOf(std::span<const uint8_t>(prgRom).subspan(0, 0x4000));
+    ASSERT_EQ(1u, nrom.size());
+    EXPECT_EQ(0xC000, nrom[0].baseAddress);
+    EXPECT_TRUE(nrom[0].isFixed);
+
+    auto uxrom = StaticDisassembler::banksOf(prgRom);
+    ASSERT_EQ(4u, uxrom.size());
+    EXPECT_EQ(0x8000, uxrom[0].baseAddress);
+    EXPECT_FALSE(uxrom[0].isFixed);
+    EXPECT_EQ(0xC000, uxrom[3].baseAddress);
+    EXPECT_TRUE(uxrom[3].isFixed);
+}
+
+TEST(StaticDisassembler, ShouldFollowCodeFromVectors) {
+    SRAM sram(64 * 1024);
+    assembleRom(sram);
+
+    StaticDisassembler disassembler(1);
+    auto codeMaps = disassembler.disassemble(StaticDisassembler::banksOf(prgRomOf(sram)));
+
+    ASSERT_EQ(1u, codeMaps.size());
+    const CodeMap& codeMap = codeMaps[0];
+
+    // SEI, LDX #$FF, TXS, JSR init
+    EXPECT_TRUE(codeMap.isOpcode(0x8000));
+    EXPECT_TRUE(codeMap.isOpcode(0x8001));
+    EXPECT_TRUE(codeMap.isCode(0x8002));
+    EXPECT_FALSE(codeMap.isOpcode(0x8002));
+    EXPECT_TRUE(codeMap.isOpcode(0x8004));
+
+    // loop, then the table isn't code
+    EXPECT_TRUE(codeMap.isOpcode(0x8007));
+    EXPECT_TRUE(codeMap.isOpcode(0x800B));
+    EXPECT_FALSE(codeMap.isCode(0x800E));
+    EXPECT_FALSE(codeMap.isCode(0x8010));
+
+    // init, up to JMP (indirect)
+    EXPECT_TRUE(codeMap.isOpcode(0x8011));
+    EXPECT_TRUE(codeMap.isOpcode(0x8015));
+    EXPECT_FALSE(codeMap.isCode(0x8018));
+
+    EXPECT_TRUE(codeMap.isOpcode(0x9000));
+    EXPECT_FALSE(codeMap.isCode(0x9003));
+
+    EXPECT_EQ(CodeMap::kLabelReset, codeMap.labelFlags(0x8000));
+    EXPECT_EQ(CodeMap::kLabelNMI | CodeMap::kLabelIRQ, codeMap.labelFlags(0x9000));
+    EXPECT_EQ(CodeMap::kLabelSubroutine, codeMap.labelFlags(0x8011));
+    EXPECT_EQ(CodeMap::kLabelBranch | CodeMap::kLabelJump, codeMap.labelFlags(0x8007));
+
+    char label[32];
+    ASSERT_TRUE(codeMap.formatLabel(0x8011, label, sizeof(label)));
+    EXPECT_STREQ("sub_8011", label);
+    ASSERT_TRUE(codeMap.formatLabel(0x8007, label, sizeof(label)));
+    EXPECT_STREQ("L_8007", label);
+    EXPECT_FALSE(codeMap.formatLabel(0x8008, label, sizeof(label)));
+
+    EXPECT_EQ(1u, disassembler.stats().numIndirectJumps);
+    EXPECT_EQ(0u, disassembler.stats().numUnsupported);
+}
+
+TEST(StaticDisassembler, ShouldOnlyKeepSpeculativeTargetsThatAreCode) {
+    // UxROM: the fixed bank calls 0x8000, which is code in bank 0, but not in bank 1
+    std::vector<uint8_t> prgRom(0x4000 * 3, 0x02);
+
+    const uint8_t bank0[] = { 0xE8, 0x60 };                     // INX, RTS
+    std::copy(std::begin(bank0), std::end(bank0), prgRom.begin());
+
+    const uint8_t fixed[] = { 0x20, 0x00, 0x80, 0x4C, 0x03, 0xC0 };     // JSR $8000, JMP $C003
+    std::copy(std::begin(fixed), std::end(fixed), prgRom.begin() + 0x8000);
+
+    prgRom[0xBFFC] = 0x00;                                      // reset = 0xC000
+    prgRom[0xBFFD] = 0xC0;
+
+    StaticDisassembler disassembler(2);
+    auto codeMaps = disassembler.disassemble(StaticDisassembler::banksOf(prgRom));
+
+    ASSERT_EQ(3u, codeMaps.size());
+
+    EXPECT_TRUE(codeMaps[2].isOpcode(0xC000));
+    EXPECT_TRUE(codeMaps[2].isOpcode(0xC003));
+
+    EXPECT_TRUE(codeMaps[0].isOpcode(0x8000));
+    EXPECT_TRUE(codeMaps[0].isOpcode(0x8001));
+    EXPECT_EQ(CodeMap::kLabelSubroutine, codeMaps[0].labelFlags(0x8000));
+
+    EXPECT_EQ(0u, codeMaps[1].numCodeBytes());
+    EXPECT_EQ(0u, codeMaps[1].numLabels());
+
+    EXPECT_EQ(2u, disassembler.stats().numSpeculative);
+    EXPECT_EQ(1u, disassembler.stats().numRejected);
+}
+
+TEST(StaticDisassembler, ShouldRollBackRejectedSpeculativeTargets) {
+    // UxROM: the fixed bank calls 0x8004 then 0x8000, of which only 0x8004 is code in bank 1
+    std::vector<uint8_t> prgRom(0x4000 * 3, 0x02);
+
+    const uint8_t bank1[] = { 0xC8, 0xD0, 0x01, 0x02, 0xE8, 0x60 };     // INY, BNE $8004, (unsupported), INX, RTS
+    std::copy(std::begin(bank1), std::end(bank1), prgRom.begin() + 0x4000);
+
+    const uint8_t fixed[] = { 0x20, 0x04, 0x80, 0x20, 0x00, 0x80, 0x4C, 0x06, 0xC0 };   // JSR $8004, JSR $8000, JMP $C006
+    std::copy(std::begin(fixed), std::end(fixed), prgRom.begin() + 0x8000);
+
+    prgRom[0xBFFC] = 0x00;                                      // reset = 0xC000
+    prgRom[0xBFFD] = 0xC0;
+
+    StaticDisassembler disassembler(1);
+    auto codeMaps = disassembler.disassemble(StaticDisassembler::banksOf(prgRom));
+
+    ASSERT_EQ(3u, codeMaps.size());
+
+    // the walk from 0x8000 reached 0x8004 before it was rejected, so its code and labels are rolled back
+    EXPECT_EQ(2u, codeMaps[1].numOpcodes());
+    EXPECT_TRUE(codeMaps[1].isOpcode(0x8004));
+    EXPECT_TRUE(codeMaps[1].isOpcode(0x8005));
+    EXPECT_EQ(CodeMap::kLabelSubroutine, codeMaps[1].labelFlags(0x8004));
+    EXPECT_EQ(1u, codeMaps[1].numLabels());
+
+    for (uint16_t address = 0x8000; address < 0x8004; address++) {
+        EXPECT_FALSE(codeMaps[1].isCode(address)) << address;
+    }
+
+    EXPECT_EQ(0u, codeMaps[0].numCodeBytes());
+    EXPECT_EQ(0u, codeMaps[0].numLabels());
+
+    EXPECT_EQ(4u, disassembler.stats().numSpeculative);
+    EXPECT_EQ(3u, disassembler.stats().numRejected);
+}
+
+TEST(StaticDisassembler, ShouldSaveAndLoadCodeMaps) {
+    SRAM sram(64 * 1024);
+    assembleRom(sram);
+
+    StaticDisassembler disassembler;
+    auto codeMaps = disassembler.disassemble(StaticDisassembler::banksOf(prgRomOf(sram)));
+
+    const std::string path = (std::filesystem::temp_directory_path() / "StaticDisassembler.test.codemap").string();
+
+    std::string error;
+    ASSERT_TRUE(CodeMap::save(path, codeMaps, prgRomOf(sram), error)) << error;
+
+    std::vector<CodeMap> loaded;
+    ASSERT_TRUE(CodeMap::load(path, prgRomOf(sram), loaded, error)) << error;
+
+    ASSERT_EQ(1u, loaded.size());
+    EXPECT_EQ(codeMaps[0].baseAddress(), loaded[0].baseAddress());
+    EXPECT_EQ(codeMaps[0].size(), loaded[0].size());
+    EXPECT_EQ(codeMaps[0].numCodeBytes(), loaded[0].numCodeBytes());
+    EXPECT_EQ(codeMaps[0].numOpcodes(), loaded[0].numOpcodes());
+    EXPECT_EQ(codeMaps[0].numLabels(), loaded[0].numLabels());
+
+    for (uint32_t address = 0x8000; address <= 0xFFFF; address++) {
+        ASSERT_EQ(codeMaps[0].isOpcode(address), loaded[0].isOpcode(address)) << address;
+        ASSERT_EQ(codeMaps[0].isCode(address), loaded[0].isCode(address)) << address;
+        ASSERT_EQ(codeMaps[0].labelFlags(address), loaded[0].labelFlags(address)) << address;
+    }
+
+    // not for a different (e.g. patched) ROM
+    sram.write(0x9003, 0xEA);
+
+    EXPECT_FALSE(CodeMap::load(path, prgRomOf(sram), loaded, error));
+    EXPECT_EQ("'" + path + "' line 2: built from a different PRG ROM", error);
+    EXPECT_TRUE(loaded.empty());
+
+    EXPECT_FALSE(CodeMap::load(path, prgRomOf(sram).first(0x4000), loaded, error));
+    EXPECT_EQ("'" + path + "' line 2: built from a different PRG ROM", error);
+
+    std::filesystem::remove(path);
+}
+
+TEST(StaticDisassembler, ShouldRejectCodeMapWithoutPrgChecksum) {
+    const std::vector<uint8_t> prgRom(0x4000, 0xEA);
+    const std::string path = (std::filesystem::temp_directory_path() / "StaticDisassembler.test.noprg.codemap").string();
+
+    {
+        std::ofstream file(path);
+        file << "# cpu6502 code map\n";
+        file << "bank 0 C000 4000\n";
+    }
+
+    std::vector<CodeMap> loaded;
+    std::string error;
+
+    EXPECT_FALSE(CodeMap::load(path, prgRom, loaded, error));
+    EXPECT_EQ("'" + path + "' line 2: expected 'prg' before 'bank'", error);
+
+    {
+        std::ofstream file(path);
+        file << "# cpu6502 code map\n";
+    }
+
+    EXPECT_FALSE(CodeMap::load(path, prgRom, loaded, error));
+    EXPECT_EQ("'" + path + "' line 1: expected 'prg <size> <checksum>'", error);
+
+    {
+        std::ofstream file(path);
+    }
+
+    EXPECT_FALSE(CodeMap::load(path, prgRom, loaded, error));
+    EXPECT_TRUE(loaded.empty());
+
+    char prg[64];
+    snprintf(prg, sizeof(prg), "prg 4000 %016llX\n", (unsigned long long)CodeMap::checksum(prgRom));
+
+    {
+        std::ofstream file(path);
+        file << prg << prg;
+    }
+
+    EXPECT_FALSE(CodeMap::load(path, prgRom, loaded, error));
+    EXPECT_EQ("'" + path + "' line 2: expected a single 'prg <size> <checksum>'", error);
+
+    {
+        std::ofstream file(path);
+        file << prg << "bank 0 C000 4000\ncode C000 111\n";
+    }
+
+    ASSERT_TRUE(CodeMap::load(path, prgRom, loaded, error)) << error;
+    ASSERT_EQ(1u, loaded.size());
+    EXPECT_EQ(3u, loaded[0].numOpcodes());
+
+    std::filesystem::remove(path);
+}
+
+TEST(StaticDisassembler, DisassemblyCacheShouldShowDataAsBytes) {
+    SRAM sram(64 * 1024);
+    assembleRom(sram);
+
+    StaticDisassembler disassembler;
+    DisassemblyCache cache(sram);
+    cache.setCodeMaps(disassembler.disassemble(StaticDisassembler::banksOf(prgRomOf(sram))));
+
+    // JMP loop, then the table (which would be disassembled as an unsupported opcode)
+    Disassembler::DisassembledOpcode opcodes[5];
+    ASSERT_EQ(5u, cache.disassemble(0x800B, opcodes));
+
+    EXPECT_STREQ("JMP", opcodes[0].labelOpcode);
+    EXPECT_STREQ(".byte", opcodes[1].labelOpcode);
+    EXPECT_STREQ("$0x02", opcodes[1].labelOperands);
+    EXPECT_STREQ(".byte", opcodes[3].labelOpcode);
+    EXPECT_STREQ("LDA", opcodes[4].labelOpcode);
+    EXPECT_EQ(0x8011, opcodes[4].pc);
+
+    char label[32];
+    ASSERT_TRUE(cache.formatLabel(0x8011, label, sizeof(label)));
+    EXPECT_STREQ("sub_8011", label);
+}
@@ -5,17 +5,26 @@
 
 #include "nes/cpu6502/assembler/Assembler.hpp"
 #include "nes/cpu6502/assembler/Disassembler.hpp"
+#include "nes/cpu6502/assembler/DisassemblyCache.hpp"
 #include "nes/memory/SRAM.hpp"
 #include "nes/Cpu6502TestBench.h"
 #include "nes/emulator/RendererCPU.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/CpuBus.hpp"
+#include "nes/simulation/NestestLog.hpp"
 
+#include <algorithm>
 #include <vector>
+#include <memory>
+#include <string>
 #include <cassert>
+#include <cstring>
 
 using namespace cpu6502;
 using namespace cpu6502::assembler;
 using namespace memory;
 using namespace cpu6502testbench;
+using namespace simulation;
 
 namespace {
     const uint32_t kScreenWidth = 1000;
@@ -26,9 +35,13 @@ namespace emulator {
     class Emulator : public olc::PixelGameEngine
     {
     public:
-        Emulator() : sram(0x10000) {
+        /// @param codeMapPath code map of the program (see rom-disassembler), or empty
+        Emulator(const std::string& codeMapPath) : sram(0x10000), bus(sram), simulation(testBench, bus), disassemblyCache(sram), codeMapPath(codeMapPath) {
             sAppName = "Emulator - CPU 6502";
 
+            // track changes to memory, to invalidate the disassembly cache
+            sram.enableTracking();
+
             SetPixelMode(olc::Pixel::ALPHA);
         }
 
@@ -40,6 +53,10 @@ namespace emulator {
             //initMario(); 
             initNesTest();
 
+            if (!codeMapPath.empty() && !loadCodeMap()) {
+                return false;
+            }
+
             mode = kSingleStep;
 
             reset();
@@ -57,10 +74,19 @@ namespace emulator {
         }
         
     private:
-        Disassembler disassembler;
-
         Cpu6502TestBench testBench;
         SRAM sram;
+        CpuBus<VCpu6502> bus;
+
+        // note: full trace is captured, for display of the last opcode
+        Simulation<Cpu6502TestBench, CpuBus<VCpu6502>> simulation;
+
+        // note: invalidated by changes to SRAM (see CpuBus::takeWrittenPages()), so code is only disassembled again when it changes
+        DisassemblyCache disassemblyCache;
+        std::string codeMapPath;
+
+        // PRG ROM of the program, to check that the code map was built from it
+        std::vector<uint8_t> prgRom;
 
         Disassembler::DisassembledOpcode lastOpcode;
         gtestverilog::Trace traceLastOpcode;
@@ -79,6 +105,9 @@ namespace emulator {
         void reset() {
             testBench.reset();
 
+            // the program may have been loaded (or changed) since the last reset
+            disassemblyCache.invalidate();
+
             // todo: reset testBench step count
             simulateOpcode();               // skip SYNC incorrectly reported during RESET
             
@@ -88,8 +117,8 @@ namespace emulator {
             // fudge data for reset
             lastOpcode.opcode = 0;
             lastOpcode.addressingMode = 0;
-            lastOpcode.labelOpcode = "RESET";
-            lastOpcode.labelOperands = "";
+            snprintf(lastOpcode.labelOpcode, sizeof(lastOpcode.labelOpcode), "RESET");
+            lastOpcode.labelOperands[0] = 0;
             lastOpcode.pc = 0xfffc;
             lastOpcode.byteSize = 0;
 
@@ -99,11 +128,14 @@ namespace emulator {
         void initMario() {
             // load bank 0 -> 0x8000:0xBFFF
             auto bank0 = loadBinaryFile("roms/supermario/prg_rom_bank_0.6502.bin");
-            sram.write(0x8000, bank0);
+            sram.write(0x8000, bank0->span());
 
             // load bank 1 -> 0xC000:0xFFFF
             auto bank1 = loadBinaryFile("roms/supermario/prg_rom_bank_1.6502.bin");
-            sram.write(0xC000, bank1);
+            sram.write(0xC000, bank1->span());
+
+            prgRom.assign(bank0->data(), bank0->data() + bank0->size());
+            prgRom.insert(prgRom.end(), bank1->data(), bank1->data() + bank1->size());
 
             // simulate PPUSTATUS register
             // https://wiki.nesdev.com/w/index.php/PPU_registers#Status_.28.242002.29_.3C_read
@@ -114,27 +146,39 @@ namespace emulator {
         void initNesTest() {
             // load bank 0 -> 0xC000:0xFFFF
             auto bank1 = loadBinaryFile("roms/nestest/prg_rom_bank_0.6502.bin");
-            sram.write(0xC000, bank1);
+            sram.write(0xC000, bank1->span());
+
+            prgRom.assign(bank1->data(), bank1->data() + bank1->size());
 
             // start PC at 0xc000
             sram.write(0xfffc, 0x00);       // low byte
             sram.write(0xfffd, 0xc0);       // high byte
         }
 
-        std::vector<uint8_t> loadBinaryFile(const char* filename) {
-            std::ifstream is;
-            is.open (filename, std::ios::binary );
-            assert(is.is_open());
+        bool loadCodeMap() {
+            std::vector<CodeMap> codeMaps;
+            std::string error;
 
-            is.seekg (0, std::ios::end);
-            int length = is.tellg();
-            is.seekg (0, std::ios::beg);
-            std::vector<uint8_t> buffer(length);
-            uint8_t* pBuffer = &(buffer.front());
-            is.read(reinterpret_cast<char*>(pBuffer), length);
-            is.close();
+            if (!CodeMap::load(codeMapPath, prgRom, codeMaps, error)) {
+                printf("unable to load code map: %s\n", error.c_str());
+                return false;
+            }
+
+            disassemblyCache.setCodeMaps(std::move(codeMaps));
+
+            return true;
+        }
 
-            return buffer;
+        std::unique_ptr<SRAM> loadBinaryFile(const char* filename) {
+            // mapped rather than read, so the file is only paged in as it is copied into SRAM
+            std::string error;
+            std::unique_ptr<SRAM> file = SRAM::mapFile(filename, error);
+            if (!file) {
+                printf("unable to load binary: %s\n", error.c_str());
+            }
+            assert(file);
+
+            return file;
         }
 
         void initSimpleProgram() {
@@ -167,35 +211,6 @@ namespace emulator {
         void initSimulation() {
             testBench.setClockPolarity(0);
             sram.clear(0);
-
-            // simulation at the end of a clock phase, before
-            //   transition to other clock phase
-            testBench.setCallbackSimulateCombinatorial([this]{
-                auto& cpu = testBench.core();
-
-                if (cpu.i_clk == 1) {
-                    // clock: end of phi2
-                    // R/W data is valid on the bus
-                    if (cpu.o_rw == 0) {
-                        // write
-                        sram.write(cpu.o_address, cpu.o_data);
-                    } else {
-                        // read
-                        cpu.i_data = sram.read(cpu.o_address);
-                    }
-
-        #ifdef CPU6502_VERBOSE
-                    printf("Cpu6502: %s addr [0x%04x] data [0x%02x]\n", 
-                            (cpu.o_rw == 1) ? "R" : "W",
-                            cpu.o_address,
-                            sram.read(cpu.o_address));
-        #endif
-                } else {
-                    // clock: end of phi 1
-                    // undefined data on the bus
-                    cpu.i_data = 0xFF;
-                }
-            });
         }
 
         void update() {
@@ -265,17 +280,21 @@ namespace emulator {
             renderer.drawTestBench(*this, 10, 200, testBench, numOpcodes);
             renderer.drawMemory(*this, 10, 250, sram);
 
-            renderer.drawDisassembly(*this, 200, 40, disassembledOpcodesAtPC());
+            Disassembler::DisassembledOpcode disassembledOpcodes[kNumDisassembledOpcodes];
+            size_t numDisassembledOpcodes = disassembledOpcodesAtPC(disassembledOpcodes);
+
+            renderer.drawDisassembly(*this, 200, 40, std::span(disassembledOpcodes, numDisassembledOpcodes), disassemblyCache);
             renderer.drawStack(*this, 200, 200, testBench, sram);
             renderer.drawLastOpcodeTrace(*this, 400, 40, traceLastOpcode, lastOpcode);
         }
 
-        Disassembler::DisassembledOpcodes disassembledOpcodesAtPC() {
+        static constexpr size_t kNumDisassembledOpcodes = 10;
+
+        size_t disassembledOpcodesAtPC(std::span<Disassembler::DisassembledOpcode> outOpcodes) {
             auto& core = testBench.core();
             uint16_t pc = (core.o_debug_pch << 8) + core.o_debug_pcl;
-            Disassembler::DisassembledOpcodes disassembledOpcodes = disassembler.disassemble(sram, pc, 10);
 
-            return disassembledOpcodes;
+            return disassemblyCache.disassemble(pc, outOpcodes);
         }
 
         bool hasCoreErrored() {
@@ -301,13 +320,7 @@ namespace emulator {
             testBench.trace.clear();
 
             uint16_t pc = getCorePC();
-            auto disassembledOpcodes = disassembler.disassemble(sram, pc, 1);
-            if (disassembledOpcodes.empty()) {
-                printf("failed to simulateOpcode()");
-                return;
-            }
-
-            lastOpcode = disassembledOpcodes[0];
+            lastOpcode = disassemblyCache.at(pc);
             
             // simulate until next fetching next opcode, or max ticks
             const int kMaxTicks = 10;
@@ -319,7 +332,7 @@ namespace emulator {
             core.i_nmi_n = 1;
 
             for (int i=0; i<kMaxTicks; i++) {
-                testBench.tick();
+                simulation.tick();
                 if (core.o_sync == 1) {
                     // opcode has completed, and we are now fetching next opcode
                     numOpcodes += 1;
@@ -328,11 +341,13 @@ namespace emulator {
 
                 if (hasCoreErrored()) {
                     // core has errored.. so tick once more (for debug display) then stop
-                    testBench.tick();
+                    simulation.tick();
                     break;
                 }
             }
 
+            disassemblyCache.invalidatePages(bus.takeWrittenPages());
+
             // we've stopped half with through T0 of next opcode, so we need to 
             // concatenate part of the last trace with the new trace in order
             // to create a full trace for last opcode
@@ -344,48 +359,44 @@ namespace emulator {
         }
 
         void logLastOpcode() {
-            printf("%04X  ", lastOpcode.pc);
-            for (auto byte: lastOpcode.data) {
-                printf("%02X ", byte);
-            }
-
-            for (size_t i=lastOpcode.data.size(); i<3; i++) {
-                printf("   ");
-            }
-            printf(" ");
-
-            Disassembler::DisassembledOpcodes disassembledOpcodes = disassembler.disassemble(sram, lastOpcode.pc, 1);
-            Disassembler::DisassembledOpcode disassembledOpcode = disassembledOpcodes[0];
-            
-            char buffer[64];
-            sprintf(buffer, "%s %s", disassembledOpcode.labelOpcode.c_str(), disassembledOpcode.labelOperands.c_str());
+            // note: some opcodes are still writing to registers in the first clock cycle
+            const gtestverilog::Step& step = traceLastOpcode.getSteps()[2];
 
-            for (size_t i=strlen(buffer); i<32; i++) {
-                buffer[i] = ' ';
-            }
+            NestestLogLine line;
+            line.pc = lastOpcode.pc;
+            line.numBytes = uint8_t(std::min<size_t>(lastOpcode.byteSize, NestestLogLine::kMaxBytes));
+            std::copy_n(lastOpcode.data, line.numBytes, line.bytes);
 
-            buffer[32] = 0;
-            printf("%s", buffer);
+            line.a = uint8_t(std::get<uint32_t>(step.port(o_debug_ac)));
+            line.x = uint8_t(std::get<uint32_t>(step.port(o_debug_x)));
+            line.y = uint8_t(std::get<uint32_t>(step.port(o_debug_y)));
+            line.p = uint8_t(std::get<uint32_t>(step.port(o_debug_p)));
+            line.sp = uint8_t(std::get<uint32_t>(step.port(o_debug_s)));
 
-            // note: some opcodes are still writing to registers in the first clock cycle
-            const gtestverilog::Step& step = traceLastOpcode.getSteps()[2];
+            // note: lastOpcode was disassembled before it was simulated, so is not disassembled again
+            char disassembly[64];
+            lastOpcode.format(disassembly, sizeof(disassembly));
 
-            printf("A:%02X X:%02X Y:%02X P:%02X SP:%02X", 
-                    uint8_t(std::get<uint32_t>(step.port(o_debug_ac))),
-                    uint8_t(std::get<uint32_t>(step.port(o_debug_x))),
-                    uint8_t(std::get<uint32_t>(step.port(o_debug_y))),
-                    uint8_t(std::get<uint32_t>(step.port(o_debug_p))),
-                    uint8_t(std::get<uint32_t>(step.port(o_debug_s)))
-                );
+            char text[128];
+            line.format(text, sizeof(text), disassembly);
 
-            printf("\n");
+            printf("%s\n", text);
         }
     };
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    emulator::Emulator emulator;
+    std::string codeMapPath;
+
+    if ((argc == 3) && (strcmp(argv[1], "--code-map") == 0)) {
+        codeMapPath = argv[2];
+    } else if (argc != 1) {
+        printf("usage: %s [--code-map <code map>]\n", argv[0]);
+        return 1;
+    }
+
+    emulator::Emulator emulator(codeMapPath);
 
     if (emulator.Construct(kScreenWidth, kScreenHeight, 1, 1))
         emulator.Start();
@@ -0,0 +1,379 @@
+#include "nes/Cpu6502TestBench.h"
+#include "nes/memory/SRAM.hpp"
+#include "nes/cartridge/INESRom.hpp"
+#include "nes/cpu6502/assembler/Disassembler.hpp"
+#include "nes/cpu6502/assembler/DisassemblyCache.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/CpuBus.hpp"
+#include "nes/simulation/NestestLog.hpp"
+
+#include <algorithm>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace cpu6502testbench;
+using namespace cpu6502::assembler;
+using namespace memory;
+using namespace simulation;
+using namespace cartridge;
+
+namespace {
+    void printUsage(const char* program) {
+        printf("usage: %s (--rom <nestest.nes> | --prg <prg bank>) [--expected <nestest.log>] [--log <path>]\n", program);
+        printf("          [--lines <n>] [--start <address>] [--ignore-cycles]\n");
+        printf("\n");
+        printf("  --rom       iNES ROM image, with the PRG ROM mapped to 0x8000:0xFFFF (16KB is mirrored)\n");
+        printf("  --prg       16KB PRG bank, loaded at 0xC000:0xFFFF\n");
+        printf("  --expected  log to compare against, which stops the run at the first mismatch\n");
+        printf("  --log       write the log (\"-\" for stdout)\n");
+        printf("  --lines     stop after this number of instructions (e.g. 5003 for the documented opcodes)\n");
+        printf("  --start     reset vector, in hex (default: C000, the automated entry point of nestest)\n");
+        printf("  --ignore-cycles  don't compare cycle counts\n");
+        printf("\n");
+        printf("  runs until the core errors (e.g. on an undocumented opcode), the expected log ends,\n");
+        printf("  or the --lines budget is used up\n");
+    }
+}
+
+namespace emulator {
+    /// @class EmulatorCPUNestest
+    /// @brief Run nestest (or another CPU test ROM) on the 6502 core without a renderer, and
+    ///        stream each instruction as a line of a nestest log into a comparator
+    class EmulatorCPUNestest
+    {
+    public:
+        struct Options {
+            std::string romPath;
+            std::string prgPath;
+            std::string expectedPath;               // empty = don't compare
+            std::string logPath;                    // empty = don't write
+            uint64_t maxLines = 0;                  // 0 = no limit
+            uint16_t startAddress = 0xC000;
+            bool isCyclesCompared = true;
+        };
+
+        EmulatorCPUNestest() : sram(0x10000), bus(sram), simulation(testBench, bus), disassemblyCache(sram) {
+            // track changes to memory, to invalidate the disassembly cache
+            sram.enableTracking();
+        }
+
+        /// @brief load the program, and open the logs
+        /// @return false if a file could not be opened
+        bool init(const Options& inOptions) {
+            options = inOptions;
+
+            sram.clear(0);
+
+            if (!options.romPath.empty() && !loadRom(options.romPath)) {
+                return false;
+            }
+
+            if (!options.prgPath.empty() && !loadPrg(options.prgPath)) {
+                return false;
+            }
+
+            sram.write(0xfffc, options.startAddress & 0xff);
+            sram.write(0xfffd, options.startAddress >> 8);
+
+            disassemblyCache.invalidate();
+
+            if (!options.expectedPath.empty()) {
+                expectedFile.open(options.expectedPath);
+                if (!expectedFile.is_open()) {
+                    printf("unable to open expected log [%s]\n", options.expectedPath.c_str());
+                    return false;
+                }
+
+                comparator = std::make_unique<NestestLogComparator>(expectedFile);
+                comparator->setCompareCycles(options.isCyclesCompared);
+            }
+
+            if (options.logPath == "-") {
+                logFile = stdout;
+            } else if (!options.logPath.empty()) {
+                logFile = fopen(options.logPath.c_str(), "w");
+                if (logFile == nullptr) {
+                    printf("unable to open log [%s]\n", options.logPath.c_str());
+                    return false;
+                }
+            }
+
+            testBench.setClockPolarity(0);
+            simulation.setTraceMode(TraceMode::kNone);
+
+            return true;
+        }
+
+        ~EmulatorCPUNestest() {
+            if ((logFile != nullptr) && (logFile != stdout)) {
+                fclose(logFile);
+            }
+        }
+
+        /// @brief simulate an instruction at a time, until the core errors, the log mismatches
+        ///        or the budget is used up
+        /// @return process exit code
+        int run() {
+            auto start = std::chrono::steady_clock::now();
+
+            reset();
+
+            NestestLogLine line;
+            char text[128];
+            bool isMatching = true;
+
+            while ((options.maxLines == 0) || (numLines < options.maxLines)) {
+                if (hasCoreErrored()) {
+                    break;
+                }
+
+                simulateOpcode(line);
+
+                if (logFile != nullptr) {
+                    formatLine(line, text, sizeof(text));
+                    fputs(text, logFile);
+                    fputc('\n', logFile);
+                }
+
+                if (comparator) {
+                    if (logFile == nullptr) {
+                        formatLine(line, text, sizeof(text));
+                    }
+
+                    if (!comparator->compare(line, text)) {
+                        isMatching = false;
+                        break;
+                    }
+                }
+
+                numLines++;
+            }
+
+            if (isMatching && comparator && (options.maxLines == 0) && !comparator->finish()) {
+                isMatching = false;
+            }
+
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+
+            if (logFile != nullptr) {
+                fflush(logFile);
+            }
+
+            int exitCode = 0;
+
+            if (!isMatching) {
+                printf("%s", comparator->diagnostic().c_str());
+                exitCode = 2;
+            } else if (hasCoreErrored() && !comparator) {
+                // without an expected log, an error is the only sign of failure
+                exitCode = 2;
+            }
+
+            if (hasCoreErrored()) {
+                printf("core errored after %llu lines, at PC 0x%04X\n", (unsigned long long) numLines, lastPC);
+            }
+
+            printf("%llu lines, %llu cycles in %.3f seconds (%.0f lines/sec)\n",
+                    (unsigned long long) numLines,
+                    (unsigned long long) numTicks,
+                    seconds,
+                    (seconds > 0.0) ? (double(numLines) / seconds) : 0.0);
+
+            if (comparator && isMatching) {
+                printf("%llu lines match [%s]\n", (unsigned long long) comparator->numLines(), options.expectedPath.c_str());
+            }
+
+            return exitCode;
+        }
+
+    private:
+        Options options;
+
+        Cpu6502TestBench testBench;
+        SRAM sram;
+        CpuBus<VCpu6502> bus;
+        Simulation<Cpu6502TestBench, CpuBus<VCpu6502>> simulation;
+
+        DisassemblyCache disassemblyCache;
+        char disassembly[64];
+
+        std::ifstream expectedFile;
+        std::unique_ptr<NestestLogComparator> comparator;
+        FILE* logFile = nullptr;
+
+        uint64_t numTicks = 0;
+        uint64_t numLines = 0;
+        uint16_t lastPC = 0;
+
+        bool loadRom(const std::string& path) {
+            INESRom rom;
+            if (!rom.open(path)) {
+                printf("unable to load rom: %s\n", rom.error().c_str());
+                return false;
+            }
+
+            auto prg = rom.prgRom();
+
+            if ((prg.size() != 0x4000) && (prg.size() != 0x8000)) {
+                printf("unsupported PRG ROM size (%zu bytes)\n", prg.size());
+                return false;
+            }
+
+            sram.write(0x8000, prg);
+
+            if (prg.size() == 0x4000) {
+                sram.write(0xC000, prg);
+            }
+
+            return true;
+        }
+
+        bool loadPrg(const std::string& path) {
+            // mapped rather than read, so the file is only paged in as it is copied into SRAM
+            std::string error;
+            std::unique_ptr<SRAM> file = SRAM::mapFile(path, error);
+            if (!file) {
+                printf("unable to load binary: %s\n", error.c_str());
+                return false;
+            }
+
+            sram.write(0xC000, file->span());
+
+            return true;
+        }
+
+        void reset() {
+            auto& core = testBench.core();
+            core.i_clk_en = 1;
+            core.i_irq_n = 1;
+            core.i_nmi_n = 1;
+
+            simulation.reset();
+            numTicks = 0;
+
+            // SYNC is reported during the first tick of RESET, then the reset vector
+            //  is fetched up to the SYNC of the first opcode
+            tick();
+
+            do {
+                tick();
+            } while ((core.o_sync == 0) && !hasCoreErrored());
+        }
+
+        void tick() {
+            simulation.tick();
+            numTicks++;
+        }
+
+        bool hasCoreErrored() {
+            return testBench.core().o_debug_error == 1;
+        }
+
+        /// @brief simulate from the SYNC of an opcode to the SYNC of the next
+        /// @param line registers before the opcode, with the number of cycles before its SYNC
+        void simulateOpcode(NestestLogLine& line) {
+            auto& core = testBench.core();
+
+            // the opcode is being fetched in the SYNC tick
+            line.pc = core.o_address;
+            line.cycles = numTicks - 1;
+            line.hasCycles = true;
+            lastPC = line.pc;
+
+            decodeOpcode(line);
+
+            // note: some opcodes are still writing to registers in the first clock cycle
+            tick();
+
+            line.a = core.o_debug_ac;
+            line.x = core.o_debug_x;
+            line.y = core.o_debug_y;
+            line.p = core.o_debug_p;
+            line.sp = core.o_debug_s;
+
+            // simulate until fetching the next opcode, or max ticks
+            const int kMaxTicks = 10;
+
+            for (int i = 0; i < kMaxTicks; i++) {
+                tick();
+
+                if ((core.o_sync == 1) || hasCoreErrored()) {
+                    break;
+                }
+            }
+
+            disassemblyCache.invalidatePages(bus.takeWrittenPages());
+        }
+
+        /// @brief take the bytes (and the text) of the opcode at line.pc, from the disassembly cache
+        void decodeOpcode(NestestLogLine& line) {
+            const Disassembler::DisassembledOpcode& opcode = disassemblyCache.at(line.pc);
+
+            if (opcode.addressingMode == kUnknown) {
+                // unsupported opcode, which the core will report as an error
+                line.numBytes = 1;
+                line.bytes[0] = opcode.opcode;
+                snprintf(disassembly, sizeof(disassembly), "???");
+                return;
+            }
+
+            line.numBytes = uint8_t(std::min<size_t>(opcode.byteSize, NestestLogLine::kMaxBytes));
+            std::copy_n(opcode.data, line.numBytes, line.bytes);
+
+            opcode.format(disassembly, sizeof(disassembly));
+        }
+
+        void formatLine(const NestestLogLine& line, char* text, size_t size) {
+            line.format(text, size, disassembly);
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    emulator::EmulatorCPUNestest::Options options;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1) < argc;
+
+        if ((strcmp(argv[i], "--rom") == 0) && hasValue) {
+            options.romPath = argv[++i];
+        } else if ((strcmp(argv[i], "--prg") == 0) && hasValue) {
+            options.prgPath = argv[++i];
+        } else if ((strcmp(argv[i], "--expected") == 0) && hasValue) {
+            options.expectedPath = argv[++i];
+        } else if ((strcmp(argv[i], "--log") == 0) && hasValue) {
+            options.logPath = argv[++i];
+        } else if ((strcmp(argv[i], "--lines") == 0) && hasValue) {
+            options.maxLines = strtoull(argv[++i], nullptr, 10);
+        } else if ((strcmp(argv[i], "--start") == 0) && hasValue) {
+            options.startAddress = uint16_t(strtoul(argv[++i], nullptr, 16));
+        } else if (strcmp(argv[i], "--ignore-cycles") == 0) {
+            options.isCyclesCompared = false;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((options.romPath.empty() == options.prgPath.empty()) || (options.expectedPath.empty() && (options.maxLines == 0))) {
+        // exactly one program, and refuse to run forever without an expected log or a budget
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // note: the Verilated model is too large for the stack
+    auto emulator = std::make_unique<emulator::EmulatorCPUNestest>();
+
+    if (!emulator->init(options)) {
+        return 1;
+    }
+
+    return emulator->run();
+}
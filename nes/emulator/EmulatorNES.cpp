@@ -5,15 +5,39 @@
 
 #include "nes/NESTestBench.h"
 #include "nes/memory/SRAM.hpp"
+#include "nes/memory/PageTable.hpp"
+#include "nes/cartridge/INESRom.hpp"
+#include "nes/cartridge/Mapper.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/NESBus.hpp"
+#include "nes/simulation/TraceRing.hpp"
+#include "nes/simulation/NESTraceStep.hpp"
+#include "nes/simulation/NESSnapshot.hpp"
+#include "nes/simulation/InputMovie.hpp"
+#include "nes/simulation/TripleBuffer.hpp"
+#include "nes/simulation/RealTimePacer.hpp"
 
 #include <vector>
+#include <string>
+#include <memory>
 #include <cassert>
+#include <iostream>
+#include <filesystem>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <array>
+#include <algorithm>
 
 using namespace nestestbench;
 using namespace memory;
+using namespace simulation;
+using namespace cartridge;
 
 #define LOG_CPU(msg, ...)   //printf(msg, __VA_ARGS__) 
-#define LOG_BUS(msg, ...)   //printf(msg, __VA_ARGS__)
 #define LOG_CONTROLLER(msg, ...) printf(msg, __VA_ARGS__)
 
 namespace {
@@ -22,13 +46,47 @@ namespace {
 
     const int kRowHeight = 11;
     const int kCharWidth = 8;
+
+    // number of steps (2 per tick) kept for a post-mortem trace if the CPU errors
+    const size_t kTraceRingSize = 256;
+
+    // snapshots are saved / loaded by key, from this directory
+    const char* kSnapshotDirectory = "snapshots";
+
+    // sleep interval of the simulation thread when it has nothing to do (single step mode)
+    const std::chrono::milliseconds kIdleInterval(1);
+
+    // maximum number of consecutive UI redraws skipped while the simulation is behind real time
+    const int kMaxSkippedRedraws = 3;
+
+    // screen layout
+    const int kPixelsX = 10;
+    const int kPixelsY = 50;
+    const int kPixelsScale = 2;
+
+    const int kVramX = 700;
+    const int kVramY = 400;
+
+    // PPU address space captured with each frame for the VRAM views (pattern tables + nametables)
+    const size_t kVideoMemorySize = 0x3000;
+    const size_t kNumVideoPages = kVideoMemorySize / PageTable::kPageSize;
+
+    // pages of the 14bit PPU address space, tracked for writes by NESBus
+    const size_t kNumPPUPages = 0x40;
 }
 
 namespace emulator {
     class EmulatorNES : public olc::PixelGameEngine
     {
     public:
-        EmulatorNES() : sram(0x10000), vram(0x10000) {
+        struct Options {
+            std::string romPath;
+            std::string recordMoviePath;            // empty = don't record
+            std::string replayMoviePath;            // empty = play from keyboard
+            double speed = 1.0;                     // multiple of the NES clock, 0 = as fast as possible
+        };
+
+        EmulatorNES(const Options& options) : options(options), sram(0x0800), vram(0x1000), bus(cpuMemory, ppuMemory), simulation(testBench, bus), traceRing(kTraceRingSize) {
             sAppName = "Emulator - NES";
         }
 
@@ -36,57 +94,532 @@ namespace emulator {
         bool OnUserCreate() override {
             initSimulation();
 
-            //initMario();
-            //initDonkeyKong();
-            //initDuckHunt();
-            initGalaga();
+            if (!loadRom()) {
+                return false;
+            }
+
+            if (!initMovie()) {
+                return false;
+            }
 
             reset();
 
+            // the UI always has a frame to draw, before the simulation thread publishes its first
+            publishFrame();
+            publishedFrames.consume();
+
+            createViews();
+
+            startSimulation();
+
             return true;
         }
 
         /// @brief called every frame
         bool OnUserUpdate(float fElapsedTime) override {
+            if (simulationError != kNoError) {
+                // the simulation thread has stopped at the error, so shut down from here (see OnUserDestroy)
+                stopSimulation();
+
+                if (simulationError == kCpuError) {
+                    // post-mortem of the steps leading up to the error
+                    std::cout << traceRing.toTrace() << std::endl;
+                }
+
+                return false;
+            }
+
             update();
 
-            render();
+            // only draw the most recent frame, frames published since the last update are dropped
+            if (publishedFrames.consume()) {
+                isRedrawRequired = true;
+            }
+
+            if (isRedrawRequired) {
+                // frame skip: leave the host to the simulation thread while it is behind real time
+                if (currentFrame().isBehind && (numSkippedRedraws < kMaxSkippedRedraws)) {
+                    numSkippedRedraws += 1;
+                } else {
+                    render();
+
+                    isRedrawRequired = false;
+                    numSkippedRedraws = 0;
+                }
+            }
+
+            // decals are only kept for a single host frame, so are drawn every frame
+            renderDecals();
+
+            return true;
+        }
+
+        /// @brief called once at exit
+        bool OnUserDestroy() override {
+            stopSimulation();
+
+            movieRecorder.close();
+
+            // textures must be released while the renderer is still alive
+            destroyViews();
 
             return true;
         }
         
+        /// @return process exit code
+        int exitCode() const {
+            return (simulationError != kNoError) ? 2 : 0;
+        }
+
     private:
+        Options options;
+
         NESTestBench testBench;
-        int numTicks = 0;
-        int numFrames = 0;
+        uint64_t numTicks = 0;
+        uint64_t numFrames = 0;
 
-        // CPU memory
+        // CPU RAM (2KB)
         SRAM sram;
 
-        // PPU memory  
+        // PPU nametable RAM (0x2000:0x2FFF)
         SRAM vram;
 
+        // CPU + PPU address spaces, decoded by page
+        PageTable cpuMemory;
+        PageTable ppuMemory;
+
+        // ROM image, with PRG + CHR banks mapped into the address spaces by the mapper
+        INESRom rom;
+        std::unique_ptr<Mapper> mapper;
+
+        // controller input, recorded / replayed by latch
+        InputMovieRecorder movieRecorder;
+        InputMovieReplayer movieReplayer;
+
+        NESBus<VNES> bus;
+        Simulation<NESTestBench, NESBus<VNES>, TraceRing<NESTraceStep>> simulation;
+        TraceRing<NESTraceStep> traceRing;
+
         const int kNESWidth = 341;
         const int kNESHeight = 262;
 
+        // frame being rendered by the simulation thread
         std::vector<olc::Pixel> pixels;
 
+        // version of each row of pixels, incremented whenever a pixel in the row changes
+        std::vector<uint32_t> rowVersions;
+
+        // version of each page of video memory, incremented whenever the page is written or remapped
+        std::array<uint32_t, kNumVideoPages> videoPageVersions {};
+        std::array<const uint8_t*, kNumPPUPages> videoPageMemory {};
+        bool isVideoMemoryInvalid = true;
+
+        // version of the palette, incremented whenever a palette entry changes
+        uint32_t paletteVersion = 1;
+        std::array<uint32_t, 8> publishedPalette {};
+
+        /// @brief NES debug ports sampled by the UI, captured by the simulation thread when a frame is published
+        struct DebugRegisters {
+            uint8_t o_cpu_debug_clk_en;
+            uint8_t o_cpu_debug_ir;
+            uint8_t o_cpu_debug_tcu;
+            uint16_t o_cpu_debug_address;
+
+            uint16_t o_video_x;
+            uint16_t o_video_y;
+            uint8_t o_video_visible;
+            uint8_t o_video_red;
+            uint8_t o_video_green;
+            uint8_t o_video_blue;
+
+            uint8_t o_ppu_debug_colour_index;
+            uint32_t o_ppu_debug_palette[8];
+            uint8_t o_ppu_debug_ppuctrl;
+            uint8_t o_ppu_debug_ppumask;
+            uint8_t o_ppu_debug_ppustatus;
+            uint16_t o_ppu_debug_vram_address;
+            uint8_t o_ppu_debug_i_vram_data;
+            uint8_t o_ppu_debug_ppuscroll_x;
+            uint8_t o_ppu_debug_ppuscroll_y;
+            uint16_t o_ppu_debug_v;
+            uint16_t o_ppu_debug_t;
+            uint8_t o_ppu_debug_x;
+            uint8_t o_ppu_debug_w;
+            uint8_t o_ppu_debug_rasterizer_counter;
+
+            static DebugRegisters capture(const VNES& core) {
+                DebugRegisters registers;
+
+                registers.o_cpu_debug_clk_en = core.o_cpu_debug_clk_en;
+                registers.o_cpu_debug_ir = core.o_cpu_debug_ir;
+                registers.o_cpu_debug_tcu = core.o_cpu_debug_tcu;
+                registers.o_cpu_debug_address = core.o_cpu_debug_address;
+
+                registers.o_video_x = core.o_video_x;
+                registers.o_video_y = core.o_video_y;
+                registers.o_video_visible = core.o_video_visible;
+                registers.o_video_red = core.o_video_red;
+                registers.o_video_green = core.o_video_green;
+                registers.o_video_blue = core.o_video_blue;
+
+                registers.o_ppu_debug_colour_index = core.o_ppu_debug_colour_index;
+                registers.o_ppu_debug_palette[0] = core.o_ppu_debug_palette_0;
+                registers.o_ppu_debug_palette[1] = core.o_ppu_debug_palette_1;
+                registers.o_ppu_debug_palette[2] = core.o_ppu_debug_palette_2;
+                registers.o_ppu_debug_palette[3] = core.o_ppu_debug_palette_3;
+                registers.o_ppu_debug_palette[4] = core.o_ppu_debug_palette_4;
+                registers.o_ppu_debug_palette[5] = core.o_ppu_debug_palette_5;
+                registers.o_ppu_debug_palette[6] = core.o_ppu_debug_palette_6;
+                registers.o_ppu_debug_palette[7] = core.o_ppu_debug_palette_7;
+                registers.o_ppu_debug_ppuctrl = core.o_ppu_debug_ppuctrl;
+                registers.o_ppu_debug_ppumask = core.o_ppu_debug_ppumask;
+                registers.o_ppu_debug_ppustatus = core.o_ppu_debug_ppustatus;
+                registers.o_ppu_debug_vram_address = core.o_ppu_debug_vram_address;
+                registers.o_ppu_debug_i_vram_data = core.o_ppu_debug_i_vram_data;
+                registers.o_ppu_debug_ppuscroll_x = core.o_ppu_debug_ppuscroll_x;
+                registers.o_ppu_debug_ppuscroll_y = core.o_ppu_debug_ppuscroll_y;
+                registers.o_ppu_debug_v = core.o_ppu_debug_v;
+                registers.o_ppu_debug_t = core.o_ppu_debug_t;
+                registers.o_ppu_debug_x = core.o_ppu_debug_x;
+                registers.o_ppu_debug_w = core.o_ppu_debug_w;
+                registers.o_ppu_debug_rasterizer_counter = core.o_ppu_debug_rasterizer_counter;
+
+                return registers;
+            }
+        };
+
+        /// @brief everything the UI draws, published by the simulation thread
+        struct Frame {
+            std::vector<olc::Pixel> pixels;
+            std::vector<uint32_t> rowVersions;
+            DebugRegisters registers;
+            std::vector<uint8_t> videoMemory;       // PPU 0x0000:0x2FFF
+            std::array<uint32_t, kNumVideoPages> videoPageVersions {};
+            uint32_t paletteVersion = 0;
+            uint64_t numTicks = 0;
+            uint64_t numFrames = 0;
+
+            double ticksPerSecond = 0.0;            // measured by the pacer
+            double speed = 0.0;                     // 0 = as fast as possible
+            bool isBehind = false;                  // simulation can't keep up with the speed
+        };
+
+        TripleBuffer<Frame> publishedFrames;
+
+        // owned by the simulation thread
+        RealTimePacer pacer;
+
+        // owned by the UI thread, the screen is only redrawn when something has changed
+        bool isRedrawRequired = true;
+        int numSkippedRedraws = 0;
+
+        /// @brief image drawn with a single (scaled) decal, rather than a FillRect per pixel
+        struct TextureView {
+            std::unique_ptr<olc::Sprite> sprite;
+            std::unique_ptr<olc::Decal> decal;
+
+            void create(int width, int height) {
+                sprite = std::make_unique<olc::Sprite>(width, height);
+                decal = std::make_unique<olc::Decal>(sprite.get());
+            }
+
+            void destroy() {
+                decal.reset();
+                sprite.reset();
+            }
+
+            olc::Pixel* row(int y) {
+                return sprite->GetData() + (y * sprite->width);
+            }
+        };
+
+        // NES video output, with the version of each row that was last uploaded to the texture
+        TextureView screenView;
+        std::vector<uint32_t> uploadedRowVersions;
+
+        // VRAM debug views, at the native resolution of each
+        TextureView nametableView;
+        TextureView attributeTableView;
+        TextureView patternTableView;
+
+        // page + palette versions each part of the VRAM views was last decoded from
+        struct ViewVersion {
+            uint64_t pages = ~uint64_t(0);
+            uint32_t palette = ~0u;
+
+            bool operator==(const ViewVersion& other) const {
+                return (pages == other.pages) && (palette == other.palette);
+            }
+        };
+
+        ViewVersion nametableVersions[2];
+        ViewVersion attributeTableVersions[2];
+        ViewVersion patternTableVersions[32];            // per row of characters (i.e. per page)
+
+        // set when ticks have been simulated since the last published frame
+        bool hasUnpublishedTicks = false;
+
         enum Mode {
             kSingleStep,
             kRun
         };
 
-        Mode mode = kRun;
+        // requests from the UI thread, handled by the simulation thread between ticks
+        std::atomic<Mode> mode{kRun};
+        std::atomic<int> numPendingSteps{0};
+        std::atomic<uint8_t> controller1Buttons{0};
+        std::atomic<bool> isMaxSpeed{false};
 
-        int vramDisplay = 0;
+        struct Command {
+            enum Type {
+                kSaveSnapshot,
+                kLoadSnapshot
+            };
+
+            Type type;
+            std::string key;
+        };
+
+        std::mutex commandMutex;
+        std::vector<Command> commands;
+
+        std::thread simulationThread;
+        std::atomic<bool> isSimulationRunning{false};
 
-        uint8_t controller1 = 0;                    // state of buttons for controller1 (1 = pressed)
-        int lastControllerClk = 1;
+        enum SimulationError {
+            kNoError,
+            kUnsupportedWrite,
+            kCpuError
+        };
+
+        // set by the simulation thread, which then stops
+        std::atomic<SimulationError> simulationError{kNoError};
+
+        int vramDisplay = 0;
 
         void reset() {
-            testBench.reset();
+            mapper->reset();
+            bus.controller1().reset();
+            simulation.reset();
+            traceRing.clear();
 
             resetPixels();            
+
+            isVideoMemoryInvalid = true;
+        }
+
+        void startSimulation() {
+            isMaxSpeed = (options.speed <= 0.0);
+
+            isSimulationRunning = true;
+            simulationThread = std::thread(&EmulatorNES::runSimulation, this);
+        }
+
+        void stopSimulation() {
+            isSimulationRunning = false;
+
+            if (simulationThread.joinable()) {
+                simulationThread.join();
+            }
+        }
+
+        /// @brief simulation thread, owns the testbench, memories, mapper and movie until stopped
+        void runSimulation() {
+            pacer.setSpeed(isMaxSpeed ? 0.0 : options.speed);
+            pacer.restart();
+
+            while (isSimulationRunning && (simulationError.load(std::memory_order_relaxed) == kNoError)) {
+                runCommands();
+
+                // controller is latched from the most recent keyboard state
+                bus.controller1().setButtons(controller1Buttons.load(std::memory_order_relaxed));
+
+                pacer.setSpeed(isMaxSpeed.load(std::memory_order_relaxed) ? 0.0 : options.speed);
+
+                switch (mode.load(std::memory_order_relaxed)) {
+                    case kRun:
+                    {
+                        // ticks owed to the wall clock, in slices short enough to keep handling UI requests
+                        uint64_t numBudgetTicks = pacer.budget();
+
+                        if (numBudgetTicks == 0) {
+                            pacer.wait();
+                            break;
+                        }
+
+                        for (uint64_t i=0; i<numBudgetTicks; i++) {
+                            if (simulateTick()) {
+                                publishFrame();
+                            }
+
+                            if (simulationError.load(std::memory_order_relaxed) != kNoError) {
+                                break;
+                            }
+                        }
+
+                        pacer.advance(numBudgetTicks);
+
+                        break;
+                    }
+                    case kSingleStep:
+                    {
+                        int numSteps = numPendingSteps.exchange(0);
+
+                        for (int i=0; (i<numSteps) && (simulationError.load(std::memory_order_relaxed) == kNoError); i++) {
+                            simulateTick();
+                        }
+
+                        if (hasUnpublishedTicks) {
+                            // show the partially rendered frame
+                            publishFrame();
+                        } else {
+                            std::this_thread::sleep_for(kIdleInterval);
+                        }
+
+                        // real time restarts from whenever run mode resumes
+                        pacer.restart();
+
+                        break;
+                    }
+                    default:
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        void sendCommand(Command::Type type, const std::string& key) {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            commands.push_back({type, key});
+        }
+
+        void runCommands() {
+            std::vector<Command> pending;
+            {
+                std::lock_guard<std::mutex> lock(commandMutex);
+                pending.swap(commands);
+            }
+
+            for (const Command& command : pending) {
+                switch (command.type) {
+                    case Command::kSaveSnapshot:
+                        saveSnapshot(command.key);
+                        break;
+                    case Command::kLoadSnapshot:
+                        loadSnapshot(command.key);
+                        publishFrame();
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        /// @brief hand the current frame and debug state over to the UI thread
+        void publishFrame() {
+            Frame& frame = publishedFrames.back();
+
+            // the back buffer holds an older frame, so only copy the rows that have changed since
+            frame.pixels.resize(pixels.size());
+            frame.rowVersions.resize(kNESHeight, ~0u);
+
+            for (int y=0; y<kNESHeight; y++) {
+                if (frame.rowVersions[y] != rowVersions[y]) {
+                    std::copy_n(pixels.begin() + (y * kNESWidth), kNESWidth, frame.pixels.begin() + (y * kNESWidth));
+                    frame.rowVersions[y] = rowVersions[y];
+                }
+            }
+            frame.registers = DebugRegisters::capture(testBench.core());
+
+            // as with the rows, only copy the pages of video memory that have changed since
+            updateVideoPageVersions();
+
+            frame.videoMemory.resize(kVideoMemorySize);
+
+            for (size_t page = 0; page < kNumVideoPages; page++) {
+                if (frame.videoPageVersions[page] != videoPageVersions[page]) {
+                    copyVideoPage(page, frame.videoMemory.data() + (page * PageTable::kPageSize));
+                    frame.videoPageVersions[page] = videoPageVersions[page];
+                }
+            }
+
+            const uint32_t* palette = frame.registers.o_ppu_debug_palette;
+            if (!std::equal(publishedPalette.begin(), publishedPalette.end(), palette)) {
+                std::copy_n(palette, publishedPalette.size(), publishedPalette.begin());
+                paletteVersion += 1;
+            }
+
+            frame.paletteVersion = paletteVersion;
+
+            frame.numTicks = numTicks;
+            frame.numFrames = numFrames;
+
+            frame.ticksPerSecond = pacer.measuredTicksPerSecond();
+            frame.speed = pacer.speed();
+            frame.isBehind = pacer.isBehind();
+
+            publishedFrames.publish();
+
+            hasUnpublishedTicks = false;
+        }
+
+        /// @brief bump the version of each page of video memory that has changed since the last frame
+        void updateVideoPageVersions() {
+            uint64_t writtenPages = bus.takePPUWrittenPages();
+
+            // a write through one page also changes any page mirrored onto the same memory
+            uint64_t changedPages = 0;
+
+            for (size_t page = 0; page < kNumPPUPages; page++) {
+                const uint8_t* memory = ppuMemory.pageMemory(uint16_t(page * PageTable::kPageSize));
+                bool isRemapped = (memory != videoPageMemory[page]);
+                bool isWritten = ((writtenPages >> page) & 1) != 0;
+
+                if (isWritten || isRemapped || isVideoMemoryInvalid) {
+                    changedPages |= uint64_t(1) << page;
+                }
+
+                videoPageMemory[page] = memory;
+            }
+
+            for (size_t page = 0; page < kNumVideoPages; page++) {
+                bool isChanged = ((changedPages >> page) & 1) != 0;
+
+                for (size_t other = 0; (other < kNumPPUPages) && !isChanged; other++) {
+                    bool isOtherWritten = ((writtenPages >> other) & 1) != 0;
+                    isChanged = isOtherWritten && (videoPageMemory[other] != nullptr) && (videoPageMemory[other] == videoPageMemory[page]);
+                }
+
+                if (isChanged) {
+                    videoPageVersions[page] += 1;
+                }
+            }
+
+            isVideoMemoryInvalid = false;
+        }
+
+        void copyVideoPage(size_t page, uint8_t* destination) {
+            uint16_t address = uint16_t(page * PageTable::kPageSize);
+
+            const uint8_t* memory = ppuMemory.pageMemory(address);
+            if (memory != nullptr) {
+                std::copy_n(memory, PageTable::kPageSize, destination);
+            } else {
+                for (size_t offset = 0; offset < PageTable::kPageSize; offset++) {
+                    destination[offset] = ppuMemory.read(uint16_t(address + offset));
+                }
+            }
+        }
+
+        /// @brief most recent frame published by the simulation thread
+        const Frame& currentFrame() const {
+            return publishedFrames.front();
+        }
+
+        /// @brief read the PPU address space, as captured with the current frame
+        uint8_t readVideoMemory(uint16_t address) const {
+            return currentFrame().videoMemory[address];
         }
 
         void resetPixels() {
@@ -94,6 +627,11 @@ namespace emulator {
             pixels.resize( kNESWidth * kNESHeight );
             std::fill(pixels.begin(), pixels.end(), olc::YELLOW);
 
+            rowVersions.resize(kNESHeight);
+            for (uint32_t& version : rowVersions) {
+                version += 1;
+            }
+
             // fill current pixel
             writeCurrentPixel();
         }
@@ -111,35 +649,49 @@ namespace emulator {
 
         void update() {
             if (GetKey(olc::ESCAPE).bReleased) {
+                // note: exit() skips destructors, so stop the simulation and finish the movie first
+                stopSimulation();
+                movieRecorder.close();
                 exit(0);
             }
 
             if (GetKey(olc::V).bReleased) {
                 toggleDisplayVRAM();
+                isRedrawRequired = true;
+            }
+
+            if (GetKey(olc::M).bReleased) {
+                // toggle between the paced speed and running as fast as possible
+                isMaxSpeed = !isMaxSpeed;
+            }
+
+            // snapshot slots: F1-F4 to load, SHIFT + F1-F4 to save
+            const olc::Key kSnapshotKeys[] = { olc::F1, olc::F2, olc::F3, olc::F4 };
+            for (int i=0; i<4; i++) {
+                if (GetKey(kSnapshotKeys[i]).bReleased) {
+                    std::string key = "slot" + std::to_string(i + 1);
+
+                    if (GetKey(olc::SHIFT).bHeld) {
+                        sendCommand(Command::kSaveSnapshot, key);
+                    } else {
+                        sendCommand(Command::kLoadSnapshot, key);
+                    }
+                }
             }
 
+            // controller is latched from the most recent keyboard state
+            controller1Buttons.store(readController1(), std::memory_order_relaxed);
+
             /*
             if (GetKey(olc::P).bReleased) {
                 printPalette();
             }
             */
 
-            switch (mode) {
+            // the simulation thread runs independently, the UI only switches mode and requests steps
+            switch (mode.load(std::memory_order_relaxed)) {
                 case kRun:
                 {
-                    // todo: replace kNumTicksPerFrame by 30fps timer
-
-                    // simulate a NES screen refresh
-                    //const int kNumTicksPerFrame = 5000000/60;
-
-                    // simulate NES at ~1fps and watch video output 
-                    // rendering line by line
-                    const int kNumTicksPerFrame = 2000;
-                    
-                    for (int i=0; i<kNumTicksPerFrame; i++) {
-                        simulateTick();
-                    }
-
                     if(GetKey(olc::R).bReleased || GetKey(olc::SPACE).bReleased) {
                         mode = kSingleStep;
                     }
@@ -155,9 +707,7 @@ namespace emulator {
                             numTicks = 100;
                         }
 
-                        for (int i=0; i<numTicks; i++) {
-                            simulateTick();
-                        }
+                        numPendingSteps += numTicks;
                     }
 
                     if (GetKey(olc::R).bReleased) {
@@ -179,13 +729,10 @@ namespace emulator {
             FillRect({ 0,0 }, { ScreenWidth(), ScreenHeight() }, olc::GREY);
 
             drawTitle(10, 10);
-            drawPixels(10, 50);
+            updateScreenView();
             drawStats(700, 50);
 
             // visual debug of VRAM
-            const int kVramX = 700;
-            const int kVramY = 400;
-
             switch (vramDisplay) {
                 case 0:
                     drawNametable(kVramX, kVramY);
@@ -201,6 +748,81 @@ namespace emulator {
             }
         }
 
+        void renderDecals() {
+            drawPixels(kPixelsX, kPixelsY);
+
+            // VRAM views are drawn below their titles
+            const olc::vf2d kVramViewPosition = { float(kVramX), float(kVramY + (2 * kRowHeight)) };
+
+            switch (vramDisplay) {
+                case 0:
+                    DrawDecal(kVramViewPosition, nametableView.decal.get());
+                    break;
+                case 1:
+                    DrawDecal(kVramViewPosition, attributeTableView.decal.get(), { 8.0f, 8.0f });
+                    break;
+                case 2:
+                    DrawDecal(kVramViewPosition, patternTableView.decal.get(), { 2.0f, 2.0f });
+                    break;
+                default:
+                   break;
+            }
+        }
+
+        void createViews() {
+            screenView.create(kNESWidth, kNESHeight);
+            uploadedRowVersions.assign(kNESHeight, ~0u);
+
+            nametableView.create(2 * 32 * 8, 30 * 8);
+            attributeTableView.create(2 * 16 * 2, 15 * 2);
+            patternTableView.create(2 * 16 * 8, 16 * 8);
+
+            // views start empty, so need a full decode
+            std::fill(std::begin(nametableVersions), std::end(nametableVersions), ViewVersion());
+            std::fill(std::begin(attributeTableVersions), std::end(attributeTableVersions), ViewVersion());
+            std::fill(std::begin(patternTableVersions), std::end(patternTableVersions), ViewVersion());
+        }
+
+        /// @brief combined version of a range of video memory pages, in the current frame
+        /// @note versions only ever increase, so the sum changes whenever any page in the range changes
+        uint64_t videoPagesVersion(uint16_t address, size_t size) const {
+            const Frame& frame = currentFrame();
+
+            uint64_t version = 0;
+            for (size_t page = address / PageTable::kPageSize; page < (address + size) / PageTable::kPageSize; page++) {
+                version += frame.videoPageVersions[page];
+            }
+
+            return version;
+        }
+
+        void destroyViews() {
+            screenView.destroy();
+            nametableView.destroy();
+            attributeTableView.destroy();
+            patternTableView.destroy();
+        }
+
+        /// @brief copy the rows of the current frame that have changed into the screen texture
+        void updateScreenView() {
+            const Frame& frame = currentFrame();
+
+            bool isDirty = false;
+
+            for (int y=0; y<kNESHeight; y++) {
+                if (uploadedRowVersions[y] != frame.rowVersions[y]) {
+                    std::copy_n(frame.pixels.begin() + (y * kNESWidth), kNESWidth, screenView.row(y));
+                    uploadedRowVersions[y] = frame.rowVersions[y];
+
+                    isDirty = true;
+                }
+            }
+
+            if (isDirty) {
+                screenView.decal->Update();
+            }
+        }
+
         void toggleDisplayVRAM() {
             vramDisplay = (vramDisplay + 1) % 4;
         }
@@ -232,41 +854,13 @@ namespace emulator {
         };
 
         uint8_t getPaletteColourIndex(int index) {
-            auto& core = testBench.core();
+            const DebugRegisters& registers = currentFrame().registers;
 
             int indexCoarse = index / 4;
             int indexFine = index % 4;
 
-            uint32_t debugPalette = -1;
-            switch (indexCoarse) {
-                case 0:
-                    debugPalette = core.o_ppu_debug_palette_0;
-                    break;
-                case 1:
-                    debugPalette = core.o_ppu_debug_palette_1;
-                    break;
-                case 2:
-                    debugPalette = core.o_ppu_debug_palette_2;
-                    break;
-                case 3:
-                    debugPalette = core.o_ppu_debug_palette_3;
-                    break;
-                case 4:
-                    debugPalette = core.o_ppu_debug_palette_4;
-                    break;
-                case 5:
-                    debugPalette = core.o_ppu_debug_palette_5;
-                    break;
-                case 6:
-                    debugPalette = core.o_ppu_debug_palette_6;
-                    break;
-                case 7:
-                    debugPalette = core.o_ppu_debug_palette_7;
-                    break;
-                default:
-                    assert(!"unknown palette entry");
-                    break;
-            }            
+            assert((indexCoarse >= 0) && (indexCoarse < 8) && "unknown palette entry");
+            uint32_t debugPalette = registers.o_ppu_debug_palette[indexCoarse];
 
             uint8_t paletteIndex = (debugPalette >> (indexFine * 8)) & 0xff;
             assert(paletteIndex < 0x40);
@@ -281,7 +875,8 @@ namespace emulator {
         }
 
         void drawStats(int x, int y) {
-            auto& core = testBench.core();
+            const Frame& frame = currentFrame();
+            const DebugRegisters& core = frame.registers;
 
             DrawString({x,y}, "Stats", olc::RED);
             y += kRowHeight;
@@ -289,13 +884,21 @@ namespace emulator {
             y += kRowHeight;
 
             char buffer[64];
-            sprintf(buffer, "     ticks %d", numTicks);
+            sprintf(buffer, "     ticks %llu", (unsigned long long) frame.numTicks);
             DrawString({x,y}, buffer, olc::BLACK);
             y += kRowHeight;
 
-            sprintf(buffer, "     frame %d", numFrames);
+            sprintf(buffer, "     frame %llu", (unsigned long long) frame.numFrames);
             DrawString({x,y}, buffer, olc::BLACK);
             y += kRowHeight;
+
+            if (frame.speed <= 0.0) {
+                sprintf(buffer, " ticks/sec %.2fM [max speed]", frame.ticksPerSecond / 1000000.0);
+            } else {
+                sprintf(buffer, " ticks/sec %.2fM [%.2fx]%s", frame.ticksPerSecond / 1000000.0, frame.speed, frame.isBehind ? " behind" : "");
+            }
+            DrawString({x,y}, buffer, frame.isBehind ? olc::DARK_RED : olc::BLACK);
+            y += kRowHeight;
             y += kRowHeight;
 
             // CPU
@@ -429,19 +1032,14 @@ namespace emulator {
         }
 
         void drawPixels(int x, int y) {
-            const int kPixelSize = 2;
+            const int kPixelSize = kPixelsScale;
 
-            for (int col = 0; col<kNESWidth; col++) {
-                for (int row = 0; row<kNESHeight; row++) {
-                    const olc::Pixel pixel = pixels[col + (row*kNESWidth)];
-                    FillRect({ x + (col*kPixelSize), y + (row*kPixelSize)}, {kPixelSize, kPixelSize}, pixel);
-                }
-            }
+            DrawDecal({ float(x), float(y) }, screenView.decal.get(), { float(kPixelSize), float(kPixelSize) });
 
             // current output position
-            auto& core = testBench.core();
-            FillRect({ x , y + (core.o_video_y*kPixelSize)}, {kPixelSize * kNESWidth, kPixelSize}, olc::GREY);
-            FillRect({ x + (core.o_video_x * kPixelSize), y + (core.o_video_y * kPixelSize)}, {kPixelSize << 1, kPixelSize << 1}, olc::WHITE);
+            const DebugRegisters& core = currentFrame().registers;
+            FillRectDecal({ float(x), float(y + (core.o_video_y*kPixelSize)) }, { float(kPixelSize * kNESWidth), float(kPixelSize) }, olc::GREY);
+            FillRectDecal({ float(x + (core.o_video_x * kPixelSize)), float(y + (core.o_video_y * kPixelSize)) }, { float(kPixelSize << 1), float(kPixelSize << 1) }, olc::WHITE);
         }
 
         struct Palette {
@@ -466,19 +1064,36 @@ namespace emulator {
             DrawLine({x, y}, {x + 42 * 8, y}, olc::RED);
             y += kRowHeight;
 
-            const int kPixelSize = 2;
+            // drawn at native resolution into the view, which is scaled up by renderDecals()
+            // note: each row of characters is a page of video memory, and only decoded when it has changed
+            bool isChanged = false;
 
             for (int section=0; section<2; section++) {
-                for (int c = 0; c<16; c++) {
-                    for (int r = 0; r<16; r++) {
+                for (int r = 0; r<16; r++) {
+                    ViewVersion version;
+                    version.pages = videoPagesVersion((section << 12) | (r << 8), PageTable::kPageSize);
+                    version.palette = 0;
+
+                    if (patternTableVersions[(section * 16) + r] == version) {
+                        continue;
+                    }
+
+                    for (int c = 0; c<16; c++) {
                         // position of character's top left corner
-                        int tx = x + (kPixelSize * ((section * 128) + (c*8)));
-                        int ty = y + (kPixelSize * (r * 8));
+                        int tx = (section * 128) + (c*8);
+                        int ty = r * 8;
 
-                        drawCharacter(tx, ty, section, c, r, kPixelSize, kDefaultPalette);
+                        drawCharacter(patternTableView, tx, ty, section, c, r, kDefaultPalette);
                     }
+
+                    patternTableVersions[(section * 16) + r] = version;
+                    isChanged = true;
                 }
             }
+
+            if (isChanged) {
+                patternTableView.decal->Update();
+            }
         }
 
         void drawNametable(int x, int y) {
@@ -487,16 +1102,28 @@ namespace emulator {
             DrawLine({x, y}, {x + 42 * 8, y}, olc::RED);
             y += kRowHeight;
 
-            const int kPixelSize = 1;
-        
+            // note: only sections whose tiles, attributes, characters or palette have changed are decoded
+            const int patternTableSection = 1;        // TODO: read from PPUCTRL[4]
+            bool isChanged = false;
+
             for (int section=0; section<2; section++) {
+                ViewVersion version;
+                version.pages = videoPagesVersion(0x2000 + (section * 0x0800), 0x0400)
+                              + videoPagesVersion(0x2300 + (section << 10), PageTable::kPageSize)
+                              + videoPagesVersion(patternTableSection << 12, 0x1000);
+                version.palette = currentFrame().paletteVersion;
+
+                if (nametableVersions[section] == version) {
+                    continue;
+                }
+
                 for (int c = 0; c<32; c++) {
                     for (int r =0; r<30; r++) {
                         // read value from nametable
-                        uint8_t tile = vram.read(0x2000 + (section * 0x0800) + c + (r * 32));
+                        uint8_t tile = readVideoMemory(0x2000 + (section * 0x0800) + c + (r * 32));
 
                         // read value from attribute table
-                        uint8_t attribute = vram.read(0x23c0 + (section << 10) + ((r/4) << 3) + (c/4));
+                        uint8_t attribute = readVideoMemory(0x23c0 + (section << 10) + ((r/4) << 3) + (c/4));
 
                         int attributeShift = (c&2) 
                                                 ? ((r&2) ? 6 : 2)               // right bottom,  right top
@@ -515,23 +1142,30 @@ namespace emulator {
                         }
 
                         // position of character's top left corner
-                        int tx = x + (kPixelSize * ((section * 32 * 8) + (c*8)));
-                        int ty = y + (kPixelSize * (r * 8));
+                        int tx = (section * 32 * 8) + (c*8);
+                        int ty = r * 8;
                         
-                        int patternTableSection = 1;        // TODO: read from PPUCTRL[4]
-                        drawCharacter(tx, ty, patternTableSection, tile & 0xF, (tile >> 4) & 0xF, kPixelSize, palette);
+                        drawCharacter(nametableView, tx, ty, patternTableSection, tile & 0xF, (tile >> 4) & 0xF, palette);
                     }
                 }
+
+                nametableVersions[section] = version;
+                isChanged = true;
+            }
+
+            if (isChanged) {
+                nametableView.decal->Update();
             }
         }
 
-        void drawCharacter(int x, int y, int section, int c, int r, int pixelSize, const Palette& palette) {
+        /// @brief decode a character from a pattern table into a view, at native resolution
+        void drawCharacter(TextureView& view, int x, int y, int section, int c, int r, const Palette& palette) {
             for (int i=0; i<8; i++) {
                 // each row in the character
-                uint8_t low = vram.read(i | (c<<4) | (r<<8) | (section << 12));
-                uint8_t high = vram.read(i | (1<<3) | (c<<4) | (r<<8) | (section << 12));
+                uint8_t low = readVideoMemory(i | (c<<4) | (r<<8) | (section << 12));
+                uint8_t high = readVideoMemory(i | (1<<3) | (c<<4) | (r<<8) | (section << 12));
 
-                int ty = y + (pixelSize * i);
+                olc::Pixel* row = view.row(y + i) + x;
 
                 for (int p=0; p<8; p++) {
                     // each pixel in the row
@@ -539,8 +1173,7 @@ namespace emulator {
                     uint8_t highBit = (high >> (7-p)) & 0x1;
                     uint8_t colour = lowBit + (highBit << 1);
                     
-                    int tx = x + (pixelSize * p);
-                    FillRect({tx, ty}, {pixelSize,pixelSize}, palette[colour]);
+                    row[p] = palette[colour];
                 }
             }
         }
@@ -550,12 +1183,23 @@ namespace emulator {
             y += kRowHeight;
             DrawLine({x, y}, {x + 42 * 8, y}, olc::RED);
             y += kRowHeight;
+
+            // note: only sections whose attributes or palette have changed are decoded
+            bool isChanged = false;
         
             for (int section=0; section<2; section++) {
+                ViewVersion version;
+                version.pages = videoPagesVersion(0x2300 + (section << 10), PageTable::kPageSize);
+                version.palette = currentFrame().paletteVersion;
+
+                if (attributeTableVersions[section] == version) {
+                    continue;
+                }
+
                 for (int c = 0; c<16; c++) {
                     for (int r =0; r<15; r++) {
                         // read value from attribute table
-                        uint8_t attribute = vram.read(0x23c0 + (section << 10) + ((r/2) << 3) + (c/2));
+                        uint8_t attribute = readVideoMemory(0x23c0 + (section << 10) + ((r/2) << 3) + (c/2));
 
                         int attributeShift = (c&1) 
                                                 ? ((r&1) ? 6 : 2)               // right bottom,  right top
@@ -573,32 +1217,40 @@ namespace emulator {
                             palette = kDefaultPalette;
                         }
 
-                        // position of character's top left corner
-                        int tx = x + (section * 16 * 16) + (c * 16);
-                        int ty = y + (r * 16);
+                        // position of the 2x2 palette swatch, scaled up by renderDecals()
+                        int tx = (section * 16 * 2) + (c * 2);
+                        int ty = r * 2;
                         
-                        FillRect({tx,ty}, {8,8}, palette[0]);
-                        FillRect({tx+8,ty}, {8,8}, palette[1]);
-                        FillRect({tx,ty+8}, {8,8}, palette[2]);
-                        FillRect({tx+8,ty+8}, {8,8}, palette[3]);
+                        attributeTableView.row(ty)[tx] = palette[0];
+                        attributeTableView.row(ty)[tx+1] = palette[1];
+                        attributeTableView.row(ty+1)[tx] = palette[2];
+                        attributeTableView.row(ty+1)[tx+1] = palette[3];
                     }
                 }
+
+                attributeTableVersions[section] = version;
+                isChanged = true;
+            }
+
+            if (isChanged) {
+                attributeTableView.decal->Update();
             }
         }
 
-        void simulateTick() {
+        /// @return true if a new frame has started (i.e. the previous frame is complete)
+        bool simulateTick() {
             auto& core = testBench.core();
 
-            testBench.tick();
+            simulation.tick();
 
-            // todo: add support for disabling trace on testbench
-            testBench.trace.clear();
-
-            if ((core.o_video_x == 0) && (core.o_video_y == 0)) {
+            bool isFrameComplete = (core.o_video_x == 0) && (core.o_video_y == 0);
+            if (isFrameComplete) {
                 numFrames +=1;
             }
             numTicks += 1;
 
+            hasUnpublishedTicks = true;
+
             // only log this on ticks when CPU clock enable is active
             LOG_CPU("CPU - IR:0x%02X address:0x%04X rw:%d\n", core.o_cpu_debug_ir, core.o_cpu_debug_address, core.o_cpu_debug_rw);
 
@@ -606,13 +1258,23 @@ namespace emulator {
                 LOG_CONTROLLER("controller - RW [%d] controller1 [%d]\n", core.o_cpu_debug_rw, core.i_controller_1);
             }
             
-            if (core.o_cpu_debug_error == 1) {
-                printf("error! tick (%d) frame (%d)\n", numTicks, numFrames);
+            // note: the UI thread shuts down on an error, as exit() here would skip finishing the movie,
+            //       and tear down while the UI thread is still rendering
+            if (bus.hasUnsupportedWrite()) {
+                printf("write to read-only memory not supported!\n");
+                simulationError = kUnsupportedWrite;
+                return false;
+            }
 
-                exit(2);
+            if (core.o_cpu_debug_error == 1) {
+                printf("error! tick (%llu) frame (%llu)\n", (unsigned long long) numTicks, (unsigned long long) numFrames);
+                simulationError = kCpuError;
+                return false;
             }
 
             writeCurrentPixel();
+
+            return isFrameComplete;
         }
 
         void writeCurrentPixel() {
@@ -627,7 +1289,12 @@ namespace emulator {
 
             if (visible == 1) {
                 olc::Pixel pixel(red, green, blue);
-                pixels[x + (y*kNESWidth)] = pixel;
+                olc::Pixel& current = pixels[x + (y*kNESWidth)];
+
+                if (current != pixel) {
+                    current = pixel;
+                    rowVersions[y] += 1;
+                }
             }
         }
 
@@ -639,97 +1306,99 @@ namespace emulator {
             sram.clear(0);
             vram.clear(0);
 
-            // simulation at the end of a clock phase, before
-            //   transition to other clock phase
-            testBench.setCallbackSimulateCombinatorial([this]{
-                auto& core = testBench.core();
+            cpuMemory.clear();
+            ppuMemory.clear();
 
-                if (core.i_clk == 1) {
-                    // clock: end of phi2
-                    // R/W data is valid on the bus
+            // note: CPUMemoryMap mirrors RAM into 0x0000:0x07FF
+            cpuMemory.map(0x0000, sram.size(), sram.data());
 
-                    if (core.o_cs_ram == 1) {
-                        if (core.o_rw_ram == 0) {
-                            sram.write(core.o_address_ram, core.o_data_ram);
+            // note: the mapper arranges vram into the nametables
 
-                            LOG_BUS("write ram 0x%04X = 0x%02X\n", core.o_address_ram, core.o_data_ram);
-                        } else {
-                            core.i_data_ram = sram.read(core.o_address_ram);
+            // skip per-tick trace capture, and only keep a short history of steps
+            simulation.setTraceMode(TraceMode::kNone);
+            simulation.setRecorder(&traceRing);
+        }
 
-                            LOG_BUS("read ram 0x%04X = 0x%02X\n", core.o_address_ram, core.i_data_ram);
-                        }
-                    }
-                    
-                    if (core.o_cs_prg == 1) {
-                        core.i_data_prg = sram.read(core.o_address_prg);
+        bool initMovie() {
+            if (!options.replayMoviePath.empty()) {
+                if (!movieReplayer.open(options.replayMoviePath)) {
+                    printf("unable to replay movie: %s\n", movieReplayer.error().c_str());
+                    return false;
+                }
 
-                        LOG_BUS("read prg 0x%04X = 0x%02X\n", core.o_address_prg, core.i_data_prg);
-                    }
+                bus.controller1().setLatchHandler(&movieReplayer);
+            } else if (!options.recordMoviePath.empty()) {
+                if (!movieRecorder.open(options.recordMoviePath)) {
+                    printf("unable to record movie: %s\n", movieRecorder.error().c_str());
+                    return false;
+                }
 
-                    if (core.o_cs_patterntable == 1) {
-                        if (core.o_rw_patterntable == 1) {
-                            core.i_data_patterntable = vram.read(core.o_address_patterntable);
+                bus.controller1().setLatchHandler(&movieRecorder);
+            }
 
-                            LOG_BUS("read patterntable 0x%04X\n = 0x%02X", core.o_address_patterntable, core.i_data_patterntable);
-                        } else {
-                            LOG_BUS("???? write patterntable 0x%04X ???? - not supported!\n", core.o_address_patterntable);
-                            printf("write to patterntable not supported!\n");
-                            exit(2);
-                        }
-                    }
+            return true;
+        }
 
-                    if (core.o_cs_nametable == 1) {
-                        if (core.o_rw_nametable == 0) {                            
-                            vram.write(core.o_address_nametable, core.o_data_nametable);
+        void saveSnapshot(const std::string& key) {
+            std::error_code errorCode;
+            std::filesystem::create_directories(kSnapshotDirectory, errorCode);
 
-                            LOG_BUS("write nametable 0x%04X = 0x%02X\n", core.o_address_nametable, core.o_data_nametable);
-                        } else {
-                            core.i_data_nametable = vram.read(core.o_address_nametable);
+            NESSnapshot::Counters counters;
+            counters.numTicks = numTicks;
+            counters.numFrames = numFrames;
 
-                            LOG_BUS("read nametable 0x%04X = 0x%02X\n", core.o_address_nametable, core.i_data_nametable);
-                        }
-                    }
+            std::string path = NESSnapshot::path(kSnapshotDirectory, key);
+            std::string error;
+            if (NESSnapshot::save(path, testBench.core(), rom, sram, vram, *mapper, bus.controller1(), counters, error)) {
+                printf("saved snapshot [%s]\n", path.c_str());
+            } else {
+                printf("unable to save snapshot: %s\n", error.c_str());
+            }
+        }
 
-                } else {
-                    // clock: end of phi 1
-                    // undefined data on the bus
-                    core.i_data_ram = 0xFF;
-                    core.i_data_prg = 0xFF;
-                    core.i_data_patterntable = 0xFF;
-                    core.i_data_nametable = 0xFF;
-                }
+        void loadSnapshot(const std::string& key) {
+            NESSnapshot::Counters counters;
 
-                // controller
+            std::string path = NESSnapshot::path(kSnapshotDirectory, key);
+            std::string error;
 
-                core.i_controller_1 = controller1 & 0x01;           // read lsb
+            // note: the recording continues from the snapshot, which can't be ahead of it (latches can't be skipped)
+            if (movieRecorder.isOpen()) {
+                NESController::State controllerState;
+                if (!NESSnapshot::readController(path, controllerState, error)) {
+                    printf("unable to load snapshot: %s\n", error.c_str());
+                    return;
+                }
 
-                // clk enable check is important here:
-                //    - perhaps latch the controller output values at I/O port on FPGA
-                if (core.o_cpu_debug_clk_en) {
-                    int controllerClk = core.o_controller_clk;
+                if (!movieRecorder.canRewind(controllerState.numLatches)) {
+                    printf("unable to load snapshot while recording: [%s] is ahead of the recording\n", path.c_str());
+                    return;
+                }
+            }
 
-                    if (core.o_controller_latch) {
-                        readController1();
+            if (!NESSnapshot::load(path, testBench.core(), rom, sram, vram, *mapper, bus.controller1(), counters, error)) {
+                printf("unable to load snapshot: %s\n", error.c_str());
+                return;
+            }
 
-                        LOG_CONTROLLER("controller - latch [%u]\n", controller1);
-                    } else {
-                        if ((controllerClk == 1) && (lastControllerClk == 0)) {
-                            LOG_CONTROLLER("controller - shift [%u]\n", controller1);
+            if (movieRecorder.isOpen() && !movieRecorder.rewind(bus.controller1().numLatches())) {
+                printf("unable to rewind movie: %s\n", movieRecorder.error().c_str());
+                movieRecorder.close();
+            }
 
-                            // shift out first bit
-                            controller1 >>= 1;
+            numTicks = counters.numTicks;
+            numFrames = counters.numFrames;
 
-                            // simulate shifting in '1' (for unpressed button) at top of shift register
-                            controller1 |= (1<<7);
-                        }
-                    }
+            traceRing.clear();
+            resetPixels();
 
-                    lastControllerClk = controllerClk;
-                }
-            });
+            // memories were restored without going through the bus
+            isVideoMemoryInvalid = true;
+
+            printf("loaded snapshot [%s]\n", path.c_str());
         }
 
-        void readController1() {
+        uint8_t readController1() {
             int a = GetKey(olc::U).bHeld ? 1 : 0;
             int b = GetKey(olc::I).bHeld ? 1 << 1: 0;
             int select = GetKey(olc::O).bHeld ? 1 << 2 : 0;
@@ -739,97 +1408,58 @@ namespace emulator {
             int left = GetKey(olc::LEFT).bHeld ? 1 << 6 : 0;
             int right = GetKey(olc::RIGHT).bHeld ? 1 << 7 : 0;
             
-            controller1 = a | b | select | start | up | down | left | right;
-
-            // NES controller sends a 0 for each button that is pressed
-            controller1 = ~controller1;
-        }
-
-        void initGalaga() {
-            // PRG - game code
-
-            // load bank 0 -> 0x8000:0xBFFF
-            auto bank0 = loadBinaryFile("roms/galaga/prg_rom_bank_0.6502.bin");
-            sram.write(0x8000, bank0);
-
-            // load bank 1 -> 0xC000:0xFFFF
-            auto bank1 = loadBinaryFile("roms/galaga/prg_rom_bank_1.6502.bin");
-            sram.write(0xC000, bank1);
-
-            // CHR - pattern table
-            auto chr = loadBinaryFile("roms/galaga/chr_rom_bank_0.bin");
-            vram.write(0x0000, chr);
+            return a | b | select | start | up | down | left | right;
         }
 
+        /// @brief map an iNES ROM image into the CPU + PPU address spaces, via its mapper
+        bool loadRom() {
+            if (!rom.open(options.romPath)) {
+                printf("unable to load ROM: %s\n", rom.error().c_str());
+                return false;
+            }
 
-        void initMario() {
-            // PRG - game code
-
-            // load bank 0 -> 0x8000:0xBFFF
-            auto bank0 = loadBinaryFile("roms/supermario/prg_rom_bank_0.6502.bin");
-            sram.write(0x8000, bank0);
-
-            // load bank 1 -> 0xC000:0xFFFF
-            auto bank1 = loadBinaryFile("roms/supermario/prg_rom_bank_1.6502.bin");
-            sram.write(0xC000, bank1);
-
-            // CHR - pattern table
-            auto chr = loadBinaryFile("roms/supermario/chr_rom_bank_0.bin");
-            vram.write(0x0000, chr);
-        }
-
-        void initDonkeyKong() {
-            // PRG - game code
-
-            // load bank 0 -> 0x0000:0xBFFF
-            // load bank 0 -> 0xC000:0xFFFF
-            auto bank0 = loadBinaryFile("roms/donkeykong/prg_rom_bank_0.6502.bin");
-            sram.write(0x0000, bank0);
-            sram.write(0xC000, bank0);
-
-            // CHR - pattern table
-            auto chr = loadBinaryFile("roms/donkeykong/chr_rom_bank_0.bin");
-            vram.write(0x0000, chr);
-        }
-
-        void initDuckHunt() {
-            // PRG - game code
-
-            // load bank 0 -> 0x0000:0xBFFF
-            // load bank 0 -> 0xC000:0xFFFF
-            auto bank0 = loadBinaryFile("roms/duckhunt/prg_rom_bank_0.6502.bin");
-            sram.write(0x0000, bank0);
-            sram.write(0xC000, bank0);
-
-            // CHR - pattern table
-            auto chr = loadBinaryFile("roms/duckhunt/chr_rom_bank_0.bin");
-            vram.write(0x0000, chr);
-        }
-
-        std::vector<uint8_t> loadBinaryFile(const char* filename) {
-            std::ifstream is;
-            is.open (filename, std::ios::binary );
-            assert(is.is_open());
-
-            is.seekg (0, std::ios::end);
-            int length = is.tellg();
-            is.seekg (0, std::ios::beg);
-            std::vector<uint8_t> buffer(length);
-            uint8_t* pBuffer = &(buffer.front());
-            is.read(reinterpret_cast<char*>(pBuffer), length);
-            is.close();
+            std::string error;
+            mapper = Mapper::create(rom, cpuMemory, ppuMemory, vram.data(), error);
+            if (!mapper) {
+                printf("unsupported ROM [%s]: %s\n", options.romPath.c_str(), error.c_str());
+                return false;
+            }
 
-            return buffer;
+            return true;
         }
     };
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    emulator::EmulatorNES emulator;
+    emulator::EmulatorNES::Options options;
+
+    // default to Galaga
+    options.romPath = "roms/galaga.nes";
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1) < argc;
+
+        if ((strcmp(argv[i], "--record") == 0) && hasValue) {
+            options.recordMoviePath = argv[++i];
+        } else if ((strcmp(argv[i], "--replay") == 0) && hasValue) {
+            options.replayMoviePath = argv[++i];
+        } else if ((strcmp(argv[i], "--speed") == 0) && hasValue) {
+            options.speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-speed") == 0) {
+            options.speed = 0.0;
+        } else if (argv[i][0] != '-') {
+            options.romPath = argv[i];
+        } else {
+            printf("usage: %s [rom.nes] [--record <movie>] [--replay <movie>] [--speed <multiple>] [--max-speed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    emulator::EmulatorNES emulator(options);
 
     if (emulator.Construct(kScreenWidth, kScreenHeight, 1, 1))
         emulator.Start();
 
-    return 0;
+    return emulator.exitCode();
 }
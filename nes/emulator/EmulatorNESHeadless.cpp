@@ -0,0 +1,884 @@
+#include "nes/NESTestBench.h"
+#include "nes/NESFastTestBench.h"
+#include "nes/memory/SRAM.hpp"
+#include "nes/memory/PageTable.hpp"
+#include "nes/cartridge/INESRom.hpp"
+#include "nes/cartridge/Mapper.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/NESBus.hpp"
+#include "nes/simulation/TraceRing.hpp"
+#include "nes/simulation/NESTraceStep.hpp"
+#include "nes/simulation/NESSnapshot.hpp"
+#include "nes/simulation/InputScript.hpp"
+#include "nes/simulation/InputMovie.hpp"
+#include "nes/simulation/ForkFanOut.hpp"
+#include "nes/simulation/RegressionManifest.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace nestestbench;
+using namespace nesfasttestbench;
+using namespace memory;
+using namespace simulation;
+using namespace cartridge;
+
+namespace {
+    const int kNESWidth = 341;
+    const int kNESHeight = 262;
+
+    void printUsage(const char* program) {
+        printf("usage: %s --rom <rom.nes> [--ticks <n>] [--frames <n>] [--output <directory>] [--trace-ring <steps>] [--fast]\n", program);
+        printf("          [--snapshot-dir <directory>] [--load-snapshot <key>] [--save-snapshot <key>]\n");
+        printf("          [--replay <movie>] [--record <movie>]\n");
+        printf("          [--branch <input script>]... [--branch-frames <n>] [--branch-processes <n>]\n");
+        printf("       %s --manifest <manifest> [--manifest-processes <n>] [--manifest-record <manifest>] [--output <directory>] [--fast]\n", program);
+        printf("\n");
+        printf("  --rom      iNES / NES 2.0 ROM image (mapper 0, 1, 2 or 3)\n");
+        printf("  --ticks    stop after simulating this number of ticks\n");
+        printf("  --frames   stop after simulating this number of frames\n");
+        printf("  --output   directory to write stats.txt and final frame (.ppm) into\n");
+        printf("  --trace-ring  keep the last <steps> (2 per tick) for a post-mortem trace on CPU error\n");
+        printf("  --fast     simulate NESFast (the NES without debug ports), which can't detect a CPU error,\n");
+        printf("             or keep a trace ring. Snapshots are only compatible with the same model\n");
+        printf("  --snapshot-dir  directory of snapshots (default: snapshots)\n");
+        printf("  --load-snapshot resume from the snapshot saved with <key>\n");
+        printf("  --save-snapshot save a snapshot with <key> when the budget is used up\n");
+        printf("  --replay   replay controller input from a movie (e.g. recorded by emulator-nes)\n");
+        printf("  --record   record the controller input latched during this run to a movie\n");
+        printf("  --branch   after the budget is used up, fork a child process per input script\n");
+        printf("             (may be repeated) and report the frame hash of each branch\n");
+        printf("  --branch-frames     number of frames to simulate in each branch\n");
+        printf("  --branch-processes  maximum number of branches running at once (default: number of cores)\n");
+        printf("  --manifest run the golden-frame regression tests in <manifest>, sharded across processes,\n");
+        printf("             and write the frame of each mismatch into the --output directory\n");
+        printf("  --manifest-processes  maximum number of tests running at once (default: number of cores)\n");
+        printf("  --manifest-record     write a copy of <manifest> with the hash of every checkpoint as simulated\n");
+        printf("                        (i.e. record golden hashes), and write the frame of each checkpoint into --output\n");
+        printf("\n");
+        printf("  --ticks / --frames are counted from the start of this run (i.e. after loading a snapshot)\n");
+    }
+}
+
+namespace emulator {
+    /// @brief options of EmulatorNESHeadless, parsed from the command line
+    struct HeadlessOptions {
+        std::string romPath;
+        std::string outputPath;
+        uint64_t maxTicks = 0;                  // 0 = no limit
+        uint64_t maxFrames = 0;                 // 0 = no limit
+        size_t traceRingSize = 0;               // 0 = no post-mortem trace
+        std::string snapshotDirectory = "snapshots";
+        std::string loadSnapshotKey;            // empty = start from reset
+        std::string saveSnapshotKey;            // empty = don't save
+        std::string replayMoviePath;            // empty = no controller input
+        std::string recordMoviePath;            // empty = don't record
+        std::vector<std::string> branchScripts; // empty = don't branch
+        uint64_t branchFrames = 0;
+        size_t branchProcesses = 0;             // 0 = number of cores
+        std::string manifestPath;               // empty = don't run regression tests
+        size_t manifestProcesses = 0;           // 0 = number of cores
+        std::string manifestRecordPath;         // empty = check the hashes of the manifest
+        bool isFast = false;                    // simulate NESFast, rather than NES
+    };
+
+    /// @class NESCore
+    /// @brief the NES model, with the debug ports to detect a CPU error + keep a post-mortem trace
+    struct NESCore {
+        typedef NESTestBench TestBench;
+        typedef VNES Core;
+        typedef TraceRing<NESTraceStep> Recorder;
+        static const bool kHasDebugPorts = true;
+    };
+
+    /// @class NESFastCore
+    /// @brief the NESFast model, for throughput, without the debug ports (see NESFast.v)
+    struct NESFastCore {
+        typedef NESFastTestBench TestBench;
+        typedef VNESFast Core;
+        typedef NullRecorder Recorder;
+        static const bool kHasDebugPorts = false;
+    };
+
+    /// @class EmulatorNESHeadless
+    /// @brief Run the NES simulation without a renderer, as fast as the host allows
+    /// @param NES_CORE the model to simulate (NESCore or NESFastCore)
+    template <class NES_CORE>
+    class EmulatorNESHeadless
+    {
+    public:
+        typedef HeadlessOptions Options;
+
+        /// @brief result of a regression test, sent from child to parent process
+        struct RegressionResult {
+            // note: the result must fit in a pipe buffer (see ForkFanOut)
+            static const size_t kMaxHashes = 256;
+
+            uint32_t numChecks;
+            uint32_t numMismatches;
+            uint64_t numFrames;
+            uint64_t firstMismatchFrame;
+            uint64_t firstMismatchHash;
+            uint8_t isLoaded;
+            uint8_t hasErrored;
+            uint64_t hashes[kMaxHashes];            // hash of each checkpoint that was checked
+        };
+
+        EmulatorNESHeadless() : sram(0x0800), vram(0x1000), bus(cpuMemory, ppuMemory), simulation(testBench, bus) {
+        }
+
+        /// @brief initialise the simulation, and load the ROM
+        /// @return false if the ROM could not be loaded
+        bool init(const Options& inOptions) {
+            options = inOptions;
+
+            initSimulation();
+
+            if (!loadRom(options.romPath)) {
+                return false;
+            }
+
+            if (!initMovie()) {
+                return false;
+            }
+
+            reset();
+
+            if (!options.loadSnapshotKey.empty()) {
+                if (!loadSnapshot(options.loadSnapshotKey)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// @brief simulate until the tick/frame budget is used up, or the core errors
+        /// @return process exit code
+        int run() {
+            startTicks = numTicks;
+            startCpuCycles = numCpuCycles;
+            startFrames = numFrames;
+
+            auto start = std::chrono::steady_clock::now();
+
+            while (!isBudgetUsed()) {
+                simulateTick();
+
+                if (hasCoreErrored() || bus.hasUnsupportedWrite()) {
+                    break;
+                }
+            }
+
+            auto end = std::chrono::steady_clock::now();
+            elapsedSeconds = std::chrono::duration<double>(end - start).count();
+
+            if (!movieRecorder.close()) {
+                printf("unable to write movie [%s]\n", options.recordMoviePath.c_str());
+            }
+
+            int exitCode = 0;
+
+            if (bus.hasUnsupportedWrite()) {
+                printf("write to read-only memory not supported!\n");
+                exitCode = 2;
+            }
+
+            if (hasCoreErrored()) {
+                printf("error! tick (%llu) frame (%llu)\n", (unsigned long long) numTicks, (unsigned long long) numFrames);
+                exitCode = 2;
+
+                if constexpr (NES_CORE::kHasDebugPorts) {
+                    if (traceRing) {
+                        // post-mortem of the steps leading up to the error
+                        std::cout << traceRing->toTrace() << std::endl;
+                    }
+                }
+            }
+
+            printStats(stdout);
+
+            if ((exitCode == 0) && !options.saveSnapshotKey.empty()) {
+                if (!saveSnapshot(options.saveSnapshotKey)) {
+                    exitCode = 1;
+                }
+            }
+
+            if (!options.outputPath.empty()) {
+                if (!writeOutput()) {
+                    exitCode = 1;
+                }
+            }
+
+            if ((exitCode == 0) && !options.branchScripts.empty()) {
+                exitCode = runBranches();
+            }
+
+            return exitCode;
+        }
+
+        /// @brief run each entry of the regression manifest in a child process, with its own simulation
+        /// @return process exit code
+        static int runRegression(const Options& options) {
+            RegressionManifest manifest;
+            if (!manifest.load(options.manifestPath)) {
+                printf("unable to load manifest: %s\n", manifest.error().c_str());
+                return 1;
+            }
+
+            auto& entries = manifest.entries();
+            const bool isRecording = !options.manifestRecordPath.empty();
+
+            if (isRecording) {
+                for (const RegressionEntry& entry : entries) {
+                    if (entry.checkpoints.size() > RegressionResult::kMaxHashes) {
+                        printf("unable to record manifest: line %d has more than %zu checkpoints\n", entry.lineNumber, RegressionResult::kMaxHashes);
+                        return 1;
+                    }
+                }
+            }
+
+            size_t maxProcesses = options.manifestProcesses;
+            if (maxProcesses == 0) {
+                maxProcesses = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            // note: the default (single-threaded) Verilator runtime does not support running models
+            //       concurrently from several threads, so each test runs in a process of its own
+            auto tests = ForkFanOut<RegressionResult>::run(entries.size(), maxProcesses, [&](size_t index) {
+                Options testOptions;
+                testOptions.romPath = entries[index].romPath;
+                testOptions.replayMoviePath = entries[index].moviePath;
+                testOptions.outputPath = options.outputPath;
+                testOptions.manifestRecordPath = options.manifestRecordPath;
+                testOptions.isFast = options.isFast;
+
+                // note: the Verilated model is too large for the stack
+                auto emulator = std::make_unique<EmulatorNESHeadless>();
+
+                RegressionResult result = {};
+                if (emulator->init(testOptions)) {
+                    result = emulator->runCheckpoints(entries[index], index);
+                }
+
+                return result;
+            });
+
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+
+            printf("\n%zu tests in %.3f seconds (%zu processes)\n", tests.size(), seconds, maxProcesses);
+            printf("test  result  checks  frames  first mismatch (frame: actual hash)   rom\n");
+
+            size_t numFailed = 0;
+
+            for (size_t i = 0; i < tests.size(); i++) {
+                const auto& test = tests[i];
+                const char* romPath = entries[i].romPath.c_str();
+
+                if (test.startError != 0) {
+                    printf("%-4zu  error   (not started: %s)  %s\n", i, strerror(test.startError), romPath);
+                    numFailed += 1;
+                    continue;
+                }
+
+                if (!test.isComplete) {
+                    printf("%-4zu  crash   (no result, status %d)  %s\n", i, test.exitStatus, romPath);
+                    numFailed += 1;
+                    continue;
+                }
+
+                const RegressionResult& result = test.result;
+
+                if (!result.isLoaded) {
+                    printf("%-4zu  error   (unable to load)  %s\n", i, romPath);
+                    numFailed += 1;
+                    continue;
+                }
+
+                const char* status = "pass";
+                if (result.hasErrored) {
+                    status = "error";
+                } else if (isRecording) {
+                    status = "record";
+                } else if (result.numMismatches > 0) {
+                    status = "FAIL";
+                }
+
+                if (result.numMismatches > 0) {
+                    printf("%-4zu  %-6s  %u/%-4u  %-6llu  %-6llu: 0x%016llx  %s\n", i, status, result.numChecks - result.numMismatches, result.numChecks, (unsigned long long) result.numFrames, (unsigned long long) result.firstMismatchFrame, (unsigned long long) result.firstMismatchHash, romPath);
+                } else {
+                    printf("%-4zu  %-6s  %u/%-4u  %-6llu  -                           %s\n", i, status, result.numChecks - result.numMismatches, result.numChecks, (unsigned long long) result.numFrames, romPath);
+                }
+
+                if (result.hasErrored || (!isRecording && (result.numMismatches > 0))) {
+                    numFailed += 1;
+                    continue;
+                }
+
+                if (isRecording) {
+                    for (uint32_t check = 0; check < result.numChecks; check++) {
+                        entries[i].checkpoints[check].hash = result.hashes[check];
+                        entries[i].checkpoints[check].hasHash = true;
+                    }
+                }
+            }
+
+            printf("\n%zu passed, %zu failed\n", tests.size() - numFailed, numFailed);
+
+            if (isRecording) {
+                // note: a test that failed keeps the hashes it had
+                if (!manifest.save(options.manifestRecordPath)) {
+                    printf("unable to record manifest: %s\n", manifest.error().c_str());
+                    return 1;
+                }
+
+                printf("recorded [%s]\n", options.manifestRecordPath.c_str());
+            }
+
+            return (numFailed == 0) ? 0 : 2;
+        }
+
+    private:
+        typedef typename NES_CORE::TestBench TestBench;
+        typedef typename NES_CORE::Core Core;
+        typedef typename NES_CORE::Recorder Recorder;
+
+        Options options;
+
+        TestBench testBench;
+        uint64_t numTicks = 0;
+        uint64_t numCpuCycles = 0;
+        uint64_t numFrames = 0;
+        double elapsedSeconds = 0.0;
+
+        // counters at the start of run(), e.g. after loading a snapshot
+        uint64_t startTicks = 0;
+        uint64_t startCpuCycles = 0;
+        uint64_t startFrames = 0;
+
+        // CPU RAM (2KB)
+        SRAM sram;
+
+        // PPU nametable RAM (0x2000:0x2FFF)
+        SRAM vram;
+
+        // CPU + PPU address spaces, decoded by page
+        PageTable cpuMemory;
+        PageTable ppuMemory;
+
+        // ROM image, with PRG + CHR banks mapped into the address spaces by the mapper
+        INESRom rom;
+        std::unique_ptr<Mapper> mapper;
+
+        // controller input, recorded / replayed by latch
+        InputMovieRecorder movieRecorder;
+        InputMovieReplayer movieReplayer;
+
+        // no buttons are pressed on controller 1
+        NESBus<Core> bus;
+        Simulation<TestBench, NESBus<Core>, Recorder> simulation;
+        std::unique_ptr<Recorder> traceRing;
+
+        // RGB888 packed into the low 24 bits of each pixel
+        std::vector<uint32_t> pixels;
+
+        bool wasFirstPixel = false;
+
+        void reset() {
+            mapper->reset();
+            bus.controller1().reset();
+            simulation.reset();
+
+            pixels.resize(kNESWidth * kNESHeight);
+            std::fill(pixels.begin(), pixels.end(), 0);
+        }
+
+        bool isBudgetUsed() const {
+            if ((options.maxTicks > 0) && ((numTicks - startTicks) >= options.maxTicks)) {
+                return true;
+            }
+
+            if ((options.maxFrames > 0) && ((numFrames - startFrames) >= options.maxFrames)) {
+                return true;
+            }
+
+            return false;
+        }
+
+        bool hasCoreErrored() {
+            if constexpr (NES_CORE::kHasDebugPorts) {
+                return testBench.core().o_cpu_debug_error == 1;
+            } else {
+                return false;
+            }
+        }
+
+        void simulateTick() {
+            auto& core = testBench.core();
+
+            simulation.tick();
+
+            numTicks += 1;
+
+            if (core.o_cpu_debug_clk_en) {
+                numCpuCycles += 1;
+            }
+
+            // the PPU holds each pixel for several ticks, so only count
+            //  a frame on the tick that first enters pixel (0,0)
+            bool isFirstPixel = (core.o_video_x == 0) && (core.o_video_y == 0);
+            if (isFirstPixel && !wasFirstPixel) {
+                numFrames += 1;
+            }
+            wasFirstPixel = isFirstPixel;
+
+            if (core.o_video_visible == 1) {
+                uint32_t pixel = (uint32_t(core.o_video_red) << 16) | (uint32_t(core.o_video_green) << 8) | uint32_t(core.o_video_blue);
+                pixels[core.o_video_x + (core.o_video_y * kNESWidth)] = pixel;
+            }
+        }
+
+        void printStats(FILE* file) {
+            double seconds = (elapsedSeconds > 0.0) ? elapsedSeconds : 1e-9;
+
+            fprintf(file, "rom           %s\n", options.romPath.c_str());
+            fprintf(file, "ticks         %llu\n", (unsigned long long) numTicks);
+            fprintf(file, "cpu cycles    %llu\n", (unsigned long long) numCpuCycles);
+            fprintf(file, "frames        %llu\n", (unsigned long long) numFrames);
+            fprintf(file, "seconds       %.3f\n", elapsedSeconds);
+            fprintf(file, "ticks/sec     %.1f\n", double(numTicks - startTicks) / seconds);
+            fprintf(file, "cpu cycles/sec %.1f\n", double(numCpuCycles - startCpuCycles) / seconds);
+            fprintf(file, "frames/sec    %.3f\n", double(numFrames - startFrames) / seconds);
+        }
+
+        bool writeOutput() {
+            std::error_code error;
+            std::filesystem::create_directories(options.outputPath, error);
+            if (error) {
+                printf("unable to create output directory [%s]\n", options.outputPath.c_str());
+                return false;
+            }
+
+            std::filesystem::path outputPath(options.outputPath);
+
+            std::string statsPath = (outputPath / "stats.txt").string();
+            FILE* statsFile = fopen(statsPath.c_str(), "w");
+            if (statsFile == nullptr) {
+                printf("unable to write [%s]\n", statsPath.c_str());
+                return false;
+            }
+            printStats(statsFile);
+            fclose(statsFile);
+
+            char filename[64];
+            sprintf(filename, "frame_%06llu.ppm", (unsigned long long) numFrames);
+            std::string framePath = (outputPath / filename).string();
+
+            return writeFrame(framePath);
+        }
+
+        /// @brief write the pixel buffer as a binary PPM image
+        bool writeFrame(const std::string& path) {
+            FILE* file = fopen(path.c_str(), "wb");
+            if (file == nullptr) {
+                printf("unable to write [%s]\n", path.c_str());
+                return false;
+            }
+
+            fprintf(file, "P6\n%d %d\n255\n", kNESWidth, kNESHeight);
+
+            std::vector<uint8_t> row(kNESWidth * 3);
+            for (int y = 0; y < kNESHeight; y++) {
+                for (int x = 0; x < kNESWidth; x++) {
+                    uint32_t pixel = pixels[x + (y * kNESWidth)];
+                    row[(x * 3) + 0] = (pixel >> 16) & 0xff;
+                    row[(x * 3) + 1] = (pixel >> 8) & 0xff;
+                    row[(x * 3) + 2] = pixel & 0xff;
+                }
+                fwrite(row.data(), 1, row.size(), file);
+            }
+
+            fclose(file);
+
+            return true;
+        }
+
+        void initSimulation() {
+            testBench.setClockPolarity(0);
+
+            testBench.core().i_ce = 1;
+
+            sram.clear(0);
+            vram.clear(0);
+
+            // note: CPUMemoryMap mirrors RAM into 0x0000:0x07FF
+            cpuMemory.map(0x0000, sram.size(), sram.data());
+
+            // note: the mapper arranges vram into the nametables
+
+            simulation.setTraceMode(TraceMode::kNone);
+
+            if constexpr (NES_CORE::kHasDebugPorts) {
+                if (options.traceRingSize > 0) {
+                    traceRing = std::make_unique<Recorder>(options.traceRingSize);
+                    simulation.setRecorder(traceRing.get());
+                }
+            }
+        }
+
+        /// @brief result of a branch, sent from child to parent process
+        struct BranchResult {
+            uint64_t numTicks;
+            uint64_t numFrames;
+            uint64_t frameHash;
+            uint8_t hasErrored;
+        };
+
+        /// @brief branch the simulation into a child process for each input script,
+        ///        sharing the common prefix that has already been simulated
+        /// @return process exit code
+        int runBranches() {
+            std::vector<InputScript> scripts(options.branchScripts.size());
+
+            for (size_t i = 0; i < scripts.size(); i++) {
+                if (!scripts[i].load(options.branchScripts[i])) {
+                    printf("unable to load input script: %s\n", scripts[i].error().c_str());
+                    return 1;
+                }
+            }
+
+            size_t maxProcesses = options.branchProcesses;
+            if (maxProcesses == 0) {
+                maxProcesses = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            auto branches = ForkFanOut<BranchResult>::run(scripts.size(), maxProcesses, [&](size_t index) {
+                return runBranch(scripts[index]);
+            });
+
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+
+            printf("\n%zu branches of %llu frames in %.3f seconds (%zu processes)\n", branches.size(), (unsigned long long) options.branchFrames, seconds, maxProcesses);
+            printf("branch  ticks       frames  error  frame hash          script\n");
+
+            int exitCode = 0;
+
+            for (size_t i = 0; i < branches.size(); i++) {
+                const auto& branch = branches[i];
+
+                if (branch.startError != 0) {
+                    printf("%-6zu  (not started: %s)  %s\n", i, strerror(branch.startError), options.branchScripts[i].c_str());
+                    exitCode = 2;
+                    continue;
+                }
+
+                if (!branch.isComplete) {
+                    printf("%-6zu  (no result, status %d)  %s\n", i, branch.exitStatus, options.branchScripts[i].c_str());
+                    exitCode = 2;
+                    continue;
+                }
+
+                const BranchResult& result = branch.result;
+                printf("%-6zu  %-10llu  %-6llu  %-5s  0x%016llx  %s\n", i, (unsigned long long) result.numTicks, (unsigned long long) result.numFrames, result.hasErrored ? "yes" : "no", (unsigned long long) result.frameHash, options.branchScripts[i].c_str());
+
+                if (result.hasErrored) {
+                    exitCode = 2;
+                }
+            }
+
+            return exitCode;
+        }
+
+        /// @brief simulate a branch (in the child process), with input from a script
+        /// @note script frame numbers are relative to the start of the branch
+        BranchResult runBranch(const InputScript& script) {
+            uint64_t branchStartFrame = numFrames;
+            uint64_t endFrame = numFrames + options.branchFrames;
+            uint64_t frame = numFrames;
+
+            bus.controller1().setButtons(script.buttons(0));
+
+            while (numFrames < endFrame) {
+                simulateTick();
+
+                if (hasCoreErrored() || bus.hasUnsupportedWrite()) {
+                    break;
+                }
+
+                if (numFrames != frame) {
+                    frame = numFrames;
+                    bus.controller1().setButtons(script.buttons(frame - branchStartFrame));
+                }
+            }
+
+            BranchResult result;
+            result.numTicks = numTicks;
+            result.numFrames = numFrames;
+            result.frameHash = hashFrame();
+            result.hasErrored = (hasCoreErrored() || bus.hasUnsupportedWrite()) ? 1 : 0;
+
+            return result;
+        }
+
+        /// @brief simulate up to the last checkpoint of a regression test, hashing the pixel buffer
+        ///        at each checkpoint, and writing a frame that doesn't match (or every frame, when
+        ///        recording) into the output directory
+        RegressionResult runCheckpoints(const RegressionEntry& entry, size_t index) {
+            const bool isRecording = !options.manifestRecordPath.empty();
+
+            RegressionResult result = {};
+            result.isLoaded = 1;
+
+            for (const FrameCheckpoint& checkpoint : entry.checkpoints) {
+                while ((numFrames < checkpoint.frame) && !result.hasErrored) {
+                    simulateTick();
+
+                    result.hasErrored = (hasCoreErrored() || bus.hasUnsupportedWrite()) ? 1 : 0;
+                }
+
+                if (result.hasErrored) {
+                    break;
+                }
+
+                uint64_t hash = hashFrame();
+
+                if (result.numChecks < RegressionResult::kMaxHashes) {
+                    result.hashes[result.numChecks] = hash;
+                }
+                result.numChecks += 1;
+
+                bool isMatch = checkpoint.hasHash && (hash == checkpoint.hash);
+
+                if (!isMatch) {
+                    if (result.numMismatches == 0) {
+                        result.firstMismatchFrame = checkpoint.frame;
+                        result.firstMismatchHash = hash;
+                    }
+                    result.numMismatches += 1;
+                }
+
+                if ((!isMatch || isRecording) && !options.outputPath.empty()) {
+                    std::error_code error;
+                    std::filesystem::create_directories(options.outputPath, error);
+
+                    char filename[64];
+                    sprintf(filename, "test_%03zu_frame_%06llu.ppm", index, (unsigned long long) checkpoint.frame);
+                    std::string framePath = (std::filesystem::path(options.outputPath) / filename).string();
+
+                    if (writeFrame(framePath)) {
+                        printf("%s [%s] frame (%llu), wrote [%s]\n", isMatch ? "checkpoint" : "mismatch", entry.romPath.c_str(), (unsigned long long) checkpoint.frame, framePath.c_str());
+                    }
+                }
+            }
+
+            result.numFrames = numFrames;
+
+            return result;
+        }
+
+        /// @brief FNV-1a hash of the pixel buffer
+        uint64_t hashFrame() const {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+
+            for (uint32_t pixel : pixels) {
+                for (int i = 0; i < 3; i++) {
+                    hash = (hash ^ ((pixel >> (i * 8)) & 0xff)) * 0x100000001b3ULL;
+                }
+            }
+
+            return hash;
+        }
+
+        bool initMovie() {
+            if (!options.replayMoviePath.empty()) {
+                if (!movieReplayer.open(options.replayMoviePath)) {
+                    printf("unable to replay movie: %s\n", movieReplayer.error().c_str());
+                    return false;
+                }
+
+                bus.controller1().setLatchHandler(&movieReplayer);
+            } else if (!options.recordMoviePath.empty()) {
+                if (!movieRecorder.open(options.recordMoviePath)) {
+                    printf("unable to record movie: %s\n", movieRecorder.error().c_str());
+                    return false;
+                }
+
+                bus.controller1().setLatchHandler(&movieRecorder);
+            }
+
+            return true;
+        }
+
+        bool saveSnapshot(const std::string& key) {
+            std::error_code errorCode;
+            std::filesystem::create_directories(options.snapshotDirectory, errorCode);
+
+            NESSnapshot::Counters counters;
+            counters.numTicks = numTicks;
+            counters.numCpuCycles = numCpuCycles;
+            counters.numFrames = numFrames;
+
+            std::string path = NESSnapshot::path(options.snapshotDirectory, key);
+            std::string error;
+            if (!NESSnapshot::save(path, testBench.core(), rom, sram, vram, *mapper, bus.controller1(), counters, error)) {
+                printf("unable to save snapshot: %s\n", error.c_str());
+                return false;
+            }
+
+            printf("saved snapshot [%s]\n", path.c_str());
+
+            return true;
+        }
+
+        bool loadSnapshot(const std::string& key) {
+            NESSnapshot::Counters counters;
+
+            std::string path = NESSnapshot::path(options.snapshotDirectory, key);
+            std::string error;
+            if (!NESSnapshot::load(path, testBench.core(), rom, sram, vram, *mapper, bus.controller1(), counters, error)) {
+                printf("unable to load snapshot: %s\n", error.c_str());
+                return false;
+            }
+
+            // note: the recording continues from the snapshot
+            if (movieRecorder.isOpen() && !movieRecorder.rewind(bus.controller1().numLatches())) {
+                printf("unable to rewind movie: %s\n", movieRecorder.error().c_str());
+                return false;
+            }
+
+            numTicks = counters.numTicks;
+            numCpuCycles = counters.numCpuCycles;
+            numFrames = counters.numFrames;
+
+            auto& core = testBench.core();
+            wasFirstPixel = (core.o_video_x == 0) && (core.o_video_y == 0);
+
+            return true;
+        }
+
+        /// @brief map an iNES ROM image into the CPU + PPU address spaces, via its mapper
+        bool loadRom(const std::string& romPath) {
+            if (!rom.open(romPath)) {
+                printf("unable to load ROM: %s\n", rom.error().c_str());
+                return false;
+            }
+
+            std::string error;
+            mapper = Mapper::create(rom, cpuMemory, ppuMemory, vram.data(), error);
+            if (!mapper) {
+                printf("unsupported ROM [%s]: %s\n", romPath.c_str(), error.c_str());
+                return false;
+            }
+
+            return true;
+        }
+    };
+}
+
+namespace {
+    template <class NES_CORE>
+    int run(const emulator::HeadlessOptions& options) {
+        typedef emulator::EmulatorNESHeadless<NES_CORE> EmulatorNESHeadless;
+
+        if (!options.manifestPath.empty()) {
+            return EmulatorNESHeadless::runRegression(options);
+        }
+
+        // note: the Verilated model is too large for the stack
+        auto emulator = std::make_unique<EmulatorNESHeadless>();
+
+        if (!emulator->init(options)) {
+            return 1;
+        }
+
+        return emulator->run();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    emulator::HeadlessOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1) < argc;
+
+        if ((strcmp(argv[i], "--rom") == 0) && hasValue) {
+            options.romPath = argv[++i];
+        } else if ((strcmp(argv[i], "--ticks") == 0) && hasValue) {
+            options.maxTicks = strtoull(argv[++i], nullptr, 10);
+        } else if ((strcmp(argv[i], "--frames") == 0) && hasValue) {
+            options.maxFrames = strtoull(argv[++i], nullptr, 10);
+        } else if ((strcmp(argv[i], "--output") == 0) && hasValue) {
+            options.outputPath = argv[++i];
+        } else if ((strcmp(argv[i], "--trace-ring") == 0) && hasValue) {
+            options.traceRingSize = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            options.isFast = true;
+        } else if ((strcmp(argv[i], "--replay") == 0) && hasValue) {
+            options.replayMoviePath = argv[++i];
+        } else if ((strcmp(argv[i], "--record") == 0) && hasValue) {
+            options.recordMoviePath = argv[++i];
+        } else if ((strcmp(argv[i], "--branch") == 0) && hasValue) {
+            options.branchScripts.push_back(argv[++i]);
+        } else if ((strcmp(argv[i], "--branch-frames") == 0) && hasValue) {
+            options.branchFrames = strtoull(argv[++i], nullptr, 10);
+        } else if ((strcmp(argv[i], "--branch-processes") == 0) && hasValue) {
+            options.branchProcesses = strtoull(argv[++i], nullptr, 10);
+        } else if ((strcmp(argv[i], "--manifest") == 0) && hasValue) {
+            options.manifestPath = argv[++i];
+        } else if ((strcmp(argv[i], "--manifest-processes") == 0) && hasValue) {
+            options.manifestProcesses = strtoull(argv[++i], nullptr, 10);
+        } else if ((strcmp(argv[i], "--manifest-record") == 0) && hasValue) {
+            options.manifestRecordPath = argv[++i];
+        } else if ((strcmp(argv[i], "--snapshot-dir") == 0) && hasValue) {
+            options.snapshotDirectory = argv[++i];
+        } else if ((strcmp(argv[i], "--load-snapshot") == 0) && hasValue) {
+            options.loadSnapshotKey = argv[++i];
+        } else if ((strcmp(argv[i], "--save-snapshot") == 0) && hasValue) {
+            options.saveSnapshotKey = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.isFast && (options.traceRingSize > 0)) {
+        // NESFast has no debug ports to trace
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!options.manifestPath.empty()) {
+        return options.isFast ? run<emulator::NESFastCore>(options) : run<emulator::NESCore>(options);
+    }
+
+    if (options.romPath.empty() || ((options.maxTicks == 0) && (options.maxFrames == 0))) {
+        // refuse to run forever without a budget
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!options.branchScripts.empty() && (options.branchFrames == 0)) {
+        // branches need a budget too
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    return options.isFast ? run<emulator::NESFastCore>(options) : run<emulator::NESCore>(options);
+}
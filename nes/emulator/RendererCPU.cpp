@@ -1,6 +1,8 @@
 #include "nes/emulator/RendererCPU.hpp"
 #include "nes/cpu6502/ProcessorStatusFlags.hpp"
 
+#include <algorithm>
+
 using namespace cpu6502;
 
 namespace {
@@ -97,17 +99,36 @@ namespace emulator {
         }
     }
 
-    void RendererCPU::drawDisassembly(olc::PixelGameEngine& engine, int x, int y, const cpu6502::assembler::Disassembler::DisassembledOpcodes& opcodes) {
+    void RendererCPU::drawDisassembly(olc::PixelGameEngine& engine, int x, int y, std::span<const cpu6502::assembler::Disassembler::DisassembledOpcode> opcodes, const cpu6502::assembler::DisassemblyCache& disassemblyCache) {
         engine.DrawString({ x, y }, "Disassembly", olc::RED);
         y += kRowHeight;
 
-        engine.DrawString({ x, y}, ">", olc::RED);
-    
+        // note: labels (from a code map) take a row, so fewer opcodes are shown
+        size_t numRows = 0;
+
         for (auto& opcode: opcodes) {
+            char label[32];
+            if (disassemblyCache.formatLabel(opcode.pc, label, sizeof(label))) {
+                if (++numRows > opcodes.size()) {
+                    break;
+                }
+
+                engine.DrawString({ x + 10, y }, PrepareString("%s:", label), olc::DARK_BLUE);
+                y += kRowHeight;
+            }
+
+            if (++numRows > opcodes.size()) {
+                break;
+            }
+
+            if (&opcode == &opcodes[0]) {
+                engine.DrawString({ x, y}, ">", olc::RED);
+            }
+
+            char strOpcode[32];
+            opcode.format(strOpcode, sizeof(strOpcode));
             
-            std::string strOpcode = opcode.labelOpcode + " " + opcode.labelOperands;
-            
-            engine.DrawString({ x + 10, y }, PrepareString("0x%04x %s", opcode.pc, strOpcode.c_str()), olc::BLACK);
+            engine.DrawString({ x + 10, y }, PrepareString("0x%04x %s", opcode.pc, strOpcode), olc::BLACK);
             y += kRowHeight;
         }
     }
@@ -156,15 +177,19 @@ namespace emulator {
         int numTicks = int(trace.getSteps().size() / 2);
         engine.DrawString({x, y}, PrepareString("%d clock cycles", numTicks), olc::BLACK);
         y += kRowHeight;
+
+        char strOpcode[32];
+        opcode.format(strOpcode, sizeof(strOpcode));
+
         engine.DrawString({x, y}, PrepareString("0x%04x:  %-16s # 0x%02X, %d bytes", 
                                         opcode.pc,
-                                        (opcode.labelOpcode + " " + opcode.labelOperands).c_str(),
+                                        strOpcode,
                                         opcode.opcode,
                                         int(opcode.byteSize)
                                         ), olc::BLACK);
 
         y += kRowHeight;
-        for (size_t i=0; i < opcode.data.size(); i++) {
+        for (size_t i=0; i < std::min<size_t>(opcode.byteSize, cpu6502::assembler::Disassembler::DisassembledOpcode::kMaxBytes); i++) {
             engine.DrawString({x + (9 * kCharWidth) + int(i * 5 * kCharWidth), y}, PrepareString("0x%02X", opcode.data[i]), olc::BLACK);
         }
 
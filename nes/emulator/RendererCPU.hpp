@@ -4,6 +4,7 @@
 
 #include "nes/Cpu6502TestBench.h"
 #include "nes/cpu6502/assembler/Disassembler.hpp"
+#include "nes/cpu6502/assembler/DisassemblyCache.hpp"
 
 namespace emulator {
 
@@ -12,7 +13,7 @@ namespace emulator {
         void drawTitle(olc::PixelGameEngine& engine, int x, int y);
         void drawCPU(olc::PixelGameEngine& engine, int x, int y, cpu6502testbench::Cpu6502TestBench& testBench);
         void drawTestBench(olc::PixelGameEngine& engine, int x, int y, cpu6502testbench::Cpu6502TestBench& testBench, int numOpcodes);
-        void drawDisassembly(olc::PixelGameEngine& engine, int x, int y, const cpu6502::assembler::Disassembler::DisassembledOpcodes& opcodes);
+        void drawDisassembly(olc::PixelGameEngine& engine, int x, int y, std::span<const cpu6502::assembler::Disassembler::DisassembledOpcode> opcodes, const cpu6502::assembler::DisassemblyCache& disassemblyCache);
         void drawStack(olc::PixelGameEngine& engine, int x, int y, cpu6502testbench::Cpu6502TestBench& testBench, const memory::SRAM& sram);
         void drawMemory(olc::PixelGameEngine& engine, int x, int y, const memory::SRAM& sram);
         void drawLastOpcodeTrace(olc::PixelGameEngine& engine, int x, int y, const gtestverilog::Trace& trace, const cpu6502::assembler::Disassembler::DisassembledOpcode& opcode);
@@ -0,0 +1,200 @@
+#include "nes/cartridge/INESRom.hpp"
+#include "nes/memory/SRAM.hpp"
+#include "nes/cpu6502/assembler/CodeMap.hpp"
+#include "nes/cpu6502/assembler/Disassembler.hpp"
+#include "nes/cpu6502/assembler/StaticDisassembler.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace cpu6502::assembler;
+using namespace cartridge;
+using namespace memory;
+
+namespace {
+    struct Options {
+        std::string romPath;
+        std::string prgPath;
+        std::string outputPath;                 // empty = don't write
+        std::string listingPath;                // empty = don't write
+        size_t numThreads = 0;                  // 0 = number of cores
+    };
+
+    void printUsage(const char* program) {
+        printf("usage: %s (--rom <rom.nes> | --prg <prg rom>) [--output <code map>] [--listing <path>] [--threads <n>]\n", program);
+        printf("\n");
+        printf("  --rom       iNES ROM image\n");
+        printf("  --prg       PRG ROM image\n");
+        printf("  --output    write the code map (code/data of each bank, and labels), e.g. for emulator-cpu --code-map\n");
+        printf("  --listing   write a listing of each bank (\"-\" for stdout)\n");
+        printf("  --threads   maximum number of banks disassembled at once (default: number of cores)\n");
+    }
+
+    /// @brief write a bank as code (with labels) where the code map has found code, and data elsewhere
+    void writeListing(FILE* file, const StaticDisassembler::Bank& bank, const CodeMap& codeMap) {
+        const size_t kMaxDataPerLine = 8;
+
+        fprintf(file, "; bank %zu (0x%04X:0x%04X)\n", codeMap.bank(), bank.baseAddress, unsigned(bank.baseAddress + bank.data.size() - 1));
+
+        size_t offset = 0;
+
+        while (offset < bank.data.size()) {
+            const uint16_t pc = uint16_t(bank.baseAddress + offset);
+
+            char label[32];
+            if (codeMap.formatLabel(pc, label, sizeof(label))) {
+                fprintf(file, "%s:\n", label);
+            }
+
+            if (codeMap.isOpcode(pc)) {
+                Disassembler::DisassembledOpcode opcode;
+                Disassembler::disassembleOpcode(bank.data, bank.baseAddress, pc, opcode);
+
+                char bytes[16] = "";
+                for (size_t i = 0; i < opcode.byteSize; i++) {
+                    snprintf(bytes + (i * 3), sizeof(bytes) - (i * 3), "%02X ", opcode.data[i]);
+                }
+
+                char text[32];
+                opcode.format(text, sizeof(text));
+
+                fprintf(file, "%04X  %-9s  %s\n", pc, bytes, text);
+                offset += opcode.byteSize;
+                continue;
+            }
+
+            // data, up to the next opcode or label
+            fprintf(file, "%04X  .byte ", pc);
+
+            size_t numBytes = 0;
+
+            do {
+                fprintf(file, "%s$%02X", (numBytes == 0) ? "" : ",", bank.data[offset]);
+                numBytes++;
+                offset++;
+            } while ((numBytes < kMaxDataPerLine) && (offset < bank.data.size()) &&
+                     !codeMap.isCode(uint16_t(bank.baseAddress + offset)) && (codeMap.labelFlags(uint16_t(bank.baseAddress + offset)) == 0));
+
+            fprintf(file, "\n");
+        }
+
+        fprintf(file, "\n");
+    }
+
+    int run(const Options& options) {
+        // the image needs to stay mapped while its banks are disassembled
+        INESRom rom;
+        std::unique_ptr<SRAM> prgFile;
+        std::span<const uint8_t> prgRom;
+
+        if (!options.romPath.empty()) {
+            if (!rom.open(options.romPath)) {
+                printf("unable to load rom: %s\n", rom.error().c_str());
+                return 1;
+            }
+
+            prgRom = rom.prgRom();
+        } else {
+            std::string error;
+            prgFile = SRAM::mapFile(options.prgPath, error);
+            if (!prgFile) {
+                printf("unable to load binary: %s\n", error.c_str());
+                return 1;
+            }
+
+            prgRom = prgFile->span();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        const std::vector<StaticDisassembler::Bank> banks = StaticDisassembler::banksOf(prgRom);
+
+        StaticDisassembler disassembler(options.numThreads);
+        const std::vector<CodeMap> codeMaps = disassembler.disassemble(banks);
+
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+
+        for (const CodeMap& codeMap: codeMaps) {
+            printf("bank %2zu  0x%04X:0x%04X  %6zu / %zu bytes of code, %5zu opcodes, %4zu labels\n",
+                    codeMap.bank(),
+                    codeMap.baseAddress(),
+                    unsigned(codeMap.baseAddress() + codeMap.size() - 1),
+                    codeMap.numCodeBytes(),
+                    codeMap.size(),
+                    codeMap.numOpcodes(),
+                    codeMap.numLabels());
+        }
+
+        const StaticDisassembler::Stats& stats = disassembler.stats();
+        printf("%zu banks in %.3f seconds (%zu rounds)\n", banks.size(), seconds, stats.numRounds);
+        printf("%zu unsupported opcodes, %zu conflicts, %zu indirect jumps not followed, %zu of %zu speculative targets rejected\n",
+                stats.numUnsupported,
+                stats.numConflicts,
+                stats.numIndirectJumps,
+                stats.numRejected,
+                stats.numSpeculative);
+
+        if (!options.outputPath.empty()) {
+            std::string error;
+            if (!CodeMap::save(options.outputPath, codeMaps, prgRom, error)) {
+                printf("unable to save code map: %s\n", error.c_str());
+                return 1;
+            }
+        }
+
+        if (!options.listingPath.empty()) {
+            FILE* file = (options.listingPath == "-") ? stdout : fopen(options.listingPath.c_str(), "w");
+            if (file == nullptr) {
+                printf("unable to open listing [%s]\n", options.listingPath.c_str());
+                return 1;
+            }
+
+            for (size_t i = 0; i < banks.size(); i++) {
+                writeListing(file, banks[i], codeMaps[i]);
+            }
+
+            if (file != stdout) {
+                fclose(file);
+            }
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1) < argc;
+
+        if ((strcmp(argv[i], "--rom") == 0) && hasValue) {
+            options.romPath = argv[++i];
+        } else if ((strcmp(argv[i], "--prg") == 0) && hasValue) {
+            options.prgPath = argv[++i];
+        } else if ((strcmp(argv[i], "--output") == 0) && hasValue) {
+            options.outputPath = argv[++i];
+        } else if ((strcmp(argv[i], "--listing") == 0) && hasValue) {
+            options.listingPath = argv[++i];
+        } else if ((strcmp(argv[i], "--threads") == 0) && hasValue) {
+            options.numThreads = strtoul(argv[++i], nullptr, 10);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.romPath.empty() == options.prgPath.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    return run(options);
+}
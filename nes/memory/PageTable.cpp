@@ -0,0 +1,121 @@
+#include "PageTable.hpp"
+
+#include <cassert>
+
+namespace memory {
+    PageTable::PageTable() : m_openBusValue(0xFF) {
+        clear();
+    }
+
+    void PageTable::map(uint16_t address, size_t size, uint8_t* memory, bool isWritable) {
+        assert(memory != nullptr);
+
+        for (size_t offset = 0; offset < size; offset += kPageSize) {
+            Page page {
+                .memory = memory + offset,
+                .isWritable = isWritable,
+                .handler = nullptr
+            };
+
+            setPages(address + offset, kPageSize, page);
+        }
+    }
+
+    void PageTable::map(uint16_t address, size_t size, const uint8_t* memory) {
+        // note: read-only pages are never written through
+        map(address, size, const_cast<uint8_t*>(memory), false);
+    }
+
+    void PageTable::map(uint16_t address, size_t size, const uint8_t* memory, PageHandler* writeHandler) {
+        assert(memory != nullptr);
+        assert(writeHandler != nullptr);
+
+        for (size_t offset = 0; offset < size; offset += kPageSize) {
+            // note: read-only pages are never written through
+            Page page {
+                .memory = const_cast<uint8_t*>(memory) + offset,
+                .isWritable = false,
+                .handler = writeHandler
+            };
+
+            setPages(address + offset, kPageSize, page);
+        }
+    }
+
+    void PageTable::map(uint16_t address, size_t size, PageHandler* handler) {
+        assert(handler != nullptr);
+
+        Page page {
+            .memory = nullptr,
+            .isWritable = false,
+            .handler = handler
+        };
+
+        setPages(address, size, page);
+    }
+
+    void PageTable::unmap(uint16_t address, size_t size) {
+        Page page {
+            .memory = nullptr,
+            .isWritable = false,
+            .handler = nullptr
+        };
+
+        setPages(address, size, page);
+    }
+
+    void PageTable::clear() {
+        unmap(0x0000, kPageSize * kNumPages);
+    }
+
+    void PageTable::setOpenBusValue(uint8_t value) {
+        m_openBusValue = value;
+    }
+
+    bool PageTable::isMapped(uint16_t address) const {
+        const Page& page = m_pages[address >> 8];
+
+        return (page.memory != nullptr) || (page.handler != nullptr);
+    }
+
+    bool PageTable::isWritable(uint16_t address) const {
+        const Page& page = m_pages[address >> 8];
+
+        return page.isWritable || (page.handler != nullptr);
+    }
+
+    const uint8_t* PageTable::pageMemory(uint16_t address) const {
+        return m_pages[address >> 8].memory;
+    }
+
+    uint8_t PageTable::readHandler(const Page& page, uint16_t address) const {
+        if (page.handler != nullptr) {
+            return page.handler->read(address);
+        }
+
+        return m_openBusValue;
+    }
+
+    bool PageTable::writeHandler(const Page& page, uint16_t address, uint8_t value) {
+        if (page.handler != nullptr) {
+            page.handler->write(address, value);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void PageTable::setPages(uint16_t address, size_t size, const Page& page) {
+        assert((address % kPageSize) == 0);
+        assert((size % kPageSize) == 0);
+        assert((size_t(address) + size) <= (kPageSize * kNumPages));
+
+        size_t firstPage = address / kPageSize;
+        size_t numPages = size / kPageSize;
+
+        for (size_t i = 0; i < numPages; i++) {
+            m_pages[firstPage + i] = page;
+        }
+    }
+}
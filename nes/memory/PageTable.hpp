@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace memory {
+    /// @class PageHandler
+    /// @brief Handle accesses to a page that is not backed by memory (e.g. memory mapped I/O)
+    class PageHandler {
+    public:
+        virtual ~PageHandler() {}
+
+        virtual uint8_t read(uint16_t address) = 0;
+        virtual void write(uint16_t address, uint8_t value) = 0;
+    };
+
+    /// @class PageTable
+    /// @brief 16bit address space, decoded through a table of 256 byte pages
+    /// @note Each page points directly at its backing memory, so that a read or write
+    ///       is a single indexed load. Mirroring and bank switching are done by 
+    ///       mapping pages onto the same (or different) memory, rather than copying.
+    class PageTable {
+    public:
+        static const size_t kPageSize = 0x100;
+        static const size_t kNumPages = 0x100;
+
+        PageTable();
+
+        /// @brief map a page aligned address range onto memory
+        /// @param address start of the range (multiple of kPageSize)
+        /// @param size size of the range in bytes (multiple of kPageSize)
+        /// @param memory memory to map the range onto, must outlive the mapping
+        /// @param isWritable can the core write to this memory
+        void map(uint16_t address, size_t size, uint8_t* memory, bool isWritable = true);
+
+        /// @brief map a page aligned address range onto read-only memory (e.g. ROM)
+        void map(uint16_t address, size_t size, const uint8_t* memory);
+
+        /// @brief map a page aligned address range onto read-only memory, with writes sent to a handler
+        ///        (e.g. PRG ROM, with mapper registers behind it)
+        void map(uint16_t address, size_t size, const uint8_t* memory, PageHandler* writeHandler);
+
+        /// @brief map a page aligned address range onto a handler (e.g. memory mapped I/O)
+        void map(uint16_t address, size_t size, PageHandler* handler);
+
+        /// @brief unmap a page aligned address range
+        /// @note reads from unmapped pages return the open bus value, writes are ignored
+        void unmap(uint16_t address, size_t size);
+
+        /// @brief unmap all pages
+        void clear();
+
+        /// @brief value returned when reading an unmapped page
+        void setOpenBusValue(uint8_t value);
+
+        bool isMapped(uint16_t address) const;
+        bool isWritable(uint16_t address) const;
+
+        /// @brief memory backing the page containing the address
+        /// @return nullptr if the page is unmapped, or handled
+        /// @note pages mirrored (or bank switched) onto the same memory return the same pointer
+        const uint8_t* pageMemory(uint16_t address) const;
+
+        /// @brief retrieve a byte at the specified address
+        uint8_t read(uint16_t address) const {
+            const Page& page = m_pages[address >> 8];
+
+            if (page.memory != nullptr) {
+                return page.memory[address & 0xff];
+            }
+
+            return readHandler(page, address);
+        }
+
+        /// @brief write a byte at the specified address
+        /// @return false if the address is read-only, or unmapped
+        bool write(uint16_t address, uint8_t value) {
+            const Page& page = m_pages[address >> 8];
+
+            if (page.isWritable) {
+                page.memory[address & 0xff] = value;
+
+                return true;
+            }
+
+            return writeHandler(page, address, value);
+        }
+
+    private:
+        struct Page {
+            uint8_t* memory;
+            bool isWritable;
+            PageHandler* handler;
+        };
+
+        uint8_t readHandler(const Page& page, uint16_t address) const;
+        bool writeHandler(const Page& page, uint16_t address, uint8_t value);
+
+        void setPages(uint16_t address, size_t size, const Page& page);
+
+        std::array<Page, kNumPages> m_pages;
+        uint8_t m_openBusValue;
+    };
+}
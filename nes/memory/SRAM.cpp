@@ -1,107 +1,322 @@
 #include "SRAM.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cctype>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace memory {
-    SRAM::SRAM(size_t size) {
-        memory = std::vector<uint8_t>(size);
+    SRAM::SRAM() {
+    }
+
+    SRAM::SRAM(size_t size) : storage(size), memory(storage.data()), memorySize(size) {
+    }
+
+    SRAM::SRAM(const SRAM& other) : storage(other.memory, other.memory + other.memorySize), memory(storage.data()), memorySize(other.memorySize) {
+        if (other.tracking != nullptr) {
+            tracking = std::make_unique<Tracking>(*other.tracking);
+        }
     }
 
     SRAM::~SRAM() {
+        unmap();
+    }
+
+    SRAM& SRAM::operator=(const SRAM& other) {
+        if (this != &other) {
+            unmap();
+
+            storage.assign(other.memory, other.memory + other.memorySize);
+            memory = storage.data();
+            memorySize = other.memorySize;
 
+            tracking = (other.tracking != nullptr) ? std::make_unique<Tracking>(*other.tracking) : nullptr;
+        }
+
+        return *this;
     }
 
-    size_t SRAM::size() const {
-        return memory.size();
+    std::unique_ptr<SRAM> SRAM::mapFile(const std::string& path, std::string& error) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "unable to open [" + path + "]: " + strerror(errno);
+            return nullptr;
+        }
+
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            error = "unable to stat [" + path + "]: " + strerror(errno);
+            close(fd);
+            return nullptr;
+        }
+
+        if (status.st_size == 0) {
+            error = "empty file [" + path + "]";
+            close(fd);
+            return nullptr;
+        }
+
+        // private + writable: pages are only copied if they are written to
+        size_t size = size_t(status.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (mapping == MAP_FAILED) {
+            error = "unable to map [" + path + "]: " + strerror(errno);
+            return nullptr;
+        }
+
+        std::unique_ptr<SRAM> sram(new SRAM());
+        sram->memory = static_cast<uint8_t*>(mapping);
+        sram->memorySize = size;
+        sram->mapping = mapping;
+
+        return sram;
     }
 
-    void SRAM::clear(uint8_t value) {
-        for (auto& memoryByte : memory) {
-            memoryByte = value;
+    void SRAM::unmap() {
+        if (mapping != nullptr) {
+            munmap(mapping, memorySize);
+            mapping = nullptr;
         }
     }
 
-    void SRAM::write(size_t address, uint8_t value) {
-        assert(address < memory.size());
+    void SRAM::clear(uint8_t value) {
+        fill(0, memorySize, value);
+    }
+
+    void SRAM::fill(size_t address, size_t size, uint8_t value) {
+        assert((address + size) <= memorySize);
+
+        if (tracking != nullptr) {
+            // track each byte, so that the journal records the changes
+            for (size_t i=0; i<size; i++) {
+                write(address + i, value);
+            }
 
-        memory[address] = value;
+            return;
+        }
+
+        std::memset(memory + address, value, size);
     }
 
-    void SRAM::write(size_t address, const std::vector<uint8_t>& program) {
-        assert( (address + program.size()) <= memory.size());
+    void SRAM::write(size_t address, std::span<const uint8_t> bytes) {
+        assert((address + bytes.size()) <= memorySize);
+
+        if (tracking != nullptr) {
+            for (size_t i=0; i<bytes.size(); i++) {
+                write(address + i, bytes[i]);
+            }
 
-        for (size_t i=0; i<program.size(); i++) {
-            write(i + address, program[i]);
+            return;
+        }
+
+        if (!bytes.empty()) {
+            std::memcpy(memory + address, bytes.data(), bytes.size());
         }
     }
 
-    uint8_t SRAM::read(size_t address) const {
-        assert(address < memory.size());
-        
-        return memory[address];
+    void SRAM::read(size_t address, std::span<uint8_t> bytes) const {
+        assert((address + bytes.size()) <= memorySize);
+
+        if (!bytes.empty()) {
+            std::memcpy(bytes.data(), memory + address, bytes.size());
+        }
     }
-}
 
-std::ostream& operator<<(std::ostream& os, const memory::SRAM& sram) {
-    // ostream formatting based on 'hexdump' tool 
+    void SRAM::hexdump(std::ostream& os, size_t address, size_t size) const {
+        // formatting based on 'hexdump' tool
+        assert((address + size) <= memorySize);
 
-    const size_t kRowSize = 16;
-    const size_t kNumRows = sram.size() / kRowSize;
-    char buffer[16];
+        const size_t kRowSize = 16;
+        const size_t kChunkSize = 8;
+        const char* kHexDigits = "0123456789abcdef";
 
-    std::vector<uint8_t> rowCache;
-    bool hasReportedRun = false;
+        // offset + 2 chunks of hex + ascii, with room to spare
+        char line[96];
 
-    size_t readIndex = 0;
+        const size_t end = address + size;
+        bool hasReportedRun = false;
 
-    for (size_t rowIndex = 0; rowIndex < kNumRows; rowIndex ++) {
-        std::vector<uint8_t> row;
-        for (size_t i=0; i < kRowSize; i++, readIndex++) {
-            row.push_back(sram.read(readIndex));
-        }
+        for (size_t rowStart = address; rowStart < end; rowStart += kRowSize) {
+            const size_t rowSize = std::min(kRowSize, end - rowStart);
+            const uint8_t* row = memory + rowStart;
+
+            // collapse full rows that repeat the previous row
+            bool isRepeat = (rowStart > address) && (rowSize == kRowSize) && (std::memcmp(row, row - kRowSize, kRowSize) == 0);
+            if (isRepeat) {
+                if (!hasReportedRun) {
+                    os << "*\n";
+                    hasReportedRun = true;
+                }
 
-        if (row == rowCache) {
-            if (!hasReportedRun) {
-                printf("*\n");
-                hasReportedRun = true;
+                continue;
             }
-        } else {
+
             hasReportedRun = false;
 
-            sprintf(buffer, "%08zx  ", rowIndex * kRowSize);
-            os << buffer;
+            int length = snprintf(line, sizeof(line), "%08zx  ", rowStart);
 
-            const size_t kChunkSize = 8;
-            const size_t kNumChunks = kRowSize / kChunkSize;
-            
-            for (size_t chunk=0; chunk < kNumChunks; chunk++) {
-                size_t chunkStart = chunk * kChunkSize;
-                size_t chunkEnd = chunkStart + kChunkSize;
+            for (size_t i=0; i<kRowSize; i++) {
+                if (i < rowSize) {
+                    line[length++] = kHexDigits[row[i] >> 4];
+                    line[length++] = kHexDigits[row[i] & 0xf];
+                } else {
+                    line[length++] = ' ';
+                    line[length++] = ' ';
+                }
+                line[length++] = ' ';
 
-                for (uint8_t i=chunkStart; i<chunkEnd; i++) {
-                    sprintf(buffer, "%02x ", row[i]);
-                    os << buffer;
+                if ((i % kChunkSize) == (kChunkSize - 1)) {
+                    line[length++] = ' ';
                 }
+            }
 
-                os << " ";
+            line[length++] = '|';
+            for (size_t i=0; i<rowSize; i++) {
+                line[length++] = isprint(row[i]) ? char(row[i]) : '.';
             }
+            line[length++] = '|';
+            line[length++] = '\n';
 
-            os << "|";
-            for (size_t i=0; i<kRowSize; i++) {
-                char c = char(row[i]);
+            os.write(line, length);
+        }
+
+        if (hasReportedRun) {
+            snprintf(line, sizeof(line), "%08zx\n", end);
+            os << line;
+        }
+    }
 
-                sprintf(buffer, "%1c", isprint(c) ? c : '.');
-                os << buffer;
+    void SRAM::enableTracking(bool isJournaled) {
+        tracking = std::make_unique<Tracking>();
+        tracking->dirtyPages.resize((numPages() + 63) / 64, 0);
+        tracking->isJournaled = isJournaled;
+    }
+
+    void SRAM::disableTracking() {
+        tracking.reset();
+    }
+
+    bool SRAM::isTracking() const {
+        return tracking != nullptr;
+    }
+
+    size_t SRAM::numPages() const {
+        return (memorySize + kPageSize - 1) / kPageSize;
+    }
+
+    bool SRAM::isPageDirty(size_t page) const {
+        assert(page < numPages());
+
+        if (tracking == nullptr) {
+            return false;
+        }
+
+        return ((tracking->dirtyPages[page / 64] >> (page % 64)) & 1) != 0;
+    }
+
+    std::vector<SRAM::DirtyRange> SRAM::dirtyRanges() const {
+        std::vector<DirtyRange> ranges;
+
+        if (tracking == nullptr) {
+            return ranges;
+        }
+
+        for (size_t page = 0; page < numPages(); page++) {
+            if (!isPageDirty(page)) {
+                continue;
+            }
+
+            size_t address = page * kPageSize;
+            size_t size = std::min(kPageSize, memorySize - address);
+
+            if (!ranges.empty() && ((ranges.back().address + ranges.back().size) == address)) {
+                ranges.back().size += size;
+            } else {
+                ranges.push_back({address, size});
             }
+        }
+
+        return ranges;
+    }
+
+    void SRAM::markDirty(size_t address, size_t size) {
+        setDirty(address, size, true);
+    }
+
+    void SRAM::clearDirty(size_t address, size_t size) {
+        setDirty(address, size, false);
+    }
+
+    void SRAM::clearDirty() {
+        if (tracking != nullptr) {
+            std::fill(tracking->dirtyPages.begin(), tracking->dirtyPages.end(), 0);
+        }
+    }
 
-            os << "|\n";
+    const std::vector<SRAM::JournalEntry>& SRAM::journal() const {
+        static const std::vector<JournalEntry> kEmptyJournal;
 
-            rowCache = row;
+        if (tracking == nullptr) {
+            return kEmptyJournal;
         }
+
+        return tracking->journal;
     }
 
-    if (hasReportedRun) {
-        sprintf(buffer, "%08zx\n", sram.size());
-        os << buffer;
+    void SRAM::clearJournal() {
+        if (tracking != nullptr) {
+            tracking->journal.clear();
+        }
+    }
+
+    void SRAM::trackWrite(size_t address, uint8_t value) {
+        uint8_t oldValue = memory[address];
+
+        // only changes are tracked, so rewriting the same value leaves a page clean
+        if (oldValue == value) {
+            return;
+        }
+
+        size_t page = address / kPageSize;
+        tracking->dirtyPages[page / 64] |= uint64_t(1) << (page % 64);
+
+        if (tracking->isJournaled) {
+            tracking->journal.push_back({uint32_t(address), oldValue, value});
+        }
     }
 
+    void SRAM::setDirty(size_t address, size_t size, bool isDirty) {
+        assert((address + size) <= memorySize);
+
+        if ((tracking == nullptr) || (size == 0)) {
+            return;
+        }
+
+        size_t firstPage = address / kPageSize;
+        size_t lastPage = (address + size - 1) / kPageSize;
+
+        for (size_t page = firstPage; page <= lastPage; page++) {
+            uint64_t bit = uint64_t(1) << (page % 64);
+
+            if (isDirty) {
+                tracking->dirtyPages[page / 64] |= bit;
+            } else {
+                tracking->dirtyPages[page / 64] &= ~bit;
+            }
+        }
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const memory::SRAM& sram) {
+    sram.hexdump(os, 0, sram.size());
+
     return os;
 }
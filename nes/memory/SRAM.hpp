@@ -3,38 +3,178 @@
 #include <vector>
 #include <cstdint>
 #include <ostream>
+#include <cassert>
+#include <memory>
+#include <span>
+#include <string>
 
 namespace memory {
     /// @class SRAM
     /// @brief Simple simulation of SRAM
+    /// @note Write tracking is opt-in (see enableTracking()). When disabled, a write only pays
+    ///       for a single (predictable) null check.
+    /// @note Memory is either owned, or a private (copy-on-write) mapping of a file, see mapFile()
     class SRAM {
     public:
+        static constexpr size_t kPageSize = 0x100;
+
+        /// @brief a write that changed memory, as recorded in the journal
+        struct JournalEntry {
+            uint32_t address;
+            uint8_t oldValue;
+            uint8_t newValue;
+        };
+
+        /// @brief contiguous range of dirty pages
+        struct DirtyRange {
+            size_t address;
+            size_t size;
+        };
+
         SRAM(size_t size);
+
+        /// @note a copy always owns its memory, even when copied from a mapped file
+        SRAM(const SRAM& other);
         ~SRAM();
 
+        SRAM& operator=(const SRAM& other);
+
+        /// @brief map a file (e.g. a ROM image) as memory, without reading it up front
+        /// @note the mapping is private, so writes to memory are never written back to the file
+        /// @param path file to map, must not be empty
+        /// @param error reason for failing
+        /// @return mapped memory, or nullptr on failure
+        static std::unique_ptr<SRAM> mapFile(const std::string& path, std::string& error);
+
         /// @brief clear the memory to a common value
         /// @param value the value to set all memory as (defaults to 0)
         void clear(uint8_t value = 0);
 
+        /// @brief set a range of memory to a common value
+        void fill(size_t address, size_t size, uint8_t value);
+
         /// @brief retrieve the size of memory
-        size_t size() const;
+        size_t size() const {
+            return memorySize;
+        }
+
+        /// @brief raw access to memory, e.g. for mapping into a PageTable, or for hot paths
+        /// @note writes through raw access are not tracked, see markDirty()
+        uint8_t* data() {
+            return memory;
+        }
+
+        const uint8_t* data() const {
+            return memory;
+        }
+
+        std::span<uint8_t> span() {
+            return std::span<uint8_t>(memory, memorySize);
+        }
+
+        std::span<const uint8_t> span() const {
+            return std::span<const uint8_t>(memory, memorySize);
+        }
 
         /// @brief set a byte in memory to the specified value
         /// @param address byte offset from start of memory
         /// @param value the value to set at specified address
-        void write(size_t address, uint8_t value);
+        /// @note inlined, as this is called on every simulated bus cycle
+        void write(size_t address, uint8_t value) {
+            assert(address < memorySize);
+
+            if (tracking != nullptr) {
+                trackWrite(address, value);
+            }
+
+            memory[address] = value;
+        }
+
+        /// @brief Write a sequence of bytes to memory
+        /// @param address byte offset from start of memory to start writing
+        /// @param bytes bytes to write (e.g. the assembled byte code of a program, or a ROM bank)
+        void write(size_t address, std::span<const uint8_t> bytes);
 
         /// @brief Write a sequence of bytes to memory
         /// @param address byte offset from start of memory to start writing
         /// @param program the assembled byte code of program to write
-        void write(size_t address, const std::vector<uint8_t>& program);
+        void write(size_t address, const std::vector<uint8_t>& program) {
+            write(address, std::span<const uint8_t>(program));
+        }
 
         /// @brief retrieve a byte of memory at the specified address
         /// @param address byte offset from start of memory
-        uint8_t read(size_t address) const;
+        /// @note inlined, as this is called on every simulated bus cycle
+        uint8_t read(size_t address) const {
+            assert(address < memorySize);
+
+            return memory[address];
+        }
+
+        /// @brief retrieve a sequence of bytes from memory
+        /// @param address byte offset from start of memory to start reading
+        /// @param bytes destination, filled completely
+        void read(size_t address, std::span<uint8_t> bytes) const;
+
+        /// @brief write a range of memory to a stream, in the format of 'hexdump -C'
+        /// @note formatted a row at a time into a fixed buffer, so large dumps don't allocate
+        void hexdump(std::ostream& os, size_t address, size_t size) const;
+
+        /// @brief start tracking writes that change memory, in a dirty bitmap with a bit per page
+        /// @param isJournaled also record each change in an append-only journal
+        /// @note all pages start clean, and the journal starts empty
+        void enableTracking(bool isJournaled = false);
+
+        /// @brief stop tracking writes, and discard the dirty bitmap + journal
+        void disableTracking();
+
+        bool isTracking() const;
+
+        /// @brief retrieve the number of pages (the last page may be partial)
+        size_t numPages() const;
+
+        /// @brief has the page been changed since it was last cleared
+        /// @note always false when not tracking
+        bool isPageDirty(size_t page) const;
+
+        /// @brief retrieve the dirty pages, merged into contiguous address ranges
+        std::vector<DirtyRange> dirtyRanges() const;
+
+        /// @brief mark the pages overlapping an address range as dirty (e.g. after writing through data())
+        void markDirty(size_t address, size_t size);
+
+        /// @brief mark the pages overlapping an address range as clean
+        void clearDirty(size_t address, size_t size);
+
+        /// @brief mark all pages as clean
+        void clearDirty();
+
+        /// @brief retrieve the changes recorded since the journal was last cleared, oldest first
+        /// @note empty unless tracking with a journal
+        const std::vector<JournalEntry>& journal() const;
+
+        void clearJournal();
 
     private:
-        std::vector<uint8_t> memory;
+        struct Tracking {
+            std::vector<uint64_t> dirtyPages;           // bit per page
+            bool isJournaled;
+            std::vector<JournalEntry> journal;
+        };
+
+        SRAM();
+
+        std::vector<uint8_t> storage;               // owned memory, empty when mapped
+        uint8_t* memory = nullptr;                  // owned or mapped memory
+        size_t memorySize = 0;
+        void* mapping = nullptr;                    // mapped file, or nullptr when owned
+
+        std::unique_ptr<Tracking> tracking;
+
+        void unmap();
+
+        void trackWrite(size_t address, uint8_t value);
+        void setDirty(size_t address, size_t size, bool isDirty);
     };
 }
 
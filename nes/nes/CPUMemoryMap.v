@@ -20,9 +20,11 @@ module CPUMemoryMap(
     output [7:0] o_data_ram,                // data written to RAM
     input [7:0] i_data_ram,                 // data read from RAM
 
-    // connections to PRG (read)
+    // connections to PRG (read, and write to mapper registers)
     output o_cs_prg,
     output [15:0] o_address_prg,
+    output o_rw_prg,                        // 1 = READ, 0 = WRITE
+    output [7:0] o_data_prg,                // data written to PRG (mapper registers)
     input [7:0] i_data_prg,                 // data read from PRG
 
     // connections to PPU (read/write)
@@ -99,6 +101,10 @@ begin
             begin
                 r_data = i_data_prg;
             end
+            else
+            begin
+                r_data = i_data_cpu;
+            end
         end
 
         if ((i_oe1_n == 0) && (i_rw_cpu == RW_READ))
@@ -125,9 +131,11 @@ assign o_data_cpu = (i_rw_cpu == RW_READ) ? r_data : 0;
 assign o_rw_ram = (r_address_range == ADDRESS_RANGE_RAM) ? i_rw_cpu : 0;
 assign o_address_ram = (r_address_range == ADDRESS_RANGE_RAM) ? r_address : 0;
 assign o_address_prg = (r_address_range == ADDRESS_RANGE_PRG) ? r_address : 0;
+assign o_rw_prg = (r_address_range == ADDRESS_RANGE_PRG) ? i_rw_cpu : 0;
 assign o_rs_ppu = (r_address_range == ADDRESS_RANGE_PPU) ? r_address[2:0] : 0;
 assign o_rw_ppu = (r_address_range == ADDRESS_RANGE_PPU) ? i_rw_cpu: 0;
 assign o_data_ram = ((r_address_range == ADDRESS_RANGE_RAM) && (i_rw_cpu == RW_WRITE)) ? r_data : 0;
+assign o_data_prg = ((r_address_range == ADDRESS_RANGE_PRG) && (i_rw_cpu == RW_WRITE)) ? r_data : 0;
 assign o_data_ppu = ((r_address_range == ADDRESS_RANGE_PPU) && (i_rw_cpu == RW_WRITE)) ? r_data : 0;
 
 endmodule
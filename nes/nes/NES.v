@@ -35,9 +35,11 @@ module NES(
     output [7:0] o_data_ram,
     input [7:0] i_data_ram,
 
-    // PRG (read only)
+    // PRG (read, and write to mapper registers)
     output o_cs_prg,
     output [15:0] o_address_prg,
+    output o_rw_prg,
+    output [7:0] o_data_prg,
     input [7:0] i_data_prg,
 
     //////////////////////////////
@@ -263,9 +265,11 @@ module NES(
         .o_rw_ram(o_rw_ram),
         .o_data_ram(o_data_ram),
         .i_data_ram(i_data_ram),
-        // PRG (read only)
+        // PRG (read, and write to mapper registers)
         .o_cs_prg(o_cs_prg),
         .o_address_prg(o_address_prg),
+        .o_rw_prg(o_rw_prg),
+        .o_data_prg(o_data_prg),
         .i_data_prg(i_data_prg),
         // PPU (read / write)
         .o_rs_ppu(w_rs_ppu),
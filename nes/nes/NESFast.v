@@ -0,0 +1,128 @@
+// NES without the debug ports, for throughput-critical simulation
+//  - Verilated with all modules inlined, so that logic which only drives
+//    the debug ports is removed from the model (see BUILD)
+//  - video, controller and memory bus ports are cycle-identical to NES
+//  - o_cpu_debug_clk_en is kept, as the controller model (NESController) samples on it
+
+module NESFast(
+    input i_clk,                            // 5 MHz
+    input i_reset_n,
+
+    input i_ce,                         // clock enable for CPU + PPU
+
+    //////////////////////////////
+    // Video output
+    //////////////////////////////
+
+    output [7:0] o_video_red,           // pixel colour - red
+    output [7:0] o_video_green,         // pixel colour - green
+    output [7:0] o_video_blue,          // pixel colour - blue
+    output [8:0] o_video_x,             // pixel clock - x co-ord of current pixel
+    output [8:0] o_video_y,             // pixel clock - y co-ord of current pixel
+    output o_video_visible,             // is current pixel visible
+
+    //////////////////////////////
+    // Controller
+    //////////////////////////////
+
+    output o_controller_latch,          // latch (high) signal for controllers
+    output o_controller_clk,            // clk (rising edge) signal for controller shift registers
+    input i_controller_1,               // input for serial data from controller 1
+
+    //////////////////////////////
+    // CPU memory access
+    //////////////////////////////
+
+    // RAM (read / write)
+    output o_cs_ram,
+    output [15:0] o_address_ram,
+    output o_rw_ram,
+    output [7:0] o_data_ram,
+    input [7:0] i_data_ram,
+
+    // PRG (read, and write to mapper registers)
+    output o_cs_prg,
+    output [15:0] o_address_prg,
+    output o_rw_prg,
+    output [7:0] o_data_prg,
+    input [7:0] i_data_prg,
+
+    //////////////////////////////
+    // PPU memory access
+    //////////////////////////////
+
+    // pattern table
+    output o_cs_patterntable,
+    input [7:0] i_data_patterntable,
+    output o_rw_patterntable,
+    output [13:0] o_address_patterntable,
+
+    // nametable
+    output o_cs_nametable,
+    input [7:0] i_data_nametable,
+    output [7:0] o_data_nametable,
+    output o_rw_nametable,
+    output [13:0] o_address_nametable,
+
+    //////////////////////////////
+    // CPU Debugging
+    //////////////////////////////
+
+    output o_cpu_debug_clk_en
+);
+
+    /* verilator lint_off PINMISSING */
+    NES nes(
+        .i_clk(i_clk),
+        .i_reset_n(i_reset_n),
+
+        // clock enable
+        .i_ce(i_ce),
+
+        // video output
+        .o_video_red(o_video_red),
+        .o_video_green(o_video_green),
+        .o_video_blue(o_video_blue),
+        .o_video_x(o_video_x),
+        .o_video_y(o_video_y),
+        .o_video_visible(o_video_visible),
+
+        // controller
+        .o_controller_latch(o_controller_latch),
+        .o_controller_clk(o_controller_clk),
+        .i_controller_1(i_controller_1),
+
+        // CPU memory access - RAM
+        .o_cs_ram(o_cs_ram),
+        .o_address_ram(o_address_ram),
+        .o_rw_ram(o_rw_ram),
+        .o_data_ram(o_data_ram),
+        .i_data_ram(i_data_ram),
+
+        // CPU memory access - PRG
+        .o_cs_prg(o_cs_prg),
+        .o_address_prg(o_address_prg),
+        .o_rw_prg(o_rw_prg),
+        .o_data_prg(o_data_prg),
+        .i_data_prg(i_data_prg),
+
+        // PPU memory access - Pattern Table
+        .o_cs_patterntable(o_cs_patterntable),
+        .i_data_patterntable(i_data_patterntable),
+        .o_rw_patterntable(o_rw_patterntable),
+        .o_address_patterntable(o_address_patterntable),
+
+        // PPU memory access - Nametable
+        .o_cs_nametable(o_cs_nametable),
+        .i_data_nametable(i_data_nametable),
+        .o_data_nametable(o_data_nametable),
+        .o_rw_nametable(o_rw_nametable),
+        .o_address_nametable(o_address_nametable),
+
+        // CPU debugging
+        .o_cpu_debug_clk_en(o_cpu_debug_clk_en)
+
+        // other debug ports are not connected
+    );
+    /* verilator lint_on PINMISSING */
+endmodule
@@ -134,6 +134,7 @@ TEST_F(CPUMemoryMap, ShouldReadFromPRGROM) {
         core.i_data_prg = data;
         core.eval();
 
+        EXPECT_EQ(RW_READ, core.o_rw_prg);
         EXPECT_EQ(address, core.o_address_prg);
         EXPECT_EQ(1, core.o_cs_prg);
         EXPECT_EQ(0, core.o_cs_ram);
@@ -141,6 +142,25 @@ TEST_F(CPUMemoryMap, ShouldReadFromPRGROM) {
     }
 }
 
+TEST_F(CPUMemoryMap, ShouldWriteToPRG) {
+    // e.g. mapper registers
+    auto& core = testBench.core();
+    
+    for (int address=ADDRESS_PRG_START, i=0; address<=ADDRESS_PRG_END; address++, i++) {
+        int data = i % 256;
+        core.i_address_cpu = address;
+        core.i_rw_cpu = RW_WRITE;
+        core.i_data_cpu = data;
+        core.eval();
+
+        EXPECT_EQ(RW_WRITE, core.o_rw_prg);
+        EXPECT_EQ(address, core.o_address_prg);
+        EXPECT_EQ(1, core.o_cs_prg);
+        EXPECT_EQ(0, core.o_cs_ram);
+        EXPECT_EQ(data, core.o_data_prg);
+    }
+}
+
 TEST_F(CPUMemoryMap, ShouldReadFromPPU) {
     auto& core = testBench.core();
     
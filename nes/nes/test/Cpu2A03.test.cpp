@@ -12,6 +12,9 @@ using namespace cpu2a03testbench;
 #include "nes/memory/SRAM.hpp"
 using namespace memory;
 
+#include "nes/simulation/CpuBus.hpp"
+using namespace simulation;
+
 #include "nes/cpu6502/assembler/Assembler.hpp"
 using namespace cpu6502::assembler;
 
@@ -23,7 +26,7 @@ const uint16_t kAddressJoy1 = 0x4016;           // 2A03 memory mapped register
 namespace {
     class Cpu2A03 : public ::testing::Test {
     public:
-        Cpu2A03(): sram(64 * 1024) {
+        Cpu2A03(): sram(64 * 1024), bus(sram) {
             
         }
 
@@ -39,21 +42,7 @@ namespace {
             // simulation at the end of a clock phase, before
             //   transition to other clock phase
             testBench.setCallbackSimulateCombinatorial([this, &core]{
-                if (core.i_clk == 1) {
-                    // clock: end of phi2
-                    // R/W data is valid on the bus
-                    if (core.o_rw == 0) {
-                        // write
-                        sram.write(core.o_address, core.o_data);
-                    } else {
-                        // read
-                        core.i_data = sram.read(core.o_address);
-                    }
-                } else {
-                    // clock: end of phi 1
-                    // undefined data on the bus
-                    core.i_data = 0xFF;
-                }
+                bus.simulateCombinatorial(core);
                 
                 // note: should work for 0x4017/kAddressJoy2 too
                 int controllerClk = !((core.o_rw == RW_READ) && (core.o_address == kAddressJoy1));
@@ -100,6 +89,7 @@ namespace {
 
         Cpu2A03TestBench testBench;
         SRAM sram;
+        CpuBus<VCpu2A03> bus;
 
         uint8_t controller1;                // bitmask of button state on controller 1
         int controllerSerialIndex = 8;       // current index into controller's serial shift register
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/Cpu2A03TestBench.h"
+using namespace cpu2a03testbench;
+
+#include "nes/memory/SRAM.hpp"
+using namespace memory;
+
+#include "nes/simulation/CpuLockstep.hpp"
+using namespace simulation;
+
+#include "nes/cpu6502/assembler/Assembler.hpp"
+using namespace cpu6502::assembler;
+
+namespace {
+    /// @brief a frame loop, as an NES program would have: the main loop updates state in RAM,
+    ///        and the NMI handler copies it
+    /// @note avoids the 2A03 registers (0x4000:0x401F), as OAM DMA stalls the CPU, which the model doesn't
+    void assembleFrameLoop(SRAM& sram) {
+        sram.clear(0);
+
+        Assembler()
+                .NOP()
+            .org(0x8000)
+            .label("reset")
+                .SEI()
+                .LDX().immediate(0xFF)
+                .TXS()
+                .LDA().immediate(0x00)
+                .TAX()
+            .label("clear")
+                .STA().absolute(0x0300).x()
+                .INX()
+                .BNE().relative("clear")
+            .label("main")
+                // (zp),y + absolute indexed, with page crossings
+                .LDA().immediate(0x80)
+                .STA().zp(0x10)
+                .LDA().immediate(0x03)
+                .STA().zp(0x11)
+                .LDY().immediate(0x90)
+                .LDA().zpIndirect(0x10).y()
+                .ADC().immediate(0x07)
+                .STA().zpIndirect(0x10).y()
+                .LDX().immediate(0xF0)
+                .ROL().absolute(0x0320).x()
+                .EOR().absolute(0x0320).x()
+                .PHA()
+                .JSR().absolute("update")
+                .PLA()
+                .JMP().absolute("main")
+            .label("update")
+                .LDY().zp(0x20)
+                .INY()
+                .STY().zp(0x20)
+                .CPY().immediate(0x40)
+                .BCC().relative("update_done")
+                .LDY().immediate(0x00)
+                .STY().zp(0x20)
+            .label("update_done")
+                .RTS()
+            .org(0x8200)
+            .label("nmi")
+                .PHA()
+                .TXA()
+                .PHA()
+                .LDA().zp(0x20)
+                .STA().zp(0x30)
+                .INC().zp(0x31)
+                .PLA()
+                .TAX()
+                .PLA()
+                .RTI()
+            .label("irq")
+                .RTI()
+            .org(0xfffa)
+            .word("nmi")
+            .word("reset")
+            .word("irq")
+            .compileTo(sram);
+    }
+
+    class Cpu2A03Lockstep : public ::testing::Test {
+    public:
+        Cpu2A03Lockstep() : sram(64 * 1024) {
+        }
+
+        void SetUp() override {
+            testBench.setClockPolarity(1);
+        }
+
+        Cpu2A03TestBench testBench;
+        SRAM sram;
+    };
+}
+
+TEST_F(Cpu2A03Lockstep, ShouldMatchModelOverFrameLoop) {
+    assembleFrameLoop(sram);
+
+    CpuLockstep<Cpu2A03TestBench, VCpu2A03> lockstep(testBench, sram);
+    lockstep.reset();
+
+    const uint64_t kNumInstructions = 2000;
+
+    EXPECT_EQ(kNumInstructions, lockstep.run(kNumInstructions)) << lockstep.diagnostic();
+    EXPECT_FALSE(lockstep.hasDiverged()) << lockstep.diagnostic();
+}
+
+TEST_F(Cpu2A03Lockstep, ShouldMatchModelTakingNMIEachFrame) {
+    assembleFrameLoop(sram);
+
+    CpuLockstep<Cpu2A03TestBench, VCpu2A03> lockstep(testBench, sram);
+    lockstep.reset();
+
+    // vblank, at a different point of the main loop each frame
+    const uint8_t kNumFrames = 8;
+
+    for (uint8_t frame = 0; frame < kNumFrames; frame++) {
+        const uint64_t numInstructions = 300 + (frame * 7);
+        ASSERT_EQ(numInstructions, lockstep.run(numInstructions)) << lockstep.diagnostic();
+
+        lockstep.setNMI(true);
+        ASSERT_EQ(20u, lockstep.run(20)) << lockstep.diagnostic();
+        lockstep.setNMI(false);
+    }
+
+    EXPECT_EQ(kNumFrames, sram.read(0x31));
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/memory/SRAM.hpp"
+#include "nes/simulation/CpuBus.hpp"
+using namespace memory;
+using namespace simulation;
+
+namespace {
+    /// @brief the bus ports of a 6502 core, without the core
+    struct BusPorts {
+        uint8_t i_clk = 0;
+        uint8_t o_rw = 1;
+        uint16_t o_address = 0;
+        uint8_t o_data = 0;
+        uint8_t i_data = 0;
+    };
+
+    void write(CpuBus<BusPorts>& bus, BusPorts& core, uint16_t address, uint8_t value) {
+        core.i_clk = 1;
+        core.o_rw = 0;
+        core.o_address = address;
+        core.o_data = value;
+        bus.simulateCombinatorial(core);
+    }
+}
+
+TEST(CpuBus, ShouldTakePagesChangedInSRAM) {
+    SRAM sram(0x10000);
+    CpuBus<BusPorts> bus(sram);
+    BusPorts core;
+
+    // nothing is tracked until enabled
+    write(bus, core, 0x0200, 0x01);
+    EXPECT_TRUE(bus.takeWrittenPages().none());
+
+    sram.enableTracking();
+
+    write(bus, core, 0x0300, 0x01);
+    write(bus, core, 0xFFFF, 0x01);
+    sram.write(0x8000, 0x02);
+
+    // unchanged memory isn't reported
+    write(bus, core, 0x0200, 0x01);
+
+    CpuBus<BusPorts>::Pages pages = bus.takeWrittenPages();
+    EXPECT_EQ(3u, pages.count());
+    EXPECT_TRUE(pages[0x03]);
+    EXPECT_TRUE(pages[0x80]);
+    EXPECT_TRUE(pages[0xFF]);
+
+    // and taken pages are cleared
+    EXPECT_TRUE(bus.takeWrittenPages().none());
+    EXPECT_TRUE(sram.dirtyRanges().empty());
+}
@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/simulation/ForkFanOut.hpp"
+using namespace simulation;
+
+namespace {
+    struct Result {
+        size_t index;
+        pid_t pid;
+    };
+}
+
+TEST(ForkFanOut, ShouldReturnResultOfEachBranchInOrder) {
+    const size_t kNumBranches = 7;
+
+    auto branches = ForkFanOut<Result>::run(kNumBranches, 3, [](size_t index) {
+        // finish out of order
+        usleep(useconds_t((kNumBranches - index) * 1000));
+
+        return Result { index, getpid() };
+    });
+
+    ASSERT_EQ(kNumBranches, branches.size());
+
+    for (size_t i = 0; i < kNumBranches; i++) {
+        ASSERT_TRUE(branches[i].isComplete) << i;
+        EXPECT_EQ(0, branches[i].startError);
+        EXPECT_TRUE(WIFEXITED(branches[i].exitStatus));
+        EXPECT_EQ(0, WEXITSTATUS(branches[i].exitStatus));
+
+        EXPECT_EQ(i, branches[i].result.index);
+        EXPECT_NE(getpid(), branches[i].result.pid);
+    }
+}
+
+TEST(ForkFanOut, ShouldShareStateOfParent) {
+    int value = 42;
+
+    auto branches = ForkFanOut<int>::run(2, 0, [&](size_t index) {
+        // note: copy-on-write, so the parent doesn't see this
+        value += int(index);
+
+        return value;
+    });
+
+    ASSERT_EQ(2u, branches.size());
+    EXPECT_EQ(42, branches[0].result);
+    EXPECT_EQ(43, branches[1].result);
+    EXPECT_EQ(42, value);
+}
+
+TEST(ForkFanOut, ShouldReportBranchWithoutResult) {
+    auto branches = ForkFanOut<int>::run(2, 2, [](size_t index) {
+        if (index == 1) {
+            _exit(3);
+        }
+
+        return 1;
+    });
+
+    ASSERT_EQ(2u, branches.size());
+    EXPECT_TRUE(branches[0].isComplete);
+
+    EXPECT_FALSE(branches[1].isComplete);
+    EXPECT_EQ(0, branches[1].startError);
+    ASSERT_TRUE(WIFEXITED(branches[1].exitStatus));
+    EXPECT_EQ(3, WEXITSTATUS(branches[1].exitStatus));
+}
+
+TEST(ForkFanOut, ShouldReportBranchThatCouldNotStart) {
+    // no file descriptors left for a pipe
+    int lowestFreeFd = dup(0);
+    ASSERT_GE(lowestFreeFd, 0);
+    close(lowestFreeFd);
+
+    struct rlimit limit;
+    ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &limit));
+
+    struct rlimit lowered = limit;
+    lowered.rlim_cur = rlim_t(lowestFreeFd);
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &lowered));
+
+    auto branches = ForkFanOut<int>::run(2, 2, [](size_t index) {
+        return 1;
+    });
+
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    ASSERT_EQ(2u, branches.size());
+
+    for (const auto& branch : branches) {
+        EXPECT_FALSE(branch.isComplete);
+        EXPECT_EQ(EMFILE, branch.startError);
+    }
+}
+
+TEST(ForkFanOut, ShouldFlushOutputOfBranches) {
+    const std::string path = (std::filesystem::temp_directory_path() / "ForkFanOut.test.stdout").string();
+
+    // send stdout to a file, which is fully buffered (as when stdout is a pipe)
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    char buffer[BUFSIZ];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+
+    auto branches = ForkFanOut<int>::run(3, 3, [](size_t index) {
+        printf("branch %zu\n", index);
+
+        return int(index);
+    });
+
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    std::ifstream file(path);
+    std::stringstream output;
+    output << file.rdbuf();
+    std::filesystem::remove(path);
+
+    for (size_t i = 0; i < branches.size(); i++) {
+        EXPECT_TRUE(branches[i].isComplete);
+        EXPECT_NE(std::string::npos, output.str().find("branch " + std::to_string(i) + "\n")) << output.str();
+    }
+}
+
+TEST(ForkFanOut, ShouldRunNoBranches) {
+    auto branches = ForkFanOut<int>::run(0, 4, [](size_t index) {
+        return 1;
+    });
+
+    EXPECT_TRUE(branches.empty());
+}
+
+TEST(ForkFanOut, ShouldOnlyReapItsOwnChildren) {
+    // a child of the caller, that exits while the branches are running
+    fflush(stdout);
+    pid_t other = fork();
+    ASSERT_GE(other, 0);
+
+    if (other == 0) {
+        _exit(7);
+    }
+
+    auto branches = ForkFanOut<int>::run(3, 3, [](size_t index) {
+        usleep(10000);
+
+        return int(index);
+    });
+
+    for (const auto& branch : branches) {
+        EXPECT_TRUE(branch.isComplete);
+    }
+
+    // its exit status is left for the caller
+    int status = 0;
+    ASSERT_EQ(other, waitpid(other, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(7, WEXITSTATUS(status));
+}
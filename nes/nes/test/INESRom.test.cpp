@@ -0,0 +1,240 @@
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/cartridge/INESRom.hpp"
+using namespace cartridge;
+
+namespace {
+    const uint8_t kMagic[] = { 'N', 'E', 'S', 0x1A };
+
+    std::vector<uint8_t> makeHeader(uint8_t prgBanks, uint8_t chrBanks, uint8_t flags6 = 0, uint8_t flags7 = 0) {
+        std::vector<uint8_t> header(INESHeader::kSize, 0);
+        std::copy(std::begin(kMagic), std::end(kMagic), header.begin());
+
+        header[4] = prgBanks;
+        header[5] = chrBanks;
+        header[6] = flags6;
+        header[7] = flags7;
+
+        return header;
+    }
+
+    /// @brief ROM image with each PRG byte set to 0x10 + its 16KB bank, and each CHR byte set to 0x80 + its 8KB bank
+    std::vector<uint8_t> makeImage(const std::vector<uint8_t>& header, size_t trainerSize, size_t prgSize, size_t chrSize) {
+        std::vector<uint8_t> image = header;
+        image.resize(image.size() + trainerSize, 0x7E);
+
+        for (size_t i = 0; i < prgSize; i++) {
+            image.push_back(uint8_t(0x10 + (i / INESHeader::kPrgBankSize)));
+        }
+
+        for (size_t i = 0; i < chrSize; i++) {
+            image.push_back(uint8_t(0x80 + (i / INESHeader::kChrBankSize)));
+        }
+
+        return image;
+    }
+
+    class INESRomTest : public ::testing::Test {
+    public:
+        void SetUp() override {
+            path = (std::filesystem::temp_directory_path() / "INESRom.test.nes").string();
+        }
+
+        void TearDown() override {
+            std::filesystem::remove(path);
+        }
+
+        void write(const std::vector<uint8_t>& image) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(image.data()), image.size());
+        }
+
+        std::string path;
+    };
+}
+
+TEST(INESHeader, ShouldRejectMissingMagic) {
+    std::vector<uint8_t> header = makeHeader(1, 1);
+    header[3] = 0;
+
+    INESHeader decoded;
+    std::string error;
+    EXPECT_FALSE(INESHeader::parse(header.data(), decoded, error));
+    EXPECT_EQ("missing iNES header", error);
+}
+
+TEST(INESHeader, ShouldRejectNoPrgRom) {
+    std::vector<uint8_t> header = makeHeader(0, 1);
+
+    INESHeader decoded;
+    std::string error;
+    EXPECT_FALSE(INESHeader::parse(header.data(), decoded, error));
+    EXPECT_EQ("no PRG ROM", error);
+}
+
+TEST(INESHeader, ShouldDecodeINES) {
+    // mapper 0x21, vertical mirroring, battery, 8KB PRG RAM
+    std::vector<uint8_t> header = makeHeader(2, 1, 0x13, 0x20);
+
+    INESHeader decoded;
+    std::string error;
+    ASSERT_TRUE(INESHeader::parse(header.data(), decoded, error)) << error;
+
+    EXPECT_FALSE(decoded.isNES20);
+    EXPECT_EQ(0x21, decoded.mapper);
+    EXPECT_EQ(Mirroring::kVertical, decoded.mirroring);
+    EXPECT_TRUE(decoded.hasBattery);
+    EXPECT_FALSE(decoded.hasTrainer);
+    EXPECT_EQ(0x8000u, decoded.prgRomSize);
+    EXPECT_EQ(0x2000u, decoded.chrRomSize);
+    EXPECT_EQ(0x2000u, decoded.prgRamSize);
+    EXPECT_EQ(0u, decoded.chrRamSize);
+}
+
+TEST(INESHeader, ShouldIgnoreUpperMapperOfDirtyINES) {
+    std::vector<uint8_t> header = makeHeader(1, 0, 0x10, 0x40);
+    std::copy_n("Dude!", 4, header.begin() + 12);
+
+    INESHeader decoded;
+    std::string error;
+    ASSERT_TRUE(INESHeader::parse(header.data(), decoded, error)) << error;
+
+    EXPECT_EQ(0x01, decoded.mapper);
+    EXPECT_EQ(Mirroring::kHorizontal, decoded.mirroring);
+    EXPECT_EQ(INESHeader::kChrBankSize, decoded.chrRamSize);
+}
+
+TEST(INESHeader, ShouldDecodeNES20BankCounts) {
+    // mapper 0x104, submapper 2, 0x102 PRG banks (MSB nibble), four screen
+    std::vector<uint8_t> header = makeHeader(0x02, 0x03, 0x48, 0x08);
+    header[8] = 0x21;
+    header[9] = 0x01;
+    header[10] = 0x70;                      // 8KB battery backed PRG RAM
+    header[11] = 0x07;                      // 8KB CHR RAM
+
+    INESHeader decoded;
+    std::string error;
+    ASSERT_TRUE(INESHeader::parse(header.data(), decoded, error)) << error;
+
+    EXPECT_TRUE(decoded.isNES20);
+    EXPECT_EQ(0x104, decoded.mapper);
+    EXPECT_EQ(2, decoded.submapper);
+    EXPECT_EQ(Mirroring::kFourScreen, decoded.mirroring);
+    EXPECT_EQ(0x102 * INESHeader::kPrgBankSize, decoded.prgRomSize);
+    EXPECT_EQ(3 * INESHeader::kChrBankSize, decoded.chrRomSize);
+    EXPECT_EQ(0x2000u, decoded.prgRamSize);
+    EXPECT_EQ(0x2000u, decoded.chrRamSize);
+}
+
+TEST(INESHeader, ShouldDecodeNES20ExponentMultiplier) {
+    // PRG: 2^10 * 3, CHR: 2^4 * 7
+    std::vector<uint8_t> header = makeHeader((10 << 2) | 1, (4 << 2) | 3, 0, 0x08);
+    header[9] = 0xFF;
+
+    INESHeader decoded;
+    std::string error;
+    ASSERT_TRUE(INESHeader::parse(header.data(), decoded, error)) << error;
+
+    EXPECT_EQ(1024u * 3, decoded.prgRomSize);
+    EXPECT_EQ(16u * 7, decoded.chrRomSize);
+}
+
+TEST(INESHeader, ShouldRejectNES20ExponentTooLarge) {
+    std::vector<uint8_t> header = makeHeader(1, (63 << 2) | 3, 0, 0x08);
+    header[9] = 0xF0;
+
+    INESHeader decoded;
+    std::string error;
+    EXPECT_FALSE(INESHeader::parse(header.data(), decoded, error));
+    EXPECT_EQ("CHR ROM size is too large", error);
+}
+
+TEST_F(INESRomTest, ShouldOpenINES) {
+    write(makeImage(makeHeader(2, 1), 0, 0x8000, 0x2000));
+
+    INESRom rom;
+    ASSERT_TRUE(rom.open(path)) << rom.error();
+
+    EXPECT_TRUE(rom.trainer().empty());
+    EXPECT_EQ(2u, rom.numPrgBanks());
+    EXPECT_EQ(1u, rom.numChrBanks());
+    EXPECT_EQ(0x10, rom.prgBank(0)[0]);
+    EXPECT_EQ(0x11, rom.prgBank(1)[0x3FFF]);
+    EXPECT_EQ(0x80, rom.chrBank(0)[0x1FFF]);
+
+    rom.close();
+    EXPECT_FALSE(rom.isOpen());
+    EXPECT_TRUE(rom.prgRom().empty());
+}
+
+TEST_F(INESRomTest, ShouldSkipTrainer) {
+    write(makeImage(makeHeader(1, 0, 0x04), INESHeader::kTrainerSize, 0x4000, 0));
+
+    INESRom rom;
+    ASSERT_TRUE(rom.open(path)) << rom.error();
+
+    EXPECT_TRUE(rom.header().hasTrainer);
+    ASSERT_EQ(INESHeader::kTrainerSize, rom.trainer().size());
+    EXPECT_EQ(0x7E, rom.trainer()[0]);
+    EXPECT_EQ(0x10, rom.prgRom()[0]);
+    EXPECT_TRUE(rom.chrRom().empty());
+}
+
+TEST_F(INESRomTest, ShouldOpenNES20ExponentMultiplier) {
+    // PRG: 2^14 * 1 (16KB), CHR: 2^13 * 1 (8KB)
+    std::vector<uint8_t> header = makeHeader(14 << 2, 13 << 2, 0, 0x08);
+    header[9] = 0xFF;
+
+    write(makeImage(header, 0, 0x4000, 0x2000));
+
+    INESRom rom;
+    ASSERT_TRUE(rom.open(path)) << rom.error();
+
+    EXPECT_EQ(1u, rom.numPrgBanks());
+    EXPECT_EQ(1u, rom.numChrBanks());
+    EXPECT_EQ(0x80, rom.chrRom()[0]);
+}
+
+TEST_F(INESRomTest, ShouldRejectTruncatedImage) {
+    std::vector<uint8_t> image = makeImage(makeHeader(2, 1), 0, 0x8000, 0x2000);
+    image.pop_back();
+    write(image);
+
+    INESRom rom;
+    EXPECT_FALSE(rom.open(path));
+    EXPECT_FALSE(rom.isOpen());
+    EXPECT_NE(std::string::npos, rom.error().find("is truncated"));
+}
+
+TEST_F(INESRomTest, ShouldRejectTruncatedTrainer) {
+    write(makeImage(makeHeader(1, 0, 0x04), 0, 0x4000, 0));
+
+    INESRom rom;
+    EXPECT_FALSE(rom.open(path));
+    EXPECT_NE(std::string::npos, rom.error().find("is truncated"));
+}
+
+TEST_F(INESRomTest, ShouldRejectHeaderLargerThanFile) {
+    // PRG: 2^30 * 7, which is allowed by the header, but can't fit the file
+    std::vector<uint8_t> header = makeHeader((30 << 2) | 3, 0, 0, 0x08);
+    header[9] = 0x0F;
+
+    write(makeImage(header, 0, 0x4000, 0));
+
+    INESRom rom;
+    EXPECT_FALSE(rom.open(path));
+    EXPECT_NE(std::string::npos, rom.error().find("is truncated"));
+}
+
+TEST_F(INESRomTest, ShouldRejectFileSmallerThanHeader) {
+    write({ 'N', 'E', 'S' });
+
+    INESRom rom;
+    EXPECT_FALSE(rom.open(path));
+    EXPECT_NE(std::string::npos, rom.error().find("too small"));
+}
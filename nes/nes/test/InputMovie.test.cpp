@@ -0,0 +1,225 @@
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/simulation/InputMovie.hpp"
+#include "nes/simulation/NESController.hpp"
+using namespace simulation;
+
+namespace {
+    const size_t kHeaderSize = 24;
+
+    std::string tempPath(const char* filename) {
+        return (std::filesystem::temp_directory_path() / filename).string();
+    }
+
+    std::vector<uint8_t> readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    /// @brief record a latch for each of the buttons, starting at firstLatchIndex
+    void record(InputMovieRecorder& recorder, uint64_t firstLatchIndex, const std::vector<uint8_t>& buttons) {
+        for (size_t i = 0; i < buttons.size(); i++) {
+            recorder.onLatch(firstLatchIndex + i, buttons[i]);
+        }
+    }
+
+    /// @brief replay a latch for each index, from firstLatchIndex
+    std::vector<uint8_t> replay(InputMovieReplayer& replayer, uint64_t firstLatchIndex, size_t numLatches) {
+        std::vector<uint8_t> buttons;
+
+        for (size_t i = 0; i < numLatches; i++) {
+            buttons.push_back(replayer.onLatch(firstLatchIndex + i, 0xFF));
+        }
+
+        return buttons;
+    }
+}
+
+TEST(InputMovie, ShouldReplayRecordedLatches) {
+    const std::string path = tempPath("InputMovie.test.roundtrip.nesmovie");
+    const std::vector<uint8_t> buttons = { 0, 0, NESController::kStart, NESController::kStart, 0, NESController::kA | NESController::kRight, 0 };
+
+    InputMovieRecorder recorder;
+    ASSERT_TRUE(recorder.open(path)) << recorder.error();
+
+    // the recorder passes the buttons through
+    EXPECT_EQ(NESController::kB, recorder.onLatch(0, NESController::kB));
+    record(recorder, 1, buttons);
+    ASSERT_TRUE(recorder.close()) << recorder.error();
+
+    InputMovieReplayer replayer;
+    ASSERT_TRUE(replayer.open(path)) << replayer.error();
+
+    EXPECT_EQ(NESController::kB, replayer.onLatch(0, 0));
+    EXPECT_EQ(buttons, replay(replayer, 1, buttons.size()));
+    EXPECT_FALSE(replayer.isFinished());
+
+    // no buttons are pressed after the end of the movie
+    EXPECT_EQ(0, replayer.onLatch(buttons.size() + 1, 0xFF));
+    EXPECT_TRUE(replayer.isFinished());
+
+    std::filesystem::remove(path);
+}
+
+TEST(InputMovie, ShouldEncodeRunLengthsAsLEB128) {
+    const std::string path = tempPath("InputMovie.test.leb128.nesmovie");
+
+    InputMovieRecorder recorder;
+    ASSERT_TRUE(recorder.open(path)) << recorder.error();
+    record(recorder, 0, std::vector<uint8_t>(127, 0x01));
+    record(recorder, 127, std::vector<uint8_t>(128, 0x02));
+    record(recorder, 255, std::vector<uint8_t>(16384, 0x03));
+    ASSERT_TRUE(recorder.close()) << recorder.error();
+
+    const std::vector<uint8_t> file = readFile(path);
+    ASSERT_GE(file.size(), kHeaderSize);
+    EXPECT_EQ(std::vector<uint8_t>({ 0x01, 0x7F, 0x02, 0x80, 0x01, 0x03, 0x80, 0x80, 0x01 }), std::vector<uint8_t>(file.begin() + kHeaderSize, file.end()));
+
+    InputMovieReplayer replayer;
+    ASSERT_TRUE(replayer.open(path)) << replayer.error();
+    EXPECT_EQ(0x01, replayer.onLatch(126, 0));
+    EXPECT_EQ(0x02, replayer.onLatch(127, 0));
+    EXPECT_EQ(0x02, replayer.onLatch(254, 0));
+    EXPECT_EQ(0x03, replayer.onLatch(255, 0));
+    EXPECT_EQ(0x03, replayer.onLatch(255 + 16383, 0));
+    EXPECT_FALSE(replayer.isFinished());
+    EXPECT_EQ(0x00, replayer.onLatch(255 + 16384, 0xFF));
+
+    std::filesystem::remove(path);
+}
+
+TEST(InputMovie, ShouldRecordFromFirstLatch) {
+    const std::string path = tempPath("InputMovie.test.first.nesmovie");
+
+    // e.g. recording after loading a snapshot
+    InputMovieRecorder recorder;
+    ASSERT_TRUE(recorder.open(path)) << recorder.error();
+    record(recorder, 100, { 0x10, 0x20 });
+    ASSERT_TRUE(recorder.close()) << recorder.error();
+
+    InputMovieReplayer replayer;
+    ASSERT_TRUE(replayer.open(path)) << replayer.error();
+
+    // the latches before the movie are not replaced
+    EXPECT_EQ(0x42, replayer.onLatch(99, 0x42));
+    EXPECT_EQ(std::vector<uint8_t>({ 0x10, 0x20 }), replay(replayer, 100, 2));
+
+    std::filesystem::remove(path);
+}
+
+TEST(InputMovie, ReplayerShouldRewind) {
+    const std::string path = tempPath("InputMovie.test.replayrewind.nesmovie");
+    const std::vector<uint8_t> buttons = { 1, 1, 2, 3, 3, 3, 4 };
+
+    InputMovieRecorder recorder;
+    ASSERT_TRUE(recorder.open(path)) << recorder.error();
+    record(recorder, 0, buttons);
+    ASSERT_TRUE(recorder.close()) << recorder.error();
+
+    InputMovieReplayer replayer;
+    ASSERT_TRUE(replayer.open(path)) << replayer.error();
+    EXPECT_EQ(buttons, replay(replayer, 0, buttons.size()));
+
+    // e.g. after loading an earlier snapshot
+    EXPECT_EQ(std::vector<uint8_t>(buttons.begin() + 1, buttons.end()), replay(replayer, 1, buttons.size() - 1));
+    EXPECT_EQ(std::vector<uint8_t>(buttons.begin() + 4, buttons.end()), replay(replayer, 4, buttons.size() - 4));
+
+    std::filesystem::remove(path);
+}
+
+TEST(InputMovie, RecorderShouldRewindToEarlierLatch) {
+    const std::string path = tempPath("InputMovie.test.recordrewind.nesmovie");
+
+    InputMovieRecorder recorder;
+    ASSERT_TRUE(recorder.open(path)) << recorder.error();
+    record(recorder, 0, { 1, 1, 2, 3, 3, 3, 4 });
+
+    // to the middle of a run that has been written, and record over the rest of it
+    ASSERT_TRUE(recorder.rewind(4)) << recorder.error();
+    record(recorder, 4, { 5, 5 });
+
+    // to the middle of the current run
+    ASSERT_TRUE(recorder.rewind(5)) << recorder.error();
+    record(recorder, 5, { 6 });
+    ASSERT_TRUE(recorder.close()) << recorder.error();
+
+    InputMovieReplayer replayer;
+    ASSERT_TRUE(replayer.open(path)) << replayer.error();
+    EXPECT_EQ(std::vector<uint8_t>({ 1, 1, 2, 3, 5, 6 }), replay(replayer, 0, 6));
+    EXPECT_EQ(0, replayer.onLatch(6, 0xFF));
+    EXPECT_TRUE(replayer.isFinished());
+
+    std::filesystem::remove(path);
+}
+
+TEST(InputMovie, RecorderShouldRewindBeforeFirstLatch) {
+    const std::string path = tempPath("InputMovie.test.recordrestart.nesmovie");
+
+    InputMovieRecorder recorder;
+    ASSERT_TRUE(recorder.open(path)) << recorder.error();
+    record(recorder, 10, { 1, 2, 3 });
+
+    ASSERT_TRUE(recorder.rewind(5)) << recorder.error();
+    record(recorder, 5, { 7, 7 });
+    ASSERT_TRUE(recorder.close()) << recorder.error();
+
+    EXPECT_EQ(kHeaderSize + 2, readFile(path).size());
+
+    InputMovieReplayer replayer;
+    ASSERT_TRUE(replayer.open(path)) << replayer.error();
+    EXPECT_EQ(0x42, replayer.onLatch(4, 0x42));
+    EXPECT_EQ(std::vector<uint8_t>({ 7, 7 }), replay(replayer, 5, 2));
+    EXPECT_EQ(0, replayer.onLatch(7, 0xFF));
+
+    std::filesystem::remove(path);
+}
+
+TEST(InputMovie, RecorderShouldRefuseToSkipLatches) {
+    const std::string path = tempPath("InputMovie.test.recordahead.nesmovie");
+
+    InputMovieRecorder recorder;
+    ASSERT_TRUE(recorder.open(path)) << recorder.error();
+
+    // nothing recorded yet, so recording can start anywhere
+    EXPECT_TRUE(recorder.canRewind(50));
+
+    record(recorder, 0, { 1, 2, 3 });
+    EXPECT_TRUE(recorder.canRewind(3));
+    EXPECT_FALSE(recorder.canRewind(4));
+
+    EXPECT_FALSE(recorder.rewind(10));
+    EXPECT_EQ("latch 10 is ahead of the recording (latch 3)", recorder.error());
+
+    // the recording is unchanged
+    record(recorder, 3, { 4 });
+    ASSERT_TRUE(recorder.close()) << recorder.error();
+
+    InputMovieReplayer replayer;
+    ASSERT_TRUE(replayer.open(path)) << replayer.error();
+    EXPECT_EQ(std::vector<uint8_t>({ 1, 2, 3, 4 }), replay(replayer, 0, 4));
+
+    std::filesystem::remove(path);
+}
+
+TEST(InputMovie, ShouldRejectFileThatIsNotAMovie) {
+    const std::string path = tempPath("InputMovie.test.invalid.nesmovie");
+
+    std::ofstream file(path, std::ios::binary);
+    file << "this is not a movie, but is long enough";
+    file.close();
+
+    InputMovieReplayer replayer;
+    EXPECT_FALSE(replayer.open(path));
+    EXPECT_EQ("'" + path + "' is not an input movie", replayer.error());
+    EXPECT_TRUE(replayer.isFinished());
+
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(replayer.open(path));
+    EXPECT_NE(std::string::npos, replayer.error().find("unable to open"));
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/simulation/InputScript.hpp"
+#include "nes/simulation/NESController.hpp"
+using namespace simulation;
+
+TEST(InputScript, ShouldHoldButtonsUntilNextChange) {
+    InputScript script;
+
+    ASSERT_TRUE(script.parse(
+        "# title screen\n"
+        "\n"
+        "120 start\n"
+        "125 -          # release\n"
+        "  200 right+a\n"
+        "200 right+a+b\r\n")) << script.error();
+
+    EXPECT_EQ(0, script.buttons(0));
+    EXPECT_EQ(0, script.buttons(119));
+    EXPECT_EQ(NESController::kStart, script.buttons(120));
+    EXPECT_EQ(NESController::kStart, script.buttons(124));
+    EXPECT_EQ(0, script.buttons(125));
+
+    // the last change of a frame wins
+    EXPECT_EQ(NESController::kRight | NESController::kA | NESController::kB, script.buttons(200));
+    EXPECT_EQ(NESController::kRight | NESController::kA | NESController::kB, script.buttons(100000));
+}
+
+TEST(InputScript, ShouldParseEachButton) {
+    InputScript script;
+
+    ASSERT_TRUE(script.parse("0 a+b+select+start+up+down+left+right\n")) << script.error();
+    EXPECT_EQ(0xFF, script.buttons(0));
+}
+
+TEST(InputScript, ShouldBeEmptyWithoutChanges) {
+    InputScript script;
+
+    ASSERT_TRUE(script.parse("# nothing\n\n")) << script.error();
+    EXPECT_EQ(0, script.buttons(0));
+    EXPECT_EQ(0, script.buttons(1000));
+}
+
+TEST(InputScript, ShouldRejectInvalidLines) {
+    InputScript script;
+
+    EXPECT_FALSE(script.parse("10 start\nstart\n"));
+    EXPECT_EQ("line 2: expected '<frame> <buttons>'", script.error());
+
+    EXPECT_FALSE(script.parse("10\n"));
+    EXPECT_EQ("line 1: invalid buttons", script.error());
+
+    EXPECT_FALSE(script.parse("10 start+turbo\n"));
+    EXPECT_EQ("line 1: invalid buttons", script.error());
+
+    EXPECT_FALSE(script.parse("10 a\n\n5 b\n"));
+    EXPECT_EQ("line 3: frames must be in order", script.error());
+}
+
+TEST(InputScript, ShouldReplaceChangesWhenParsedAgain) {
+    InputScript script;
+
+    ASSERT_TRUE(script.parse("0 a\n"));
+    ASSERT_TRUE(script.parse("10 b\n"));
+
+    EXPECT_EQ(0, script.buttons(0));
+    EXPECT_EQ(NESController::kB, script.buttons(10));
+}
+
+TEST(InputScript, ShouldReportFileThatCannotBeOpened) {
+    InputScript script;
+
+    EXPECT_FALSE(script.load("/nonexistent/InputScript.test.txt"));
+    EXPECT_EQ("unable to open '/nonexistent/InputScript.test.txt'", script.error());
+}
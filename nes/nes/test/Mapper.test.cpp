@@ -0,0 +1,264 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/cartridge/Mapper.hpp"
+#include "nes/memory/PageTable.hpp"
+using namespace cartridge;
+using namespace memory;
+
+#include "TestRom.hpp"
+using namespace testrom;
+
+namespace {
+    typedef std::pair<uint8_t, uint8_t> Banks;
+
+    class MapperTest : public ::testing::Test {
+    public:
+        MapperTest() : nametableRam(0x1000, 0) {
+
+        }
+
+        void create(const TestRom& testRom) {
+            ASSERT_TRUE(testRom.rom().isOpen()) << testRom.rom().error();
+
+            std::string error;
+            mapper = Mapper::create(testRom.rom(), cpuMemory, ppuMemory, nametableRam.data(), error);
+            ASSERT_NE(nullptr, mapper) << error;
+
+            mapper->reset();
+        }
+
+        /// @brief load an MMC1 register through its serial port, LSB first
+        void writeMMC1(uint16_t address, uint8_t value) {
+            for (int i = 0; i < 5; i++) {
+                cpuMemory.write(address, (value >> i) & 1);
+            }
+        }
+
+        /// @brief 16KB PRG banks mapped at 0x8000 and 0xC000
+        Banks prgBanks() const {
+            return { cpuMemory.read(0x8000), cpuMemory.read(0xC000) };
+        }
+
+        /// @brief 4KB CHR banks mapped at 0x0000 and 0x1000
+        Banks chrBanks() const {
+            return { uint8_t(ppuMemory.read(0x0000) - 0x80), uint8_t(ppuMemory.read(0x1000) - 0x80) };
+        }
+
+        /// @brief nametable RAM (1KB unit) seen at each of the 4 nametables
+        std::vector<size_t> nametableLayout() const {
+            std::vector<size_t> layout;
+
+            for (uint16_t address = 0x2000; address < 0x3000; address += 0x400) {
+                layout.push_back((ppuMemory.pageMemory(address) - nametableRam.data()) / 0x400);
+            }
+
+            return layout;
+        }
+
+        PageTable cpuMemory;
+        PageTable ppuMemory;
+        std::vector<uint8_t> nametableRam;
+        std::unique_ptr<Mapper> mapper;
+    };
+}
+
+TEST_F(MapperTest, ShouldRejectUnsupportedMapper) {
+    TestRom testRom("Mapper.test.unsupported.nes", 1, 1, 4);
+    ASSERT_TRUE(testRom.rom().isOpen());
+
+    std::string error;
+    EXPECT_EQ(nullptr, Mapper::create(testRom.rom(), cpuMemory, ppuMemory, nametableRam.data(), error));
+    EXPECT_EQ("mapper 4 is not supported", error);
+}
+
+TEST_F(MapperTest, NROMShouldMirror16KBPrg) {
+    TestRom testRom("Mapper.test.nrom.nes", 1, 1, 0);
+    create(testRom);
+
+    EXPECT_EQ(Banks(0, 0), prgBanks());
+    EXPECT_EQ(Banks(0, 1), chrBanks());
+
+    // no registers, and PRG is read-only
+    EXPECT_FALSE(cpuMemory.isWritable(0x8000));
+    EXPECT_FALSE(cpuMemory.write(0x8000, 0x01));
+    EXPECT_FALSE(ppuMemory.isWritable(0x0000));
+}
+
+TEST_F(MapperTest, NROMShouldMap32KBPrg) {
+    TestRom testRom("Mapper.test.nrom32.nes", 2, 1, 0);
+    create(testRom);
+
+    EXPECT_EQ(Banks(0, 1), prgBanks());
+}
+
+TEST_F(MapperTest, ShouldArrangeNametablesByHeaderMirroring) {
+    TestRom horizontal("Mapper.test.horizontal.nes", 1, 1, 0, false);
+    create(horizontal);
+    EXPECT_EQ(std::vector<size_t>({ 0, 0, 1, 1 }), nametableLayout());
+
+    TestRom vertical("Mapper.test.vertical.nes", 1, 1, 0, true);
+    create(vertical);
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 0, 1 }), nametableLayout());
+
+    ppuMemory.write(0x2005, 0x42);
+    EXPECT_EQ(0x42, ppuMemory.read(0x2805));
+    EXPECT_EQ(Mirroring::kVertical, mapper->mirroring());
+}
+
+TEST_F(MapperTest, UxROMShouldSwitchPrgAt8000) {
+    TestRom testRom("Mapper.test.uxrom.nes", 8, 0, 2);
+    create(testRom);
+
+    EXPECT_EQ(Banks(0, 7), prgBanks());
+
+    // writes go to the bank select register, not PRG
+    EXPECT_TRUE(cpuMemory.write(0xABCD, 3));
+    EXPECT_EQ(Banks(3, 7), prgBanks());
+
+    // bank numbers wrap to the size of PRG
+    cpuMemory.write(0x8000, 9);
+    EXPECT_EQ(Banks(1, 7), prgBanks());
+}
+
+TEST_F(MapperTest, UxROMShouldUseWritableChrRam) {
+    TestRom testRom("Mapper.test.uxrom.chrram.nes", 2, 0, 2);
+    create(testRom);
+
+    EXPECT_TRUE(ppuMemory.isWritable(0x1FFF));
+    EXPECT_TRUE(ppuMemory.write(0x1FFF, 0x5A));
+    EXPECT_EQ(0x5A, ppuMemory.read(0x1FFF));
+}
+
+TEST_F(MapperTest, CNROMShouldSwitchChr) {
+    TestRom testRom("Mapper.test.cnrom.nes", 2, 4, 3);
+    create(testRom);
+
+    EXPECT_EQ(Banks(0, 1), prgBanks());
+    EXPECT_EQ(Banks(0, 1), chrBanks());
+
+    cpuMemory.write(0x8000, 2);
+    EXPECT_EQ(Banks(4, 5), chrBanks());
+    EXPECT_EQ(Banks(0, 1), prgBanks());
+}
+
+TEST_F(MapperTest, MMC1ShouldPowerOnWithLastBankFixed) {
+    TestRom testRom("Mapper.test.mmc1.nes", 8, 2, 1);
+    create(testRom);
+
+    EXPECT_EQ(Banks(0, 7), prgBanks());
+    EXPECT_EQ(Banks(0, 1), chrBanks());
+    EXPECT_EQ(Mirroring::kSingleScreenLower, mapper->mirroring());
+}
+
+TEST_F(MapperTest, MMC1ShouldOnlyUpdateRegisterOnFifthWrite) {
+    TestRom testRom("Mapper.test.mmc1.shift.nes", 8, 2, 1);
+    create(testRom);
+
+    // PRG bank 5 (0b00101)
+    cpuMemory.write(0xE000, 1);
+    cpuMemory.write(0xE000, 0);
+    cpuMemory.write(0xE000, 1);
+    cpuMemory.write(0xE000, 0);
+    EXPECT_EQ(Banks(0, 7), prgBanks());
+
+    cpuMemory.write(0xE000, 0);
+    EXPECT_EQ(Banks(5, 7), prgBanks());
+}
+
+TEST_F(MapperTest, MMC1ShouldResetShiftRegister) {
+    TestRom testRom("Mapper.test.mmc1.reset.nes", 8, 2, 1);
+    create(testRom);
+
+    // PRG mode 2 (first bank fixed), then a partial load is discarded by the reset
+    writeMMC1(0x8000, 0x08);
+    cpuMemory.write(0xE000, 1);
+    cpuMemory.write(0xE000, 1);
+    cpuMemory.write(0xE000, 0x80);
+
+    // the reset also restores PRG mode 3 (last bank fixed)
+    EXPECT_EQ(Banks(0, 7), prgBanks());
+
+    writeMMC1(0xE000, 2);
+    EXPECT_EQ(Banks(2, 7), prgBanks());
+}
+
+TEST_F(MapperTest, MMC1ShouldSwitchPrgModes) {
+    TestRom testRom("Mapper.test.mmc1.prg.nes", 8, 2, 1);
+    create(testRom);
+
+    writeMMC1(0xE000, 5);
+
+    // mode 2: first bank fixed at 0x8000, switch 0xC000
+    writeMMC1(0x8000, 0x08);
+    EXPECT_EQ(Banks(0, 5), prgBanks());
+
+    // mode 0: 32KB, ignoring the low bit of the bank number
+    writeMMC1(0x8000, 0x00);
+    EXPECT_EQ(Banks(4, 5), prgBanks());
+}
+
+TEST_F(MapperTest, MMC1ShouldSwitchChrModes) {
+    TestRom testRom("Mapper.test.mmc1.chr.nes", 2, 4, 1);
+    create(testRom);
+
+    // 8KB mode, ignoring the low bit of the bank number
+    writeMMC1(0xA000, 5);
+    EXPECT_EQ(Banks(4, 5), chrBanks());
+
+    // 4KB mode
+    writeMMC1(0x8000, 0x1C);
+    writeMMC1(0xC000, 2);
+    EXPECT_EQ(Banks(5, 2), chrBanks());
+}
+
+TEST_F(MapperTest, MMC1ShouldControlMirroring) {
+    TestRom testRom("Mapper.test.mmc1.mirroring.nes", 2, 1, 1);
+    create(testRom);
+
+    writeMMC1(0x8000, 0x0D);
+    EXPECT_EQ(Mirroring::kSingleScreenUpper, mapper->mirroring());
+    EXPECT_EQ(std::vector<size_t>({ 1, 1, 1, 1 }), nametableLayout());
+
+    writeMMC1(0x8000, 0x0E);
+    EXPECT_EQ(Mirroring::kVertical, mapper->mirroring());
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 0, 1 }), nametableLayout());
+
+    writeMMC1(0x8000, 0x0F);
+    EXPECT_EQ(Mirroring::kHorizontal, mapper->mirroring());
+    EXPECT_EQ(std::vector<size_t>({ 0, 0, 1, 1 }), nametableLayout());
+}
+
+TEST_F(MapperTest, ShouldRestoreSavedState) {
+    TestRom testRom("Mapper.test.state.nes", 8, 0, 1);
+    create(testRom);
+
+    writeMMC1(0xE000, 3);
+    writeMMC1(0x8000, 0x0E);
+    ppuMemory.write(0x0010, 0x77);
+    cpuMemory.write(0x8000, 1);             // part of a serial load
+
+    std::vector<uint8_t> state = mapper->saveState();
+
+    mapper->reset();
+    ppuMemory.write(0x0010, 0x00);
+    EXPECT_EQ(Banks(0, 7), prgBanks());
+
+    ASSERT_TRUE(mapper->restoreState(state));
+    EXPECT_EQ(Banks(3, 7), prgBanks());
+    EXPECT_EQ(Mirroring::kVertical, mapper->mirroring());
+    EXPECT_EQ(0x77, ppuMemory.read(0x0010));
+
+    // the serial load continues where it was saved (0x0D)
+    cpuMemory.write(0x8000, 0);
+    cpuMemory.write(0x8000, 1);
+    cpuMemory.write(0x8000, 1);
+    cpuMemory.write(0x8000, 0);
+    EXPECT_EQ(Mirroring::kSingleScreenUpper, mapper->mirroring());
+
+    state.pop_back();
+    EXPECT_FALSE(mapper->restoreState(state));
+}
@@ -0,0 +1,287 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "gtestverilog/gtestverilog.h"
+using namespace gtestverilog;
+
+#include "nes/NESTestBench.h"
+#include "nes/NESFastTestBench.h"
+
+#include "nes/memory/SRAM.hpp"
+#include "nes/memory/PageTable.hpp"
+using namespace memory;
+
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/NESBus.hpp"
+using namespace simulation;
+
+#include "nes/cpu6502/assembler/Assembler.hpp"
+using namespace cpu6502::assembler;
+
+const uint16_t PPUCTRL = 0x2000;
+const uint16_t PPUMASK = 0x2001;
+const uint16_t PPUSTATUS = 0x2002;
+const uint16_t PPUADDR = 0x2006;
+const uint16_t PPUDATA = 0x2007;
+const uint16_t JOY1 = 0x4016;
+
+const uint16_t RAM = 0x0000;
+
+namespace {
+    /// @brief video, controller + memory bus outputs, that NES + NESFast should share
+    struct Outputs {
+        uint8_t o_video_red;
+        uint8_t o_video_green;
+        uint8_t o_video_blue;
+        uint16_t o_video_x;
+        uint16_t o_video_y;
+        uint8_t o_video_visible;
+
+        uint8_t o_controller_latch;
+        uint8_t o_controller_clk;
+
+        uint8_t o_cs_ram;
+        uint16_t o_address_ram;
+        uint8_t o_rw_ram;
+        uint8_t o_data_ram;
+
+        uint8_t o_cs_prg;
+        uint16_t o_address_prg;
+        uint8_t o_rw_prg;
+        uint8_t o_data_prg;
+
+        uint8_t o_cs_patterntable;
+        uint8_t o_rw_patterntable;
+        uint16_t o_address_patterntable;
+
+        uint8_t o_cs_nametable;
+        uint8_t o_data_nametable;
+        uint8_t o_rw_nametable;
+        uint16_t o_address_nametable;
+
+        uint8_t o_cpu_debug_clk_en;
+
+        bool operator==(const Outputs& other) const = default;
+
+        template <class CORE>
+        static Outputs capture(const CORE& core) {
+            Outputs outputs;
+
+            outputs.o_video_red = core.o_video_red;
+            outputs.o_video_green = core.o_video_green;
+            outputs.o_video_blue = core.o_video_blue;
+            outputs.o_video_x = core.o_video_x;
+            outputs.o_video_y = core.o_video_y;
+            outputs.o_video_visible = core.o_video_visible;
+
+            outputs.o_controller_latch = core.o_controller_latch;
+            outputs.o_controller_clk = core.o_controller_clk;
+
+            outputs.o_cs_ram = core.o_cs_ram;
+            outputs.o_address_ram = core.o_address_ram;
+            outputs.o_rw_ram = core.o_rw_ram;
+            outputs.o_data_ram = core.o_data_ram;
+
+            outputs.o_cs_prg = core.o_cs_prg;
+            outputs.o_address_prg = core.o_address_prg;
+            outputs.o_rw_prg = core.o_rw_prg;
+            outputs.o_data_prg = core.o_data_prg;
+
+            outputs.o_cs_patterntable = core.o_cs_patterntable;
+            outputs.o_rw_patterntable = core.o_rw_patterntable;
+            outputs.o_address_patterntable = core.o_address_patterntable;
+
+            outputs.o_cs_nametable = core.o_cs_nametable;
+            outputs.o_data_nametable = core.o_data_nametable;
+            outputs.o_rw_nametable = core.o_rw_nametable;
+            outputs.o_address_nametable = core.o_address_nametable;
+
+            outputs.o_cpu_debug_clk_en = core.o_cpu_debug_clk_en;
+
+            return outputs;
+        }
+    };
+
+    /// @brief record the outputs of each step (i.e. both clock phases of each tick)
+    struct OutputsRecorder {
+        std::vector<Outputs> steps;
+
+        template <class CORE>
+        void capture(const CORE& core) {
+            steps.push_back(Outputs::capture(core));
+        }
+    };
+
+    /// @brief an NES core, with RAM, PRG, CHR RAM and nametables of its own
+    template <class TESTBENCH, class CORE>
+    class Machine {
+    public:
+        Machine(const SRAM& program) : prg(program), sram(0x0800), chr(0x2000), vram(0x1000), bus(cpuMemory, ppuMemory), simulation(testBench, bus) {
+            cpuMemory.map(0x0000, sram.size(), sram.data());
+            cpuMemory.map(0x8000, 0x8000, static_cast<const uint8_t*>(prg.data() + 0x8000));
+
+            for (size_t i = 0; i < chr.size(); i++) {
+                chr.write(i, uint8_t((i >> 4) ^ (i * 0x35)));
+            }
+
+            ppuMemory.map(0x0000, chr.size(), chr.data());
+            ppuMemory.map(0x2000, vram.size(), vram.data());
+
+            testBench.setClockPolarity(0);
+            testBench.core().i_ce = 1;
+
+            bus.controller1().setButtons(NESController::kA | NESController::kRight);
+
+            simulation.setTraceMode(TraceMode::kNone);
+            simulation.setRecorder(&recorder);
+            simulation.reset();
+        }
+
+        /// @brief simulate a tick, and return the outputs of each step
+        const std::vector<Outputs>& tick() {
+            recorder.steps.clear();
+            simulation.tick();
+
+            return recorder.steps;
+        }
+
+        SRAM& ram() {
+            return sram;
+        }
+
+    private:
+        TESTBENCH testBench;
+
+        SRAM prg;
+        SRAM sram;
+        SRAM chr;
+        SRAM vram;
+
+        PageTable cpuMemory;
+        PageTable ppuMemory;
+
+        NESBus<CORE> bus;
+        OutputsRecorder recorder;
+        Simulation<TESTBENCH, NESBus<CORE>, OutputsRecorder> simulation;
+    };
+
+    class NESFast : public ::testing::Test {
+    public:
+        NESFast() : program(0x10000) {
+
+        }
+
+        void SetUp() override {
+            program.clear(0);
+
+            // boot, fill a nametable + palette, then render with NMI enabled
+            //  while reading the controller, and writing to PRG
+            // note: Assembler only positions code by .org after the first opcode
+            Assembler()
+                    .NOP()
+                .org(0x8000)
+                .label("reset")
+                    .SEI()
+                    .CLD()
+                    .LDX().immediate(0xff)
+                    .TXS()
+                    .LDA().immediate(0)
+                    .STA().absolute(PPUCTRL)
+                    .STA().absolute(PPUMASK)
+                .label("vblank1")
+                    .BIT().absolute(PPUSTATUS)
+                    .BPL().relative("vblank1")
+                    .LDX().immediate(0)
+                .label("clear_ram")
+                    .STA().absolute(RAM).x()
+                    .STA().absolute(RAM + 0x0100).x()
+                    .INX()
+                    .BNE().relative("clear_ram")
+                .label("vblank2")
+                    .BIT().absolute(PPUSTATUS)
+                    .BPL().relative("vblank2")
+                    .LDA().immediate(0x20)
+                    .STA().absolute(PPUADDR)
+                    .LDA().immediate(0x00)
+                    .STA().absolute(PPUADDR)
+                    .LDY().immediate(4)
+                .label("fill_nametable_page")
+                    .LDX().immediate(0)
+                .label("fill_nametable")
+                    .STX().absolute(PPUDATA)
+                    .INX()
+                    .BNE().relative("fill_nametable")
+                    .DEY()
+                    .BNE().relative("fill_nametable_page")
+                    .LDA().immediate(0x3f)
+                    .STA().absolute(PPUADDR)
+                    .LDA().immediate(0x00)
+                    .STA().absolute(PPUADDR)
+                    .LDX().immediate(0)
+                .label("fill_palette")
+                    .STX().absolute(PPUDATA)
+                    .INX()
+                    .CPX().immediate(0x20)
+                    .BNE().relative("fill_palette")
+                    .LDA().immediate(0x80)
+                    .STA().absolute(PPUCTRL)
+                    .LDA().immediate(0x1e)
+                    .STA().absolute(PPUMASK)
+                .label("main")
+                    .LDA().immediate(1)
+                    .STA().absolute(JOY1)
+                    .LDA().immediate(0)
+                    .STA().absolute(JOY1)
+                    .LDA().absolute(JOY1)
+                    .STA().absolute(0x0020)
+                    .STA().absolute(0x8000)
+                    .INC().absolute(0x0010)
+                    .JMP().absolute("main")
+                .label("nmi")
+                    .INC().absolute(0x0011)
+                    .RTI()
+                .org(0xfffa)
+                .word("nmi")
+                .word("reset")
+                .word("nmi")
+                .compileTo(program);
+        }
+
+        void TearDown() override {
+
+        }
+
+        SRAM program;
+    };
+}
+
+TEST_F(NESFast, ShouldConstruct) {
+
+}
+
+TEST_F(NESFast, ShouldBeCycleIdenticalToNES) {
+    const int kNumTicksPerFrame = 341 * 262;
+    const int kNumFrames = 3;
+
+    // note: the Verilated models are too large for the stack
+    auto debug = std::make_unique<Machine<nestestbench::NESTestBench, VNES>>(program);
+    auto fast = std::make_unique<Machine<nesfasttestbench::NESFastTestBench, VNESFast>>(program);
+
+    for (int i = 0; i < (kNumTicksPerFrame * kNumFrames); i++) {
+        const auto& debugSteps = debug->tick();
+        const auto& fastSteps = fast->tick();
+
+        ASSERT_TRUE(debugSteps == fastSteps) << "outputs differ at tick " << i;
+    }
+
+    // should have run the main loop + NMI
+    EXPECT_NE(0, debug->ram().read(0x0010));
+    EXPECT_NE(0, debug->ram().read(0x0011));
+
+    for (uint16_t address = 0; address < 0x0800; address++) {
+        ASSERT_EQ(debug->ram().read(address), fast->ram().read(address)) << "RAM differs at " << address;
+    }
+}
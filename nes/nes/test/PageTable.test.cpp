@@ -0,0 +1,133 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/memory/PageTable.hpp"
+using namespace memory;
+
+namespace {
+    class RecordingHandler : public PageHandler {
+    public:
+        uint8_t read(uint16_t address) override {
+            reads.push_back(address);
+            return uint8_t(address >> 8);
+        }
+
+        void write(uint16_t address, uint8_t value) override {
+            writes.push_back({ address, value });
+        }
+
+        std::vector<uint16_t> reads;
+        std::vector<std::pair<uint16_t, uint8_t>> writes;
+    };
+}
+
+TEST(PageTable, ShouldReadOpenBusWhenUnmapped) {
+    PageTable pageTable;
+
+    EXPECT_FALSE(pageTable.isMapped(0x1234));
+    EXPECT_FALSE(pageTable.isWritable(0x1234));
+    EXPECT_EQ(nullptr, pageTable.pageMemory(0x1234));
+    EXPECT_EQ(0xFF, pageTable.read(0x1234));
+
+    pageTable.setOpenBusValue(0x40);
+    EXPECT_EQ(0x40, pageTable.read(0x1234));
+
+    EXPECT_FALSE(pageTable.write(0x1234, 0x55));
+    EXPECT_EQ(0x40, pageTable.read(0x1234));
+}
+
+TEST(PageTable, ShouldReadAndWriteMappedMemory) {
+    PageTable pageTable;
+    std::vector<uint8_t> ram(0x800, 0);
+
+    pageTable.map(0x0000, ram.size(), ram.data());
+
+    EXPECT_TRUE(pageTable.isMapped(0x07FF));
+    EXPECT_TRUE(pageTable.isWritable(0x07FF));
+    EXPECT_FALSE(pageTable.isMapped(0x0800));
+
+    EXPECT_TRUE(pageTable.write(0x0123, 0xAB));
+    EXPECT_EQ(0xAB, ram[0x0123]);
+    EXPECT_EQ(0xAB, pageTable.read(0x0123));
+}
+
+TEST(PageTable, ShouldMirrorPagesOntoTheSameMemory) {
+    PageTable pageTable;
+    std::vector<uint8_t> ram(0x800, 0);
+
+    for (uint16_t address = 0x0000; address < 0x2000; address += 0x800) {
+        pageTable.map(address, ram.size(), ram.data());
+    }
+
+    pageTable.write(0x0801, 0x42);
+
+    EXPECT_EQ(0x42, pageTable.read(0x0001));
+    EXPECT_EQ(0x42, pageTable.read(0x1001));
+    EXPECT_EQ(0x42, pageTable.read(0x1801));
+    EXPECT_EQ(pageTable.pageMemory(0x0000), pageTable.pageMemory(0x1800));
+}
+
+TEST(PageTable, ShouldNotWriteReadOnlyMemory) {
+    PageTable pageTable;
+    const std::vector<uint8_t> rom(0x4000, 0xEA);
+
+    pageTable.map(0xC000, rom.size(), rom.data());
+
+    EXPECT_TRUE(pageTable.isMapped(0xC000));
+    EXPECT_FALSE(pageTable.isWritable(0xC000));
+    EXPECT_FALSE(pageTable.write(0xC000, 0x00));
+    EXPECT_EQ(0xEA, pageTable.read(0xC000));
+}
+
+TEST(PageTable, ShouldSendWritesToReadOnlyMemoryToHandler) {
+    PageTable pageTable;
+    RecordingHandler handler;
+    const std::vector<uint8_t> rom(0x8000, 0xEA);
+
+    pageTable.map(0x8000, rom.size(), rom.data(), &handler);
+
+    EXPECT_TRUE(pageTable.isWritable(0x8000));
+    EXPECT_TRUE(pageTable.write(0x8000, 0x07));
+    EXPECT_EQ(0xEA, pageTable.read(0x8000));
+    EXPECT_TRUE(handler.reads.empty());
+
+    ASSERT_EQ(1u, handler.writes.size());
+    EXPECT_EQ(0x8000, handler.writes[0].first);
+    EXPECT_EQ(0x07, handler.writes[0].second);
+}
+
+TEST(PageTable, ShouldSendAccessesToHandler) {
+    PageTable pageTable;
+    RecordingHandler handler;
+
+    pageTable.map(0x2000, 0x2000, &handler);
+
+    EXPECT_TRUE(pageTable.isMapped(0x3FFF));
+    EXPECT_EQ(nullptr, pageTable.pageMemory(0x2000));
+    EXPECT_EQ(0x3F, pageTable.read(0x3F07));
+    EXPECT_TRUE(pageTable.write(0x2007, 0x11));
+
+    ASSERT_EQ(1u, handler.reads.size());
+    EXPECT_EQ(0x3F07, handler.reads[0]);
+    ASSERT_EQ(1u, handler.writes.size());
+    EXPECT_EQ(0x2007, handler.writes[0].first);
+}
+
+TEST(PageTable, ShouldUnmapPages) {
+    PageTable pageTable;
+    std::vector<uint8_t> ram(0x800, 0x12);
+
+    pageTable.map(0x0000, ram.size(), ram.data());
+    pageTable.unmap(0x0100, 0x100);
+
+    EXPECT_TRUE(pageTable.isMapped(0x0000));
+    EXPECT_FALSE(pageTable.isMapped(0x0100));
+    EXPECT_EQ(0xFF, pageTable.read(0x0100));
+    EXPECT_TRUE(pageTable.isMapped(0x0200));
+
+    pageTable.clear();
+    EXPECT_FALSE(pageTable.isMapped(0x0000));
+    EXPECT_EQ(0xFF, pageTable.read(0x0000));
+}
@@ -0,0 +1,141 @@
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/simulation/RealTimePacer.hpp"
+using namespace simulation;
+
+namespace {
+    // slow enough that the ticks owed are predictable from short sleeps
+    const double kTicksPerSecond = 10000.0;
+
+    const uint64_t kInitialSliceTicks = 4096;
+    const uint64_t kMinSliceTicks = 256;
+
+    void sleepFor(double seconds) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+}
+
+TEST(RealTimePacer, ShouldOweTicksForElapsedTime) {
+    RealTimePacer pacer(kTicksPerSecond);
+
+    EXPECT_EQ(1.0, pacer.speed());
+    EXPECT_FALSE(pacer.isMaxSpeed());
+    EXPECT_LT(pacer.budget(), 10u);
+
+    sleepFor(0.02);
+
+    // ~200 ticks owed (allowing for a slow host)
+    uint64_t budget = pacer.budget();
+    EXPECT_GE(budget, 200u);
+    EXPECT_LE(budget, 900u);
+
+    // and none once they have been simulated
+    pacer.advance(budget);
+    EXPECT_LT(pacer.budget(), 50u);
+    EXPECT_FALSE(pacer.isBehind());
+}
+
+TEST(RealTimePacer, ShouldScaleBySpeed) {
+    RealTimePacer pacer(kTicksPerSecond);
+    pacer.setSpeed(4.0);
+
+    EXPECT_EQ(4.0, pacer.speed());
+
+    sleepFor(0.02);
+
+    // ~800 ticks owed
+    uint64_t budget = pacer.budget();
+    EXPECT_GE(budget, 800u);
+    EXPECT_LE(budget, 3000u);
+}
+
+TEST(RealTimePacer, ShouldLimitBudgetToSlice) {
+    RealTimePacer pacer(1000000.0);
+
+    sleepFor(0.01);
+
+    // ~10000 ticks owed, in slices
+    EXPECT_EQ(kInitialSliceTicks, pacer.budget());
+}
+
+TEST(RealTimePacer, ShouldIgnoreWallClockAtMaxSpeed) {
+    RealTimePacer pacer(kTicksPerSecond);
+    pacer.setSpeed(0.0);
+
+    EXPECT_TRUE(pacer.isMaxSpeed());
+    EXPECT_EQ(kInitialSliceTicks, pacer.budget());
+
+    pacer.advance(1000000);
+    EXPECT_EQ(kInitialSliceTicks, pacer.budget());
+
+    auto start = RealTimePacer::Clock::now();
+    pacer.wait();
+    EXPECT_LT(std::chrono::duration<double>(RealTimePacer::Clock::now() - start).count(), 0.01);
+}
+
+TEST(RealTimePacer, ShouldWaitForMinimumSlice) {
+    RealTimePacer pacer(kTicksPerSecond);
+
+    // ahead of the wall clock
+    pacer.advance(100);
+    EXPECT_EQ(0u, pacer.budget());
+
+    // until (100 + 256) ticks are owed, i.e. ~36ms
+    auto start = RealTimePacer::Clock::now();
+    pacer.wait();
+    EXPECT_GE(std::chrono::duration<double>(RealTimePacer::Clock::now() - start).count(), 0.03);
+
+    EXPECT_GE(pacer.budget(), kMinSliceTicks);
+}
+
+TEST(RealTimePacer, ShouldDropDebtWhenTooFarBehind) {
+    RealTimePacer pacer(kTicksPerSecond);
+
+    // more than 0.1 seconds behind
+    sleepFor(0.15);
+
+    EXPECT_EQ(kInitialSliceTicks, pacer.budget());
+    EXPECT_TRUE(pacer.isBehind());
+
+    // the debt is not caught up on later
+    EXPECT_LT(pacer.budget(), 50u);
+
+    // restart clears it
+    pacer.restart();
+    EXPECT_FALSE(pacer.isBehind());
+}
+
+TEST(RealTimePacer, ShouldSizeSliceFromMeasuredRate) {
+    RealTimePacer pacer(kTicksPerSecond);
+    pacer.setSpeed(0.0);
+
+    // 5000 ticks over a 0.5 second window, i.e. ~10000 ticks/sec
+    pacer.advance(2500);
+    sleepFor(0.5);
+    pacer.advance(2500);
+
+    EXPECT_GT(pacer.measuredTicksPerSecond(), 5000.0);
+    EXPECT_LE(pacer.measuredTicksPerSecond(), 10000.0);
+
+    // slices take ~4ms of simulation, but no fewer than the minimum
+    EXPECT_EQ(kMinSliceTicks, pacer.budget());
+    EXPECT_FALSE(pacer.isBehind());
+}
+
+TEST(RealTimePacer, ShouldReportBehindWhenRateFallsShort) {
+    RealTimePacer pacer(kTicksPerSecond);
+
+    // only half of the ticks owed are simulated, over more than a measurement window
+    for (int i = 0; i < 30; i++) {
+        sleepFor(0.02);
+        pacer.advance(100);
+    }
+
+    EXPECT_GT(pacer.measuredTicksPerSecond(), 0.0);
+    EXPECT_LT(pacer.measuredTicksPerSecond(), 0.98 * kTicksPerSecond);
+    EXPECT_TRUE(pacer.isBehind());
+}
@@ -0,0 +1,139 @@
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/simulation/RegressionManifest.hpp"
+using namespace simulation;
+
+namespace {
+    class RegressionManifestTest : public ::testing::Test {
+    public:
+        RegressionManifestTest() {
+            directory = std::filesystem::temp_directory_path() / "RegressionManifest.test";
+            std::filesystem::create_directories(directory);
+        }
+
+        ~RegressionManifestTest() {
+            std::filesystem::remove_all(directory);
+        }
+
+        /// @brief write a manifest into the test directory
+        std::string write(const std::string& text, const char* filename = "manifest.txt") {
+            std::string path = (directory / filename).string();
+
+            std::ofstream file(path);
+            file << text;
+
+            return path;
+        }
+
+        std::filesystem::path directory;
+        RegressionManifest manifest;
+    };
+}
+
+TEST_F(RegressionManifestTest, ShouldParseEntries) {
+    std::string path = write(
+        "# rom movie frame:hash ...\n"
+        "\n"
+        "supermario.nes  supermario.movie  600:0x0123456789abcdef 60:1f2e3d4c5b6a7988   # comment\n"
+        "/roms/galaga.nes -                120:0x8877665544332211\n");
+
+    ASSERT_TRUE(manifest.load(path)) << manifest.error();
+    ASSERT_EQ(2u, manifest.entries().size());
+
+    const RegressionEntry& supermario = manifest.entries()[0];
+    EXPECT_EQ((directory / "supermario.nes").string(), supermario.romPath);
+    EXPECT_EQ((directory / "supermario.movie").string(), supermario.moviePath);
+    EXPECT_EQ(3, supermario.lineNumber);
+
+    // ordered by frame
+    ASSERT_EQ(2u, supermario.checkpoints.size());
+    EXPECT_EQ(60u, supermario.checkpoints[0].frame);
+    EXPECT_EQ(0x1f2e3d4c5b6a7988ULL, supermario.checkpoints[0].hash);
+    EXPECT_TRUE(supermario.checkpoints[0].hasHash);
+    EXPECT_EQ(600u, supermario.checkpoints[1].frame);
+    EXPECT_EQ(0x0123456789abcdefULL, supermario.checkpoints[1].hash);
+
+    const RegressionEntry& galaga = manifest.entries()[1];
+    EXPECT_EQ("/roms/galaga.nes", galaga.romPath);
+    EXPECT_TRUE(galaga.moviePath.empty());
+    ASSERT_EQ(1u, galaga.checkpoints.size());
+    EXPECT_EQ(120u, galaga.checkpoints[0].frame);
+}
+
+TEST_F(RegressionManifestTest, ShouldParseCheckpointsWithoutHash) {
+    std::string path = write("zelda.nes - 900 300:0x1234\n");
+
+    ASSERT_TRUE(manifest.load(path)) << manifest.error();
+    const auto& checkpoints = manifest.entries()[0].checkpoints;
+
+    ASSERT_EQ(2u, checkpoints.size());
+    EXPECT_EQ(300u, checkpoints[0].frame);
+    EXPECT_TRUE(checkpoints[0].hasHash);
+    EXPECT_EQ(900u, checkpoints[1].frame);
+    EXPECT_FALSE(checkpoints[1].hasHash);
+}
+
+TEST_F(RegressionManifestTest, ShouldRejectMissingFields) {
+    std::string path = write("ok.nes - 60:0x1\nrom-only.nes\n");
+    EXPECT_FALSE(manifest.load(path));
+    EXPECT_EQ("'" + path + "' line 2: expected '<rom> <movie> <frame>:<hash>...'", manifest.error());
+    EXPECT_TRUE(manifest.entries().empty());
+
+    path = write("galaga.nes -   # no checkpoints\n");
+    EXPECT_FALSE(manifest.load(path));
+    EXPECT_EQ("'" + path + "' line 1: no checkpoints", manifest.error());
+}
+
+TEST_F(RegressionManifestTest, ShouldRejectMalformedCheckpoints) {
+    for (const char* checkpoint : { ":0x1234", "60:", "60:0xZZ", "sixty:0x1234", "60x:0x1234", "-60:0x1234", "60:-1", "60:0x12:34" }) {
+        std::string path = write(std::string("galaga.nes - ") + checkpoint + "\n");
+
+        EXPECT_FALSE(manifest.load(path)) << checkpoint;
+        EXPECT_EQ("'" + path + "' line 1: invalid checkpoint '" + checkpoint + "'", manifest.error());
+    }
+}
+
+TEST_F(RegressionManifestTest, ShouldReportFileThatCannotBeOpened) {
+    std::string path = (directory / "missing.txt").string();
+
+    EXPECT_FALSE(manifest.load(path));
+    EXPECT_EQ("unable to open '" + path + "'", manifest.error());
+}
+
+TEST_F(RegressionManifestTest, ShouldSaveRecordedHashes) {
+    std::string path = write(
+        "supermario.nes  supermario.movie  60 600:0x1\n"
+        "/roms/galaga.nes -                120\n");
+
+    ASSERT_TRUE(manifest.load(path)) << manifest.error();
+
+    auto& checkpoints = manifest.entries()[0].checkpoints;
+    checkpoints[0].hash = 0x1f2e3d4c5b6a7988ULL;
+    checkpoints[0].hasHash = true;
+
+    std::string recordedPath = (directory / "recorded.txt").string();
+    ASSERT_TRUE(manifest.save(recordedPath)) << manifest.error();
+
+    // paths stay relative to the manifest, and checkpoints without a hash are kept
+    RegressionManifest recorded;
+    ASSERT_TRUE(recorded.load(recordedPath)) << recorded.error();
+    ASSERT_EQ(2u, recorded.entries().size());
+
+    const RegressionEntry& supermario = recorded.entries()[0];
+    EXPECT_EQ((directory / "supermario.nes").string(), supermario.romPath);
+    EXPECT_EQ((directory / "supermario.movie").string(), supermario.moviePath);
+    ASSERT_EQ(2u, supermario.checkpoints.size());
+    EXPECT_EQ(0x1f2e3d4c5b6a7988ULL, supermario.checkpoints[0].hash);
+    EXPECT_EQ(0x1ULL, supermario.checkpoints[1].hash);
+
+    const RegressionEntry& galaga = recorded.entries()[1];
+    EXPECT_TRUE(galaga.moviePath.empty());
+    EXPECT_FALSE(galaga.checkpoints[0].hasHash);
+
+    EXPECT_FALSE(manifest.save((directory / "missing" / "recorded.txt").string()));
+    EXPECT_NE(std::string::npos, manifest.error().find("unable to write"));
+}
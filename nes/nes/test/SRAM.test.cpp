@@ -0,0 +1,166 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/memory/SRAM.hpp"
+using namespace memory;
+
+// note: in the namespace of the types, so that they are found when comparing vectors
+namespace memory {
+    bool operator==(const SRAM::DirtyRange& a, const SRAM::DirtyRange& b) {
+        return (a.address == b.address) && (a.size == b.size);
+    }
+
+    bool operator==(const SRAM::JournalEntry& a, const SRAM::JournalEntry& b) {
+        return (a.address == b.address) && (a.oldValue == b.oldValue) && (a.newValue == b.newValue);
+    }
+
+    std::ostream& operator<<(std::ostream& os, const SRAM::DirtyRange& range) {
+        return os << "{0x" << std::hex << range.address << ", 0x" << range.size << "}";
+    }
+
+    std::ostream& operator<<(std::ostream& os, const SRAM::JournalEntry& entry) {
+        return os << "{0x" << std::hex << entry.address << ": 0x" << int(entry.oldValue) << " -> 0x" << int(entry.newValue) << "}";
+    }
+}
+
+TEST(SRAM, ShouldNotTrackByDefault) {
+    SRAM sram(0x1000);
+
+    EXPECT_FALSE(sram.isTracking());
+
+    sram.write(0x0123, 0x42);
+    sram.markDirty(0, sram.size());
+
+    EXPECT_FALSE(sram.isPageDirty(1));
+    EXPECT_TRUE(sram.dirtyRanges().empty());
+    EXPECT_TRUE(sram.journal().empty());
+}
+
+TEST(SRAM, ShouldTrackPagesChangedByWrites) {
+    SRAM sram(0x1000);
+    sram.enableTracking();
+
+    EXPECT_TRUE(sram.isTracking());
+    EXPECT_EQ(16u, sram.numPages());
+
+    sram.write(0x0123, 0x42);
+    EXPECT_TRUE(sram.isPageDirty(1));
+    EXPECT_FALSE(sram.isPageDirty(0));
+    EXPECT_FALSE(sram.isPageDirty(2));
+
+    // rewriting the same value isn't a change
+    sram.write(0x0234, 0x00);
+    EXPECT_FALSE(sram.isPageDirty(2));
+
+    // nor are writes through raw access, until they are marked
+    sram.data()[0x0345] = 0x42;
+    EXPECT_FALSE(sram.isPageDirty(3));
+
+    sram.markDirty(0x0345, 1);
+    EXPECT_TRUE(sram.isPageDirty(3));
+
+    sram.clearDirty();
+    EXPECT_TRUE(sram.dirtyRanges().empty());
+
+    sram.disableTracking();
+    EXPECT_FALSE(sram.isTracking());
+}
+
+TEST(SRAM, ShouldMergeDirtyPagesIntoRanges) {
+    // the last page is partial
+    SRAM sram(0x1080);
+    sram.enableTracking();
+
+    sram.write(0x0010, 1);
+    sram.write(0x01FF, 1);
+    sram.write(0x0200, 1);
+    sram.write(0x0500, 1);
+    sram.write(0x1000, 1);
+    sram.markDirty(0x0F80, 0x10);
+
+    EXPECT_EQ(std::vector<SRAM::DirtyRange>({ {0x0000, 0x0300}, {0x0500, 0x0100}, {0x0F00, 0x0180} }), sram.dirtyRanges());
+
+    // pages overlapping the range are cleared
+    sram.clearDirty(0x0180, 0x0081);
+    sram.clearDirty(0x0F00, 0);
+    EXPECT_EQ(std::vector<SRAM::DirtyRange>({ {0x0000, 0x0100}, {0x0500, 0x0100}, {0x0F00, 0x0180} }), sram.dirtyRanges());
+
+    // ranges also merge across the words of the bitmap
+    SRAM large(0x10000);
+    large.enableTracking();
+    large.markDirty(0x3E00, 0x0400);
+
+    EXPECT_TRUE(large.isPageDirty(63));
+    EXPECT_TRUE(large.isPageDirty(64));
+    EXPECT_EQ(std::vector<SRAM::DirtyRange>({ {0x3E00, 0x0400} }), large.dirtyRanges());
+}
+
+TEST(SRAM, ShouldJournalChanges) {
+    SRAM sram(0x1000);
+    sram.enableTracking(true);
+
+    sram.write(0x0010, 0x01);
+    sram.write(0x0010, 0x01);
+    sram.write(0x0010, 0x02);
+    sram.write(0x0800, std::vector<uint8_t>({ 0x00, 0x03 }));
+    sram.fill(0x0F00, 2, 0x04);
+
+    EXPECT_EQ(std::vector<SRAM::JournalEntry>({
+        {0x0010, 0x00, 0x01},
+        {0x0010, 0x01, 0x02},
+        {0x0801, 0x00, 0x03},
+        {0x0F00, 0x00, 0x04},
+        {0x0F01, 0x00, 0x04}
+    }), sram.journal());
+
+    // the journal is independent of the dirty bitmap
+    sram.clearDirty();
+    EXPECT_EQ(5u, sram.journal().size());
+
+    sram.clearJournal();
+    EXPECT_TRUE(sram.journal().empty());
+    EXPECT_EQ(0x02, sram.read(0x0010));
+
+    // without a journal, only pages are tracked
+    sram.enableTracking(false);
+    sram.write(0x0010, 0x03);
+    EXPECT_TRUE(sram.journal().empty());
+    EXPECT_TRUE(sram.isPageDirty(0));
+}
+
+TEST(SRAM, CopyShouldOwnMemoryAndTracking) {
+    SRAM sram(0x1000);
+    sram.enableTracking(true);
+    sram.write(0x0010, 0x01);
+
+    SRAM copy(sram);
+
+    EXPECT_TRUE(copy.isTracking());
+    EXPECT_EQ(0x01, copy.read(0x0010));
+    EXPECT_TRUE(copy.isPageDirty(0));
+    EXPECT_EQ(1u, copy.journal().size());
+
+    // changes to the copy don't affect the original, nor the reverse
+    copy.write(0x0210, 0x02);
+    sram.clearDirty();
+    sram.clearJournal();
+
+    EXPECT_EQ(0x00, sram.read(0x0210));
+    EXPECT_FALSE(sram.isPageDirty(2));
+    EXPECT_TRUE(copy.isPageDirty(0));
+    EXPECT_TRUE(copy.isPageDirty(2));
+    EXPECT_EQ(2u, copy.journal().size());
+
+    // assignment replaces memory and tracking
+    SRAM untracked(0x100);
+    untracked = copy;
+
+    EXPECT_EQ(0x1000u, untracked.size());
+    EXPECT_EQ(0x02, untracked.read(0x0210));
+    EXPECT_EQ(copy.dirtyRanges().size(), untracked.dirtyRanges().size());
+
+    untracked = SRAM(0x100);
+    EXPECT_FALSE(untracked.isTracking());
+}
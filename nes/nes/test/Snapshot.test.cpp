@@ -0,0 +1,293 @@
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "gtestverilog/gtestverilog.h"
+using namespace gtestverilog;
+
+#include "nes/NESTestBench.h"
+#include "nes/NESFastTestBench.h"
+using namespace nestestbench;
+using namespace nesfasttestbench;
+
+#include "nes/memory/SRAM.hpp"
+#include "nes/memory/PageTable.hpp"
+using namespace memory;
+
+#include "nes/cartridge/Mapper.hpp"
+using namespace cartridge;
+
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/NESBus.hpp"
+#include "nes/simulation/NESSnapshot.hpp"
+#include "nes/simulation/Snapshot.hpp"
+using namespace simulation;
+
+#include "nes/cpu6502/assembler/Assembler.hpp"
+using namespace cpu6502::assembler;
+
+#include "TestRom.hpp"
+using namespace testrom;
+
+namespace {
+    std::string tempPath(const char* filename) {
+        return (std::filesystem::temp_directory_path() / filename).string();
+    }
+
+    /// @brief 32KB PRG ROM, that counts in RAM + in NMI
+    std::vector<uint8_t> assembleProgram(uint8_t step) {
+        SRAM program(0x10000);
+        program.clear(0);
+
+        // note: Assembler only positions code by .org after the first opcode
+        Assembler()
+                .NOP()
+            .org(0x8000)
+            .label("reset")
+                .SEI()
+                .LDX().immediate(0xff)
+                .TXS()
+                .LDA().immediate(0x80)
+                .STA().absolute(0x2000)
+            .label("loop")
+                .LDA().zp(0x10)
+                .CLC()
+                .ADC().immediate(step)
+                .STA().zp(0x10)
+                .STA().absolute(0x0300)
+                .INC().absolute(0x0301)
+                .JMP().absolute("loop")
+            .label("nmi")
+                .INC().zp(0x11)
+                .RTI()
+            .org(0xfffa)
+            .word("nmi")
+            .word("reset")
+            .word("nmi")
+            .compileTo(program);
+
+        return std::vector<uint8_t>(program.data() + 0x8000, program.data() + 0x10000);
+    }
+
+    /// @brief an NES core, with a cartridge, RAM and nametables of its own
+    class Machine {
+    public:
+        Machine(const INESRom& rom) : sram(0x0800), vram(0x1000), bus(cpuMemory, ppuMemory), simulation(testBench, bus) {
+            testBench.setClockPolarity(0);
+            testBench.core().i_ce = 1;
+
+            sram.clear(0);
+            vram.clear(0);
+            cpuMemory.map(0x0000, sram.size(), sram.data());
+
+            std::string error;
+            mapper = Mapper::create(rom, cpuMemory, ppuMemory, vram.data(), error);
+
+            mapper->reset();
+            bus.controller1().reset();
+            bus.controller1().setButtons(NESController::kStart);
+
+            simulation.setTraceMode(TraceMode::kNone);
+            simulation.reset();
+        }
+
+        void tick(size_t numTicks) {
+            simulation.tick(numTicks);
+            counters.numTicks += numTicks;
+        }
+
+        bool save(const std::string& path, const INESRom& rom, std::string& error) {
+            return NESSnapshot::save(path, testBench.core(), rom, sram, vram, *mapper, bus.controller1(), counters, error);
+        }
+
+        bool load(const std::string& path, const INESRom& rom, std::string& error) {
+            return NESSnapshot::load(path, testBench.core(), rom, sram, vram, *mapper, bus.controller1(), counters, error);
+        }
+
+        std::vector<uint8_t> ram() const {
+            return std::vector<uint8_t>(sram.data(), sram.data() + sram.size());
+        }
+
+        NESTestBench testBench;
+
+        SRAM sram;
+        SRAM vram;
+
+        PageTable cpuMemory;
+        PageTable ppuMemory;
+
+        std::unique_ptr<Mapper> mapper;
+
+        NESBus<VNES> bus;
+        Simulation<NESTestBench, NESBus<VNES>> simulation;
+
+        NESSnapshot::Counters counters;
+    };
+}
+
+TEST(Snapshot, ShouldReadSectionsThatWereWritten) {
+    const std::string path = tempPath("Snapshot.test.sections.nessnap");
+
+    const std::vector<uint8_t> data = { 1, 2, 3, 4, 5 };
+    const uint64_t value = 0x0123456789ABCDEFULL;
+
+    SnapshotWriter writer;
+    writer.addSection(7, data);
+    writer.addValue(9, value);
+    writer.addSection(11, {});
+    ASSERT_TRUE(writer.write(path)) << writer.error();
+
+    SnapshotReader reader;
+    ASSERT_TRUE(reader.open(path)) << reader.error();
+
+    std::span<const uint8_t> section;
+    ASSERT_TRUE(reader.section(7, section));
+    EXPECT_EQ(data, std::vector<uint8_t>(section.begin(), section.end()));
+
+    uint64_t readValue = 0;
+    ASSERT_TRUE(reader.value(9, readValue));
+    EXPECT_EQ(value, readValue);
+
+    ASSERT_TRUE(reader.section(11, section));
+    EXPECT_TRUE(section.empty());
+
+    // missing, or the wrong size
+    EXPECT_FALSE(reader.section(8, section));
+    uint32_t smallValue = 0;
+    EXPECT_FALSE(reader.value(9, smallValue));
+
+    reader.close();
+    std::filesystem::remove(path);
+}
+
+TEST(Snapshot, ShouldRejectFileThatIsNotASnapshot) {
+    const std::string path = tempPath("Snapshot.test.invalid.nessnap");
+
+    FILE* file = fopen(path.c_str(), "wb");
+    fputs("this is not a snapshot, but is long enough", file);
+    fclose(file);
+
+    SnapshotReader reader;
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_NE(std::string::npos, reader.error().find("is not a snapshot"));
+
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_NE(std::string::npos, reader.error().find("unable to open"));
+}
+
+TEST(Snapshot, ShouldRejectTruncatedSnapshot) {
+    const std::string path = tempPath("Snapshot.test.truncated.nessnap");
+
+    SnapshotWriter writer;
+    writer.addSection(1, std::vector<uint8_t>(64, 0xAA));
+    ASSERT_TRUE(writer.write(path)) << writer.error();
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 32);
+
+    SnapshotReader reader;
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_NE(std::string::npos, reader.error().find("is truncated"));
+
+    std::filesystem::remove(path);
+}
+
+TEST(Snapshot, ShouldResumeSimulationFromSnapshot) {
+    const std::string path = tempPath("Snapshot.test.nes.nessnap");
+    const size_t kNumTicksPerFrame = 341 * 262;
+
+    std::vector<uint8_t> program = assembleProgram(3);
+    TestRom testRom("Snapshot.test.nes", program, 1, 0);
+    ASSERT_TRUE(testRom.rom().isOpen()) << testRom.rom().error();
+
+    // note: the Verilated models are too large for the stack
+    auto machine = std::make_unique<Machine>(testRom.rom());
+    machine->tick(kNumTicksPerFrame + 1234);
+
+    std::string error;
+    ASSERT_TRUE(machine->save(path, testRom.rom(), error)) << error;
+
+    const NESSnapshot::Counters savedCounters = machine->counters;
+    const std::vector<uint8_t> savedRam = machine->ram();
+
+    machine->tick(kNumTicksPerFrame);
+    const std::vector<uint8_t> expectedRam = machine->ram();
+    const uint16_t expectedX = machine->testBench.core().o_video_x;
+    const uint16_t expectedY = machine->testBench.core().o_video_y;
+
+    ASSERT_NE(savedRam, expectedRam);
+
+    // rewind, and the simulation should take the same path
+    ASSERT_TRUE(machine->load(path, testRom.rom(), error)) << error;
+    EXPECT_EQ(savedCounters.numTicks, machine->counters.numTicks);
+    EXPECT_EQ(savedRam, machine->ram());
+
+    machine->tick(kNumTicksPerFrame);
+    EXPECT_EQ(expectedRam, machine->ram());
+    EXPECT_EQ(expectedX, machine->testBench.core().o_video_x);
+    EXPECT_EQ(expectedY, machine->testBench.core().o_video_y);
+
+    // and another simulation can resume from it
+    auto other = std::make_unique<Machine>(testRom.rom());
+    ASSERT_TRUE(other->load(path, testRom.rom(), error)) << error;
+    other->tick(kNumTicksPerFrame);
+    EXPECT_EQ(expectedRam, other->ram());
+
+    std::filesystem::remove(path);
+}
+
+TEST(Snapshot, ShouldRejectSnapshotOfDifferentRom) {
+    const std::string path = tempPath("Snapshot.test.rom.nessnap");
+
+    std::vector<uint8_t> program = assembleProgram(3);
+    TestRom testRom("Snapshot.test.rom.nes", program, 1, 0);
+
+    std::vector<uint8_t> otherProgram = assembleProgram(5);
+    TestRom otherRom("Snapshot.test.rom.other.nes", otherProgram, 1, 0);
+
+    auto machine = std::make_unique<Machine>(testRom.rom());
+    machine->tick(1000);
+
+    std::string error;
+    ASSERT_TRUE(machine->save(path, testRom.rom(), error)) << error;
+
+    auto other = std::make_unique<Machine>(otherRom.rom());
+    EXPECT_FALSE(other->load(path, otherRom.rom(), error));
+    EXPECT_NE(std::string::npos, error.find("different ROM"));
+    EXPECT_EQ(0u, other->counters.numTicks);
+
+    std::filesystem::remove(path);
+}
+
+TEST(Snapshot, ShouldRejectSnapshotOfDifferentModel) {
+    const std::string path = tempPath("Snapshot.test.model.nessnap");
+
+    std::vector<uint8_t> program = assembleProgram(3);
+    TestRom testRom("Snapshot.test.model.nes", program, 1, 0);
+
+    auto machine = std::make_unique<Machine>(testRom.rom());
+    machine->tick(1000);
+
+    std::string error;
+    ASSERT_TRUE(machine->save(path, testRom.rom(), error)) << error;
+
+    // the same ROM, but simulated by NESFast
+    auto fastTestBench = std::make_unique<NESFastTestBench>();
+    SRAM sram(0x0800);
+    SRAM vram(0x1000);
+    PageTable cpuMemory;
+    PageTable ppuMemory;
+    std::unique_ptr<Mapper> mapper = Mapper::create(testRom.rom(), cpuMemory, ppuMemory, vram.data(), error);
+    NESController controller;
+    NESSnapshot::Counters counters;
+
+    EXPECT_FALSE(NESSnapshot::load(path, fastTestBench->core(), testRom.rom(), sram, vram, *mapper, controller, counters, error));
+    EXPECT_NE(std::string::npos, error.find("different model"));
+    EXPECT_EQ(0u, counters.numTicks);
+
+    std::filesystem::remove(path);
+}
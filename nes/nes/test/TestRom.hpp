@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "nes/cartridge/INESRom.hpp"
+
+namespace testrom {
+    /// @class TestRom
+    /// @brief iNES ROM image, written to a temporary file and opened
+    /// @note unless PRG ROM is given, each PRG byte is the index of its 16KB bank. Each CHR byte is 0x80 + the index
+    ///       of its 4KB bank, so that a read shows which bank is mapped
+    class TestRom {
+    public:
+        /// @param name unique name of the temporary file
+        /// @param numChrBanks number of 8KB CHR ROM banks (0 for CHR RAM)
+        TestRom(const std::string& name, size_t numPrgBanks, size_t numChrBanks, uint8_t mapper, bool isVertical = false) {
+            std::vector<uint8_t> prgRom;
+
+            for (size_t i = 0; i < (numPrgBanks * cartridge::INESHeader::kPrgBankSize); i++) {
+                prgRom.push_back(uint8_t(i / cartridge::INESHeader::kPrgBankSize));
+            }
+
+            write(name, prgRom, numChrBanks, mapper, isVertical);
+        }
+
+        /// @param prgRom PRG ROM (e.g. an assembled program), a multiple of 16KB
+        TestRom(const std::string& name, std::span<const uint8_t> prgRom, size_t numChrBanks, uint8_t mapper) {
+            write(name, prgRom, numChrBanks, mapper, false);
+        }
+
+        ~TestRom() {
+            m_rom.close();
+            std::filesystem::remove(m_path);
+        }
+
+        TestRom(const TestRom&) = delete;
+        TestRom& operator=(const TestRom&) = delete;
+
+        const cartridge::INESRom& rom() const {
+            return m_rom;
+        }
+
+    private:
+        void write(const std::string& name, std::span<const uint8_t> prgRom, size_t numChrBanks, uint8_t mapper, bool isVertical) {
+            m_path = (std::filesystem::temp_directory_path() / name).string();
+
+            const size_t kChrBankSize = 0x1000;
+            const size_t numPrgBanks = prgRom.size() / cartridge::INESHeader::kPrgBankSize;
+
+            std::vector<uint8_t> image = { 'N', 'E', 'S', 0x1A, uint8_t(numPrgBanks), uint8_t(numChrBanks), uint8_t((mapper << 4) | (isVertical ? 1 : 0)), uint8_t(mapper & 0xF0) };
+            image.resize(cartridge::INESHeader::kSize, 0);
+            image.insert(image.end(), prgRom.begin(), prgRom.end());
+
+            for (size_t i = 0; i < (numChrBanks * 2 * kChrBankSize); i++) {
+                image.push_back(uint8_t(0x80 + (i / kChrBankSize)));
+            }
+
+            std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(image.data()), image.size());
+            file.close();
+
+            m_rom.open(m_path);
+        }
+
+        std::string m_path;
+        cartridge::INESRom m_rom;
+    };
+}
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+using namespace testing;
+
+#include "nes/simulation/TripleBuffer.hpp"
+using namespace simulation;
+
+namespace {
+    /// @brief a value that can be checked for a torn read (i.e. part written)
+    struct Value {
+        uint64_t sequence = 0;
+        uint64_t check = 0;
+        uint64_t padding[30] = {};
+    };
+}
+
+TEST(TripleBuffer, ShouldStartWithInitialValue) {
+    TripleBuffer<int> buffer(7);
+
+    EXPECT_EQ(7, buffer.front());
+    EXPECT_EQ(7, buffer.back());
+
+    // nothing has been published
+    EXPECT_FALSE(buffer.consume());
+    EXPECT_EQ(7, buffer.front());
+}
+
+TEST(TripleBuffer, ShouldConsumeMostRecentlyPublishedValue) {
+    TripleBuffer<int> buffer;
+
+    buffer.back() = 1;
+    buffer.publish();
+
+    ASSERT_TRUE(buffer.consume());
+    EXPECT_EQ(1, buffer.front());
+
+    // front is kept until something new is published
+    EXPECT_FALSE(buffer.consume());
+    EXPECT_EQ(1, buffer.front());
+
+    // intermediate values are dropped
+    buffer.back() = 2;
+    buffer.publish();
+    buffer.back() = 3;
+    buffer.publish();
+
+    ASSERT_TRUE(buffer.consume());
+    EXPECT_EQ(3, buffer.front());
+    EXPECT_FALSE(buffer.consume());
+}
+
+TEST(TripleBuffer, BackShouldHoldAnEarlierPublishedValue) {
+    TripleBuffer<int> buffer(0);
+
+    buffer.back() = 1;
+    buffer.publish();
+    EXPECT_EQ(0, buffer.back());
+
+    buffer.back() = 2;
+    buffer.publish();
+    EXPECT_EQ(1, buffer.back());
+
+    // the consumer takes 2, and hands back the buffer it held
+    ASSERT_TRUE(buffer.consume());
+    EXPECT_EQ(2, buffer.front());
+
+    buffer.back() = 3;
+    buffer.publish();
+    EXPECT_EQ(0, buffer.back());
+
+    // so a producer that updates incrementally must track what each buffer holds
+    buffer.back() = 4;
+    buffer.publish();
+    EXPECT_EQ(3, buffer.back());
+}
+
+TEST(TripleBuffer, ShouldHandOverValuesBetweenThreads) {
+    const uint64_t kNumValues = 200000;
+
+    TripleBuffer<Value> buffer;
+    std::atomic<bool> isProducing{true};
+
+    std::thread producer([&]() {
+        for (uint64_t sequence = 1; sequence <= kNumValues; sequence++) {
+            Value& value = buffer.back();
+            value.sequence = sequence;
+            value.check = sequence * 3;
+            buffer.publish();
+        }
+
+        isProducing = false;
+    });
+
+    uint64_t lastSequence = 0;
+    uint64_t numConsumed = 0;
+    bool isConsistent = true;
+
+    while (true) {
+        // note: once production has finished, one more consume() takes the last value
+        bool wasProducing = isProducing;
+
+        if (buffer.consume()) {
+            const Value& value = buffer.front();
+            isConsistent = isConsistent && (value.check == (value.sequence * 3)) && (value.sequence > lastSequence);
+
+            lastSequence = value.sequence;
+            numConsumed += 1;
+        }
+
+        if (!wasProducing) {
+            break;
+        }
+    }
+
+    producer.join();
+
+    EXPECT_TRUE(isConsistent);
+    EXPECT_GT(numConsumed, 0u);
+    EXPECT_EQ(kNumValues, buffer.front().sequence);
+    EXPECT_EQ(kNumValues * 3, buffer.front().check);
+}
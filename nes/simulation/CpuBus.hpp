@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+
+#include "nes/memory/SRAM.hpp"
+
+namespace simulation {
+    /// @class CpuBus
+    /// @brief Connect the address/data bus of a 6502 core to SRAM
+    /// @param CORE Verilated core with a 6502 bus (i.e. VCpu6502, VCpu2A03)
+    /// @note Resolved at compile time, so that it can be inlined into the tick loop
+    template <class CORE>
+    class CpuBus {
+    public:
+        /// @brief set of the pages (of memory::SRAM::kPageSize bytes) in the 16bit address space
+        typedef std::bitset<0x10000 / memory::SRAM::kPageSize> Pages;
+
+        CpuBus(memory::SRAM& sram) : m_sram(sram) {
+        }
+
+        /// @brief retrieve, and clear, the set of pages changed in SRAM (e.g. to invalidate a disassembly cache)
+        /// @note pages are taken from the SRAM's dirty bitmap, so include changes made outside of the bus
+        ///       (e.g. loading a program), and are always empty unless SRAM tracking is enabled
+        Pages takeWrittenPages() {
+            Pages pages;
+
+            size_t numPages = std::min(pages.size(), m_sram.numPages());
+            for (size_t page = 0; page < numPages; page++) {
+                pages[page] = m_sram.isPageDirty(page);
+            }
+
+            m_sram.clearDirty();
+
+            return pages;
+        }
+
+        /// @brief simulation at the end of a clock phase, before
+        ///        transition to other clock phase
+        inline void simulateCombinatorial(CORE& core) {
+            if (core.i_clk == 1) {
+                // clock: end of phi2
+                // R/W data is valid on the bus
+                if (core.o_rw == 0) {
+                    // write
+                    m_sram.write(core.o_address, core.o_data);
+                } else {
+                    // read
+                    core.i_data = m_sram.read(core.o_address);
+                }
+            } else {
+                // clock: end of phi 1
+                // undefined data on the bus
+                core.i_data = 0xFF;
+            }
+        }
+
+    private:
+        memory::SRAM& m_sram;
+    };
+}
@@ -0,0 +1,458 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "nes/memory/SRAM.hpp"
+#include "nes/simulation/Simulation.hpp"
+#include "nes/simulation/CpuBus.hpp"
+#include "nes/cpu6502/model/Cpu6502Model.hpp"
+#include "nes/cpu6502/assembler/Disassembler.hpp"
+
+namespace simulation {
+    /// @class CpuLockstep
+    /// @brief Co-simulate a Verilated 6502 core with the behavioural model (cpu6502::model::Cpu6502Model),
+    ///        an instruction at a time, and stop at the first divergence
+    /// @param TESTBENCH gtestverilog TestBench that owns the core
+    /// @param CORE Verilated core with a 6502 bus and debug ports (i.e. VCpu6502, VCpu2A03)
+    /// @note At each o_sync the registers reported by the o_debug_* ports are compared with the model,
+    ///       as are the number of cycles and the address / R/W (and write data) of every bus cycle
+    ///       of the previous instruction
+    /// @note The model runs on its own copy of memory, so a divergent write can't hide itself by
+    ///       changing what the other side reads
+    /// @note The interrupt lines are driven by setNMI() / setIRQ(). The model doesn't model the latency of
+    ///       the core taking an interrupt, so it takes an interrupt on the instruction that the core does,
+    ///       which must be one that was signalled, and within kMaxInterruptLatency instructions
+    template <class TESTBENCH, class CORE>
+    class CpuLockstep {
+    public:
+        typedef cpu6502::model::Registers Registers;
+
+        /// @brief bits of P that are compared (B is not a register on the 6502, but is on the RTL)
+        static const uint8_t kComparedFlags = 0xFF & ~(1 << 4);
+
+        /// @brief cycles after which the core is considered hung, if it has not reported o_sync
+        static const uint32_t kMaxCycles = 16;
+
+        /// @brief cycles that are kept (and compared) for each instruction, reset and BRK being longest
+        static const uint32_t kMaxBusCycles = 8;
+
+        /// @brief instructions that are kept for the diagnostic
+        static const size_t kHistorySize = 16;
+
+        /// @brief instructions that may complete while an interrupt is pending, before the core must take it
+        /// @note the core samples the interrupt lines a cycle late, and only takes an interrupt at the end of
+        ///       an instruction, so one that is signalled late in an instruction is taken after the next
+        static const uint32_t kMaxInterruptLatency = 2;
+
+        /// @brief cycles of the interrupt sequence (as for BRK)
+        static const uint32_t kInterruptCycles = 7;
+
+        struct BusCycle {
+            uint16_t address;
+            uint8_t data;           // written data (0 for reads)
+            bool isRead;
+
+            bool operator==(const BusCycle& other) const {
+                return (address == other.address) && (isRead == other.isRead) && (isRead || (data == other.data));
+            }
+        };
+
+        struct Instruction {
+            uint64_t index = 0;                 // 0 is the reset sequence
+            uint64_t tick = 0;                  // tick of the opcode fetch
+            Registers registers;                // RTL registers before the instruction
+            uint32_t numCycles = 0;             // RTL cycles taken
+            uint16_t interruptVector = 0;       // vector of an interrupt taken by the RTL, instead of an opcode
+        };
+
+        /// @param sram memory connected to the core, which is copied for the model on reset()
+        CpuLockstep(TESTBENCH& testBench, memory::SRAM& sram) : m_testBench(testBench), m_sram(sram), m_modelMemory(sram), m_bus(sram), m_simulation(testBench, m_bus), m_modelBus(*this), m_model(m_modelBus) {
+            m_simulation.setTraceMode(TraceMode::kNone);
+        }
+
+        CpuLockstep(const CpuLockstep&) = delete;
+        CpuLockstep& operator=(const CpuLockstep&) = delete;
+
+        /// @brief reset the core, and take a copy of memory for the model
+        /// @note the model starts in the power on state, so this should be called once per TestBench
+        void reset() {
+            auto& core = m_testBench.core();
+            core.i_clk_en = 1;
+            core.i_irq_n = 1;
+            core.i_nmi_n = 1;
+
+            m_isNMIActive = false;
+            m_isNMIPending = false;
+            m_isIRQActive = false;
+            m_numPendingInstructions = 0;
+
+            m_simulation.reset();
+
+            m_modelMemory = m_sram;
+            m_model.registers() = Registers();
+            m_model.registers().p = ModelCpu::kFlagU;
+
+            m_numTicks = 0;
+            m_numInstructions = 0;
+            m_numRtlCycles = 0;
+            m_numHistory = 0;
+            m_diagnostic.clear();
+
+            // the reset sequence is reported by o_sync, and is checked as the first instruction
+            tickCore();
+        }
+
+        /// @brief drive the NMI line of the core, which is edge triggered (cf Cpu6502Model::setNMI)
+        /// @note the line should be held active until the NMI has been taken
+        void setNMI(bool isActive) {
+            if (isActive && !m_isNMIActive) {
+                m_isNMIPending = true;
+            }
+
+            m_isNMIActive = isActive;
+            m_testBench.core().i_nmi_n = isActive ? 0 : 1;
+        }
+
+        /// @brief drive the IRQ line of the core (cf Cpu6502Model::setIRQ)
+        void setIRQ(bool isActive) {
+            m_isIRQActive = isActive;
+            m_testBench.core().i_irq_n = isActive ? 0 : 1;
+        }
+
+        /// @brief step the core and the model through an instruction
+        /// @return false if they have diverged
+        bool step() {
+            if (hasDiverged()) {
+                return false;
+            }
+
+            auto& core = m_testBench.core();
+
+            Instruction instruction;
+            instruction.index = m_numInstructions;
+            instruction.tick = m_numTicks - 1;
+
+            const uint16_t pc = m_rtlCycles[0].address;
+            m_numModelCycles = 0;
+
+            // note: some opcodes are still writing to registers in the first clock cycle
+            //  (see EmulatorCPU::logLastOpcode)
+            tickCore();
+            instruction.registers = coreRegisters(pc);
+
+            if ((instruction.index > 0) && !isEqual(instruction.registers, m_model.registers())) {
+                return diverge(instruction, "registers differ after the previous instruction");
+            }
+
+            while (core.o_sync == 0) {
+                if ((core.o_debug_error == 1) || (m_numRtlCycles >= kMaxCycles)) {
+                    break;
+                }
+
+                tickCore();
+            }
+
+            // the last tick fetched the next opcode
+            instruction.numCycles = m_numRtlCycles - 1;
+
+            if (core.o_debug_error == 1) {
+                return diverge(instruction, "core reported o_debug_error");
+            }
+
+            if (core.o_sync == 0) {
+                return diverge(instruction, "core did not report o_sync");
+            }
+
+            // the RTL enters an interrupt by fetching the opcode at PC again, rather than its operand
+            if ((instruction.index > 0) && (instruction.numCycles == kInterruptCycles) && m_rtlCycles[1].isRead && (m_rtlCycles[1].address == pc)) {
+                instruction.interruptVector = m_rtlCycles[5].address;
+            }
+
+            // note: the model is stepped after the RTL, to take an interrupt where the RTL does
+            uint32_t numModelCycles = 0;
+
+            if (instruction.index == 0) {
+                numModelCycles = m_model.reset();
+            } else if (instruction.interruptVector == ModelCpu::kVectorNMI) {
+                if (!m_isNMIPending) {
+                    return diverge(instruction, "core took an NMI that was not signalled");
+                }
+
+                m_isNMIPending = false;
+                m_numPendingInstructions = 0;
+
+                m_model.setNMI(false);
+                m_model.setNMI(true);
+                numModelCycles = m_model.step();
+                m_model.setNMI(false);
+            } else if (instruction.interruptVector == ModelCpu::kVectorIRQ) {
+                if (!m_isIRQActive) {
+                    return diverge(instruction, "core took an IRQ that was not signalled");
+                }
+
+                m_numPendingInstructions = 0;
+
+                m_model.setIRQ(true);
+                numModelCycles = m_model.step();
+                m_model.setIRQ(false);
+            } else {
+                const bool isInterruptPending = m_isNMIPending || (m_isIRQActive && ((m_model.registers().p & ModelCpu::kFlagI) == 0));
+
+                numModelCycles = m_model.step();
+
+                m_numPendingInstructions = isInterruptPending ? (m_numPendingInstructions + 1) : 0;
+
+                if (m_numPendingInstructions > kMaxInterruptLatency) {
+                    return diverge(instruction, "core did not take a pending interrupt");
+                }
+            }
+
+            if (m_model.hasErrored()) {
+                return diverge(instruction, "model executed an undocumented opcode");
+            }
+
+            if (instruction.numCycles != numModelCycles) {
+                return diverge(instruction, "number of cycles differ");
+            }
+
+            const uint32_t numCompared = std::min(instruction.numCycles, kMaxBusCycles);
+
+            for (uint32_t i = 0; i < numCompared; ++i) {
+                if (!(m_rtlCycles[i] == m_modelCycles[i])) {
+                    return diverge(instruction, "bus cycles differ");
+                }
+            }
+
+            pushHistory(instruction);
+            m_numInstructions++;
+
+            // start the cycles of the next instruction with its opcode fetch
+            m_rtlCycles[0] = m_rtlCycles[m_numRtlCycles - 1];
+            m_numRtlCycles = 1;
+
+            return true;
+        }
+
+        /// @brief step through instructions, until the core and the model diverge
+        /// @return number of instructions that matched
+        uint64_t run(uint64_t numInstructions) {
+            uint64_t i = 0;
+
+            while ((i < numInstructions) && step()) {
+                i++;
+            }
+
+            return i;
+        }
+
+        bool hasDiverged() const {
+            return !m_diagnostic.empty();
+        }
+
+        /// @brief description of the divergence, with the instructions that led up to it
+        const std::string& diagnostic() const {
+            return m_diagnostic;
+        }
+
+        /// @brief number of instructions that matched (including the reset sequence)
+        uint64_t numInstructions() const {
+            return m_numInstructions;
+        }
+
+        uint64_t numTicks() const {
+            return m_numTicks;
+        }
+
+        const Registers& modelRegisters() const {
+            return m_model.registers();
+        }
+
+    private:
+        /// @class ModelBus
+        /// @brief connect the model to its copy of memory, and record its bus cycles
+        class ModelBus {
+        public:
+            ModelBus(CpuLockstep& lockstep) : m_lockstep(lockstep) {
+            }
+
+            inline uint8_t read(uint16_t address) {
+                m_lockstep.recordModelCycle(address, 0, true);
+
+                return m_lockstep.m_modelMemory.read(address);
+            }
+
+            inline void write(uint16_t address, uint8_t data) {
+                m_lockstep.recordModelCycle(address, data, false);
+
+                m_lockstep.m_modelMemory.write(address, data);
+            }
+
+        private:
+            CpuLockstep& m_lockstep;
+        };
+
+        typedef cpu6502::model::Cpu6502Model<ModelBus> ModelCpu;
+
+        TESTBENCH& m_testBench;
+        memory::SRAM& m_sram;
+        memory::SRAM m_modelMemory;
+        CpuBus<CORE> m_bus;
+        Simulation<TESTBENCH, CpuBus<CORE>> m_simulation;
+        ModelBus m_modelBus;
+        ModelCpu m_model;
+
+        // interrupt lines, as driven by setNMI() / setIRQ()
+        bool m_isNMIActive = false;
+        bool m_isNMIPending = false;            // falling edge, that the core hasn't taken yet
+        bool m_isIRQActive = false;
+        uint32_t m_numPendingInstructions = 0;  // completed while an interrupt was pending
+
+        uint64_t m_numTicks = 0;
+        uint64_t m_numInstructions = 0;
+
+        // bus cycles of the current instruction, from its opcode fetch
+        BusCycle m_rtlCycles[kMaxCycles + 1];
+        uint32_t m_numRtlCycles = 0;
+        BusCycle m_modelCycles[kMaxBusCycles];
+        uint32_t m_numModelCycles = 0;
+
+        // ring of the most recent instructions
+        Instruction m_history[kHistorySize];
+        size_t m_numHistory = 0;
+
+        std::string m_diagnostic;
+
+        void tickCore() {
+            m_simulation.tick();
+            m_numTicks++;
+
+            auto& core = m_testBench.core();
+
+            if (m_numRtlCycles <= kMaxCycles) {
+                BusCycle& cycle = m_rtlCycles[m_numRtlCycles++];
+                cycle.address = core.o_address;
+                cycle.isRead = (core.o_rw == 1);
+                cycle.data = cycle.isRead ? 0 : core.o_data;
+            }
+        }
+
+        inline void recordModelCycle(uint16_t address, uint8_t data, bool isRead) {
+            if (m_numModelCycles < kMaxBusCycles) {
+                m_modelCycles[m_numModelCycles] = BusCycle{address, data, isRead};
+            }
+
+            m_numModelCycles++;
+        }
+
+        Registers coreRegisters(uint16_t pc) const {
+            const auto& core = m_testBench.core();
+
+            Registers registers;
+            registers.pc = pc;
+            registers.a = core.o_debug_ac;
+            registers.x = core.o_debug_x;
+            registers.y = core.o_debug_y;
+            registers.s = core.o_debug_s;
+            registers.p = core.o_debug_p;
+
+            return registers;
+        }
+
+        static bool isEqual(const Registers& rtl, const Registers& model) {
+            Registers masked = rtl;
+            masked.p = (rtl.p & kComparedFlags) | (model.p & ~kComparedFlags);
+
+            return masked == model;
+        }
+
+        void pushHistory(const Instruction& instruction) {
+            m_history[m_numHistory % kHistorySize] = instruction;
+            m_numHistory++;
+        }
+
+        bool diverge(const Instruction& instruction, const char* reason) {
+            char line[128];
+
+            snprintf(line, sizeof(line), "lockstep: %s at instruction %llu (tick %llu)\n", reason, (unsigned long long)instruction.index, (unsigned long long)instruction.tick);
+            m_diagnostic = line;
+
+            m_diagnostic += "  history (RTL registers before each instruction):\n";
+
+            const size_t numHistory = std::min(m_numHistory, kHistorySize);
+
+            for (size_t i = m_numHistory - numHistory; i < m_numHistory; ++i) {
+                appendInstruction(m_history[i % kHistorySize], m_history[i % kHistorySize].registers);
+            }
+
+            m_diagnostic += "  divergent instruction:\n";
+            appendInstruction(instruction, instruction.registers);
+
+            m_diagnostic += "  registers:\n";
+            appendRegisters("    RTL   ", instruction.registers);
+            appendRegisters("    model ", m_model.registers());
+
+            m_diagnostic += "  bus cycles (RTL | model):\n";
+
+            const uint32_t numRtlCycles = std::min(instruction.numCycles, kMaxCycles);
+            const uint32_t numModelCycles = std::min(m_numModelCycles, kMaxBusCycles);
+
+            for (uint32_t i = 0; i < std::max(numRtlCycles, numModelCycles); ++i) {
+                std::string rtl = (i < numRtlCycles) ? formatCycle(m_rtlCycles[i]) : std::string("");
+                std::string model = (i < numModelCycles) ? formatCycle(m_modelCycles[i]) : std::string("");
+                const char* marker = ((i < numRtlCycles) && (i < numModelCycles) && (m_rtlCycles[i] == m_modelCycles[i])) ? " " : "*";
+
+                snprintf(line, sizeof(line), "   %s T%u  %-10s | %s\n", marker, i, rtl.c_str(), model.c_str());
+                m_diagnostic += line;
+            }
+
+            snprintf(line, sizeof(line), "  cycles: RTL %u, model %u\n", instruction.numCycles, m_numModelCycles);
+            m_diagnostic += line;
+
+            return false;
+        }
+
+        void appendInstruction(const Instruction& instruction, const Registers& registers) {
+            char line[128];
+
+            char disassembly[32] = "RESET";
+
+            if (instruction.interruptVector == ModelCpu::kVectorNMI) {
+                snprintf(disassembly, sizeof(disassembly), "NMI");
+            } else if (instruction.interruptVector == ModelCpu::kVectorIRQ) {
+                snprintf(disassembly, sizeof(disassembly), "IRQ");
+            } else if (instruction.index > 0) {
+                cpu6502::assembler::Disassembler::DisassembledOpcode opcode;
+                cpu6502::assembler::Disassembler::disassembleOpcode(m_modelMemory.span(), 0, registers.pc, opcode);
+
+                opcode.format(disassembly, sizeof(disassembly));
+            }
+
+            snprintf(line, sizeof(line), "    %8llu  %04X  %-24s", (unsigned long long)instruction.index, registers.pc, disassembly);
+            m_diagnostic += line;
+
+            appendRegisters("", registers);
+        }
+
+        void appendRegisters(const char* prefix, const Registers& registers) {
+            char line[128];
+
+            snprintf(line, sizeof(line), "%sPC:%04X A:%02X X:%02X Y:%02X P:%02X SP:%02X\n", prefix, registers.pc, registers.a, registers.x, registers.y, registers.p, registers.s);
+            m_diagnostic += line;
+        }
+
+        static std::string formatCycle(const BusCycle& cycle) {
+            char buffer[16];
+
+            if (cycle.isRead) {
+                snprintf(buffer, sizeof(buffer), "R %04X", cycle.address);
+            } else {
+                snprintf(buffer, sizeof(buffer), "W %04X %02X", cycle.address, cycle.data);
+            }
+
+            return buffer;
+        }
+    };
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace simulation {
+    /// @class ForkFanOut
+    /// @brief Branch the current simulation into child processes, that share its state
+    ///        copy-on-write, and collect a result from each child over a pipe
+    /// @note The expensive common prefix of a simulation (e.g. booting to a title screen)
+    ///       only needs to be simulated once, in the parent, before calling run()
+    /// @param RESULT trivially copyable result of a branch (e.g. frame hash + counters)
+    template <class RESULT>
+    class ForkFanOut {
+        static_assert(std::is_trivially_copyable<RESULT>::value, "RESULT is sent over a pipe");
+        static_assert(sizeof(RESULT) <= PIPE_BUF, "RESULT must be written to a pipe atomically");
+
+    public:
+        struct Branch {
+            bool isComplete = false;            // did the child report a result
+            int exitStatus = -1;                // status from waitpid()
+            int startError = 0;                 // errno, if the child could not be started (pipe() or fork() failed)
+            RESULT result {};
+        };
+
+        /// @brief run each branch in its own child process
+        /// @param numBranches number of child processes to fork
+        /// @param maxProcesses maximum number of child processes running at once (e.g. number of cores)
+        /// @param branch called in the child process with the index of the branch, returns its result
+        /// @return a Branch for each index, in order
+        template <class BRANCH>
+        static std::vector<Branch> run(size_t numBranches, size_t maxProcesses, BRANCH&& branch) {
+            std::vector<Branch> branches(numBranches);
+
+            std::vector<Child> children;
+            size_t nextIndex = 0;
+
+            maxProcesses = (maxProcesses == 0) ? 1 : maxProcesses;
+
+            // don't duplicate pending output in each child
+            fflush(stdout);
+            fflush(stderr);
+
+            while ((nextIndex < numBranches) || !children.empty()) {
+                while ((nextIndex < numBranches) && (children.size() < maxProcesses)) {
+                    size_t index = nextIndex++;
+
+                    int fds[2];
+                    if (pipe(fds) != 0) {
+                        branches[index].startError = errno;
+                        continue;
+                    }
+
+                    pid_t pid = fork();
+
+                    if (pid == 0) {
+                        // child
+                        close(fds[0]);
+
+                        RESULT result = branch(index);
+                        bool isWritten = write(fds[1], &result, sizeof(RESULT)) == ssize_t(sizeof(RESULT));
+
+                        // note: skip destructors + atexit handlers, which belong to the parent,
+                        //       but not output of the branch that is still buffered (e.g. to a pipe)
+                        fflush(stdout);
+                        fflush(stderr);
+                        _exit(isWritten ? 0 : 1);
+                    }
+
+                    if (pid < 0) {
+                        branches[index].startError = errno;
+                        close(fds[0]);
+                        close(fds[1]);
+                        continue;
+                    }
+
+                    close(fds[1]);
+
+                    children.push_back({ pid, fds[0], index });
+                }
+
+                if (children.empty()) {
+                    break;
+                }
+
+                // only the children forked here are waited on, so that the exit status of the caller's
+                // other children (e.g. a popen'd tool) isn't taken: poll each of them, and if none have
+                // exited, block on the oldest
+                bool hasReaped = false;
+
+                for (size_t i = 0; i < children.size(); ) {
+                    int status = 0;
+                    pid_t pid = waitpid(children[i].pid, &status, WNOHANG);
+
+                    if ((pid == 0) || ((pid < 0) && (errno == EINTR))) {
+                        i++;
+                        continue;
+                    }
+
+                    reap(branches, children[i], pid > 0, status);
+                    children.erase(children.begin() + i);
+                    hasReaped = true;
+                }
+
+                if (!hasReaped) {
+                    int status = 0;
+                    pid_t pid = waitpid(children.front().pid, &status, 0);
+
+                    if ((pid < 0) && (errno == EINTR)) {
+                        continue;
+                    }
+
+                    reap(branches, children.front(), pid > 0, status);
+                    children.erase(children.begin());
+                }
+            }
+
+            return branches;
+        }
+
+    private:
+        struct Child {
+            pid_t pid;
+            int fd;
+            size_t index;
+        };
+
+        /// @brief collect the result of a child, and close its pipe
+        /// @param hasExited false if the child could not be waited on (e.g. it was reaped elsewhere),
+        ///                  in which case its branch is left incomplete
+        static void reap(std::vector<Branch>& branches, const Child& child, bool hasExited, int status) {
+            if (hasExited) {
+                Branch& done = branches[child.index];
+                done.exitStatus = status;
+
+                // note: the whole result is already buffered in the pipe, as the child has exited
+                done.isComplete = read(child.fd, &done.result, sizeof(RESULT)) == ssize_t(sizeof(RESULT));
+            }
+
+            close(child.fd);
+        }
+    };
+}
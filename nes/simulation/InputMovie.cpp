@@ -0,0 +1,325 @@
+#include "InputMovie.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace {
+    const char kMagic[8] = { 'N', 'E', 'S', 'M', 'O', 'V', 'I', 'E' };
+    const uint32_t kVersion = 1;
+
+    struct MovieHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t firstLatchIndex;
+    };
+
+    void writeVarint(FILE* file, uint64_t value) {
+        do {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+
+            if (value != 0) {
+                byte |= 0x80;
+            }
+
+            fputc(byte, file);
+        } while (value != 0);
+    }
+
+    bool readVarint(FILE* file, uint64_t& value) {
+        value = 0;
+
+        for (int shift = 0; shift < 64; shift += 7) {
+            int byte = fgetc(file);
+            if (byte == EOF) {
+                return false;
+            }
+
+            value |= uint64_t(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+namespace simulation {
+    InputMovieRecorder::InputMovieRecorder() : m_file(nullptr), m_hasHeader(false), m_firstLatchIndex(0), m_runButtons(0), m_runLength(0), m_nextLatchIndex(0) {
+
+    }
+
+    InputMovieRecorder::~InputMovieRecorder() {
+        close();
+    }
+
+    bool InputMovieRecorder::open(const std::string& path) {
+        close();
+
+        m_file = fopen(path.c_str(), "wb");
+        if (m_file == nullptr) {
+            m_error = "unable to open '" + path + "': " + strerror(errno);
+            return false;
+        }
+
+        m_hasHeader = false;
+        m_runLength = 0;
+        m_runs.clear();
+
+        return true;
+    }
+
+    bool InputMovieRecorder::close() {
+        if (m_file == nullptr) {
+            return true;
+        }
+
+        if (!m_hasHeader) {
+            // empty movie
+            writeHeader(0);
+        }
+
+        writeRun();
+
+        bool isOk = !ferror(m_file);
+        isOk = (fclose(m_file) == 0) && isOk;
+        m_file = nullptr;
+
+        return isOk;
+    }
+
+    bool InputMovieRecorder::isOpen() const {
+        return m_file != nullptr;
+    }
+
+    const std::string& InputMovieRecorder::error() const {
+        return m_error;
+    }
+
+    bool InputMovieRecorder::canRewind(uint64_t latchIndex) const {
+        return !m_hasHeader || (latchIndex <= m_nextLatchIndex);
+    }
+
+    bool InputMovieRecorder::rewind(uint64_t latchIndex) {
+        if ((m_file == nullptr) || !m_hasHeader) {
+            // nothing recorded yet, recording starts from the next latch
+            return true;
+        }
+
+        if (!canRewind(latchIndex)) {
+            m_error = "latch " + std::to_string(latchIndex) + " is ahead of the recording (latch " + std::to_string(m_nextLatchIndex) + ")";
+            return false;
+        }
+
+        if (latchIndex <= m_firstLatchIndex) {
+            // start again, from the latch
+            m_hasHeader = false;
+            m_runLength = 0;
+            m_runs.clear();
+
+            return truncate(0);
+        }
+
+        uint64_t runStart = m_nextLatchIndex - m_runLength;
+
+        if (latchIndex < runStart) {
+            // the latch is in a run that has been written, so truncate the file to that run, and continue it
+            auto it = std::upper_bound(m_runs.begin(), m_runs.end(), latchIndex, [](uint64_t latchIndex, const Run& run) {
+                return latchIndex < run.start;
+            }) - 1;
+
+            if (!truncate(it->offset)) {
+                return false;
+            }
+
+            runStart = it->start;
+            m_runButtons = it->buttons;
+            m_runs.erase(it, m_runs.end());
+        }
+
+        m_runLength = latchIndex - runStart;
+        m_nextLatchIndex = latchIndex;
+
+        return true;
+    }
+
+    uint8_t InputMovieRecorder::onLatch(uint64_t latchIndex, uint8_t buttons) {
+        if (m_file == nullptr) {
+            return buttons;
+        }
+
+        if (!m_hasHeader) {
+            // note: recording may start part way through a run (e.g. after loading a snapshot)
+            writeHeader(latchIndex);
+            m_nextLatchIndex = latchIndex;
+        }
+
+        // note: movies are contiguous, a latch can not be skipped (see rewind())
+        if (latchIndex != m_nextLatchIndex) {
+            return buttons;
+        }
+
+        if ((m_runLength > 0) && (buttons != m_runButtons)) {
+            writeRun();
+        }
+
+        m_runButtons = buttons;
+        m_runLength += 1;
+        m_nextLatchIndex += 1;
+
+        return buttons;
+    }
+
+    bool InputMovieRecorder::writeHeader(uint64_t firstLatchIndex) {
+        MovieHeader header;
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.reserved = 0;
+        header.firstLatchIndex = firstLatchIndex;
+
+        m_hasHeader = true;
+        m_firstLatchIndex = firstLatchIndex;
+
+        return fwrite(&header, sizeof(header), 1, m_file) == 1;
+    }
+
+    void InputMovieRecorder::writeRun() {
+        if (m_runLength == 0) {
+            return;
+        }
+
+        m_runs.push_back({ m_nextLatchIndex - m_runLength, ftell(m_file), m_runButtons });
+
+        fputc(m_runButtons, m_file);
+        writeVarint(m_file, m_runLength);
+
+        m_runLength = 0;
+    }
+
+    bool InputMovieRecorder::truncate(long offset) {
+        if ((fflush(m_file) != 0) || (ftruncate(fileno(m_file), offset) != 0) || (fseek(m_file, offset, SEEK_SET) != 0)) {
+            m_error = std::string("unable to rewind the recording: ") + strerror(errno);
+            return false;
+        }
+
+        return true;
+    }
+
+    InputMovieReplayer::InputMovieReplayer() : m_file(nullptr), m_firstLatchIndex(0), m_runStart(0), m_runLength(0), m_runButtons(0), m_isFinished(true) {
+
+    }
+
+    InputMovieReplayer::~InputMovieReplayer() {
+        close();
+    }
+
+    bool InputMovieReplayer::open(const std::string& path) {
+        close();
+
+        m_path = path;
+        m_file = fopen(path.c_str(), "rb");
+        if (m_file == nullptr) {
+            m_error = "unable to open '" + path + "': " + strerror(errno);
+            return false;
+        }
+
+        if (!readHeader()) {
+            m_error = "'" + path + "' is not an input movie";
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void InputMovieReplayer::close() {
+        if (m_file != nullptr) {
+            fclose(m_file);
+        }
+
+        m_file = nullptr;
+        m_isFinished = true;
+    }
+
+    const std::string& InputMovieReplayer::error() const {
+        return m_error;
+    }
+
+    bool InputMovieReplayer::isFinished() const {
+        return m_isFinished;
+    }
+
+    uint8_t InputMovieReplayer::onLatch(uint64_t latchIndex, uint8_t buttons) {
+        if (m_file == nullptr) {
+            return buttons;
+        }
+
+        if (latchIndex < m_firstLatchIndex) {
+            return buttons;
+        }
+
+        if (latchIndex < m_runStart) {
+            // rewind (e.g. to an earlier snapshot), and stream forward again
+            if (!open(m_path)) {
+                return 0;
+            }
+        }
+
+        // skip forward to the run that contains the latch
+        while (!m_isFinished && (latchIndex >= (m_runStart + m_runLength))) {
+            m_runStart += m_runLength;
+            m_runLength = 0;
+
+            if (!readRun()) {
+                m_isFinished = true;
+            }
+        }
+
+        if (m_isFinished) {
+            return 0;
+        }
+
+        return m_runButtons;
+    }
+
+    bool InputMovieReplayer::readHeader() {
+        MovieHeader header;
+        if (fread(&header, sizeof(header), 1, m_file) != 1) {
+            return false;
+        }
+
+        if ((memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) || (header.version != kVersion)) {
+            return false;
+        }
+
+        m_firstLatchIndex = header.firstLatchIndex;
+        m_runStart = m_firstLatchIndex;
+        m_runLength = 0;
+        m_isFinished = false;
+
+        return true;
+    }
+
+    bool InputMovieReplayer::readRun() {
+        int buttons = fgetc(m_file);
+        if (buttons == EOF) {
+            return false;
+        }
+
+        uint64_t length = 0;
+        if (!readVarint(m_file, length) || (length == 0)) {
+            return false;
+        }
+
+        m_runButtons = uint8_t(buttons);
+        m_runLength = length;
+
+        return true;
+    }
+}
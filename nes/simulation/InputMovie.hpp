@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "nes/simulation/NESController.hpp"
+
+namespace simulation {
+    /// @brief Binary controller input movie, keyed by latch index
+    /// @note File layout:
+    ///         header:  "NESMOVIE", uint32 version, uint32 reserved, uint64 first latch index
+    ///         runs:    uint8 buttons, LEB128 varint number of consecutive latches
+    ///       Input is keyed by latch (rather than by frame or tick), so that replay is
+    ///       bit-exact regardless of how often the runner samples its own input.
+
+    /// @class InputMovieRecorder
+    /// @brief Record the buttons latched by the NES, streamed to file
+    class InputMovieRecorder : public LatchHandler {
+    public:
+        InputMovieRecorder();
+        ~InputMovieRecorder() override;
+
+        InputMovieRecorder(const InputMovieRecorder&) = delete;
+        InputMovieRecorder& operator=(const InputMovieRecorder&) = delete;
+
+        /// @brief start recording to file
+        /// @return false if the file could not be opened (see error())
+        bool open(const std::string& path);
+
+        /// @brief finish recording
+        /// @return false if the file could not be written
+        bool close();
+
+        bool isOpen() const;
+
+        const std::string& error() const;
+
+        /// @brief can the recording continue from a latch (e.g. of a snapshot that is about to be loaded)
+        /// @note latches can't be skipped, so only a latch that has been recorded (or the next) can be continued from
+        bool canRewind(uint64_t latchIndex) const;
+
+        /// @brief discard the latches recorded from latchIndex onwards, so that recording continues from there
+        /// @return false if the latch is ahead of the recording (see canRewind()), or the file could not be truncated
+        bool rewind(uint64_t latchIndex);
+
+        /// @brief record the latched buttons
+        uint8_t onLatch(uint64_t latchIndex, uint8_t buttons) override;
+
+    private:
+        bool writeHeader(uint64_t firstLatchIndex);
+        void writeRun();
+        bool truncate(long offset);
+
+        /// @brief a run that has been written to file
+        struct Run {
+            uint64_t start;             // latch index of the first latch in the run
+            long offset;                // file offset of the run
+            uint8_t buttons;
+        };
+
+        FILE* m_file;
+        bool m_hasHeader;
+        uint64_t m_firstLatchIndex;
+        uint8_t m_runButtons;
+        uint64_t m_runLength;
+        uint64_t m_nextLatchIndex;
+        std::vector<Run> m_runs;
+        std::string m_error;
+    };
+
+    /// @class InputMovieReplayer
+    /// @brief Replay the buttons of a movie at each latch, streamed from file
+    /// @note Only the current run is held in memory, so movies of any length can be replayed
+    class InputMovieReplayer : public LatchHandler {
+    public:
+        InputMovieReplayer();
+        ~InputMovieReplayer() override;
+
+        InputMovieReplayer(const InputMovieReplayer&) = delete;
+        InputMovieReplayer& operator=(const InputMovieReplayer&) = delete;
+
+        /// @brief open a movie for replay
+        /// @return false if the file could not be opened, or is not a movie (see error())
+        bool open(const std::string& path);
+
+        void close();
+
+        const std::string& error() const;
+
+        /// @brief has the movie run out of input
+        bool isFinished() const;
+
+        /// @brief replace the buttons with the movie's, before the movie starts the
+        ///        buttons are passed through, and after it ends no buttons are pressed
+        uint8_t onLatch(uint64_t latchIndex, uint8_t buttons) override;
+
+    private:
+        bool readHeader();
+        bool readRun();
+
+        FILE* m_file;
+        std::string m_path;
+        uint64_t m_firstLatchIndex;
+        uint64_t m_runStart;            // latch index of the first latch in the current run
+        uint64_t m_runLength;
+        uint8_t m_runButtons;
+        bool m_isFinished;
+        std::string m_error;
+    };
+}
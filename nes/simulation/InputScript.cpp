@@ -0,0 +1,129 @@
+#include "InputScript.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "nes/simulation/NESController.hpp"
+
+namespace {
+    bool parseButtons(const std::string& text, uint8_t& buttons) {
+        buttons = 0;
+
+        if (text == "-") {
+            return true;
+        }
+
+        std::stringstream stream(text);
+        std::string name;
+
+        while (std::getline(stream, name, '+')) {
+            if (name == "a") {
+                buttons |= simulation::NESController::kA;
+            } else if (name == "b") {
+                buttons |= simulation::NESController::kB;
+            } else if (name == "select") {
+                buttons |= simulation::NESController::kSelect;
+            } else if (name == "start") {
+                buttons |= simulation::NESController::kStart;
+            } else if (name == "up") {
+                buttons |= simulation::NESController::kUp;
+            } else if (name == "down") {
+                buttons |= simulation::NESController::kDown;
+            } else if (name == "left") {
+                buttons |= simulation::NESController::kLeft;
+            } else if (name == "right") {
+                buttons |= simulation::NESController::kRight;
+            } else {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+namespace simulation {
+    bool InputScript::load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            m_error = "unable to open '" + path + "'";
+            return false;
+        }
+
+        std::stringstream text;
+        text << file.rdbuf();
+
+        if (!parse(text.str())) {
+            m_error = "'" + path + "': " + m_error;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool InputScript::parse(const std::string& text) {
+        m_changes.clear();
+        m_error.clear();
+
+        std::stringstream stream(text);
+        std::string line;
+        int lineNumber = 0;
+
+        while (std::getline(stream, line)) {
+            lineNumber += 1;
+
+            line = line.substr(0, line.find('#'));
+
+            std::stringstream lineStream(line);
+            uint64_t frame;
+            std::string buttonsText;
+
+            if (!(lineStream >> frame)) {
+                // blank, or comment
+                if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                    continue;
+                }
+
+                m_error = "line " + std::to_string(lineNumber) + ": expected '<frame> <buttons>'";
+                return false;
+            }
+
+            uint8_t buttons;
+            if (!(lineStream >> buttonsText) || !parseButtons(buttonsText, buttons)) {
+                m_error = "line " + std::to_string(lineNumber) + ": invalid buttons";
+                return false;
+            }
+
+            if (!m_changes.empty() && (frame < m_changes.back().frame)) {
+                m_error = "line " + std::to_string(lineNumber) + ": frames must be in order";
+                return false;
+            }
+
+            add(frame, buttons);
+        }
+
+        return true;
+    }
+
+    void InputScript::add(uint64_t frame, uint8_t buttons) {
+        m_changes.push_back({ frame, buttons });
+    }
+
+    uint8_t InputScript::buttons(uint64_t frame) const {
+        // most recent change at, or before, the frame
+        auto it = std::upper_bound(m_changes.begin(), m_changes.end(), frame, [](uint64_t frame, const Change& change) {
+            return frame < change.frame;
+        });
+
+        if (it == m_changes.begin()) {
+            return 0;
+        }
+
+        return (it - 1)->buttons;
+    }
+
+    const std::string& InputScript::error() const {
+        return m_error;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace simulation {
+    /// @class InputScript
+    /// @brief Controller input, as a list of button changes keyed by frame number
+    /// @note Text format, one change per line, e.g.
+    ///         # comment
+    ///         120 start          (press START from frame 120)
+    ///         125 -              (release all buttons from frame 125)
+    ///         200 right+a        (hold RIGHT and A from frame 200)
+    ///       buttons: a, b, select, start, up, down, left, right
+    class InputScript {
+    public:
+        /// @brief load a script from file
+        /// @return false if the file could not be read or parsed (see error())
+        bool load(const std::string& path);
+
+        /// @brief parse a script from text
+        bool parse(const std::string& text);
+
+        /// @brief add a change to the buttons (1 = pressed), from a frame onwards
+        /// @note changes must be added in frame order
+        void add(uint64_t frame, uint8_t buttons);
+
+        /// @brief state of the buttons at a frame (1 = pressed)
+        uint8_t buttons(uint64_t frame) const;
+
+        const std::string& error() const;
+
+    private:
+        struct Change {
+            uint64_t frame;
+            uint8_t buttons;
+        };
+
+        std::vector<Change> m_changes;
+        std::string m_error;
+    };
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "nes/memory/PageTable.hpp"
+#include "nes/simulation/NESController.hpp"
+
+// define NES_BUS_VERBOSE to display NES bus
+//   simulation in TTY
+//#define NES_BUS_VERBOSE
+
+#ifdef NES_BUS_VERBOSE
+#define LOG_NES_BUS(msg, ...) printf(msg, __VA_ARGS__)
+#else
+#define LOG_NES_BUS(msg, ...)
+#endif
+
+namespace simulation {
+    /// @class NESBus
+    /// @brief Connect the CPU + PPU memory buses, and controller port, of an NES core
+    /// @param CORE Verilated core with the NES ports (i.e. VNES)
+    /// @note Resolved at compile time, so that it can be inlined into the tick loop
+    template <class CORE>
+    class NESBus {
+    public:
+        /// @param cpuMemory CPU address space (RAM + PRG, with writes to PRG sent to the mapper)
+        /// @param ppuMemory PPU address space (pattern tables + nametables)
+        NESBus(memory::PageTable& cpuMemory, memory::PageTable& ppuMemory) : m_cpuMemory(cpuMemory), m_ppuMemory(ppuMemory), m_hasUnsupportedWrite(false), m_ppuWrittenPages(0) {
+        }
+
+        NESController& controller1() {
+            return m_controller1;
+        }
+
+        /// @brief has the core tried to write to read-only or unmapped memory (e.g. CHR ROM)
+        bool hasUnsupportedWrite() const {
+            return m_hasUnsupportedWrite;
+        }
+
+        /// @brief retrieve, and clear, the set of PPU pages written by the core (e.g. to invalidate VRAM debug views)
+        /// @return bit N is set if page N (0xN00:0xNFF) of the 14bit PPU address space has been written
+        /// @note pages are tracked by address, so writes through a mirror only mark the mirror's page
+        /// @note tracked on the bus, rather than by SRAM (see memory::SRAM::enableTracking()), as the
+        ///       PageTable writes straight to each page's memory
+        uint64_t takePPUWrittenPages() {
+            uint64_t pages = m_ppuWrittenPages;
+            m_ppuWrittenPages = 0;
+
+            return pages;
+        }
+
+        /// @brief simulation at the end of a clock phase, before
+        ///        transition to other clock phase
+        inline void simulateCombinatorial(CORE& core) {
+            if (core.i_clk == 1) {
+                // clock: end of phi2
+                // R/W data is valid on the bus
+
+                if (core.o_cs_ram == 1) {
+                    if (core.o_rw_ram == 0) {
+                        if (!m_cpuMemory.write(core.o_address_ram, core.o_data_ram)) {
+                            m_hasUnsupportedWrite = true;
+                        }
+
+                        LOG_NES_BUS("write ram 0x%04X = 0x%02X\n", core.o_address_ram, core.o_data_ram);
+                    } else {
+                        core.i_data_ram = m_cpuMemory.read(core.o_address_ram);
+
+                        LOG_NES_BUS("read ram 0x%04X = 0x%02X\n", core.o_address_ram, core.i_data_ram);
+                    }
+                }
+
+                if (core.o_cs_prg == 1) {
+                    if (core.o_rw_prg == 0) {
+                        // note: writes to PRG ROM without mapper registers (e.g. NROM) are ignored
+                        m_cpuMemory.write(core.o_address_prg, core.o_data_prg);
+
+                        LOG_NES_BUS("write prg 0x%04X = 0x%02X\n", core.o_address_prg, core.o_data_prg);
+                    } else {
+                        core.i_data_prg = m_cpuMemory.read(core.o_address_prg);
+
+                        LOG_NES_BUS("read prg 0x%04X = 0x%02X\n", core.o_address_prg, core.i_data_prg);
+                    }
+                }
+
+                if (core.o_cs_patterntable == 1) {
+                    if (core.o_rw_patterntable == 1) {
+                        core.i_data_patterntable = m_ppuMemory.read(core.o_address_patterntable);
+
+                        LOG_NES_BUS("read patterntable 0x%04X = 0x%02X\n", core.o_address_patterntable, core.i_data_patterntable);
+                    } else {
+                        LOG_NES_BUS("write patterntable 0x%04X\n", core.o_address_patterntable);
+
+                        // note: the PPU's write data is only exposed on the nametable data port
+                        if (!m_ppuMemory.write(core.o_address_patterntable, core.o_data_nametable)) {
+                            m_hasUnsupportedWrite = true;
+                        }
+
+                        markPPUWritten(core.o_address_patterntable);
+                    }
+                }
+
+                if (core.o_cs_nametable == 1) {
+                    if (core.o_rw_nametable == 0) {
+                        if (!m_ppuMemory.write(core.o_address_nametable, core.o_data_nametable)) {
+                            m_hasUnsupportedWrite = true;
+                        }
+
+                        markPPUWritten(core.o_address_nametable);
+
+                        LOG_NES_BUS("write nametable 0x%04X = 0x%02X\n", core.o_address_nametable, core.o_data_nametable);
+                    } else {
+                        core.i_data_nametable = m_ppuMemory.read(core.o_address_nametable);
+
+                        LOG_NES_BUS("read nametable 0x%04X = 0x%02X\n", core.o_address_nametable, core.i_data_nametable);
+                    }
+                }
+            } else {
+                // clock: end of phi 1
+                // undefined data on the bus
+                core.i_data_ram = 0xFF;
+                core.i_data_prg = 0xFF;
+                core.i_data_patterntable = 0xFF;
+                core.i_data_nametable = 0xFF;
+            }
+
+            m_controller1.simulateCombinatorial(core);
+        }
+
+    private:
+        memory::PageTable& m_cpuMemory;
+        memory::PageTable& m_ppuMemory;
+        NESController m_controller1;
+        bool m_hasUnsupportedWrite;
+        uint64_t m_ppuWrittenPages;
+
+        inline void markPPUWritten(uint16_t address) {
+            m_ppuWrittenPages |= uint64_t(1) << ((address >> 8) & 0x3f);
+        }
+    };
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+
+namespace simulation {
+    /// @class LatchHandler
+    /// @brief Notified each time the NES latches the controller (e.g. to record or replay input)
+    class LatchHandler {
+    public:
+        virtual ~LatchHandler() {}
+
+        /// @param latchIndex number of latches since power on
+        /// @param buttons state of the buttons set on the controller (1 = pressed)
+        /// @return state of the buttons to latch
+        virtual uint8_t onLatch(uint64_t latchIndex, uint8_t buttons) = 0;
+    };
+
+    /// @class NESController
+    /// @brief Simulate the shift register in a standard NES controller
+    class NESController {
+    public:
+        enum Button : uint8_t {
+            kA = 1 << 0,
+            kB = 1 << 1,
+            kSelect = 1 << 2,
+            kStart = 1 << 3,
+            kUp = 1 << 4,
+            kDown = 1 << 5,
+            kLeft = 1 << 6,
+            kRight = 1 << 7
+        };
+
+        /// @brief set the state of the buttons (1 = pressed), sampled on the next latch
+        void setButtons(uint8_t buttons) {
+            m_buttons = buttons;
+        }
+
+        uint8_t buttons() const {
+            return m_buttons;
+        }
+
+        /// @brief state of the shift register (0 = pressed)
+        uint8_t shiftRegister() const {
+            return m_shiftRegister;
+        }
+
+        /// @brief restore power-on state (the buttons are unchanged)
+        void reset() {
+            m_latchedButtons = 0;
+            m_shiftRegister = 0xFF;
+            m_lastControllerClk = 1;
+            m_lastControllerLatch = 0;
+            m_numLatches = 0;
+        }
+
+        /// @brief number of times the controller has been latched
+        uint64_t numLatches() const {
+            return m_numLatches;
+        }
+
+        /// @brief attach a handler that is called on each latch, or nullptr to detach
+        void setLatchHandler(LatchHandler* handler) {
+            m_latchHandler = handler;
+        }
+
+        /// @brief state of the controller, e.g. for a snapshot
+        struct State {
+            uint64_t numLatches;
+            uint8_t buttons;
+            uint8_t latchedButtons;
+            uint8_t shiftRegister;
+            uint8_t lastControllerClk;
+            uint8_t lastControllerLatch;
+        };
+
+        State state() const {
+            return State { m_numLatches, m_buttons, m_latchedButtons, m_shiftRegister, uint8_t(m_lastControllerClk), uint8_t(m_lastControllerLatch) };
+        }
+
+        void setState(const State& state) {
+            m_numLatches = state.numLatches;
+            m_buttons = state.buttons;
+            m_latchedButtons = state.latchedButtons;
+            m_shiftRegister = state.shiftRegister;
+            m_lastControllerClk = state.lastControllerClk;
+            m_lastControllerLatch = state.lastControllerLatch;
+        }
+
+        /// @brief simulate the controller port of the NES core
+        template <class CORE>
+        inline void simulateCombinatorial(CORE& core) {
+            core.i_controller_1 = m_shiftRegister & 0x01;           // read lsb
+
+            // clk enable check is important here:
+            //    - perhaps latch the controller output values at I/O port on FPGA
+            if (core.o_cpu_debug_clk_en) {
+                int controllerClk = core.o_controller_clk;
+                int controllerLatch = core.o_controller_latch;
+
+                if ((controllerLatch == 1) && (m_lastControllerLatch == 0)) {
+                    // buttons are sampled once per latch, so that input can be recorded / replayed by latch index
+                    m_latchedButtons = (m_latchHandler != nullptr) ? m_latchHandler->onLatch(m_numLatches, m_buttons) : m_buttons;
+
+                    m_numLatches += 1;
+                }
+
+                if (controllerLatch) {
+                    // NES controller sends a 0 for each button that is pressed
+                    m_shiftRegister = ~m_latchedButtons;
+                } else {
+                    if ((controllerClk == 1) && (m_lastControllerClk == 0)) {
+                        // shift out first bit
+                        m_shiftRegister >>= 1;
+
+                        // simulate shifting in '1' (for unpressed button) at top of shift register
+                        m_shiftRegister |= (1<<7);
+                    }
+                }
+
+                m_lastControllerClk = controllerClk;
+                m_lastControllerLatch = controllerLatch;
+            }
+        }
+
+    private:
+        uint8_t m_buttons = 0;                      // state of buttons (1 = pressed)
+        uint8_t m_latchedButtons = 0;               // state of buttons at the most recent latch
+        uint8_t m_shiftRegister = 0xFF;             // state of shift register (0 = pressed)
+        int m_lastControllerClk = 1;
+        int m_lastControllerLatch = 0;
+        uint64_t m_numLatches = 0;                  // number of latches since power on
+        LatchHandler* m_latchHandler = nullptr;
+    };
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "nes/memory/SRAM.hpp"
+#include "nes/cartridge/INESRom.hpp"
+#include "nes/cartridge/Mapper.hpp"
+#include "nes/simulation/NESController.hpp"
+#include "nes/simulation/Snapshot.hpp"
+#include "nes/simulation/VerilatedModelState.hpp"
+
+namespace simulation {
+    /// @class NESSnapshot
+    /// @brief Save / load the full state of an NES simulation (Verilated model, RAM, 
+    ///        mapper, controller and counters), so that a run can resume from a known point
+    /// @note requires the NES model to be verilated with '--savable'
+    class NESSnapshot {
+    public:
+        /// @brief counters that are saved with the simulation state
+        struct Counters {
+            uint64_t numTicks = 0;
+            uint64_t numCpuCycles = 0;
+            uint64_t numFrames = 0;
+        };
+
+        enum Section : uint32_t {
+            kRom = 1,
+            kModel,
+            kCpuRam,
+            kNametableRam,
+            kMapper,
+            kController,
+            kCounters,
+            kModelType
+        };
+
+        /// @brief filepath of the snapshot for a key (e.g. "title-screen")
+        static std::string path(const std::string& directory, const std::string& key) {
+            return directory + "/" + key + ".nessnap";
+        }
+
+        /// @brief write a snapshot of the simulation
+        /// @return false if the snapshot could not be written (see error)
+        template <class CORE>
+        static bool save(const std::string& path, CORE& core, const cartridge::INESRom& rom, const memory::SRAM& cpuRam, const memory::SRAM& nametableRam, const cartridge::Mapper& mapper, const NESController& controller, const Counters& counters, std::string& error) {
+            SnapshotWriter writer;
+
+            writer.addValue(kRom, romChecksum(rom));
+            writer.addValue(kModelType, modelType<CORE>());
+            writer.addSection(kModel, saveModelState(core));
+            writer.addSection(kCpuRam, std::span<const uint8_t>(cpuRam.data(), cpuRam.size()));
+            writer.addSection(kNametableRam, std::span<const uint8_t>(nametableRam.data(), nametableRam.size()));
+            writer.addSection(kMapper, mapper.saveState());
+            writer.addValue(kController, controller.state());
+            writer.addValue(kCounters, counters);
+
+            if (!writer.write(path)) {
+                error = writer.error();
+                return false;
+            }
+
+            return true;
+        }
+
+        /// @brief restore the simulation from a snapshot
+        /// @return false if the snapshot could not be loaded, or was saved from a different ROM (see error)
+        /// @note the simulation is unchanged if the snapshot is rejected
+        template <class CORE>
+        static bool load(const std::string& path, CORE& core, const cartridge::INESRom& rom, memory::SRAM& cpuRam, memory::SRAM& nametableRam, cartridge::Mapper& mapper, NESController& controller, Counters& counters, std::string& error) {
+            SnapshotReader reader;
+
+            if (!reader.open(path)) {
+                error = reader.error();
+                return false;
+            }
+
+            uint64_t checksum = 0;
+            if (!reader.value(kRom, checksum) || (checksum != romChecksum(rom))) {
+                error = "'" + path + "' was saved from a different ROM";
+                return false;
+            }
+
+            // note: the state of one model (e.g. NES) can't be restored into another (e.g. NESFast)
+            uint64_t type = 0;
+            if (!reader.value(kModelType, type) || (type != modelType<CORE>())) {
+                error = "'" + path + "' was saved from a different model";
+                return false;
+            }
+
+            std::span<const uint8_t> model;
+            std::span<const uint8_t> cpuRamData;
+            std::span<const uint8_t> nametableRamData;
+            std::span<const uint8_t> mapperState;
+            NESController::State controllerState;
+            Counters savedCounters;
+
+            bool isValid = reader.section(kModel, model)
+                && reader.section(kCpuRam, cpuRamData) && (cpuRamData.size() == cpuRam.size())
+                && reader.section(kNametableRam, nametableRamData) && (nametableRamData.size() == nametableRam.size())
+                && reader.section(kMapper, mapperState)
+                && reader.value(kController, controllerState)
+                && reader.value(kCounters, savedCounters);
+
+            if (!isValid || !mapper.restoreState(mapperState)) {
+                error = "'" + path + "' is incomplete, or does not match this simulation";
+                return false;
+            }
+
+            restoreModelState(core, model);
+            std::copy(cpuRamData.begin(), cpuRamData.end(), cpuRam.data());
+            std::copy(nametableRamData.begin(), nametableRamData.end(), nametableRam.data());
+            controller.setState(controllerState);
+            counters = savedCounters;
+
+            return true;
+        }
+
+        /// @brief read the controller state of a snapshot, without restoring it (e.g. to check its latch index against a recording)
+        /// @return false if the snapshot could not be read (see error)
+        static bool readController(const std::string& path, NESController::State& state, std::string& error) {
+            SnapshotReader reader;
+
+            if (!reader.open(path)) {
+                error = reader.error();
+                return false;
+            }
+
+            if (!reader.value(kController, state)) {
+                error = "'" + path + "' is incomplete, or does not match this simulation";
+                return false;
+            }
+
+            return true;
+        }
+
+    private:
+        /// @brief identify the Verilated model that a snapshot was saved from (FNV-1a of its type name)
+        template <class CORE>
+        static uint64_t modelType() {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+
+            for (const char* name = typeid(CORE).name(); *name != '\0'; name++) {
+                hash = (hash ^ uint8_t(*name)) * 0x100000001b3ULL;
+            }
+
+            return hash;
+        }
+
+        /// @brief identify the ROM that a snapshot was saved from (FNV-1a of PRG + CHR ROM)
+        static uint64_t romChecksum(const cartridge::INESRom& rom) {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+
+            for (auto data : { rom.prgRom(), rom.chrRom() }) {
+                for (uint8_t value : data) {
+                    hash = (hash ^ value) * 0x100000001b3ULL;
+                }
+            }
+
+            return hash;
+        }
+    };
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "gtestverilog/gtestverilog.h"
+#include "nes/NESTestBench.h"
+
+namespace simulation {
+    /// @class NESTraceStep
+    /// @brief Snapshot of the NES ports that are useful for a post-mortem, for use with TraceRing
+    struct NESTraceStep {
+        uint8_t i_clk;
+
+        uint16_t o_video_x;
+        uint16_t o_video_y;
+        uint8_t o_video_visible;
+
+        uint8_t o_cs_ram;
+        uint16_t o_address_ram;
+        uint8_t o_rw_ram;
+        uint8_t o_data_ram;
+        uint8_t i_data_ram;
+
+        uint8_t o_cs_prg;
+        uint16_t o_address_prg;
+        uint8_t o_rw_prg;
+        uint8_t o_data_prg;
+        uint8_t i_data_prg;
+
+        uint8_t o_cs_patterntable;
+        uint16_t o_address_patterntable;
+        uint8_t i_data_patterntable;
+
+        uint8_t o_cs_nametable;
+        uint16_t o_address_nametable;
+        uint8_t o_rw_nametable;
+        uint8_t o_data_nametable;
+        uint8_t i_data_nametable;
+
+        uint8_t o_cpu_debug_ir;
+        uint8_t o_cpu_debug_error;
+        uint8_t o_cpu_debug_rw;
+        uint16_t o_cpu_debug_address;
+        uint8_t o_cpu_debug_tcu;
+        uint8_t o_cpu_debug_clk_en;
+        uint8_t o_cpu_debug_sync;
+
+        template <class CORE>
+        static NESTraceStep capture(const CORE& core) {
+            NESTraceStep step;
+
+            step.i_clk = core.i_clk;
+
+            step.o_video_x = core.o_video_x;
+            step.o_video_y = core.o_video_y;
+            step.o_video_visible = core.o_video_visible;
+
+            step.o_cs_ram = core.o_cs_ram;
+            step.o_address_ram = core.o_address_ram;
+            step.o_rw_ram = core.o_rw_ram;
+            step.o_data_ram = core.o_data_ram;
+            step.i_data_ram = core.i_data_ram;
+
+            step.o_cs_prg = core.o_cs_prg;
+            step.o_address_prg = core.o_address_prg;
+            step.o_rw_prg = core.o_rw_prg;
+            step.o_data_prg = core.o_data_prg;
+            step.i_data_prg = core.i_data_prg;
+
+            step.o_cs_patterntable = core.o_cs_patterntable;
+            step.o_address_patterntable = core.o_address_patterntable;
+            step.i_data_patterntable = core.i_data_patterntable;
+
+            step.o_cs_nametable = core.o_cs_nametable;
+            step.o_address_nametable = core.o_address_nametable;
+            step.o_rw_nametable = core.o_rw_nametable;
+            step.o_data_nametable = core.o_data_nametable;
+            step.i_data_nametable = core.i_data_nametable;
+
+            step.o_cpu_debug_ir = core.o_cpu_debug_ir;
+            step.o_cpu_debug_error = core.o_cpu_debug_error;
+            step.o_cpu_debug_rw = core.o_cpu_debug_rw;
+            step.o_cpu_debug_address = core.o_cpu_debug_address;
+            step.o_cpu_debug_tcu = core.o_cpu_debug_tcu;
+            step.o_cpu_debug_clk_en = core.o_cpu_debug_clk_en;
+            step.o_cpu_debug_sync = core.o_cpu_debug_sync;
+
+            return step;
+        }
+
+        static gtestverilog::Trace toTrace(const std::vector<NESTraceStep>& steps) {
+            gtestverilog::TraceBuilder traceBuilder;
+
+            auto addPort = [&](const gtestverilog::PortDescription& port, auto member) {
+                std::vector<uint32_t> values;
+                values.reserve(steps.size());
+                for (const auto& step : steps) {
+                    values.push_back(uint32_t(step.*member));
+                }
+
+                traceBuilder.port(port).signal(values);
+            };
+
+            addPort(nestestbench::i_clk, &NESTraceStep::i_clk);
+
+            addPort(nestestbench::o_video_x, &NESTraceStep::o_video_x);
+            addPort(nestestbench::o_video_y, &NESTraceStep::o_video_y);
+            addPort(nestestbench::o_video_visible, &NESTraceStep::o_video_visible);
+
+            addPort(nestestbench::o_cs_ram, &NESTraceStep::o_cs_ram);
+            addPort(nestestbench::o_address_ram, &NESTraceStep::o_address_ram);
+            addPort(nestestbench::o_rw_ram, &NESTraceStep::o_rw_ram);
+            addPort(nestestbench::o_data_ram, &NESTraceStep::o_data_ram);
+            addPort(nestestbench::i_data_ram, &NESTraceStep::i_data_ram);
+
+            addPort(nestestbench::o_cs_prg, &NESTraceStep::o_cs_prg);
+            addPort(nestestbench::o_address_prg, &NESTraceStep::o_address_prg);
+            addPort(nestestbench::o_rw_prg, &NESTraceStep::o_rw_prg);
+            addPort(nestestbench::o_data_prg, &NESTraceStep::o_data_prg);
+            addPort(nestestbench::i_data_prg, &NESTraceStep::i_data_prg);
+
+            addPort(nestestbench::o_cs_patterntable, &NESTraceStep::o_cs_patterntable);
+            addPort(nestestbench::o_address_patterntable, &NESTraceStep::o_address_patterntable);
+            addPort(nestestbench::i_data_patterntable, &NESTraceStep::i_data_patterntable);
+
+            addPort(nestestbench::o_cs_nametable, &NESTraceStep::o_cs_nametable);
+            addPort(nestestbench::o_address_nametable, &NESTraceStep::o_address_nametable);
+            addPort(nestestbench::o_rw_nametable, &NESTraceStep::o_rw_nametable);
+            addPort(nestestbench::o_data_nametable, &NESTraceStep::o_data_nametable);
+            addPort(nestestbench::i_data_nametable, &NESTraceStep::i_data_nametable);
+
+            addPort(nestestbench::o_cpu_debug_ir, &NESTraceStep::o_cpu_debug_ir);
+            addPort(nestestbench::o_cpu_debug_error, &NESTraceStep::o_cpu_debug_error);
+            addPort(nestestbench::o_cpu_debug_rw, &NESTraceStep::o_cpu_debug_rw);
+            addPort(nestestbench::o_cpu_debug_address, &NESTraceStep::o_cpu_debug_address);
+            addPort(nestestbench::o_cpu_debug_tcu, &NESTraceStep::o_cpu_debug_tcu);
+            addPort(nestestbench::o_cpu_debug_clk_en, &NESTraceStep::o_cpu_debug_clk_en);
+            addPort(nestestbench::o_cpu_debug_sync, &NESTraceStep::o_cpu_debug_sync);
+
+            return traceBuilder;
+        }
+    };
+}
@@ -0,0 +1,297 @@
+#include "NestestLog.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    // columns of the nestest log format
+    const size_t kColumnBytes = 6;
+    const size_t kColumnDisassembly = 16;
+    const size_t kColumnRegisters = 48;
+
+    int hexDigit(char c) {
+        if ((c >= '0') && (c <= '9')) {
+            return c - '0';
+        } else if ((c >= 'A') && (c <= 'F')) {
+            return c - 'A' + 10;
+        } else if ((c >= 'a') && (c <= 'f')) {
+            return c - 'a' + 10;
+        }
+
+        return -1;
+    }
+
+    bool parseHex(std::string_view line, size_t position, size_t numDigits, uint32_t& value) {
+        if ((position + numDigits) > line.size()) {
+            return false;
+        }
+
+        value = 0;
+
+        for (size_t i = 0; i < numDigits; ++i) {
+            int digit = hexDigit(line[position + i]);
+            if (digit < 0) {
+                return false;
+            }
+
+            value = (value << 4) | uint32_t(digit);
+        }
+
+        return true;
+    }
+
+    /// @brief parse the two hex digits of a register that follow a label (e.g. "A:")
+    bool parseRegister(std::string_view line, size_t& position, std::string_view label, uint8_t& value) {
+        position = line.find(label, position);
+        if (position == std::string_view::npos) {
+            return false;
+        }
+
+        position += label.size();
+
+        uint32_t parsed;
+        if (!parseHex(line, position, 2, parsed)) {
+            return false;
+        }
+
+        value = uint8_t(parsed);
+
+        return true;
+    }
+}
+
+namespace simulation {
+    bool NestestLogLine::parse(std::string_view line, NestestLogLine& outLine) {
+        outLine = NestestLogLine();
+
+        uint32_t value;
+        if (!parseHex(line, 0, 4, value)) {
+            return false;
+        }
+
+        outLine.pc = uint16_t(value);
+
+        for (size_t i = 0; i < kMaxBytes; ++i) {
+            if (!parseHex(line, kColumnBytes + (i * 3), 2, value)) {
+                break;
+            }
+
+            outLine.bytes[i] = uint8_t(value);
+            outLine.numBytes++;
+        }
+
+        if (outLine.numBytes == 0) {
+            return false;
+        }
+
+        // note: the disassembly may be wider than its column (e.g. undocumented opcodes),
+        //  but never contains " A:"
+        size_t position = line.find(" A:", kColumnDisassembly);
+        if (position == std::string_view::npos) {
+            return false;
+        }
+
+        if (!parseRegister(line, position, "A:", outLine.a) ||
+            !parseRegister(line, position, "X:", outLine.x) ||
+            !parseRegister(line, position, "Y:", outLine.y) ||
+            !parseRegister(line, position, "P:", outLine.p) ||
+            !parseRegister(line, position, "SP:", outLine.sp)) {
+            return false;
+        }
+
+        position = line.find("CYC:", position);
+        if (position != std::string_view::npos) {
+            uint64_t cycles = 0;
+            size_t numDigits = 0;
+
+            for (position += 4; (position < line.size()) && (line[position] >= '0') && (line[position] <= '9'); ++position) {
+                cycles = (cycles * 10) + uint64_t(line[position] - '0');
+                numDigits++;
+            }
+
+            outLine.cycles = cycles;
+            outLine.hasCycles = (numDigits > 0);
+        }
+
+        return true;
+    }
+
+    size_t NestestLogLine::format(char* buffer, size_t size, const char* disassembly) const {
+        char bytesText[kMaxBytes * 3 + 1] = "         ";
+
+        for (size_t i = 0; i < numBytes; ++i) {
+            snprintf(bytesText + (i * 3), 4, "%02X ", bytes[i]);
+        }
+
+        if (numBytes < kMaxBytes) {
+            // restore the padding after the terminator of the last byte
+            bytesText[numBytes * 3] = ' ';
+        }
+
+        int length = snprintf(buffer, size, "%04X  %s %-*s A:%02X X:%02X Y:%02X P:%02X SP:%02X",
+                                pc,
+                                bytesText,
+                                int(kColumnRegisters - kColumnDisassembly - 1), disassembly,
+                                a, x, y, p, sp);
+
+        if ((length >= 0) && hasCycles && (size_t(length) < size)) {
+            length += snprintf(buffer + length, size - length, " CYC:%llu", (unsigned long long)cycles);
+        }
+
+        return (length < 0) ? 0 : std::min(size_t(length), size - 1);
+    }
+
+    NestestLogComparator::NestestLogComparator(std::istream& expected) : m_expected(expected) {
+    }
+
+    void NestestLogComparator::setCompareCycles(bool isCompared) {
+        m_isCyclesCompared = isCompared;
+    }
+
+    bool NestestLogComparator::compare(const NestestLogLine& actual, const char* actualText) {
+        if (hasMismatched()) {
+            return false;
+        }
+
+        NestestLogLine expected;
+        if (!readExpected(expected)) {
+            if (m_diagnostic.empty()) {
+                char text[128];
+                snprintf(text, sizeof(text), "expected log ended after %llu lines, actual continues with\n", (unsigned long long)m_numLines);
+                m_diagnostic = text;
+                m_diagnostic += "              ";
+                m_diagnostic += actualText;
+                m_diagnostic += "\n";
+            }
+
+            return false;
+        }
+
+        if (expected.pc != actual.pc) {
+            mismatch("pc", expected.pc, actual.pc, 4, actualText);
+        } else if (expected.numBytes != actual.numBytes) {
+            mismatch("size", expected.numBytes, actual.numBytes, 1, actualText);
+        } else if (memcmp(expected.bytes, actual.bytes, expected.numBytes) != 0) {
+            for (size_t i = 0; i < expected.numBytes; ++i) {
+                if (expected.bytes[i] != actual.bytes[i]) {
+                    mismatch((i == 0) ? "opcode" : "operand", expected.bytes[i], actual.bytes[i], 2, actualText);
+                    break;
+                }
+            }
+        } else if (expected.a != actual.a) {
+            mismatch("A", expected.a, actual.a, 2, actualText);
+        } else if (expected.x != actual.x) {
+            mismatch("X", expected.x, actual.x, 2, actualText);
+        } else if (expected.y != actual.y) {
+            mismatch("Y", expected.y, actual.y, 2, actualText);
+        } else if (expected.p != actual.p) {
+            mismatch("P", expected.p, actual.p, 2, actualText);
+        } else if (expected.sp != actual.sp) {
+            mismatch("SP", expected.sp, actual.sp, 2, actualText);
+        } else if (m_isCyclesCompared && expected.hasCycles && actual.hasCycles && (expected.cycles != actual.cycles)) {
+            mismatch("CYC", expected.cycles, actual.cycles, 0, actualText);
+        }
+
+        if (hasMismatched()) {
+            return false;
+        }
+
+        m_history[m_numLines % kHistorySize].assign(m_line);
+        m_numLines++;
+
+        return true;
+    }
+
+    bool NestestLogComparator::finish() {
+        if (hasMismatched()) {
+            return false;
+        }
+
+        NestestLogLine expected;
+        if (readExpected(expected)) {
+            char text[128];
+            snprintf(text, sizeof(text), "actual log ended after %llu lines, expected continues with\n", (unsigned long long)m_numLines);
+            m_diagnostic = text;
+            m_diagnostic += "              ";
+            m_diagnostic += m_line;
+            m_diagnostic += "\n";
+        }
+
+        return !hasMismatched();
+    }
+
+    bool NestestLogComparator::hasMismatched() const {
+        return !m_diagnostic.empty();
+    }
+
+    const std::string& NestestLogComparator::diagnostic() const {
+        return m_diagnostic;
+    }
+
+    uint64_t NestestLogComparator::numLines() const {
+        return m_numLines;
+    }
+
+    bool NestestLogComparator::readExpected(NestestLogLine& outLine) {
+        while (std::getline(m_expected, m_line)) {
+            if (!m_line.empty() && (m_line.back() == '\r')) {
+                m_line.pop_back();
+            }
+
+            if (m_line.empty()) {
+                continue;
+            }
+
+            if (!NestestLogLine::parse(m_line, outLine)) {
+                char text[128];
+                snprintf(text, sizeof(text), "line %llu of the expected log is not in the nestest log format\n", (unsigned long long)(m_numLines + 1));
+                m_diagnostic = text;
+                m_diagnostic += "              ";
+                m_diagnostic += m_line;
+                m_diagnostic += "\n";
+
+                return false;
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void NestestLogComparator::mismatch(const char* field, uint64_t expected, uint64_t actual, int digits, const char* actualText) {
+        char text[256];
+        const uint64_t lineNumber = m_numLines + 1;
+
+        snprintf(text, sizeof(text), "difference at line %llu\n", (unsigned long long)lineNumber);
+        m_diagnostic = text;
+
+        if (digits > 0) {
+            snprintf(text, sizeof(text), "[%s] expected [%0*llX] actual [%0*llX]\n", field, digits, (unsigned long long)expected, digits, (unsigned long long)actual);
+        } else {
+            snprintf(text, sizeof(text), "[%s] expected [%llu] actual [%llu]\n", field, (unsigned long long)expected, (unsigned long long)actual);
+        }
+
+        m_diagnostic += text;
+
+        const uint64_t numHistory = std::min<uint64_t>(m_numLines, kHistorySize);
+
+        for (uint64_t i = m_numLines - numHistory; i < m_numLines; ++i) {
+            snprintf(text, sizeof(text), "%6llu            ", (unsigned long long)(i + 1));
+            m_diagnostic += text;
+            m_diagnostic += m_history[i % kHistorySize];
+            m_diagnostic += "\n";
+        }
+
+        snprintf(text, sizeof(text), "%6llu  expected  ", (unsigned long long)lineNumber);
+        m_diagnostic += text;
+        m_diagnostic += m_line;
+        m_diagnostic += " <<\n";
+
+        snprintf(text, sizeof(text), "%6llu    actual  ", (unsigned long long)lineNumber);
+        m_diagnostic += text;
+        m_diagnostic += actualText;
+        m_diagnostic += " <<\n";
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace simulation {
+    /// @class NestestLogLine
+    /// @brief Fields of a line of a nestest log, as integers
+    /// @note e.g. "C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7"
+    ///       the registers are those before the instruction is executed, and the cycle count
+    ///       is the number of CPU cycles before its opcode fetch (so 7 for the first instruction)
+    struct NestestLogLine {
+        static constexpr size_t kMaxBytes = 3;
+
+        uint16_t pc = 0;
+        uint8_t bytes[kMaxBytes] = {};
+        uint8_t numBytes = 0;
+
+        uint8_t a = 0;
+        uint8_t x = 0;
+        uint8_t y = 0;
+        uint8_t p = 0;
+        uint8_t sp = 0;
+
+        uint64_t cycles = 0;
+        bool hasCycles = false;             // CYC: is optional
+
+        /// @brief parse the fields of a line (ignoring the disassembly and the PPU position)
+        /// @return false if the line is not in the nestest log format
+        static bool parse(std::string_view line, NestestLogLine& outLine);
+
+        /// @brief format as a line of a nestest log (without a trailing newline)
+        /// @param disassembly text of the instruction, in columns 16 to 47
+        /// @return length of the line, truncated to size - 1
+        size_t format(char* buffer, size_t size, const char* disassembly) const;
+    };
+
+    /// @class NestestLogComparator
+    /// @brief Compare lines of a log as they are produced, against an expected log (e.g. nestest.log)
+    ///        that is streamed a line at a time, and stop at the first mismatch
+    /// @note PC, instruction bytes, A/X/Y/P/SP and (if both lines have one) the cycle count are compared
+    class NestestLogComparator {
+    public:
+        /// @brief number of expected lines before a mismatch that are shown in the diagnostic
+        static constexpr size_t kHistorySize = 10;
+
+        /// @param expected log to compare against, which must outlive the comparator
+        explicit NestestLogComparator(std::istream& expected);
+
+        /// @brief compare cycle counts (default true)
+        void setCompareCycles(bool isCompared);
+
+        /// @brief compare with the next line of the expected log
+        /// @param actualText formatted actual line, shown in the diagnostic
+        /// @return false if the line did not match, or the expected log has ended (see diagnostic())
+        bool compare(const NestestLogLine& actual, const char* actualText);
+
+        /// @brief check that the expected log has no more lines, once the actual log has ended
+        /// @return false if there are more lines (see diagnostic())
+        bool finish();
+
+        bool hasMismatched() const;
+
+        /// @brief description of the first mismatch, with the expected lines leading up to it
+        const std::string& diagnostic() const;
+
+        /// @brief number of lines that have matched
+        uint64_t numLines() const;
+
+    private:
+        std::istream& m_expected;
+        bool m_isCyclesCompared = true;
+
+        std::string m_line;
+        uint64_t m_numLines = 0;
+
+        // ring of the most recent expected lines
+        std::string m_history[kHistorySize];
+
+        std::string m_diagnostic;
+
+        bool readExpected(NestestLogLine& outLine);
+        void mismatch(const char* field, uint64_t expected, uint64_t actual, int digits, const char* actualText);
+    };
+}
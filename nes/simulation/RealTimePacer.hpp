@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace simulation {
+    /// @class RealTimePacer
+    /// @brief Paces a simulation to a clock rate (or a multiple of it), by handing out a budget
+    ///        of ticks to simulate in each slice, from the wall clock time that has elapsed
+    /// @note The slice size adapts to the measured simulation rate, so a slice always takes
+    ///       about kSliceDuration of wall clock time, however fast the host is
+    /// @note When the simulation can't keep up, the debt is dropped (rather than caught up on
+    ///       later in a burst), and isBehind() reports it until the rate recovers
+    class RealTimePacer {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        // NES clock on the Arty A7 board (ticks of i_clk)
+        static constexpr double kNESTicksPerSecond = 5000000.0;
+
+        /// @param ticksPerSecond clock rate being paced, at a speed of 1.0
+        explicit RealTimePacer(double ticksPerSecond = kNESTicksPerSecond) : m_ticksPerSecond(ticksPerSecond) {
+            restart();
+        }
+
+        /// @brief run at a multiple of the clock rate
+        /// @param speed multiple of the clock rate, or 0 to run as fast as possible (ignoring the wall clock)
+        void setSpeed(double speed) {
+            if (speed != m_speed) {
+                m_speed = speed;
+                restart();
+            }
+        }
+
+        double speed() const {
+            return m_speed;
+        }
+
+        bool isMaxSpeed() const {
+            return m_speed <= 0.0;
+        }
+
+        /// @brief restart pacing from now (e.g. after a pause), without catching up on the time before
+        void restart() {
+            Clock::time_point now = Clock::now();
+
+            m_start = now;
+            m_numTicks = 0;
+
+            m_windowStart = now;
+            m_numWindowTicks = 0;
+            m_isBehind = false;
+        }
+
+        /// @brief number of ticks to simulate next, before calling advance()
+        /// @return 0 if the simulation is ahead of the wall clock, see wait()
+        uint64_t budget() {
+            if (isMaxSpeed()) {
+                return m_sliceTicks;
+            }
+
+            double targetTicks = seconds(Clock::now() - m_start) * targetTicksPerSecond();
+            double owedTicks = targetTicks - double(m_numTicks);
+
+            if (owedTicks <= 0.0) {
+                return 0;
+            }
+
+            if (owedTicks > (kMaxLag * targetTicksPerSecond())) {
+                // too far behind to catch up, so drop the debt
+                m_start = Clock::now();
+                m_numTicks = 0;
+                m_isBehind = true;
+
+                return m_sliceTicks;
+            }
+
+            return std::min(uint64_t(owedTicks), m_sliceTicks);
+        }
+
+        /// @brief record ticks that have been simulated
+        void advance(uint64_t numTicks) {
+            m_numTicks += numTicks;
+            m_numWindowTicks += numTicks;
+
+            Clock::time_point now = Clock::now();
+            double windowSeconds = seconds(now - m_windowStart);
+
+            if (windowSeconds >= kMeasurementWindow) {
+                m_measuredTicksPerSecond = double(m_numWindowTicks) / windowSeconds;
+
+                // when paced, the measured rate includes time spent waiting, so it only falls short of the target when behind
+                m_isBehind = !isMaxSpeed() && (m_measuredTicksPerSecond < (kBehindThreshold * targetTicksPerSecond()));
+
+                // size slices from the rate the host can actually simulate at
+                m_sliceTicks = std::max(kMinSliceTicks, uint64_t(m_measuredTicksPerSecond * kSliceDuration));
+
+                m_windowStart = now;
+                m_numWindowTicks = 0;
+            }
+        }
+
+        /// @brief sleep until at least a minimum slice of ticks is owed (i.e. when budget() returned 0)
+        void wait() const {
+            if (isMaxSpeed()) {
+                return;
+            }
+
+            double nextTickSeconds = double(m_numTicks + kMinSliceTicks) / targetTicksPerSecond();
+            std::this_thread::sleep_until(m_start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(nextTickSeconds)));
+        }
+
+        /// @brief ticks per second achieved, over the most recent measurement window
+        double measuredTicksPerSecond() const {
+            return m_measuredTicksPerSecond;
+        }
+
+        /// @brief is the simulation running slower than the paced rate
+        bool isBehind() const {
+            return m_isBehind;
+        }
+
+    private:
+        // wall clock time that a slice of ticks should take, so the caller stays responsive
+        static constexpr double kSliceDuration = 0.004;
+
+        static constexpr uint64_t kMinSliceTicks = 256;
+
+        // debt (in seconds) beyond which the pacer stops trying to catch up
+        static constexpr double kMaxLag = 0.1;
+
+        // seconds over which the achieved rate is measured
+        static constexpr double kMeasurementWindow = 0.5;
+
+        // fraction of the target rate below which the simulation is considered behind
+        static constexpr double kBehindThreshold = 0.98;
+
+        double m_ticksPerSecond;
+        double m_speed = 1.0;
+
+        // ticks simulated since m_start
+        Clock::time_point m_start;
+        uint64_t m_numTicks = 0;
+
+        // achieved rate measurement
+        Clock::time_point m_windowStart;
+        uint64_t m_numWindowTicks = 0;
+        double m_measuredTicksPerSecond = 0.0;
+        bool m_isBehind = false;
+
+        uint64_t m_sliceTicks = 4096;
+
+        double targetTicksPerSecond() const {
+            return m_ticksPerSecond * m_speed;
+        }
+
+        static double seconds(Clock::duration duration) {
+            return std::chrono::duration<double>(duration).count();
+        }
+    };
+}
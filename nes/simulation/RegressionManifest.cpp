@@ -0,0 +1,172 @@
+#include "RegressionManifest.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    bool parseCheckpoint(const std::string& text, simulation::FrameCheckpoint& checkpoint) {
+        size_t separator = text.find(':');
+        if ((separator == 0) || (separator == (text.size() - 1))) {
+            return false;
+        }
+
+        char* end = nullptr;
+        std::string frame = text.substr(0, separator);
+        checkpoint.frame = strtoull(frame.c_str(), &end, 10);
+        if ((*end != '\0') || !isdigit(uint8_t(frame[0]))) {
+            return false;
+        }
+
+        checkpoint.hash = 0;
+        checkpoint.hasHash = separator != std::string::npos;
+        if (!checkpoint.hasHash) {
+            return true;
+        }
+
+        std::string hash = text.substr(separator + 1);
+        checkpoint.hash = strtoull(hash.c_str(), &end, 16);
+        if ((*end != '\0') || !isxdigit(uint8_t(hash[0]))) {
+            return false;
+        }
+
+        return true;
+    }
+}
+
+namespace simulation {
+    bool RegressionManifest::load(const std::string& path) {
+        m_entries.clear();
+        m_error.clear();
+
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            m_error = "unable to open '" + path + "'";
+            return false;
+        }
+
+        std::filesystem::path directory = std::filesystem::path(path).parent_path();
+        auto resolve = [&](const std::string& entryPath) {
+            std::filesystem::path resolved(entryPath);
+
+            return resolved.is_absolute() ? entryPath : (directory / resolved).string();
+        };
+
+        // note: the entries are only kept if the whole manifest is valid
+        std::vector<RegressionEntry> entries;
+        std::string line;
+        int lineNumber = 0;
+
+        while (std::getline(file, line)) {
+            lineNumber += 1;
+
+            line = line.substr(0, line.find('#'));
+
+            std::stringstream lineStream(line);
+            std::string romPath;
+            std::string moviePath;
+
+            if (!(lineStream >> romPath)) {
+                // blank, or comment
+                continue;
+            }
+
+            RegressionEntry entry;
+            entry.lineNumber = lineNumber;
+            entry.romPath = resolve(romPath);
+
+            if (!(lineStream >> moviePath)) {
+                m_error = "'" + path + "' line " + std::to_string(lineNumber) + ": expected '<rom> <movie> <frame>:<hash>...'";
+                return false;
+            }
+
+            if (moviePath != "-") {
+                entry.moviePath = resolve(moviePath);
+            }
+
+            std::string checkpointText;
+            while (lineStream >> checkpointText) {
+                FrameCheckpoint checkpoint;
+                if (!parseCheckpoint(checkpointText, checkpoint)) {
+                    m_error = "'" + path + "' line " + std::to_string(lineNumber) + ": invalid checkpoint '" + checkpointText + "'";
+                    return false;
+                }
+
+                entry.checkpoints.push_back(checkpoint);
+            }
+
+            if (entry.checkpoints.empty()) {
+                m_error = "'" + path + "' line " + std::to_string(lineNumber) + ": no checkpoints";
+                return false;
+            }
+
+            std::sort(entry.checkpoints.begin(), entry.checkpoints.end(), [](const FrameCheckpoint& a, const FrameCheckpoint& b) {
+                return a.frame < b.frame;
+            });
+
+            entries.push_back(entry);
+        }
+
+        m_entries = entries;
+
+        return true;
+    }
+
+    bool RegressionManifest::save(const std::string& path) {
+        m_error.clear();
+
+        FILE* file = fopen(path.c_str(), "w");
+        if (file == nullptr) {
+            m_error = "unable to write '" + path + "'";
+            return false;
+        }
+
+        std::filesystem::path directory = std::filesystem::absolute(std::filesystem::path(path).parent_path());
+        auto relative = [&](const std::string& entryPath) {
+            std::error_code error;
+            std::filesystem::path relativePath = std::filesystem::relative(entryPath, directory, error);
+
+            return (error || relativePath.empty()) ? entryPath : relativePath.string();
+        };
+
+        fprintf(file, "# rom movie frame:hash ...\n");
+
+        for (const RegressionEntry& entry : m_entries) {
+            fprintf(file, "%s %s", relative(entry.romPath).c_str(), entry.moviePath.empty() ? "-" : relative(entry.moviePath).c_str());
+
+            for (const FrameCheckpoint& checkpoint : entry.checkpoints) {
+                if (checkpoint.hasHash) {
+                    fprintf(file, " %" PRIu64 ":0x%016" PRIx64, checkpoint.frame, checkpoint.hash);
+                } else {
+                    fprintf(file, " %" PRIu64, checkpoint.frame);
+                }
+            }
+
+            fprintf(file, "\n");
+        }
+
+        if (fclose(file) != 0) {
+            m_error = "unable to write '" + path + "'";
+            return false;
+        }
+
+        return true;
+    }
+
+    const std::vector<RegressionEntry>& RegressionManifest::entries() const {
+        return m_entries;
+    }
+
+    std::vector<RegressionEntry>& RegressionManifest::entries() {
+        return m_entries;
+    }
+
+    const std::string& RegressionManifest::error() const {
+        return m_error;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace simulation {
+    /// @brief expected hash of the framebuffer at a frame
+    struct FrameCheckpoint {
+        uint64_t frame;
+        uint64_t hash;
+        bool hasHash;                                   // false = not recorded yet
+    };
+
+    /// @brief a ROM, the input to replay, and the frames to check
+    struct RegressionEntry {
+        std::string romPath;
+        std::string moviePath;                          // empty = no input
+        std::vector<FrameCheckpoint> checkpoints;       // ordered by frame
+        int lineNumber;
+    };
+
+    /// @class RegressionManifest
+    /// @brief List of golden-frame regression tests
+    /// @note Text format, one entry per line, e.g.
+    ///         # rom             movie               frame:hash ...
+    ///         supermario.nes    supermario.movie    60:0x1f2e3d4c5b6a7988 600:0x0123456789abcdef
+    ///         galaga.nes        -                   120:0x8877665544332211
+    ///         zelda.nes         zelda.movie         300 900
+    ///       Relative paths are resolved from the directory of the manifest. A checkpoint without a hash
+    ///       has not been recorded yet (see save()).
+    class RegressionManifest {
+    public:
+        /// @return false if the manifest could not be read or parsed (see error())
+        bool load(const std::string& path);
+
+        /// @brief write the manifest (e.g. with the hashes recorded from a run)
+        /// @note paths are written relative to the directory of the manifest, where possible
+        /// @return false if the manifest could not be written (see error())
+        bool save(const std::string& path);
+
+        const std::vector<RegressionEntry>& entries() const;
+        std::vector<RegressionEntry>& entries();
+
+        const std::string& error() const;
+
+    private:
+        std::vector<RegressionEntry> m_entries;
+        std::string m_error;
+    };
+}
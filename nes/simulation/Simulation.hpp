@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+
+namespace simulation {
+    /// @brief how much of each simulation step is captured
+    enum class TraceMode {
+        kFull,              // capture every port into testBench.trace (TestBench::tick)
+        kNone               // skip per-step trace capture entirely
+    };
+
+    /// @class NullRecorder
+    /// @brief default recorder for Simulation, that records nothing
+    struct NullRecorder {
+        template <class CORE>
+        void capture(const CORE& core) {}
+    };
+
+    /// @class Simulation
+    /// @brief Drive the Verilated core of a gtestverilog TestBench, with optional trace capture
+    /// @param TESTBENCH gtestverilog TestBench that owns the core
+    /// @param BUS bus model with 'void simulateCombinatorial(CORE& core)' (e.g. CpuBus, NESBus)
+    /// @param RECORDER optional recorder (e.g. TraceRing) that is given each step in TraceMode::kNone
+    /// @note In TraceMode::kNone the core is clocked directly, and the bus model is called
+    ///       without type erasure, so that long runs do not pay to capture every port of 
+    ///       every step into a gtestverilog::Trace.
+    template <class TESTBENCH, class BUS, class RECORDER = NullRecorder>
+    class Simulation {
+    public:
+        Simulation(TESTBENCH& testBench, BUS& bus);
+
+        Simulation(const Simulation&) = delete;
+        Simulation& operator=(const Simulation&) = delete;
+
+        /// @brief select how much of each step is captured (defaults to kFull)
+        void setTraceMode(TraceMode mode);
+
+        TraceMode traceMode() const;
+
+        /// @brief attach a recorder that is given every step in TraceMode::kNone
+        /// @param recorder the recorder to attach, or nullptr to detach
+        void setRecorder(RECORDER* recorder);
+
+        /// @brief reset the core (via the TestBench), and discard the reset trace
+        void reset();
+
+        /// @brief simulate the specified number of clock cycles
+        void tick(size_t numTicks = 1);
+
+    private:
+        /// @brief simulate one clock phase without trace capture
+        void step();
+
+        TESTBENCH& m_testBench;
+        BUS& m_bus;
+        TraceMode m_traceMode;
+        RECORDER* m_recorder;
+    };
+}
+
+// inlined template implementations
+#include "Simulation.inl"
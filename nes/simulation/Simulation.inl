@@ -0,0 +1,63 @@
+// note: included inline from Simulation.hpp
+
+namespace simulation {
+    template <class TESTBENCH, class BUS, class RECORDER>
+    Simulation<TESTBENCH, BUS, RECORDER>::Simulation(TESTBENCH& testBench, BUS& bus) : m_testBench(testBench), m_bus(bus), m_traceMode(TraceMode::kFull), m_recorder(nullptr) {
+        // TestBench still owns reset, and ticks in TraceMode::kFull
+        m_testBench.setCallbackSimulateCombinatorial([this]{
+            m_bus.simulateCombinatorial(m_testBench.core());
+        });
+    }
+
+    template <class TESTBENCH, class BUS, class RECORDER>
+    void Simulation<TESTBENCH, BUS, RECORDER>::setTraceMode(TraceMode mode) {
+        m_traceMode = mode;
+    }
+
+    template <class TESTBENCH, class BUS, class RECORDER>
+    TraceMode Simulation<TESTBENCH, BUS, RECORDER>::traceMode() const {
+        return m_traceMode;
+    }
+
+    template <class TESTBENCH, class BUS, class RECORDER>
+    void Simulation<TESTBENCH, BUS, RECORDER>::setRecorder(RECORDER* recorder) {
+        m_recorder = recorder;
+    }
+
+    template <class TESTBENCH, class BUS, class RECORDER>
+    void Simulation<TESTBENCH, BUS, RECORDER>::reset() {
+        m_testBench.reset();
+        m_testBench.trace.clear();
+    }
+
+    template <class TESTBENCH, class BUS, class RECORDER>
+    void Simulation<TESTBENCH, BUS, RECORDER>::tick(size_t numTicks) {
+        if (m_traceMode == TraceMode::kFull) {
+            m_testBench.tick(numTicks);
+
+            return;
+        }
+
+        for (size_t i = 0; i < numTicks; i++) {
+            step();
+            step();
+        }
+    }
+
+    template <class TESTBENCH, class BUS, class RECORDER>
+    inline void Simulation<TESTBENCH, BUS, RECORDER>::step() {
+        auto& core = m_testBench.core();
+
+        // toggle from the phase that TestBench (or the previous step) left the clock in,
+        //   so the two drivers can be interleaved
+        core.i_clk = !core.i_clk;
+        core.eval();
+
+        m_bus.simulateCombinatorial(core);
+        core.eval();
+
+        if (m_recorder != nullptr) {
+            m_recorder->capture(core);
+        }
+    }
+}
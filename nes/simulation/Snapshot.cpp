@@ -0,0 +1,183 @@
+#include "Snapshot.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kMagic[8] = { 'N', 'E', 'S', 'S', 'N', 'A', 'P', 0 };
+    const uint32_t kVersion = 1;
+    const size_t kAlignment = 8;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t numSections;
+    };
+
+    struct SnapshotSection {
+        uint32_t id;
+        uint32_t reserved;
+        uint64_t size;
+    };
+
+    size_t align(size_t size) {
+        return (size + kAlignment - 1) & ~(kAlignment - 1);
+    }
+}
+
+namespace simulation {
+    void SnapshotWriter::addSection(uint32_t id, std::span<const uint8_t> data) {
+        m_sections.push_back({ id, std::vector<uint8_t>(data.begin(), data.end()) });
+    }
+
+    bool SnapshotWriter::write(const std::string& path) {
+        // write to a temporary file, and rename, so that an existing snapshot
+        // is never left partially overwritten
+        std::string tempPath = path + ".tmp";
+
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if (file == nullptr) {
+            m_error = "unable to open '" + tempPath + "': " + strerror(errno);
+            return false;
+        }
+
+        const uint8_t padding[kAlignment] = {};
+
+        SnapshotHeader header;
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.numSections = uint32_t(m_sections.size());
+
+        bool isOk = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        for (const auto& section : m_sections) {
+            SnapshotSection sectionHeader { section.id, 0, section.data.size() };
+            size_t paddingSize = align(section.data.size()) - section.data.size();
+
+            isOk = isOk && (fwrite(&sectionHeader, sizeof(sectionHeader), 1, file) == 1);
+            isOk = isOk && (fwrite(section.data.data(), 1, section.data.size(), file) == section.data.size());
+            isOk = isOk && (fwrite(padding, 1, paddingSize, file) == paddingSize);
+        }
+
+        isOk = (fclose(file) == 0) && isOk;
+
+        if (!isOk || (rename(tempPath.c_str(), path.c_str()) != 0)) {
+            m_error = "unable to write '" + path + "': " + strerror(errno);
+            remove(tempPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    const std::string& SnapshotWriter::error() const {
+        return m_error;
+    }
+
+    SnapshotReader::SnapshotReader() : m_data(nullptr), m_size(0) {
+
+    }
+
+    SnapshotReader::~SnapshotReader() {
+        close();
+    }
+
+    bool SnapshotReader::open(const std::string& path) {
+        close();
+        m_error.clear();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return fail("unable to open '" + path + "': " + strerror(errno));
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0) {
+            ::close(fd);
+            return fail("unable to stat '" + path + "': " + strerror(errno));
+        }
+
+        size_t size = size_t(fileStat.st_size);
+        if (size < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            return fail("'" + path + "' is not a snapshot");
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (mapping == MAP_FAILED) {
+            return fail("unable to map '" + path + "': " + strerror(errno));
+        }
+
+        m_data = static_cast<const uint8_t*>(mapping);
+        m_size = size;
+
+        const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(m_data);
+        if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+            return fail("'" + path + "' is not a snapshot");
+        }
+
+        if (header->version != kVersion) {
+            return fail("'" + path + "' is snapshot version " + std::to_string(header->version) + ", expected " + std::to_string(kVersion));
+        }
+
+        size_t offset = sizeof(SnapshotHeader);
+
+        for (uint32_t i = 0; i < header->numSections; i++) {
+            if ((offset + sizeof(SnapshotSection)) > m_size) {
+                return fail("'" + path + "' is truncated");
+            }
+
+            const SnapshotSection* section = reinterpret_cast<const SnapshotSection*>(m_data + offset);
+            offset += sizeof(SnapshotSection);
+
+            if (section->size > (m_size - offset)) {
+                return fail("'" + path + "' is truncated");
+            }
+
+            m_sections.push_back({ section->id, std::span<const uint8_t>(m_data + offset, section->size) });
+            offset += align(section->size);
+        }
+
+        return true;
+    }
+
+    void SnapshotReader::close() {
+        if (m_data != nullptr) {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_sections.clear();
+    }
+
+    bool SnapshotReader::section(uint32_t id, std::span<const uint8_t>& data) const {
+        for (const auto& section : m_sections) {
+            if (section.first == id) {
+                data = section.second;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const std::string& SnapshotReader::error() const {
+        return m_error;
+    }
+
+    bool SnapshotReader::fail(const std::string& reason) {
+        close();
+        m_error = reason;
+
+        return false;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace simulation {
+    /// @class SnapshotWriter
+    /// @brief Collect sections of simulation state, and write them to a snapshot file
+    /// @note File layout: SnapshotHeader, then for each section a SnapshotSection
+    ///       followed by its data (padded to 8 bytes), so that sections can be
+    ///       used directly from a memory mapping of the file
+    class SnapshotWriter {
+    public:
+        /// @brief add a section (data is copied)
+        void addSection(uint32_t id, std::span<const uint8_t> data);
+
+        /// @brief add a section of a trivially copyable value
+        template <class T>
+        void addValue(uint32_t id, const T& value) {
+            addSection(id, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(&value), sizeof(T)));
+        }
+
+        /// @brief write all sections to file
+        /// @return false if the file could not be written (see error())
+        bool write(const std::string& path);
+
+        const std::string& error() const;
+
+    private:
+        struct Section {
+            uint32_t id;
+            std::vector<uint8_t> data;
+        };
+
+        std::vector<Section> m_sections;
+        std::string m_error;
+    };
+
+    /// @class SnapshotReader
+    /// @brief Memory map a snapshot file, and expose its sections without copying
+    class SnapshotReader {
+    public:
+        SnapshotReader();
+        ~SnapshotReader();
+
+        SnapshotReader(const SnapshotReader&) = delete;
+        SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+        /// @brief memory map and validate a snapshot file
+        /// @return false if the file could not be mapped, or is not a snapshot (see error())
+        bool open(const std::string& path);
+
+        /// @brief unmap the snapshot file
+        void close();
+
+        /// @brief find a section
+        /// @return false if the snapshot has no section with this id
+        bool section(uint32_t id, std::span<const uint8_t>& data) const;
+
+        /// @brief read a section of a trivially copyable value
+        /// @return false if the section is missing, or is not the size of the value
+        template <class T>
+        bool value(uint32_t id, T& value) const {
+            std::span<const uint8_t> data;
+            if (!section(id, data) || (data.size() != sizeof(T))) {
+                return false;
+            }
+
+            value = *reinterpret_cast<const T*>(data.data());
+
+            return true;
+        }
+
+        const std::string& error() const;
+
+    private:
+        bool fail(const std::string& reason);
+
+        const uint8_t* m_data;
+        size_t m_size;
+        std::vector<std::pair<uint32_t, std::span<const uint8_t>>> m_sections;
+        std::string m_error;
+    };
+}
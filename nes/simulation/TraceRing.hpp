@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "gtestverilog/gtestverilog.h"
+
+namespace simulation {
+    /// @class TraceRing
+    /// @brief Fixed capacity ring buffer of the most recent simulation steps
+    /// @note Steps are captured as small POD records, and are only converted into
+    ///       a gtestverilog::Trace on demand (e.g. for a post-mortem when the core errors)
+    /// @param STEP record type, providing:
+    ///          static STEP capture(const CORE& core)
+    ///          static gtestverilog::Trace toTrace(const std::vector<STEP>& steps)
+    template <class STEP>
+    class TraceRing {
+    public:
+        /// @param capacity maximum number of steps retained (2 steps per tick)
+        TraceRing(size_t capacity) : m_steps(capacity), m_next(0), m_size(0) {
+            assert(capacity > 0);
+        }
+
+        /// @brief record the current state of the core, overwriting the oldest step when full
+        template <class CORE>
+        void capture(const CORE& core) {
+            m_steps[m_next] = STEP::capture(core);
+
+            m_next += 1;
+            if (m_next == m_steps.size()) {
+                m_next = 0;
+            }
+
+            if (m_size < m_steps.size()) {
+                m_size += 1;
+            }
+        }
+
+        /// @brief discard all recorded steps
+        void clear() {
+            m_next = 0;
+            m_size = 0;
+        }
+
+        /// @brief number of steps currently recorded
+        size_t size() const {
+            return m_size;
+        }
+
+        /// @brief maximum number of steps that can be recorded
+        size_t capacity() const {
+            return m_steps.size();
+        }
+
+        /// @brief retrieve recorded steps, ordered from oldest to newest
+        std::vector<STEP> steps() const {
+            std::vector<STEP> ordered;
+            ordered.reserve(m_size);
+
+            size_t start = (m_next + m_steps.size() - m_size) % m_steps.size();
+            for (size_t i = 0; i < m_size; i++) {
+                ordered.push_back(m_steps[(start + i) % m_steps.size()]);
+            }
+
+            return ordered;
+        }
+
+        /// @brief convert the recorded steps into a trace, ordered from oldest to newest
+        gtestverilog::Trace toTrace() const {
+            return STEP::toTrace(steps());
+        }
+
+    private:
+        std::vector<STEP> m_steps;
+        size_t m_next;
+        size_t m_size;
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace simulation {
+    /// @class TripleBuffer
+    /// @brief Lock-free single producer / single consumer hand over of the most recent value
+    ///        (e.g. a completed video frame, from the simulation thread to the UI thread)
+    /// @note The producer fills back() and publishes it, the consumer takes the latest published
+    ///       value into front(). Neither side ever waits: the producer may publish many values
+    ///       between two consumes (intermediate values are dropped), and the consumer keeps its
+    ///       current front() until something new is published.
+    /// @note The buffer returned by back() after publish() holds a value that was published earlier
+    ///       (not necessarily the most recent one), as the consumer never writes to the buffers. So the
+    ///       producer must either fully overwrite it, or track what each buffer holds to update it
+    ///       incrementally (e.g. by version, as EmulatorNES does for the rows of a frame).
+    /// @param T value type, copy constructible
+    template <class T>
+    class TripleBuffer {
+    public:
+        /// @param initial value that all three buffers start with
+        explicit TripleBuffer(const T& initial = T()) : m_buffers{initial, initial, initial}, m_back(0), m_middle(1), m_front(2) {
+        }
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /// @brief buffer owned by the producer, to be filled before publish()
+        T& back() {
+            return m_buffers[m_back];
+        }
+
+        /// @brief hand the back buffer over to the consumer, and take ownership of a free buffer
+        void publish() {
+            m_back = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+        }
+
+        /// @brief take the most recently published buffer (if any) as the new front buffer
+        /// @return true if front() changed
+        bool consume() {
+            if ((m_middle.load(std::memory_order_relaxed) & kFresh) == 0) {
+                return false;
+            }
+
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & kIndexMask;
+
+            return true;
+        }
+
+        /// @brief buffer owned by the consumer, valid until the next consume()
+        const T& front() const {
+            return m_buffers[m_front];
+        }
+
+    private:
+        // the middle buffer is tagged when it holds a value that has not been consumed yet
+        static const uint8_t kFresh = 0x80;
+        static const uint8_t kIndexMask = 0x03;
+
+        T m_buffers[3];
+
+        uint8_t m_back;                         // producer only
+        std::atomic<uint8_t> m_middle;          // shared
+        uint8_t m_front;                        // consumer only
+    };
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "verilated_save.h"
+
+namespace simulation {
+    /// @class VerilatedModelWriter
+    /// @brief Serialise a Verilated model into memory, rather than to a file (VerilatedSave)
+    /// @note requires the model to be verilated with '--savable'
+    class VerilatedModelWriter : public VerilatedSerialize {
+    public:
+        VerilatedModelWriter(std::vector<uint8_t>& output) : m_output(output) {
+            m_isOpen = true;
+            header();
+        }
+
+        ~VerilatedModelWriter() override {
+            close();
+        }
+
+        void close() override {
+            if (m_isOpen) {
+                flush();
+                m_isOpen = false;
+            }
+        }
+
+        void flush() override {
+            m_output.insert(m_output.end(), m_bufp, m_cp);
+            m_cp = m_bufp;
+        }
+
+    private:
+        std::vector<uint8_t>& m_output;
+    };
+
+    /// @class VerilatedModelReader
+    /// @brief Deserialise a Verilated model from memory (e.g. a memory mapped snapshot),
+    ///        rather than from a file (VerilatedRestore)
+    class VerilatedModelReader : public VerilatedDeserialize {
+    public:
+        VerilatedModelReader(std::span<const uint8_t> input) : m_input(input) {
+            m_isOpen = true;
+            header();
+        }
+
+        ~VerilatedModelReader() override {
+            close();
+        }
+
+        void close() override {
+            m_isOpen = false;
+        }
+
+        void flush() override {}
+
+    protected:
+        void fill() override {
+            // move unread data to the start of the buffer
+            size_t numUnread = m_endp - m_cp;
+            memmove(m_bufp, m_cp, numUnread);
+            m_cp = m_bufp;
+            m_endp = m_bufp + numUnread;
+
+            size_t numCopied = std::min(bufferSize() - numUnread, m_input.size());
+            memcpy(m_endp, m_input.data(), numCopied);
+            m_endp += numCopied;
+            m_input = m_input.subspan(numCopied);
+        }
+
+    private:
+        std::span<const uint8_t> m_input;
+    };
+
+    /// @brief serialise the full state of a Verilated model
+    template <class CORE>
+    std::vector<uint8_t> saveModelState(CORE& core) {
+        std::vector<uint8_t> state;
+
+        {
+            VerilatedModelWriter writer(state);
+            writer << core;
+        }
+
+        return state;
+    }
+
+    /// @brief restore the full state of a Verilated model, captured with saveModelState()
+    template <class CORE>
+    void restoreModelState(CORE& core, std::span<const uint8_t> state) {
+        VerilatedModelReader reader(state);
+        reader >> core;
+    }
+}
@@ -0,0 +1,101 @@
+# compare throughput of the NES model between the default build, the optimised
+#  Verilator build (--config release-sim), and the optimised build with profile guided
+#  optimisation, trained on the boot of a ROM (e.g. Super Mario Bros) in emulator-nes-headless
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+
+BAZEL_FLAGS = ["--incompatible_require_linker_input_cc_api=false"]
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='benchmark default vs optimised vs PGO builds of the NES model')
+    parser.add_argument('--rom', '-r', default='roms/supermario.nes', dest='rom', help='filepath of .nes ROM file used to train PGO')
+    parser.add_argument('--frames', '-f', default='300', dest='frames', help='number of frames to simulate when training PGO')
+    parser.add_argument('--work', '-w', default='bench_nes_opt', dest='work', help='directory for binaries, profiles and results')
+    parser.add_argument('--no-pgo', dest='no_pgo', action='store_true', help='skip the profile guided build')
+    args = parser.parse_args()
+
+    return args
+
+def is_clang():
+    output = subprocess.check_output(["cc", "--version"]).decode()
+
+    return "clang" in output
+
+def bazel_build(targets, flags):
+    subprocess.check_call(["bazel", "build"] + BAZEL_FLAGS + flags + targets)
+
+def build_bench(work, name, flags):
+    bazel_build(["//nes:bench"], flags)
+
+    path = os.path.join(work, "bench-" + name)
+    shutil.copyfile("bazel-bin/nes/bench", path)
+    os.chmod(path, 0o755)
+
+    return path
+
+def build_pgo(args, work):
+    profile_dir = os.path.abspath(os.path.join(work, "profile"))
+    shutil.rmtree(profile_dir, ignore_errors=True)
+    os.makedirs(profile_dir)
+
+    # note: gcc names profiles by the absolute path of each object, so build outside the sandbox
+    #       for the paths to match between the two passes
+    pgo_flags = ["--config", "release-sim", "--spawn_strategy=local"]
+
+    # pass 1: instrumented build, trained on the boot of the ROM
+    generate = "-fprofile-generate=" + profile_dir
+    bazel_build(["//nes:emulator-nes-headless"], pgo_flags + ["--copt=" + generate, "--linkopt=" + generate])
+    subprocess.check_call(["bazel-bin/nes/emulator-nes-headless", "--rom", args.rom, "--frames", args.frames])
+
+    # pass 2: optimised by the profile
+    if is_clang():
+        profile = os.path.join(profile_dir, "nes.profdata")
+        raw_profiles = [os.path.join(profile_dir, f) for f in os.listdir(profile_dir) if f.endswith(".profraw")]
+        profdata = ["xcrun", "llvm-profdata"] if shutil.which("xcrun") else ["llvm-profdata"]
+        subprocess.check_call(profdata + ["merge", "-o", profile] + raw_profiles)
+        use_flags = ["--copt=-fprofile-use=" + profile, "--copt=-Wno-profile-instr-unprofiled"]
+    else:
+        use_flags = ["--copt=-fprofile-use=" + profile_dir, "--copt=-fprofile-partial-training", "--copt=-Wno-missing-profile"]
+
+    return build_bench(work, "pgo", pgo_flags + use_flags)
+
+def run_bench(path):
+    output = subprocess.check_output([path, "--benchmark_filter=BM_NES_", "--benchmark_format=json"])
+
+    return json.loads(output)
+
+def main():
+    args = parse_args()
+
+    os.makedirs(args.work, exist_ok=True)
+
+    variants = [
+        ("default", build_bench(args.work, "default", ["--config", "release"])),
+        ("opt", build_bench(args.work, "opt", ["--config", "release-sim"]))
+    ]
+
+    if not args.no_pgo:
+        variants.append(("pgo", build_pgo(args, args.work)))
+
+    results = {}
+    for name, path in variants:
+        results[name] = run_bench(path)
+
+    with open(os.path.join(args.work, "results.json"), "w") as file:
+        json.dump(results, file, indent=2)
+
+    print("benchmark        build    ticks/sec      speedup")
+
+    baseline = {benchmark["name"]: benchmark["ticks/sec"] for benchmark in results["default"]["benchmarks"]}
+    for name, _ in variants:
+        for benchmark in results[name]["benchmarks"]:
+            ticks_per_second = benchmark["ticks/sec"]
+            speedup = ticks_per_second / baseline[benchmark["name"]]
+            print("%-15s  %-7s  %-13.1f  %.2fx" % (benchmark["name"], name, ticks_per_second, speedup))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,50 @@
+# report throughput of full-frame rendering against the number of Verilator threads
+#  (run 'bazel build //nes:bench-nes-threads-1 //nes:bench-nes-threads-2 //nes:bench-nes-threads-4 --config release' first)
+
+import argparse
+import json
+import subprocess
+
+THREADS = [1, 2, 4]
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='benchmark NES rendering against the number of Verilator threads')
+    parser.add_argument('--bin', '-b', default='bazel-bin/nes', dest='bin', help='directory of the bench-nes-threads-N binaries')
+    parser.add_argument('--min-time', '-t', default='2', dest='min_time', help='minimum seconds to run each variant')
+    parser.add_argument('--out', '-o', dest='out', help='filepath to write the combined results (.json)')
+    args = parser.parse_args()
+
+    return args
+
+def run_variant(bin_dir, threads, min_time):
+    path = "%s/bench-nes-threads-%d" % (bin_dir, threads)
+    output = subprocess.check_output([path, "--benchmark_format=json", "--benchmark_min_time=%s" % min_time])
+
+    return json.loads(output)
+
+def main():
+    args = parse_args()
+
+    results = {}
+    for threads in THREADS:
+        results[threads] = run_variant(args.bin, threads, args.min_time)
+
+    print("threads  ticks/sec      frames/sec  speedup")
+
+    baseline = None
+    for threads in THREADS:
+        benchmark = results[threads]["benchmarks"][0]
+        ticks_per_second = benchmark["ticks/sec"]
+        frames_per_second = benchmark["frames/sec"]
+
+        if baseline is None:
+            baseline = ticks_per_second
+
+        print("%-7d  %-13.1f  %-10.3f  %.2fx" % (threads, ticks_per_second, frames_per_second, ticks_per_second / baseline))
+
+    if args.out:
+        with open(args.out, "w") as file:
+            json.dump({str(threads): results[threads] for threads in THREADS}, file, indent=2)
+
+if __name__ == "__main__":
+    main()